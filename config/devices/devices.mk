@@ -21,6 +21,15 @@ ifeq ($(strip $(device)),omp)
 CFLAGS+=-Wall -x c++
 CFLAGS+= -DTHRUST_DEVICE_SYSTEM=THRUST_DEVICE_SYSTEM_OMP
 CFLAGS+= $(OMPFLAG) 
+ifeq ($(strip $(numa)),yes)
+CFLAGS+= -DDG_NUMA #dg::DVec first-touches its pages (make numa=yes)
+endif #numa=yes
+ifeq ($(strip $(simd)),avx2)
+CFLAGS+= -mavx2 -mfma #dg::SVec kernels use AVX2 intrinsics (make simd=avx2)
+endif #simd=avx2
+ifeq ($(strip $(simd)),avx512)
+CFLAGS+= -mavx512f -mfma #dg::SVec kernels use AVX-512 intrinsics (make simd=avx512)
+endif #simd=avx512
 MPICFLAGS+=$(CFLAGS) #includes values in CFLAGS defined later
 endif #device=omp
 ifeq ($(strip $(device)),mic)
@@ -1,7 +1,10 @@
 #include <iostream>
+#include <cstdlib>
 
 #include "dg/blas1.h"
+#include "dg/backend/projection.cuh"
 #include "file/nc_utilities.h"
+#include "file/modal_output.h"
 
 
 //This program reads in two netcdf files and tries to compare the fields 
@@ -10,15 +13,39 @@
 // be of the same size. 
 // The physical boundaries and the coordinate system is assumed to be the same. 
 //Only fields at the same time can be compared.
+//If the numbers of polynomial coefficients n1 and n2 of both runs are given
+// the resolutions may differ (grid convergence studies): the fields are then
+// compared cell overlap by cell overlap with dg::OverlapNorm.
+//Fields written as modal coefficients (n_modal != 0) are reconstructed first.
+
+//reconstruct the 1d grid of a dimension from its n*N Gauss-node coordinates
+//(length must be a multiple of n)
+dg::Grid1d read_grid( int ncid, int dimID, size_t length, unsigned n)
+{
+    file::NC_Error_Handle err;
+    char name[NC_MAX_NAME+1];
+    int varID;
+    err = nc_inq_dimname( ncid, dimID, name);
+    err = nc_inq_varid( ncid, name, &varID);
+    std::vector<double> points( length);
+    err = nc_get_var_double( ncid, varID, &points[0]);
+    const unsigned N = length/n;
+    //the first and last node are a fraction d of a cell away from the boundaries
+    const double d = (1.+dg::DLT<double>( n).abscissas()[0])/2.;
+    const double lx = (points.back() - points.front())/(1.-2.*d/(double)N);
+    const double x0 = points.front() - d*lx/(double)N;
+    return dg::Grid1d( x0, x0+lx, n, N);
+}
 
 
 int main( int argc, char** argv)
 {
-    if( argc != 3)
+    if( argc != 3 && argc != 5)
     {
-        std::cerr << "Usage: "<<argv[0]<<" [file1.nc file2.nc]\n";
+        std::cerr << "Usage: "<<argv[0]<<" [file1.nc file2.nc] ([n1 n2])\n";
         return -1;
     }
+    const bool overlap = (argc == 5);
     std::cout << "Compare "<<argv[1]<<" with "<<argv[2]<<"\n";
     //////////////////////////////open nc files//////////////////////////////////
     file::NC_Error_Handle err;
@@ -55,6 +82,7 @@ int main( int argc, char** argv)
     for( int i=0; i<numDims1+1; i++)
     {
         std::cout << "Dimension "<<i<<" has "<<length1[i]<<" points!\n";
+        if( overlap && i < numDims1) continue;
         if( length1[i] != length2[i])
         {
             std::cerr << "Dimension lengths not equal!! "<<length1[i]<<" "<<length2[i]<<"\n";
@@ -62,15 +90,17 @@ int main( int argc, char** argv)
         }
     }
     int dataID1, dataID2;
+    std::string name = "electrons";
     try{
-        err = nc_inq_varid(ncid1, "electrons", &dataID1);
-        err = nc_inq_varid(ncid2, "electrons", &dataID2);
+        err = nc_inq_varid(ncid1, name.data(), &dataID1);
+        err = nc_inq_varid(ncid2, name.data(), &dataID2);
     }
     catch( file::NC_Error)
     {
         try{
-            err = nc_inq_varid(ncid1, "T", &dataID1);
-            err = nc_inq_varid(ncid2, "T", &dataID2);
+            name = "T";
+            err = nc_inq_varid(ncid1, name.data(), &dataID1);
+            err = nc_inq_varid(ncid2, name.data(), &dataID2);
         }
         catch( file::NC_Error)
         {
@@ -78,19 +108,48 @@ int main( int argc, char** argv)
             return -1;
         }
     }
-    size_t start[numDims1+1], count[numDims1+1], size=1;
+    size_t size1=1, size2=1;
     for( int i=0; i<numDims1; i++) {
-        start[numDims1-i] = 0;
-        count[numDims1-i] = length1[i];
-        size*=length1[i];
+        size1*=length1[i];
+        size2*=length2[i];
+    }
+    thrust::host_vector<double> input1( size1), input2( size2);
+    if( overlap)
+    {
+        const unsigned n1 = atoi( argv[3]), n2 = atoi( argv[4]);
+        if( n1 == 0 || n2 == 0)
+        {
+            std::cerr << "The numbers of polynomial coefficients must be positive!\n";
+            return -1;
+        }
+        for( int i=0; i<2; i++)
+            if( length1[i] % n1 != 0 || length2[i] % n2 != 0)
+            {
+                std::cerr << "Dimension "<<i<<" has "<<length1[i]<<" and "<<length2[i]
+                          <<" points, which are not multiples of n1 = "<<n1<<" and n2 = "<<n2<<"!\n";
+                return -1;
+            }
+        dg::Grid1d gx1 = read_grid( ncid1, dimIDs1[0], length1[0], n1), gx2 = read_grid( ncid2, dimIDs2[0], length2[0], n2);
+        dg::Grid1d gy1 = read_grid( ncid1, dimIDs1[1], length1[1], n1), gy2 = read_grid( ncid2, dimIDs2[1], length2[1], n2);
+        dg::Grid1d gz1( 0, 1, 1, 1), gz2( gz1);
+        if( numDims1 == 3)
+            gz1 = read_grid( ncid1, dimIDs1[2], length1[2], 1), gz2 = read_grid( ncid2, dimIDs2[2], length2[2], 1);
+        dg::OverlapNorm norm( dg::Grid3d( gx1, gy1, gz1), dg::Grid3d( gx2, gy2, gz2));
+        for( size_t i=0; i<length1[numDims1]; i++)
+        {
+            file::get_field_vara( ncid1, name.data(), i, input1); //nodal or modal output
+            file::get_field_vara( ncid2, name.data(), i, input2);
+            const double diff = norm( input1, input2), ref = norm( input1);
+            std::cout << "Abs. and rel. L2 difference at timestep \t"<<i<<"\t"<<diff<<"\t"<<diff/ref<<"\n";
+        }
+        err = nc_close(ncid1);
+        err = nc_close(ncid2);
+        return 0;
     }
-    start[0] = 0, count[0] = 1;
-    thrust::host_vector<double> input1( size), input2(input1);
     for( size_t i=0; i<length1[numDims1]; i++)
     {
-        start[0] = i;
-        err = nc_get_vara_double( ncid1, dataID1, start, count, input1.data());
-        err = nc_get_vara_double( ncid2, dataID2, start, count, input2.data());
+        file::get_field_vara( ncid1, name.data(), i, input1); //nodal or modal output
+        file::get_field_vara( ncid2, name.data(), i, input2);
         dg::blas1::axpby( 1., input1, -1., input2, input2);
         double norm = dg::blas1::dot( input1, input1);
         double diff = dg::blas1::dot( input2, input2);
@@ -14,6 +14,7 @@
 #include "dg/functors.h"
 
 #include "file/nc_utilities.h"
+#include "file/prefetch.h"
 #include "feltorShw/parameters.h"
 // #include "probes.h"
 
@@ -65,7 +66,6 @@ int main( int argc, char* argv[])
     dg::HVec temp(dg::evaluate(dg::zero,g2d));
     dg::HVec temp1(dg::evaluate(dg::zero,g2d));
     dg::HVec temp2(dg::evaluate(dg::zero,g2d));
-    dg::HVec temp_in(dg::evaluate(dg::zero,g2d_in));
     dg::HVec one(dg::evaluate(dg::one,g2d));
     dg::HVec one1d(dg::evaluate(dg::one,g1d));
     dg::HVec temp1d(dg::evaluate(dg::zero,g1d));
@@ -80,10 +80,7 @@ int main( int argc, char* argv[])
     dg::Elliptic<dg::CartesianGrid2d, dg::HMatrix, dg::HVec> pol(g2d,   p.bc_x_phi, p.bc_y, dg::normed, dg::centered);
 
     //2d field
-    size_t count2d[3]  = {1, g2d_in.n()*g2d_in.Ny(), g2d_in.n()*g2d_in.Nx()};
-    size_t start2d[3]  = {0, 0, 0};
     std::string names[4] = {"electrons", "ions",  "potential","vor"}; 
-    int dataIDs[4]; 
     //1d profiles
     file::NC_Error_Handle err_out;
     int ncid_out,dataIDs1d[24], tvarIDout;
@@ -208,327 +205,321 @@ int main( int argc, char* argv[])
     err = nc_inq_dimlen(ncid, timeID, &steps);
     steps-=1;
     imax = steps;
-    for( unsigned i=imin; i<imax; i++)//timestepping
+    //the next time slice is read while the current one is analysed;
+    //the reader's thread is joined at the end of the block before the files are closed
     {
-            start2d[0] = i;
+        file::PrefetchReader prefetch( ncid, std::vector<std::string>( names, names+4), imin, imax);
+        file::Slice slice;
+        for( unsigned i=imin; i<imax; i++)//timestepping
+        {
 //             start2d_out[0] = i;
-            start1d[0] = i;
-            time += p.itstp*p.dt;
+                start1d[0] = i;
+                time += p.itstp*p.dt;
 
-            std::cout << "time = "<< time <<  std::endl;
+                std::cout << "time = "<< time <<  std::endl;
 
-            double Tperp,Tperpz,Tperpratio,Gamma_ne,Omega,Omegaz,Omegaratio;
+                prefetch.next( slice);
+                double Tperp,Tperpz,Tperpratio,Gamma_ne,Omega,Omegaz,Omegaratio;
             
-            err = nc_inq_varid(ncid, names[2].data(), &dataIDs[2]);
-            err = nc_get_vara_double( ncid, dataIDs[2], start2d, count2d,  temp_in.data());
-            dg::blas2::gemv( interp_in, temp_in,phi);
-            err = nc_inq_varid(ncid, names[3].data(), &dataIDs[3]);
-            err = nc_get_vara_double( ncid, dataIDs[3], start2d, count2d,  temp_in.data());
-            dg::blas2::gemv( interp_in, temp_in,vor);
-            //Full-F
-            if (p.modelmode==0 || p.modelmode==1)
-            {
-                err = nc_inq_varid(ncid, names[0].data(), &dataIDs[0]);
-                err = nc_get_vara_double( ncid, dataIDs[0], start2d, count2d, temp_in.data());
-                dg::blas2::gemv( interp_in, temp_in,npe[0]);
-                err = nc_inq_varid(ncid, names[1].data(), &dataIDs[1]);
-                err = nc_get_vara_double( ncid, dataIDs[1], start2d, count2d,  temp_in.data());
-                dg::blas2::gemv( interp_in, temp_in,npe[1]);
+                dg::blas2::gemv( interp_in, slice.fields[2],phi);
+                dg::blas2::gemv( interp_in, slice.fields[3],vor);
+                //Full-F
+                if (p.modelmode==0 || p.modelmode==1)
+                {
+                    dg::blas2::gemv( interp_in, slice.fields[0],npe[0]);
+                    dg::blas2::gemv( interp_in, slice.fields[1],npe[1]);
                  
-                for (unsigned i=0;i<2;i++) {
-                    dg::blas1::transform(npe[i], npe[i], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
-                    dg::blas1::transform( npe[i], logn[i], dg::LN<double>());
-                    dg::blas1::pointwiseDivide(npe[i],nprof,ntilde[i]);
-                    dg::blas1::transform(ntilde[i], ntilde[i], dg::PLUS<>(-1.0));
+                    for (unsigned i=0;i<2;i++) {
+                        dg::blas1::transform(npe[i], npe[i], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
+                        dg::blas1::transform( npe[i], logn[i], dg::LN<double>());
+                        dg::blas1::pointwiseDivide(npe[i],nprof,ntilde[i]);
+                        dg::blas1::transform(ntilde[i], ntilde[i], dg::PLUS<>(-1.0));
 		    
-		    polavg(npe[i],temp);
-		    dg::blas1::pointwiseDivide(npe[i],temp,navgtilde[i]);
-		    dg::blas1::transform(navgtilde[i], navgtilde[i], dg::PLUS<>(-1.0));
+    		    polavg(npe[i],temp);
+    		    dg::blas1::pointwiseDivide(npe[i],temp,navgtilde[i]);
+    		    dg::blas1::transform(navgtilde[i], navgtilde[i], dg::PLUS<>(-1.0));
 		    
-                }
+                    }
 
-                poisson.variationRHS(phi,temp2);
-                Tperp = 0.5*dg::blas2::dot( one, w2d, temp2);   // 0.5   u_E^2            
-                polavg(phi,temp);      // <N u_E^2 > 
-                poisson.variationRHS(temp,temp2);
-                Tperpz = 0.5*dg::blas2::dot( one, w2d, temp2);   //0.5 ( D_x <phi> )^2 
-                Tperpratio = Tperpz/Tperp;
-                dg::blas2::gemv( poisson.dyrhs(), phi, temp2); 
-                Gamma_ne = -1.* dg::blas2::dot(npe[0],w2d,temp2);
+                    poisson.variationRHS(phi,temp2);
+                    Tperp = 0.5*dg::blas2::dot( one, w2d, temp2);   // 0.5   u_E^2            
+                    polavg(phi,temp);      // <N u_E^2 > 
+                    poisson.variationRHS(temp,temp2);
+                    Tperpz = 0.5*dg::blas2::dot( one, w2d, temp2);   //0.5 ( D_x <phi> )^2 
+                    Tperpratio = Tperpz/Tperp;
+                    dg::blas2::gemv( poisson.dyrhs(), phi, temp2); 
+                    Gamma_ne = -1.* dg::blas2::dot(npe[0],w2d,temp2);
 
                
-                pol.set_chi(one);
-                dg::blas2::symv(pol,phi,temp); //- nabla ( nabla phi)
-                dg::blas1::scal(temp,-1.);     // nabla ( nabla phi)
-                Omega = 0.5* dg::blas2::dot( temp, w2d, temp);  // (nabla (N nabla phi) )^2              
-                polavg(phi,temp2);      // <N u_E^2 > 
-                dg::blas2::symv(pol,temp2,temp); //- nabla ( nabla <phi>)
-                dg::blas1::scal(temp,-1.);     // nabla ( nabla <phi>)
-                Omegaz =0.5* dg::blas2::dot( temp, w2d, temp);   //< nabla (N nabla phi) >^2 or better < nabla (N nabla phi)^2 >?
-                Omegaratio = Omegaz/Omega;
+                    pol.set_chi(one);
+                    dg::blas2::symv(pol,phi,temp); //- nabla ( nabla phi)
+                    dg::blas1::scal(temp,-1.);     // nabla ( nabla phi)
+                    Omega = 0.5* dg::blas2::dot( temp, w2d, temp);  // (nabla (N nabla phi) )^2              
+                    polavg(phi,temp2);      // <N u_E^2 > 
+                    dg::blas2::symv(pol,temp2,temp); //- nabla ( nabla <phi>)
+                    dg::blas1::scal(temp,-1.);     // nabla ( nabla <phi>)
+                    Omegaz =0.5* dg::blas2::dot( temp, w2d, temp);   //< nabla (N nabla phi) >^2 or better < nabla (N nabla phi)^2 >?
+                    Omegaratio = Omegaz/Omega;
                 
-                //Favre and conventional Reynolds stress
-                polavg(npe[0],anpe);
-                dg::blas1::axpby(1.0,npe[0],-1.0,anpe,dne);
-                dg::blas2::gemv(poisson.dxrhs(),phi,uy);
-                dg::blas2::gemv(poisson.dyrhs(),phi,ux);
-                dg::blas1::scal(ux,-1.0);
+                    //Favre and conventional Reynolds stress
+                    polavg(npe[0],anpe);
+                    dg::blas1::axpby(1.0,npe[0],-1.0,anpe,dne);
+                    dg::blas2::gemv(poisson.dxrhs(),phi,uy);
+                    dg::blas2::gemv(poisson.dyrhs(),phi,ux);
+                    dg::blas1::scal(ux,-1.0);
 
-                //conventional Reynolds stress
-                polavg(ux,aux);
-                polavg(uy,auy);
-                dg::blas1::axpby(1.0,ux,-1.0,aux,tux);
-                dg::blas1::axpby(1.0,uy,-1.0,auy,tuy);
-                dg::blas1::pointwiseDot(tuy,tux,temp);
-                polavg(temp,R);
+                    //conventional Reynolds stress
+                    polavg(ux,aux);
+                    polavg(uy,auy);
+                    dg::blas1::axpby(1.0,ux,-1.0,aux,tux);
+                    dg::blas1::axpby(1.0,uy,-1.0,auy,tuy);
+                    dg::blas1::pointwiseDot(tuy,tux,temp);
+                    polavg(temp,R);
                 
-                //Favre Reynolds stress
-                dg::blas1::pointwiseDot(ux,npe[0],temp1);
-                polavg(temp1,faux);
-                dg::blas1::pointwiseDivide(faux,anpe,faux);
-                dg::blas1::axpby(1.0,ux,-1.0,faux,ftux);
-                dg::blas1::pointwiseDot(uy,npe[0],temp1);
-                polavg(temp1,fauy);
-                dg::blas1::pointwiseDivide(fauy,anpe,fauy);
-                dg::blas1::axpby(1.0,uy,-1.0,fauy,ftuy);
-                dg::blas1::pointwiseDot(ftuy,ftux,temp);
-                dg::blas1::pointwiseDot(temp,npe[0],temp);
-                polavg(temp,temp1);
-                dg::blas1::pointwiseDivide(temp1,anpe,Rf);
-            }
-            //delta-f
-            if (p.modelmode==2)
-            { 
-                err = nc_inq_varid(ncid, names[0].data(), &dataIDs[0]);
-                err = nc_get_vara_double( ncid, dataIDs[0], start2d, count2d, temp_in.data());
-                dg::blas2::gemv( interp_in, temp_in,ntilde[0]);
-                err = nc_inq_varid(ncid, names[1].data(), &dataIDs[1]);
-                err = nc_get_vara_double( ncid, dataIDs[1], start2d, count2d,  temp_in.data());
-                dg::blas2::gemv( interp_in, temp_in,ntilde[1]);
+                    //Favre Reynolds stress
+                    dg::blas1::pointwiseDot(ux,npe[0],temp1);
+                    polavg(temp1,faux);
+                    dg::blas1::pointwiseDivide(faux,anpe,faux);
+                    dg::blas1::axpby(1.0,ux,-1.0,faux,ftux);
+                    dg::blas1::pointwiseDot(uy,npe[0],temp1);
+                    polavg(temp1,fauy);
+                    dg::blas1::pointwiseDivide(fauy,anpe,fauy);
+                    dg::blas1::axpby(1.0,uy,-1.0,fauy,ftuy);
+                    dg::blas1::pointwiseDot(ftuy,ftux,temp);
+                    dg::blas1::pointwiseDot(temp,npe[0],temp);
+                    polavg(temp,temp1);
+                    dg::blas1::pointwiseDivide(temp1,anpe,Rf);
+                }
+                //delta-f
+                if (p.modelmode==2)
+                { 
+                    dg::blas2::gemv( interp_in, slice.fields[0],ntilde[0]);
+                    dg::blas2::gemv( interp_in, slice.fields[1],ntilde[1]);
 
-                for (unsigned i=0;i<2;i++) {
-                    dg::blas1::pointwiseDot(nprof,ntilde[i],temp);
-                    dg::blas1::axpby(1.0,nprof,1.0,temp,npe[i]);
-                    dg::blas1::transform( npe[i], logn[i], dg::LN<double>());
+                    for (unsigned i=0;i<2;i++) {
+                        dg::blas1::pointwiseDot(nprof,ntilde[i],temp);
+                        dg::blas1::axpby(1.0,nprof,1.0,temp,npe[i]);
+                        dg::blas1::transform( npe[i], logn[i], dg::LN<double>());
 		    
-		    polavg(npe[i],temp);
-		    dg::blas1::pointwiseDivide(npe[i],temp,navgtilde[i]);
-		    dg::blas1::transform(navgtilde[i], navgtilde[i], dg::PLUS<>(-1.0));
-                }
+    		    polavg(npe[i],temp);
+    		    dg::blas1::pointwiseDivide(npe[i],temp,navgtilde[i]);
+    		    dg::blas1::transform(navgtilde[i], navgtilde[i], dg::PLUS<>(-1.0));
+                    }
                                     
-                poisson.variationRHS(phi,temp2);
-                Tperp = 0.5*dg::blas2::dot( one, w2d, temp2);   // 0.5   u_E^2            
-                polavg(phi,temp);      // <N u_E^2 > 
-                poisson.variationRHS(temp,temp2);
-                Tperpz = 0.5*dg::blas2::dot( one, w2d, temp2);   //0.5 ( D_x <phi> )^2 
-                Tperpratio = Tperpz/Tperp;
-                dg::blas2::gemv( poisson.dyrhs(), phi, temp2); 
-                Gamma_ne = -1.* dg::blas2::dot(npe[0],w2d,temp2);
+                    poisson.variationRHS(phi,temp2);
+                    Tperp = 0.5*dg::blas2::dot( one, w2d, temp2);   // 0.5   u_E^2            
+                    polavg(phi,temp);      // <N u_E^2 > 
+                    poisson.variationRHS(temp,temp2);
+                    Tperpz = 0.5*dg::blas2::dot( one, w2d, temp2);   //0.5 ( D_x <phi> )^2 
+                    Tperpratio = Tperpz/Tperp;
+                    dg::blas2::gemv( poisson.dyrhs(), phi, temp2); 
+                    Gamma_ne = -1.* dg::blas2::dot(npe[0],w2d,temp2);
 
                
-                pol.set_chi(one);
-                dg::blas2::symv(pol,phi,temp); //- nabla ( nabla phi)
-                dg::blas1::scal(temp,-1.);     // nabla ( nabla phi)
-                Omega = 0.5* dg::blas2::dot( temp, w2d, temp);  // (nabla (N nabla phi) )^2              
-                polavg(phi,temp2);      // <N u_E^2 > 
-                dg::blas2::symv(pol,temp2,temp); //- nabla ( nabla <phi>)
-                dg::blas1::scal(temp,-1.);     // nabla ( nabla <phi>)
-                Omegaz =0.5* dg::blas2::dot( temp, w2d, temp);   //< nabla (N nabla phi) >^2 or better < nabla (N nabla phi)^2 >?
-                Omegaratio = Omegaz/Omega;
+                    pol.set_chi(one);
+                    dg::blas2::symv(pol,phi,temp); //- nabla ( nabla phi)
+                    dg::blas1::scal(temp,-1.);     // nabla ( nabla phi)
+                    Omega = 0.5* dg::blas2::dot( temp, w2d, temp);  // (nabla (N nabla phi) )^2              
+                    polavg(phi,temp2);      // <N u_E^2 > 
+                    dg::blas2::symv(pol,temp2,temp); //- nabla ( nabla <phi>)
+                    dg::blas1::scal(temp,-1.);     // nabla ( nabla <phi>)
+                    Omegaz =0.5* dg::blas2::dot( temp, w2d, temp);   //< nabla (N nabla phi) >^2 or better < nabla (N nabla phi)^2 >?
+                    Omegaratio = Omegaz/Omega;
                 
-                //Favre Reynolds stress
-                polavg(npe[0],anpe);
-                dg::blas1::axpby(1.0,npe[0],-1.0,anpe,dne);
-                dg::blas2::gemv(poisson.dxrhs(),phi,uy);
-                dg::blas2::gemv(poisson.dyrhs(),phi,ux);
-                dg::blas1::scal(ux,-1.0);
+                    //Favre Reynolds stress
+                    polavg(npe[0],anpe);
+                    dg::blas1::axpby(1.0,npe[0],-1.0,anpe,dne);
+                    dg::blas2::gemv(poisson.dxrhs(),phi,uy);
+                    dg::blas2::gemv(poisson.dyrhs(),phi,ux);
+                    dg::blas1::scal(ux,-1.0);
 
-                dg::blas1::pointwiseDot(ux,npe[0],temp1);
-                polavg(temp1,faux);
-                dg::blas1::pointwiseDivide(faux,anpe,faux);
-                dg::blas1::axpby(1.0,ux,-1.0,faux,ftux);
-                dg::blas1::pointwiseDot(uy,npe[0],temp1);
-                polavg(temp1,fauy);
-                dg::blas1::pointwiseDivide(fauy,anpe,fauy);
-                dg::blas1::axpby(1.0,uy,-1.0,fauy,ftuy);
-                dg::blas1::pointwiseDot(ftuy,ftux,temp);
-                dg::blas1::pointwiseDot(temp,npe[0],temp);
-                polavg(temp,temp1);
-                dg::blas1::pointwiseDivide(temp1,anpe,Rf);
-            }
+                    dg::blas1::pointwiseDot(ux,npe[0],temp1);
+                    polavg(temp1,faux);
+                    dg::blas1::pointwiseDivide(faux,anpe,faux);
+                    dg::blas1::axpby(1.0,ux,-1.0,faux,ftux);
+                    dg::blas1::pointwiseDot(uy,npe[0],temp1);
+                    polavg(temp1,fauy);
+                    dg::blas1::pointwiseDivide(fauy,anpe,fauy);
+                    dg::blas1::axpby(1.0,uy,-1.0,fauy,ftuy);
+                    dg::blas1::pointwiseDot(ftuy,ftux,temp);
+                    dg::blas1::pointwiseDot(temp,npe[0],temp);
+                    polavg(temp,temp1);
+                    dg::blas1::pointwiseDivide(temp1,anpe,Rf);
+                }
             
-        polavg(phi,temp);      //<phi>      
-        dg::blas2::gemv(interp,temp,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[4],   start1d, count1d, temp1d.data()); //<phi>      
-        polavg(vor,temp);     //<nabla_perp^2 phi>      
-        dg::blas2::gemv(interp,temp,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[5],   start1d, count1d, temp1d.data()); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[6],   start1d, count1d, xcoo.data());             
-        dg::blas2::gemv(poisson.dxrhs(),phi,temp);
-        polavg(temp,temp2);             //<u_Ey>    
-        dg::blas2::gemv(interp,temp2,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[7],   start1d, count1d, temp1d.data());           
+            polavg(phi,temp);      //<phi>      
+            dg::blas2::gemv(interp,temp,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[4],   start1d, count1d, temp1d.data()); //<phi>      
+            polavg(vor,temp);     //<nabla_perp^2 phi>      
+            dg::blas2::gemv(interp,temp,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[5],   start1d, count1d, temp1d.data()); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[6],   start1d, count1d, xcoo.data());             
+            dg::blas2::gemv(poisson.dxrhs(),phi,temp);
+            polavg(temp,temp2);             //<u_Ey>    
+            dg::blas2::gemv(interp,temp2,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[7],   start1d, count1d, temp1d.data());           
         
-        //Compute the 4 terms on the RHS
-        dg::blas2::gemv(poisson.dxrhs(),Rf,temp1);
-        dg::blas1::scal(temp1,-1.0); //-dx Rf
-        dg::blas1::axpby(1.0,temp1,0.0,temp); 
-	    double Rfxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[8],   start1d, count1d, temp1d.data()); //Rfx =- dx Rf
-        dg::blas2::gemv(poisson.dxrhs(),fauy,temp1); // dx fauy
-        dg::blas1::pointwiseDot(faux,temp1,temp1); // faux dx fauy
-        dg::blas1::scal(temp1,-1.0);  // -  faux dx fauy
-        dg::blas1::axpby(1.0,temp1,1.0,temp);  
-	    double Anorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[9],   start1d, count1d, temp1d.data()); //A =  -  faux dx fauy
-        dg::blas1::transform(anpe, temp2, dg::LN<double>()); //ln<n_e>
-        dg::blas2::gemv(poisson.dxlhs(),temp2,temp1); // dx ln<n_e>
-        dg::blas2::gemv(interp,temp1,temp1d); // dx ln<n_e> =- kappa(x)
-        double invkappaavg = -p.lx/dg::blas2::dot(one1d,w1d,temp1d); //-1/(dx ln<n_e>)
-        dg::blas1::scal(temp1d,-1.0);   // -dx ln<n_e>   
-        dg::blas1::transform(temp1d,temp1d, dg::INVERT<double>()); // -1/dx ln<n_e>   
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[14],   start1d, count1d, temp1d.data());  //invkappa(x) = -dxln<n_e>  
-        dg::blas1::pointwiseDot(Rf,temp1,temp2); // Rf dx ln<n_e>
-        dg::blas1::axpby(1.0,temp2,1.0,temp);  
-	    double Rfnnorm = sqrt(dg::blas2::dot(temp2,w2d,temp2))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp2,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[10],   start1d, count1d, temp1d.data()); //Rfn = Rf dx ln<n_e>
-        dg::blas1::pointwiseDot(faux,temp1,temp2); // faux dx ln<n_e>
-        dg::blas1::pointwiseDot(fauy,temp2,temp1); // faux fauy dx ln<n_e>
-        dg::blas1::scal(temp1,2.0);  // 2 faux fauy dx ln<n_e>
-        dg::blas1::axpby(1.0,temp1,1.0,temp);  
-	    double Annorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[11],   start1d, count1d, temp1d.data()); //An = 2 faux fauy dx ln<n_e>
-        double dtfauynorm = sqrt(dg::blas2::dot(temp,w2d,temp))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[12],   start1d, count1d, temp1d.data()); //Rfx+A+Rfn+An
-        dg::blas2::gemv(poisson.dxrhs(),R,temp1);
-        dg::blas1::scal(temp1,-1.0); //-dx R
-	    double Rxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[13],   start1d, count1d, temp1d.data()); // Rx = - dx R
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[15],   start1d, count1d, fauy.data()); 
-        dg::blas1::pointwiseDot(npe[0],uy,temp2); //n u_y
-        polavg(temp2,temp1);   //< n u_y >
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[16],   start1d, count1d, temp1d.data()); //< n u_y >
-        dg::blas1::pointwiseDot(R,anpe,temp2);
-        dg::blas2::gemv(poisson.dxrhs(),temp2,temp1);
-        dg::blas1::scal(temp1,-1.0); //temp1 = -dx ( <n_e>  R)
-	    double Rnxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-	    dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[17],   start1d, count1d, temp1d.data()); //Rnx = -dx ( <n_e>  R)
-        dg::blas1::pointwiseDot(dne,tux,temp1);
-        polavg(temp1,temp2);   //temp2 = <\delta ne \ðelta u_y >
-        dg::blas1::pointwiseDot(temp2,auy,temp2); //temp2 =<u_y> <\delta ne \ðelta u_y >
-        dg::blas1::pointwiseDivide(temp2,anpe,temp); //temp2 =<u_y> <\delta ne \ðelta u_y >/<n_e>
-        dg::blas2::gemv(poisson.dxrhs(),temp2,temp1); //temp1 = dx (<u_y> <\delta ne \ðelta u_y >)
-        dg::blas1::scal(temp1,-1.0); //temp1 = -dx (<u_y> <\delta ne \ðelta u_y >)
-	    double Guyxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[18],   start1d, count1d, temp1d.data()); //Guyx =  -dx (<u_y> <\delta ne \ðelta u_y >)
-        dg::blas2::gemv(poisson.dxrhs(),temp,temp1); //temp1 = dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)
-        dg::blas1::scal(temp1,-1.0); //temp1 = -dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)
-	    double Guynxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[20],   start1d, count1d, temp1d.data()); //Guynx =  -dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)            
-        dg::blas1::pointwiseDot(dne,tux,temp1);       //temp1 = \delta n_e \delta u_x
-        dg::blas1::pointwiseDot(tuy,temp1,temp1);     //temp1 = \delta n_e \delta u_x \delta u_y
-        polavg(temp1,temp2);                          //temp2 = <\delta n_e \delta u_x \delta u_y >
-        dg::blas1::pointwiseDivide(temp2,anpe,temp);
-        dg::blas2::gemv(poisson.dxrhs(),temp2,temp1); //temp1 = dx <\delta n_e \delta u_x \delta u_y >
-        dg::blas1::scal(temp1,-1.0);                  //temp1 =-dx <\delta n_e \delta u_x \delta u_y >
-	    double Txnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d);             
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[19], start1d, count1d, temp1d.data()); //Tx =  - dx <\delta n_e \delta u_x \delta u_y >
-        dg::blas2::gemv(poisson.dxrhs(),temp,temp1); //temp1 = dx <\delta n_e \delta u_x \delta u_y >
-        dg::blas1::scal(temp1,-1.0);                  //temp1 =-dx <\delta n_e \delta u_x \delta u_y >
-	    double Tnxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
-        dg::blas2::gemv(interp,temp1,temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[21],   start1d, count1d, temp1d.data()); //Tnx =  - dx ( <\delta n_e \delta u_x \delta u_y >/<n_e>
+            //Compute the 4 terms on the RHS
+            dg::blas2::gemv(poisson.dxrhs(),Rf,temp1);
+            dg::blas1::scal(temp1,-1.0); //-dx Rf
+            dg::blas1::axpby(1.0,temp1,0.0,temp); 
+    	    double Rfxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[8],   start1d, count1d, temp1d.data()); //Rfx =- dx Rf
+            dg::blas2::gemv(poisson.dxrhs(),fauy,temp1); // dx fauy
+            dg::blas1::pointwiseDot(faux,temp1,temp1); // faux dx fauy
+            dg::blas1::scal(temp1,-1.0);  // -  faux dx fauy
+            dg::blas1::axpby(1.0,temp1,1.0,temp);  
+    	    double Anorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[9],   start1d, count1d, temp1d.data()); //A =  -  faux dx fauy
+            dg::blas1::transform(anpe, temp2, dg::LN<double>()); //ln<n_e>
+            dg::blas2::gemv(poisson.dxlhs(),temp2,temp1); // dx ln<n_e>
+            dg::blas2::gemv(interp,temp1,temp1d); // dx ln<n_e> =- kappa(x)
+            double invkappaavg = -p.lx/dg::blas2::dot(one1d,w1d,temp1d); //-1/(dx ln<n_e>)
+            dg::blas1::scal(temp1d,-1.0);   // -dx ln<n_e>   
+            dg::blas1::transform(temp1d,temp1d, dg::INVERT<double>()); // -1/dx ln<n_e>   
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[14],   start1d, count1d, temp1d.data());  //invkappa(x) = -dxln<n_e>  
+            dg::blas1::pointwiseDot(Rf,temp1,temp2); // Rf dx ln<n_e>
+            dg::blas1::axpby(1.0,temp2,1.0,temp);  
+    	    double Rfnnorm = sqrt(dg::blas2::dot(temp2,w2d,temp2))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp2,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[10],   start1d, count1d, temp1d.data()); //Rfn = Rf dx ln<n_e>
+            dg::blas1::pointwiseDot(faux,temp1,temp2); // faux dx ln<n_e>
+            dg::blas1::pointwiseDot(fauy,temp2,temp1); // faux fauy dx ln<n_e>
+            dg::blas1::scal(temp1,2.0);  // 2 faux fauy dx ln<n_e>
+            dg::blas1::axpby(1.0,temp1,1.0,temp);  
+    	    double Annorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[11],   start1d, count1d, temp1d.data()); //An = 2 faux fauy dx ln<n_e>
+            double dtfauynorm = sqrt(dg::blas2::dot(temp,w2d,temp))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[12],   start1d, count1d, temp1d.data()); //Rfx+A+Rfn+An
+            dg::blas2::gemv(poisson.dxrhs(),R,temp1);
+            dg::blas1::scal(temp1,-1.0); //-dx R
+    	    double Rxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[13],   start1d, count1d, temp1d.data()); // Rx = - dx R
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[15],   start1d, count1d, fauy.data()); 
+            dg::blas1::pointwiseDot(npe[0],uy,temp2); //n u_y
+            polavg(temp2,temp1);   //< n u_y >
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[16],   start1d, count1d, temp1d.data()); //< n u_y >
+            dg::blas1::pointwiseDot(R,anpe,temp2);
+            dg::blas2::gemv(poisson.dxrhs(),temp2,temp1);
+            dg::blas1::scal(temp1,-1.0); //temp1 = -dx ( <n_e>  R)
+    	    double Rnxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+    	    dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[17],   start1d, count1d, temp1d.data()); //Rnx = -dx ( <n_e>  R)
+            dg::blas1::pointwiseDot(dne,tux,temp1);
+            polavg(temp1,temp2);   //temp2 = <\delta ne \ðelta u_y >
+            dg::blas1::pointwiseDot(temp2,auy,temp2); //temp2 =<u_y> <\delta ne \ðelta u_y >
+            dg::blas1::pointwiseDivide(temp2,anpe,temp); //temp2 =<u_y> <\delta ne \ðelta u_y >/<n_e>
+            dg::blas2::gemv(poisson.dxrhs(),temp2,temp1); //temp1 = dx (<u_y> <\delta ne \ðelta u_y >)
+            dg::blas1::scal(temp1,-1.0); //temp1 = -dx (<u_y> <\delta ne \ðelta u_y >)
+    	    double Guyxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[18],   start1d, count1d, temp1d.data()); //Guyx =  -dx (<u_y> <\delta ne \ðelta u_y >)
+            dg::blas2::gemv(poisson.dxrhs(),temp,temp1); //temp1 = dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)
+            dg::blas1::scal(temp1,-1.0); //temp1 = -dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)
+    	    double Guynxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[20],   start1d, count1d, temp1d.data()); //Guynx =  -dx (<u_y> <\delta ne \ðelta u_y >/<n_e>)            
+            dg::blas1::pointwiseDot(dne,tux,temp1);       //temp1 = \delta n_e \delta u_x
+            dg::blas1::pointwiseDot(tuy,temp1,temp1);     //temp1 = \delta n_e \delta u_x \delta u_y
+            polavg(temp1,temp2);                          //temp2 = <\delta n_e \delta u_x \delta u_y >
+            dg::blas1::pointwiseDivide(temp2,anpe,temp);
+            dg::blas2::gemv(poisson.dxrhs(),temp2,temp1); //temp1 = dx <\delta n_e \delta u_x \delta u_y >
+            dg::blas1::scal(temp1,-1.0);                  //temp1 =-dx <\delta n_e \delta u_x \delta u_y >
+    	    double Txnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d);             
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[19], start1d, count1d, temp1d.data()); //Tx =  - dx <\delta n_e \delta u_x \delta u_y >
+            dg::blas2::gemv(poisson.dxrhs(),temp,temp1); //temp1 = dx <\delta n_e \delta u_x \delta u_y >
+            dg::blas1::scal(temp1,-1.0);                  //temp1 =-dx <\delta n_e \delta u_x \delta u_y >
+    	    double Tnxnorm = sqrt(dg::blas2::dot(temp1,w2d,temp1))/p.lx/p.ly;
+            dg::blas2::gemv(interp,temp1,temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[21],   start1d, count1d, temp1d.data()); //Tnx =  - dx ( <\delta n_e \delta u_x \delta u_y >/<n_e>
         
-	    double netnorm = sqrt(dg::blas2::dot(ntilde[0],w2d,ntilde[0]))/p.ly;
-	    dg::blas2::gemv(interp,ntilde[0],temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[22],   start1d, count1d, temp1d.data()); //netilde
-	    double neatnorm = sqrt(dg::blas2::dot(navgtilde[0],w2d,navgtilde[0]))/p.ly;
-	    dg::blas2::gemv(interp,navgtilde[0],temp1d); 
-        err_out = nc_put_vara_double( ncid_out, dataIDs1d[23],   start1d, count1d, temp1d.data()); //neavgtilde
+    	    double netnorm = sqrt(dg::blas2::dot(ntilde[0],w2d,ntilde[0]))/p.ly;
+    	    dg::blas2::gemv(interp,ntilde[0],temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[22],   start1d, count1d, temp1d.data()); //netilde
+    	    double neatnorm = sqrt(dg::blas2::dot(navgtilde[0],w2d,navgtilde[0]))/p.ly;
+    	    dg::blas2::gemv(interp,navgtilde[0],temp1d); 
+            err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[23],   start1d, count1d, temp1d.data()); //neavgtilde
             
 	
-	double sumnorm = Rxnorm + Guynxnorm+ Tnxnorm + Anorm + Annorm + Rfnnorm;
-	double Rxnormscal = Rxnorm/sumnorm;
-	double Guynxnormscal = Guynxnorm/sumnorm;
-	double Tnxnormscal = Tnxnorm/sumnorm;
-	double Anormscal = Anorm/sumnorm;
-	double Annormscal = Annorm/sumnorm;
-	double Rfnnormscal = Rfnnorm/sumnorm;
-            //write 2d fields (ne,phi,vor)
+    	double sumnorm = Rxnorm + Guynxnorm+ Tnxnorm + Anorm + Annorm + Rfnnorm;
+    	double Rxnormscal = Rxnorm/sumnorm;
+    	double Guynxnormscal = Guynxnorm/sumnorm;
+    	double Tnxnormscal = Tnxnorm/sumnorm;
+    	double Anormscal = Anorm/sumnorm;
+    	double Annormscal = Annorm/sumnorm;
+    	double Rfnnormscal = Rfnnorm/sumnorm;
+                //write 2d fields (ne,phi,vor)
 //          UNCOMMENT for 2d output
-//             err_out = nc_put_vara_double( ncid_out, dataIDs2d[0], start2d_out, count2d_out, npe[0].data());
-//             err_out = nc_put_vara_double( ncid_out, dataIDs2d[1], start2d_out, count2d_out, phi.data());
-//             err_out = nc_put_vara_double( ncid_out, dataIDs2d[2], start2d_out, count2d_out, vor.data());
-//             err_out = nc_put_vara_double( ncid_out, dataIDs2d[3], start2d_out, count2d_out, ntilde[0].data());
+//             err_out = file::put_vara_double_locked( ncid_out, dataIDs2d[0], start2d_out, count2d_out, npe[0].data());
+//             err_out = file::put_vara_double_locked( ncid_out, dataIDs2d[1], start2d_out, count2d_out, phi.data());
+//             err_out = file::put_vara_double_locked( ncid_out, dataIDs2d[2], start2d_out, count2d_out, vor.data());
+//             err_out = file::put_vara_double_locked( ncid_out, dataIDs2d[3], start2d_out, count2d_out, ntilde[0].data());
 
-            //Compute avg 2d fields and convert them into 1d field
-            polavg(npe[0],temp);
-            dg::blas2::gemv(interp,temp,temp1d); 
-            err_out = nc_put_vara_double( ncid_out, dataIDs1d[0],   start1d, count1d, temp1d.data()); 
-            polavg(npe[1],temp);
-            dg::blas2::gemv(interp,temp,temp1d); 
-            err_out = nc_put_vara_double( ncid_out, dataIDs1d[1],   start1d, count1d, temp1d.data()); 
-            polavg(logn[0],temp);
-            dg::blas2::gemv(interp,temp,temp1d); 
-            err_out = nc_put_vara_double( ncid_out, dataIDs1d[2],   start1d, count1d, temp1d.data()); 
-            polavg(logn[1],temp);
-            dg::blas2::gemv(interp,temp,temp1d); 
-            err_out = nc_put_vara_double( ncid_out, dataIDs1d[3],   start1d, count1d, temp1d.data()); 
+                //Compute avg 2d fields and convert them into 1d field
+                polavg(npe[0],temp);
+                dg::blas2::gemv(interp,temp,temp1d); 
+                err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[0],   start1d, count1d, temp1d.data()); 
+                polavg(npe[1],temp);
+                dg::blas2::gemv(interp,temp,temp1d); 
+                err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[1],   start1d, count1d, temp1d.data()); 
+                polavg(logn[0],temp);
+                dg::blas2::gemv(interp,temp,temp1d); 
+                err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[2],   start1d, count1d, temp1d.data()); 
+                polavg(logn[1],temp);
+                dg::blas2::gemv(interp,temp,temp1d); 
+                err_out = file::put_vara_double_locked( ncid_out, dataIDs1d[3],   start1d, count1d, temp1d.data()); 
             
-            //compute probe values by interpolation and write 2d data fields
-            dg::blas2::gemv(probe_interp, ntilde[0], npe_probes);
-            polavg(phi,temp);
-            dg::blas2::gemv(probe_interp, phi, phi_probes);
-            dg::blas2::gemv(dy, phi, temp);
-            dg::blas2::gemv(probe_interp, temp, gamma_probes);
+                //compute probe values by interpolation and write 2d data fields
+                dg::blas2::gemv(probe_interp, ntilde[0], npe_probes);
+                polavg(phi,temp);
+                dg::blas2::gemv(probe_interp, phi, phi_probes);
+                dg::blas2::gemv(dy, phi, temp);
+                dg::blas2::gemv(probe_interp, temp, gamma_probes);
             
-            //write data in netcdf file
-            err_out = nc_put_vara_double( ncid_out, timevarID, start1d, count1d, &time);
-            for( unsigned i=0; i<num_probes; i++){
-                err_out= nc_put_vara_double( ncid_out, npe_probesID[i], start1d, count1d, &npe_probes[i]);
-                err_out= nc_put_vara_double( ncid_out, phi_probesID[i], start1d, count1d, &phi_probes[i]);
-                err_out= nc_put_vara_double( ncid_out, gamma_probesID[i], start1d, count1d, &gamma_probes[i]);
-            }
-            err_out = nc_put_vara_double( ncid_out, TperpzID, start1d, count1d, &Tperpz);
-            err_out = nc_put_vara_double( ncid_out, TperpID, start1d, count1d, &Tperp);
-            err_out = nc_put_vara_double( ncid_out, TperpratioID, start1d, count1d, &Tperpratio);
-            err_out = nc_put_vara_double( ncid_out, OmegaID, start1d, count1d, &Omega);
-            err_out = nc_put_vara_double( ncid_out, OmegazID, start1d, count1d, &Omegaz);
-            err_out = nc_put_vara_double( ncid_out, OmegaratioID, start1d, count1d, &Omegaratio);
-            err_out = nc_put_vara_double( ncid_out, Gamma_neID, start1d, count1d, &Gamma_ne);
-            err_out = nc_put_vara_double( ncid_out, invkappaavgID, start1d, count1d, &invkappaavg);
-            err_out = nc_put_vara_double( ncid_out, RfxnormID, start1d, count1d, &Rfxnorm);
-            err_out = nc_put_vara_double( ncid_out, AnormID,   start1d, count1d, &Anorm);            
-            err_out = nc_put_vara_double( ncid_out, RfnnormID, start1d, count1d, &Rfnnorm);
-            err_out = nc_put_vara_double( ncid_out, AnnormID, start1d, count1d, &Annorm);
-            err_out = nc_put_vara_double( ncid_out, RxnormID, start1d, count1d, &Rxnorm);
-            err_out = nc_put_vara_double( ncid_out, RnxnormID, start1d, count1d, &Rnxnorm);
-            err_out = nc_put_vara_double( ncid_out, GuyxnormID, start1d, count1d, &Guyxnorm);
-            err_out = nc_put_vara_double( ncid_out, TxnormID, start1d, count1d, &Txnorm);
-            err_out = nc_put_vara_double( ncid_out, GuynxnormID, start1d, count1d, &Guynxnorm);
-            err_out = nc_put_vara_double( ncid_out, TnxnormID, start1d, count1d, &Tnxnorm);
-            err_out = nc_put_vara_double( ncid_out, netnormID, start1d, count1d,  &netnorm);
-            err_out = nc_put_vara_double( ncid_out, neatnormID, start1d, count1d, &neatnorm);
-            err_out = nc_put_vara_double( ncid_out, dtfauynormID, start1d, count1d, &dtfauynorm);
-            err_out = nc_put_vara_double( ncid_out, RxnormscalID, start1d, count1d, &Rxnormscal);
-	    err_out = nc_put_vara_double( ncid_out, GuynxnormscalID, start1d, count1d, &Guynxnormscal);
-	    err_out = nc_put_vara_double( ncid_out, TnxnormscalID, start1d, count1d, &Tnxnormscal);
-	    err_out = nc_put_vara_double( ncid_out, AnormscalID, start1d, count1d, &Anormscal);
-	    err_out = nc_put_vara_double( ncid_out, AnnormscalID, start1d, count1d, &Annormscal);
-	    err_out = nc_put_vara_double( ncid_out, RfnnormscalID, start1d, count1d, &Rfnnormscal);
-            err_out = nc_put_vara_double( ncid_out, tvarIDout, start1d, count1d, &time);        
+                //write data in netcdf file
+                err_out = file::put_vara_double_locked( ncid_out, timevarID, start1d, count1d, &time);
+                for( unsigned i=0; i<num_probes; i++){
+                    err_out= file::put_vara_double_locked( ncid_out, npe_probesID[i], start1d, count1d, &npe_probes[i]);
+                    err_out= file::put_vara_double_locked( ncid_out, phi_probesID[i], start1d, count1d, &phi_probes[i]);
+                    err_out= file::put_vara_double_locked( ncid_out, gamma_probesID[i], start1d, count1d, &gamma_probes[i]);
+                }
+                err_out = file::put_vara_double_locked( ncid_out, TperpzID, start1d, count1d, &Tperpz);
+                err_out = file::put_vara_double_locked( ncid_out, TperpID, start1d, count1d, &Tperp);
+                err_out = file::put_vara_double_locked( ncid_out, TperpratioID, start1d, count1d, &Tperpratio);
+                err_out = file::put_vara_double_locked( ncid_out, OmegaID, start1d, count1d, &Omega);
+                err_out = file::put_vara_double_locked( ncid_out, OmegazID, start1d, count1d, &Omegaz);
+                err_out = file::put_vara_double_locked( ncid_out, OmegaratioID, start1d, count1d, &Omegaratio);
+                err_out = file::put_vara_double_locked( ncid_out, Gamma_neID, start1d, count1d, &Gamma_ne);
+                err_out = file::put_vara_double_locked( ncid_out, invkappaavgID, start1d, count1d, &invkappaavg);
+                err_out = file::put_vara_double_locked( ncid_out, RfxnormID, start1d, count1d, &Rfxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, AnormID,   start1d, count1d, &Anorm);            
+                err_out = file::put_vara_double_locked( ncid_out, RfnnormID, start1d, count1d, &Rfnnorm);
+                err_out = file::put_vara_double_locked( ncid_out, AnnormID, start1d, count1d, &Annorm);
+                err_out = file::put_vara_double_locked( ncid_out, RxnormID, start1d, count1d, &Rxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, RnxnormID, start1d, count1d, &Rnxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, GuyxnormID, start1d, count1d, &Guyxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, TxnormID, start1d, count1d, &Txnorm);
+                err_out = file::put_vara_double_locked( ncid_out, GuynxnormID, start1d, count1d, &Guynxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, TnxnormID, start1d, count1d, &Tnxnorm);
+                err_out = file::put_vara_double_locked( ncid_out, netnormID, start1d, count1d,  &netnorm);
+                err_out = file::put_vara_double_locked( ncid_out, neatnormID, start1d, count1d, &neatnorm);
+                err_out = file::put_vara_double_locked( ncid_out, dtfauynormID, start1d, count1d, &dtfauynorm);
+                err_out = file::put_vara_double_locked( ncid_out, RxnormscalID, start1d, count1d, &Rxnormscal);
+    	    err_out = file::put_vara_double_locked( ncid_out, GuynxnormscalID, start1d, count1d, &Guynxnormscal);
+    	    err_out = file::put_vara_double_locked( ncid_out, TnxnormscalID, start1d, count1d, &Tnxnormscal);
+    	    err_out = file::put_vara_double_locked( ncid_out, AnormscalID, start1d, count1d, &Anormscal);
+    	    err_out = file::put_vara_double_locked( ncid_out, AnnormscalID, start1d, count1d, &Annormscal);
+    	    err_out = file::put_vara_double_locked( ncid_out, RfnnormscalID, start1d, count1d, &Rfnnormscal);
+                err_out = file::put_vara_double_locked( ncid_out, tvarIDout, start1d, count1d, &time);        
 	    
+        }
     }
     err = nc_close(ncid);
     err_out = nc_close(ncid_out);
@@ -13,6 +13,8 @@
 #include "dg/functors.h"
 
 #include "file/nc_utilities.h"
+#include "file/modal_output.h"
+#include "file/prefetch.h"
 
 #include "geometries/geometries.h"
 #include "feltor/parameters.h"
@@ -88,7 +90,6 @@ int main( int argc, char* argv[])
     dg::HVec transfer1d = dg::evaluate(dg::zero,g1d_out);
     //read in midplane of electrons, ions Ue, Ui, and potential, and energy
     std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
-    int dataIDs[5];
 
     std::string names2d[13] = {"Ne_avg", "Ni_avg", "Ue_avg", "Ui_avg", "phi_avg","dNe_mp", "dNi_mp", "dUe_mp", "dUi_mp", "dphi_mp","vor_avg","Depsi_avg","Lperpinv_avg"}; 
     int dataIDs2d[13];
@@ -110,7 +111,6 @@ int main( int argc, char* argv[])
     size_t count2d[3]  = {1, g3d_out.n()*g3d_out.Ny(), g3d_out.n()*g3d_out.Nx()};
     size_t start2d[3]  = {0, 0, 0};
     size_t count3d[4]  = {1, g3d_out.Nz(), g3d_out.n()*g3d_out.Ny(), g3d_out.n()*g3d_out.Nx()};
-    size_t start3d[4]  = {0, 0, 0, 0};
     //size_t count3dp[4] = {1, 1, g3d_out.n()*g3d_out.Ny(), g3d_out.n()*g3d_out.Nx()};
 //     size_t start3dp[4] = {0, 0, 0, 0};
 
@@ -187,150 +187,173 @@ int main( int argc, char* argv[])
     err = nc_inq_dimlen( ncid, timeID, &steps);
     steps-=1;
     outlim = steps/p.itstp;
-    for( unsigned i=0; i<outlim; i++)//timestepping
+    //modal output is read as Legendre coefficients and reconstructed on the grid stored in the file
+    std::vector<file::ModalReader> modal; //empty for nodal output
     {
-//      start3dp[0] = i; //set specific time  
-        start3d[0] = i; //set specific time  
-        start2d[0] = i;
-        start1d[0] = i;
-        time += p.itstp*p.dt;
-        err2d = nc_open(argv[3], NC_WRITE, &ncid2d);
-        err1d = nc_open(argv[2], NC_WRITE, &ncid1d);
-
-        std::cout << "Timestep = " << i << "  time = " << time << "\n";
-
-        //Compute toroidal average and fluctuation at midplane for every timestep
-        dg::DVec data2davg = dg::evaluate( dg::zero, g2d_out);   
-        dg::DVec data2dfsa = dg::evaluate( dg::zero, g2d_out);    
-        dg::DVec vor2davg = dg::evaluate( dg::zero, g2d_out);
-        dg::DVec Depsip2davg =  dg::evaluate(dg::zero , g2d_out); 
-        dg::DVec Depsip3dfluc =  dg::evaluate(dg::zero , g3d_out);
-        dg::DVec Depsip2dflucavg =  dg::evaluate(dg::zero , g2d_out);  
-        dg::DVec Lperpinv2davg =  dg::evaluate(dg::zero , g2d_out);          
-        //Ne,Ni,Ue,Ui,Phi
-        for( unsigned j=0;j<5; j++)
+        int varID;
+        err = nc_inq_varid( ncid, names[0].data(), &varID);
+        if( file::is_modal_variable( ncid, varID))
+            modal.push_back( file::ModalReader( ncid));
+    }
+    std::vector<float> coefficients;
+    //the next time slice is read while the current one is analysed;
+    //the reader's thread is joined at the end of the block before the input file is closed
+    {
+        file::PrefetchReader prefetch( ncid, std::vector<std::string>( names, names+5), 0, outlim);
+        file::Slice slice;
+        for( unsigned i=0; i<outlim; i++)//timestepping
         {
-            //set quantities to zero
-            data2davg = dg::evaluate( dg::zero, g2d_out);   
-            data2dfsa = dg::evaluate( dg::zero, g2d_out);    
-
-            //get 3d data
-            err = nc_open( argv[1], NC_NOWRITE, &ncid); //open 3d file
-            err = nc_inq_varid(ncid, names[j].data(), &dataIDs[j]);
-            err = nc_get_vara_double( ncid, dataIDs[j], start3d, count3d, fields3d_h[j].data());
-            err = nc_close(ncid);  //close 3d file
-            fields3d[j] = fields3d_h[j];
+//      start3dp[0] = i; //set specific time  
+            start2d[0] = i;
+            start1d[0] = i;
+            time += p.itstp*p.dt;
+            {
+                file::NC_Guard guard;
+                err2d = nc_open(argv[3], NC_WRITE, &ncid2d);
+                err1d = nc_open(argv[2], NC_WRITE, &ncid1d);
+            }
+            prefetch.next( slice);
+
+            std::cout << "Timestep = " << i << "  time = " << time << "\n";
+
+            //Compute toroidal average and fluctuation at midplane for every timestep
+            dg::DVec data2davg = dg::evaluate( dg::zero, g2d_out);   
+            dg::DVec data2dfsa = dg::evaluate( dg::zero, g2d_out);    
+            dg::DVec vor2davg = dg::evaluate( dg::zero, g2d_out);
+            dg::DVec Depsip2davg =  dg::evaluate(dg::zero , g2d_out); 
+            dg::DVec Depsip3dfluc =  dg::evaluate(dg::zero , g3d_out);
+            dg::DVec Depsip2dflucavg =  dg::evaluate(dg::zero , g2d_out);  
+            dg::DVec Lperpinv2davg =  dg::evaluate(dg::zero , g2d_out);          
+            //Ne,Ni,Ue,Ui,Phi
+            for( unsigned j=0;j<5; j++)
+            {
+                //set quantities to zero
+                data2davg = dg::evaluate( dg::zero, g2d_out);   
+                data2dfsa = dg::evaluate( dg::zero, g2d_out);    
+
+                //get 3d data
+                if( modal.empty())
+                    fields3d_h[j].swap( slice.fields[j]);
+                else
+                {
+                    coefficients.assign( slice.fields[j].begin(), slice.fields[j].end());
+                    modal[0].transform().backward( coefficients, fields3d_h[j]);
+                }
+                fields3d[j] = fields3d_h[j];
     
-            //get 2d data and sum up for avg
-            toravg(fields3d[j],data2davg);
+                //get 2d data and sum up for avg
+                toravg(fields3d[j],data2davg);
 
-            //get 2d data of MidPlane
-            unsigned kmp = (g3d_out.Nz()/2);
-            dg::DVec data2dflucmid(fields3d[j].begin() + kmp*g2d_out.size(),fields3d[j].begin() + (kmp+1)*g2d_out.size());
+                //get 2d data of MidPlane
+                unsigned kmp = (g3d_out.Nz()/2);
+                dg::DVec data2dflucmid(fields3d[j].begin() + kmp*g2d_out.size(),fields3d[j].begin() + (kmp+1)*g2d_out.size());
             
-            //for fluctuations to be  f_varphi
+                //for fluctuations to be  f_varphi
 //             dg::blas1::axpby(1.0,data2dflucmid,-1.0,data2davg,data2dflucmid); //Compute z fluctuation
-            dg::blas1::transfer(data2davg,transfer2d);            
-            err2d = nc_put_vara_double( ncid2d, dataIDs2d[j],   start2d, count2d, transfer2d.data()); //write avg
+                dg::blas1::transfer(data2davg,transfer2d);            
+                err2d = file::put_vara_double_locked( ncid2d, dataIDs2d[j],   start2d, count2d, transfer2d.data()); //write avg
 
 
-            //computa fsa of quantities
-            dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsadata(g2d_out,c, data2davg );
-            dg::DVec data1dfsa = dg::evaluate(fsadata,g1d_out);
-            dg::blas1::transfer(data1dfsa,transfer1d);
-            err1d = nc_put_vara_double( ncid1d, dataIDs1d[j], start1d, count1d,  transfer1d.data());
+                //computa fsa of quantities
+                dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsadata(g2d_out,c, data2davg );
+                dg::DVec data1dfsa = dg::evaluate(fsadata,g1d_out);
+                dg::blas1::transfer(data1dfsa,transfer1d);
+                err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[j], start1d, count1d,  transfer1d.data());
             
-            //compute delta f on midplane : df = f_mp - <f>
-            dg::blas2::gemv(fsaonrzmatrix, data1dfsa, data2dfsa); //fsa on RZ grid
-            dg::blas1::axpby(1.0,data2dflucmid,-1.0,data2dfsa,data2dflucmid); 
-            dg::blas1::transfer(data2dflucmid,transfer2d);     
-            err2d = nc_put_vara_double( ncid2d, dataIDs2d[j+5], start2d, count2d, transfer2d.data());
-
-        }
-        //----------------Start vorticity computation
-        dg::blas2::gemv( laplacian,fields3d[4],vor3d);
-        toravg(vor3d,vor2davg);
-        dg::blas1::transfer(vor2davg,transfer2d);     
-
-        err2d = nc_put_vara_double( ncid2d, dataIDs2d[10],   start2d, count2d, transfer2d.data());
-        dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsavor(g2d_out,c, vor2davg );
-        dg::DVec vor1dfsa = dg::evaluate(fsavor,g1d_out);
-        dg::blas1::transfer(vor1dfsa,transfer1d);
-        err1d = nc_put_vara_double( ncid1d, dataIDs1d[6], start1d, count1d,  transfer1d.data()); 
-        //----------------Stop vorticity computation
+                //compute delta f on midplane : df = f_mp - <f>
+                dg::blas2::gemv(fsaonrzmatrix, data1dfsa, data2dfsa); //fsa on RZ grid
+                dg::blas1::axpby(1.0,data2dflucmid,-1.0,data2dfsa,data2dflucmid); 
+                dg::blas1::transfer(data2dflucmid,transfer2d);     
+                err2d = file::put_vara_double_locked( ncid2d, dataIDs2d[j+5], start2d, count2d, transfer2d.data());
+
+            }
+            //----------------Start vorticity computation
+            dg::blas2::gemv( laplacian,fields3d[4],vor3d);
+            toravg(vor3d,vor2davg);
+            dg::blas1::transfer(vor2davg,transfer2d);     
+
+            err2d = file::put_vara_double_locked( ncid2d, dataIDs2d[10],   start2d, count2d, transfer2d.data());
+            dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsavor(g2d_out,c, vor2davg );
+            dg::DVec vor1dfsa = dg::evaluate(fsavor,g1d_out);
+            dg::blas1::transfer(vor1dfsa,transfer1d);
+            err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[6], start1d, count1d,  transfer1d.data()); 
+            //----------------Stop vorticity computation
         
-        //--------------- Start RADIALELECTRONDENSITYFLUX computation
-        dg::blas1::transform(fields3d[0], temp3, dg::PLUS<>(+1)); 
-        #ifdef RADIALELECTRONDENSITYFLUX
-        //ExB term  =  1/B[phi,psi_p] term
-        dg::blas2::gemv( poisson.dxlhs(), fields3d[4], temp1); //temp1 = d_R phi
-        dg::blas2::gemv( poisson.dylhs(), fields3d[4], temp2);  //temp2 = d_Z phi
-        dg::blas1::pointwiseDot( psipZ, temp1, temp1);//temp1 = d_R phi d_Z psi_p
-        dg::blas1::pointwiseDot( psipR, temp2, temp2); //temp2 = d_Z phi d_R psi_p 
-        dg::blas1::axpby( 1.0, temp1, -1.0,temp2, Depsip3d);  //Depsip3d=[phi,psip]_RZ
-        dg::blas1::pointwiseDot( Depsip3d, binv, Depsip3d); //Depsip3d = 1/B*[phi,psip]_RZ             
-        //Curvature Term = -(1-0.5*mu_e U_e^2) K(psi_p) term
-        dg::blas1::pointwiseDot( curvR,  psipR, temp1);  //temp1 = K^R d_R psi
-        dg::blas1::pointwiseDot( curvZ,  psipZ, temp2);  //temp2 = K^Z d_Z psi
-        dg::blas1::axpby( 1.0, temp1, 1.0,temp2,  temp2);  //temp2 =K(psi_p)
-        dg::blas1::pointwiseDot(fields3d[2], fields3d[2], temp1); // temp1=U_e^2
-        dg::blas1::pointwiseDot(temp1,temp2, temp1); // temp1=U_e^2 K(psi_p)
-        dg::blas1::axpby( -1.0, temp2,1.0,  Depsip3d );  //Depsip3d = 1/B*[phi,psi_p]_RZ - K(psi_p) 
-        dg::blas1::axpby(  0.5*p.mu[0], temp1, 1.0,  Depsip3d);  //Depsip3d = 1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p)
-        dg::blas1::pointwiseDot( Depsip3d, temp3, Depsip3d); //Depsip3d = N_e*(1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p))
+            //--------------- Start RADIALELECTRONDENSITYFLUX computation
+            dg::blas1::transform(fields3d[0], temp3, dg::PLUS<>(+1)); 
+            #ifdef RADIALELECTRONDENSITYFLUX
+            //ExB term  =  1/B[phi,psi_p] term
+            dg::blas2::gemv( poisson.dxlhs(), fields3d[4], temp1); //temp1 = d_R phi
+            dg::blas2::gemv( poisson.dylhs(), fields3d[4], temp2);  //temp2 = d_Z phi
+            dg::blas1::pointwiseDot( psipZ, temp1, temp1);//temp1 = d_R phi d_Z psi_p
+            dg::blas1::pointwiseDot( psipR, temp2, temp2); //temp2 = d_Z phi d_R psi_p 
+            dg::blas1::axpby( 1.0, temp1, -1.0,temp2, Depsip3d);  //Depsip3d=[phi,psip]_RZ
+            dg::blas1::pointwiseDot( Depsip3d, binv, Depsip3d); //Depsip3d = 1/B*[phi,psip]_RZ             
+            //Curvature Term = -(1-0.5*mu_e U_e^2) K(psi_p) term
+            dg::blas1::pointwiseDot( curvR,  psipR, temp1);  //temp1 = K^R d_R psi
+            dg::blas1::pointwiseDot( curvZ,  psipZ, temp2);  //temp2 = K^Z d_Z psi
+            dg::blas1::axpby( 1.0, temp1, 1.0,temp2,  temp2);  //temp2 =K(psi_p)
+            dg::blas1::pointwiseDot(fields3d[2], fields3d[2], temp1); // temp1=U_e^2
+            dg::blas1::pointwiseDot(temp1,temp2, temp1); // temp1=U_e^2 K(psi_p)
+            dg::blas1::axpby( -1.0, temp2,1.0,  Depsip3d );  //Depsip3d = 1/B*[phi,psi_p]_RZ - K(psi_p) 
+            dg::blas1::axpby(  0.5*p.mu[0], temp1, 1.0,  Depsip3d);  //Depsip3d = 1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p)
+            dg::blas1::pointwiseDot( Depsip3d, temp3, Depsip3d); //Depsip3d = N_e*(1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p))
         
-        //normalize by 1/|nabla psip|
-        dg::blas1::pointwiseDot( psipR, psipR, temp1); // psipR^2
-        dg::blas1::pointwiseDot( psipZ, psipZ, temp2); // psipZ^2
-        dg::blas1::axpby(  1.0, temp1, 1.0,temp2,  temp1);  // psipR^2 +   psipZ^2
-        dg::blas1::transform(temp1, temp1, dg::SQRT<double>());  // sqrt(psipR^2 +   psipZ^2)
-        dg::blas1::pointwiseDivide( Depsip3d, temp1, Depsip3d); //Depsip3d = N_e*(1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p))
+            //normalize by 1/|nabla psip|
+            dg::blas1::pointwiseDot( psipR, psipR, temp1); // psipR^2
+            dg::blas1::pointwiseDot( psipZ, psipZ, temp2); // psipZ^2
+            dg::blas1::axpby(  1.0, temp1, 1.0,temp2,  temp1);  // psipR^2 +   psipZ^2
+            dg::blas1::transform(temp1, temp1, dg::SQRT<double>());  // sqrt(psipR^2 +   psipZ^2)
+            dg::blas1::pointwiseDivide( Depsip3d, temp1, Depsip3d); //Depsip3d = N_e*(1/B*[phi,psi_p]_RZ - K(psi_p) + 0.5*nu_e*U_e^2*K(psi_p))
       
-        toravg(Depsip3d,Depsip2davg);
-
-        dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaDepsip(g2d_out,c, Depsip2davg );
-        dg::DVec  Depsip1Dfsa = dg::evaluate(fsaDepsip,g1d_out);
-        //compute delta f on midplane : d Depsip2d = Depsip - <Depsip>       
-        dg::blas2::gemv(fsaonrzphimatrix, Depsip1Dfsa , Depsip3dfluc ); //fsa on RZ grid
-        dg::blas1::axpby(1.0,Depsip3d,-1.0, Depsip3dfluc, Depsip3dfluc); 
-        //Same procedure for fluc
-        toravg(Depsip3dfluc,Depsip2dflucavg);
-        //fluctuation
+            toravg(Depsip3d,Depsip2davg);
+
+            dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaDepsip(g2d_out,c, Depsip2davg );
+            dg::DVec  Depsip1Dfsa = dg::evaluate(fsaDepsip,g1d_out);
+            //compute delta f on midplane : d Depsip2d = Depsip - <Depsip>       
+            dg::blas2::gemv(fsaonrzphimatrix, Depsip1Dfsa , Depsip3dfluc ); //fsa on RZ grid
+            dg::blas1::axpby(1.0,Depsip3d,-1.0, Depsip3dfluc, Depsip3dfluc); 
+            //Same procedure for fluc
+            toravg(Depsip3dfluc,Depsip2dflucavg);
+            //fluctuation
 //         transfer2d = Depsip2dflucavg;
-        //toroidal avg
-        transfer2d = Depsip2davg;
-        err2d = nc_put_vara_double( ncid2d, dataIDs2d[11],   start2d, count2d, transfer2d.data());
-        dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaDepsipfluc(g2d_out,c, Depsip2dflucavg );
-        dg::DVec  Depsip1Dflucfsa = dg::evaluate(fsaDepsipfluc,g1d_out);
-        transfer1d =Depsip1Dflucfsa;
-        err1d = nc_put_vara_double( ncid1d, dataIDs1d[7], start1d, count1d,   transfer1d.data()); 
+            //toroidal avg
+            transfer2d = Depsip2davg;
+            err2d = file::put_vara_double_locked( ncid2d, dataIDs2d[11],   start2d, count2d, transfer2d.data());
+            dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaDepsipfluc(g2d_out,c, Depsip2dflucavg );
+            dg::DVec  Depsip1Dflucfsa = dg::evaluate(fsaDepsipfluc,g1d_out);
+            transfer1d =Depsip1Dflucfsa;
+            err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[7], start1d, count1d,   transfer1d.data()); 
 //         std::cout << "Depsip =" << dg::blas2::dot(psipupilog3d,w3d, Depsip3dfluc) << std::endl;
-        #endif
-        //STOP RADIALELECTRONDENSITYFLUX
-        #ifdef GRADIENTLENGTH
-        dg::blas1::transform(temp3, temp1, dg::LN<double>()); // lnN
-        poisson.variationRHS(temp1,temp2); // (nabla_perp N)^2
-        dg::blas1::transform(temp2, Lperpinv3d, dg::SQRT<double>()); // |(nabla_perp N)|
-        toravg(Lperpinv3d,Lperpinv2davg);
-        transfer2d = Lperpinv2davg;
-        err2d = nc_put_vara_double( ncid2d, dataIDs2d[12],   start2d, count2d, transfer2d.data());
-        dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaLperpinv(g2d_out,c, Lperpinv2davg );
-        dg::DVec  Lperpinv1Dfsa = dg::evaluate(fsaLperpinv,g1d_out);
-        transfer1d =Lperpinv1Dfsa;
-        err1d = nc_put_vara_double( ncid1d, dataIDs1d[8], start1d, count1d,   transfer1d.data()); 
+            #endif
+            //STOP RADIALELECTRONDENSITYFLUX
+            #ifdef GRADIENTLENGTH
+            dg::blas1::transform(temp3, temp1, dg::LN<double>()); // lnN
+            poisson.variationRHS(temp1,temp2); // (nabla_perp N)^2
+            dg::blas1::transform(temp2, Lperpinv3d, dg::SQRT<double>()); // |(nabla_perp N)|
+            toravg(Lperpinv3d,Lperpinv2davg);
+            transfer2d = Lperpinv2davg;
+            err2d = file::put_vara_double_locked( ncid2d, dataIDs2d[12],   start2d, count2d, transfer2d.data());
+            dg::geo::FluxSurfaceAverage<dg::geo::solovev::MagneticField, dg::DVec> fsaLperpinv(g2d_out,c, Lperpinv2davg );
+            dg::DVec  Lperpinv1Dfsa = dg::evaluate(fsaLperpinv,g1d_out);
+            transfer1d =Lperpinv1Dfsa;
+            err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[8], start1d, count1d,   transfer1d.data()); 
 //         std::cout << "Lperpinv=" <<dg::blas2::dot(psipupilog3d,w3d, Lperpinv3d) << std::endl;
-        #endif
+            #endif
         
-        //put safety factor into file
-        dg::blas1::transfer(sf,transfer1d);
-        err1d = nc_put_vara_double( ncid1d, dataIDs1d[5], start1d, count1d,  transfer1d.data());
-        dg::blas1::transfer(abs,transfer1d);
-        err1d = nc_put_vara_double( ncid1d, dataIDs1d[9], start1d, count1d, transfer1d.data());
-        //write time data
-        err1d = nc_put_vara_double( ncid1d, tvarID1d, start1d, count1d, &time);
-        err1d = nc_close(ncid1d);  //close 1d netcdf files
-        err2d = nc_put_vara_double( ncid2d, tvarID, start2d, count2d, &time);
-        err2d = nc_close(ncid2d); //close 2d netcdf files
+            //put safety factor into file
+            dg::blas1::transfer(sf,transfer1d);
+            err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[5], start1d, count1d,  transfer1d.data());
+            dg::blas1::transfer(abs,transfer1d);
+            err1d = file::put_vara_double_locked( ncid1d, dataIDs1d[9], start1d, count1d, transfer1d.data());
+            //write time data
+            err1d = file::put_vara_double_locked( ncid1d, tvarID1d, start1d, count1d, &time);
+            err2d = file::put_vara_double_locked( ncid2d, tvarID, start2d, count2d, &time);
+            {
+                file::NC_Guard guard;
+                err1d = nc_close(ncid1d);  //close 1d netcdf files
+                err2d = nc_close(ncid2d); //close 2d netcdf files
+            }
       
 //         //Probe 
 //         const dg::DVec Rprobe(1,gp.R_0+p.boxscaleRm*gp.a*0.8);
@@ -340,16 +363,18 @@ int main( int argc, char* argv[])
 //         dg::DVec probevalue(1,0.0);
 //         dg::blas2::gemv(probeinterp,fields3d[0],probevalue);
 //         std::cout << probevalue[0]<< std::endl;
-        // ---- Compute energies ----
+            // ---- Compute energies ----
 //         std::cout << "Compute macroscopic timedependent quantities"<< "\n";
 
     
 
-        //write macroscopic timedependent quantities into output.dat file
+            //write macroscopic timedependent quantities into output.dat file
 //         os << time << " " << mass_norm << " " <<  U_e_norm <<" " <<  U_i_norm <<" " << U_phi_norm <<" " << U_pare_norm <<" " << U_pari_norm <<" "  << energy_norm <<" " << energy_diff<<std::endl;
         
         
-    } //end timestepping
+        } //end timestepping
+    }
+    err = nc_close(ncid);
     //cross coherence between phi and ne
     //relative fluctuation amplitude(R,Z,phi) = delta n(R,Z,phi)/n0(psi)
     
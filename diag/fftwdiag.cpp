@@ -5,8 +5,6 @@
 #include <string>
 #include <cmath>
 #include <complex>
-#include "spectral/drt_dft.h"
-// #include "spectral/drt_drt.h"
 
 #include "dg/algorithm.h"
 #include "dg/poisson.h"
@@ -17,6 +15,8 @@
 #include "dg/functors.h"
 
 #include "file/nc_utilities.h"
+#include "file/prefetch.h"
+#include "spectral.h"
 #include "feltorShw/parameters.h"
 int main( int argc, char* argv[])
 {
@@ -70,8 +70,6 @@ int main( int argc, char* argv[])
 
 
     //2d field netcdf vars of input.nc
-    size_t count2d[3]  = {1, g2d.n()*g2d.Ny(), g2d.n()*g2d.Nx()};
-    size_t start2d[3]  = {0, 0, 0};
     std::string names[4] = {"electrons", "ions",  "potential","vor"}; 
     int dataIDs[4];
     
@@ -112,28 +110,20 @@ int main( int argc, char* argv[])
     std::vector<dg::HVec> npe(2,dg::evaluate(dg::zero,g2d));
     std::vector<dg::HVec> ntilde(2,dg::evaluate(dg::zero,g2d));    
     std::vector<dg::HVec> energies(2,phi); //Se,Si,SE
-    std::vector<dg::HVec> energiesequi(2,phi); 
     dg::HVec k= dg::evaluate(dg::cooX1d,g1d_f);
-    //scatter matrix
-    dg::IHMatrix equi = dg::create::backscatter( g2d);
  
-    //spectral stuff 
-    spectral::Matrix<double, spectral::TL_DRT_DFT> tempxy(  Ny, Nx);
-    spectral::Matrix<std::complex<double> > tempkykx(g2d_f.Nx(), g2d_f.Ny());  //# = (Nx, Ny/2+1)
-    spectral::Matrix<double> kxkyspec( g2d_f.Ny(), g2d_f.Nx()); //Dimensions are transposed of tempkykx = ( Ny/2+1,Nx)
-    spectral::Matrix<double> gammakxkyspec( g2d_f.Ny(), g2d_f.Nx());
-    std::vector<double> gammakspec( g1d_f.N());    
-    std::vector<double> kspec( g1d_f.N());
-    std::vector<unsigned> counter( g1d_f.N());
-     
     //FFTW SETUP
     
     //FFTW_RODFT11 computes an RODFT11 transform, i.e. a DST-IV. (Logical N=2*n, inverse is FFTW_RODFT11.)  -> DIR_NEU
     //FFTW_RODFT10 computes an RODFT10 transform, i.e. a DST-II. (Logical N=2*n, inverse is FFTW_RODFT01.) -> DIR_DIR
     //FFTW_RODFT00 computes an RODFT00 transform, i.e. a DST-I. (Logical N=2*(n+1), inverse is FFTW_RODFT00.) -> DIR_DIR
     fftw_r2r_kind kind = FFTW_RODFT10; //DST & DST IV
-    spectral::DRT_DFT trafo( Ny, Nx, kind);
-    
+    //plans for both fields are made once (wisdom is cached in fftw_wisdom)
+    Spectra spectra( g2d, 2, kind);
+    //spectra are (ky,kx) = (Ny/2+1,Nx) row-major
+    std::vector<double> kxkyspec( g2d_f.Ny()*g2d_f.Nx());
+    std::vector<double> kxkyspec_old( kxkyspec.size(), 0.), gammakxkyspec( kxkyspec.size(), 0.);
+    std::vector<double> kspec( g1d_f.N()), kspec_old( g1d_f.N(), 0.), gammakspec( g1d_f.N(), 0.);
     
     //open netcdf files
     err = nc_open( argv[1], NC_NOWRITE, &ncid);
@@ -151,114 +141,86 @@ int main( int argc, char* argv[])
     imax = steps/p.itstp;
     double deltaT = p.dt*p.itstp;     //define timestep
 
-    //initialize gammas
-    for( unsigned m = 0; m < gammakxkyspec.rows(); m++) {
-        for( unsigned n = 0; n < gammakxkyspec.cols(); n++) {
-            gammakxkyspec(m,n) =0.;
-        }
-    }
-    for (unsigned mn=0;mn<g1d_f.N();mn++) { 
-        gammakspec[mn]=0.;
-        kspec[mn]=0.;
-    }
- 
-//     std::cout<< kxkyspec.cols() << " " << kxkyspec.rows() << std::endl;
-//     std::cout<< g2d_f.Nx() << " " << g2d_f.Ny() << std::endl;
-    for( unsigned i=imin; i<imax+1; i++)//timestepping
+    //the next time slices are read while the current one is transformed;
+    //the reader is destroyed (its thread joined) at the end of the block before the files are closed
     {
-            start2d[0] = i;
-            start2d_f[0] = i;
-            start1d_f[0] = i;
-            std::cout << "time = "<< time << " i = " << i <<  std::endl;
-
-            //get input.nc data
-            err = nc_inq_varid(ncid, names[0].data(), &dataIDs[0]);
-            err = nc_get_vara_double( ncid, dataIDs[0], start2d, count2d, npe[0].data());
-            err = nc_inq_varid(ncid, names[1].data(), &dataIDs[1]);
-            err = nc_get_vara_double( ncid, dataIDs[1], start2d, count2d, npe[1].data());
-            err = nc_inq_varid(ncid, names[2].data(), &dataIDs[2]);
-            err = nc_get_vara_double( ncid, dataIDs[2], start2d, count2d, phi.data());
-            dg::blas1::transform( npe[0], npe[0], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
-            dg::blas1::transform( npe[1], npe[1], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
-
-            //compute tilde_N
-            dg::blas1::pointwiseDivide(npe[0],nprof,ntilde[0]);
-            dg::blas1::axpby(1.0,ntilde[0],-1.0,one,ntilde[0]);
-            dg::blas1::pointwiseDot(one,ntilde[0],energies[0]);
-            dg::blas1::pointwiseDot(phi,one,energies[1]);
+        std::vector<std::string> fields( names, names+3);
+        file::PrefetchReader prefetch( ncid, fields, imin, imax+1);
+        file::Slice slice;
+
+        for( unsigned i=imin; i<imax+1; i++)//timestepping
+        {
+                start2d_f[0] = i;
+                start1d_f[0] = i;
+                std::cout << "time = "<< time << " i = " << i <<  std::endl;
+
+                //get input.nc data
+                prefetch.next( slice);
+                npe[0].swap( slice.fields[0]);
+                npe[1].swap( slice.fields[1]);
+                phi.swap( slice.fields[2]);
+                dg::blas1::transform( npe[0], npe[0], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
+                dg::blas1::transform( npe[1], npe[1], dg::PLUS<>(p.bgprofamp + p.nprofileamp));
+
+                //compute tilde_N
+                dg::blas1::pointwiseDivide(npe[0],nprof,ntilde[0]);
+                dg::blas1::axpby(1.0,ntilde[0],-1.0,one,ntilde[0]);
+                dg::blas1::pointwiseDot(one,ntilde[0],energies[0]);
+                dg::blas1::pointwiseDot(phi,one,energies[1]);
            
-            //
-            for (unsigned j=0;j<2;j++)
-            {
-                //Backscatter to equidistant grid
-                dg::blas2::gemv( equi, energies[j],energiesequi[j]);
-                //Fill (x,y) matrix with values, normalise trafo
-                for( unsigned m = 0; m < tempxy.rows(); m++) {
-                    for( unsigned n = 0; n <tempxy.cols(); n++) {   
-                        tempxy(m,n) = energiesequi[j][n+m*tempxy.cols()];
+                //backscatter to equidistant grid and compute 2d spectra E(kx,ky) of both fields at once
+                spectra.transform( energies);
+                for (unsigned j=0;j<2;j++)
+                {
+                    spectra.spectrum( j, kxkyspec);
+                    //grow rate for phi spec
+                    if (j==1) 
+                    {
+                        for( unsigned mn=0; mn<kxkyspec.size(); mn++)
+                            gammakxkyspec[mn] = (kxkyspec[mn] - kxkyspec_old[mn])/deltaT;
+                        kxkyspec_old = kxkyspec;
                     }
-                }
-                //compute 2d spectrum E(kx,ky) with forward real to complex transform
-                trafo.r2c_T( tempxy, tempkykx); //Note that output is transposed
-
-                for( unsigned m = 0; m <  tempkykx.rows(); m++) {
-                    for( unsigned n = 0; n < tempkykx.cols(); n++) {
-                        //transpose absolute of transposed output
-                        kxkyspec(n,m) = std::abs(tempkykx(m,n)); //is padded -> Y?
-                        
-//                         squspec(m,n)/=sqrt((2.*((double)Nx)+1.)*(double)Ny); //for rodft00
-                        kxkyspec(n,m)/= sqrt((2.*((double)Nx))*(double)Ny); //otherwise
-                        
-                        //grow rate for phi spec
-                        if (j==1) gammakxkyspec(n,m) =(kxkyspec(n,m) - gammakxkyspec(n,m))/deltaT;
+                    //Write E(kx,ky) spectrum
+                    {
+                        file::NC_Guard guard;
+                        err2d_f = nc_put_vara_double( ncid2d_f, dataIDs2d_f[j],   start2d_f, count2d_f, kxkyspec.data()); 
                     }
-                } 
-//                 std::cout << std::setprecision(4) << std::fixed;
-//                 if (j==0) std::cout << "plotting"<< std::endl;
-//                 if (j==0) std::cout << kxkyspec << std::endl;
-                //Write E(kx,ky) spectrum
-                err2d_f = nc_put_vara_double( ncid2d_f, dataIDs2d_f[j],   start2d_f, count2d_f, kxkyspec.getPtr()); 
                 
-//                 compute (normalised) shell spectrum        
-                for (unsigned mn=0;mn<g1d_f.N();mn++) {
-                    kspec[mn]=0.;
-                    counter[mn]=0;
-                    for( unsigned m = 0; m <kxkyspec.rows(); m++) {
-                        for( unsigned n = 0; n < kxkyspec.cols(); n++){           
-                            if((unsigned)(sqrt(m*m+n*n) - mn)<1) {
-                                counter[mn]+=1;
-                                kspec[mn] += kxkyspec(m,n);
-                                //grow rate for phi spec
-                                if (j==1) gammakspec[mn] =(kspec[mn] - gammakspec[mn]);
-                            }
-                        }
+                    //compute (normalised) shell spectrum        
+                    spectra.shell( kxkyspec, kspec);
+                    if (j==1) 
+                    {
+                        for( unsigned mn=0; mn<kspec.size(); mn++)
+                            gammakspec[mn] = (kspec[mn] - kspec_old[mn])/deltaT;
+                        kspec_old = kspec;
                     }
-                    //normalise
-                    kspec[mn] /= counter[mn];
-                    //grow rate for phi spec
-                    if (j==1) gammakspec[mn] /= (counter[mn]*deltaT);   
-                }
-
-                //Write E(k) spectrum
-                err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[j],   start1d_f, count1d_f, kspec.data()); 
-                //      todo                
-                //compute E(ky) spectrum
-                //compute E(kx) spectrum                
-
-              }
 
-            err2d_f = nc_put_vara_double( ncid2d_f, dataIDs2d_f[2],   start2d_f, count2d_f, gammakxkyspec.getPtr()); 
-            err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[2],   start1d_f, count1d_f, gammakspec.data()); 
-            err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[3],   start1d_f, count1d_f, k.data()); 
-            err1d_f = nc_put_vara_double( ncid1d_f, tvarID1d_f, start1d_f, count1d_f, &time);
-            err2d_f = nc_put_vara_double( ncid2d_f, tvarID2d_f, start2d_f, count2d_f, &time);
+                    //Write E(k) spectrum
+                    {
+                        file::NC_Guard guard;
+                        err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[j],   start1d_f, count1d_f, kspec.data()); 
+                    }
+                    //      todo                
+                    //compute E(ky) spectrum
+                    //compute E(kx) spectrum                
+
+                  }
+
+                {
+                    file::NC_Guard guard;
+                    err2d_f = nc_put_vara_double( ncid2d_f, dataIDs2d_f[2],   start2d_f, count2d_f, gammakxkyspec.data()); 
+                    err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[2],   start1d_f, count1d_f, gammakspec.data()); 
+                    err1d_f = nc_put_vara_double( ncid1d_f, dataIDs1d_f[3],   start1d_f, count1d_f, k.data()); 
+                    err1d_f = nc_put_vara_double( ncid1d_f, tvarID1d_f, start1d_f, count1d_f, &time);
+                    err2d_f = nc_put_vara_double( ncid2d_f, tvarID2d_f, start2d_f, count2d_f, &time);
+                }
 
-            //advance time
-            time += p.itstp*p.dt;        
+                //advance time
+                time += p.itstp*p.dt;        
+        }
     }
     err1d_f = nc_close(ncid1d_f);
     err2d_f = nc_close(ncid2d_f);
     err = nc_close(ncid);
     return 0;
 }
-
@@ -13,6 +13,7 @@
 #include "dg/functors.h"
 
 #include "file/nc_utilities.h"
+#include "file/modal_output.h"
 
 #include "dg/geometry.h"
 #include "feltor/parameters.h"
@@ -87,7 +88,6 @@ int main( int argc, char* argv[])
     std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
     std::vector<dg::HVec> fields3d_h(5,dg::evaluate(dg::zero,g3d_out));
     std::vector<dg::DVec> fields3d_d(5,dg::evaluate(dg::zero,g3d_out));
-    int dataIDs[5];
     size_t count[4]  = {1, g3d_out.Nz(), g3d_out.n()*g3d_out.Ny(), g3d_out.n()*g3d_out.Nx()};
     size_t start[4]  = {0, 0, 0, 0};
     double time=0.;
@@ -152,8 +152,7 @@ int main( int argc, char* argv[])
         for( unsigned j=0;j<5; j++)
         {
             err = nc_open( argv[1], NC_NOWRITE, &ncidin); //open 3d file
-            err = nc_inq_varid(ncidin, names[j].data(), &dataIDs[j]);
-            err = nc_get_vara_double( ncidin, dataIDs[j], start, count, fields3d_h[j].data());
+            file::get_field_vara( ncidin, names[j].data(), start[0], fields3d_h[j]); //nodal or modal output
             fields3d_d[j] = fields3d_h[j];
             err = nc_close(ncidin);  //close 3d file
         }
@@ -9,6 +9,7 @@
 #include "dg/backend/interpolation.cuh"
 #include "dg/backend/xspacelib.cuh"
 #include "dg/functors.h"
+#include "dg/backend/histogram.h"
 #include "file/nc_utilities.h"
 
 /**
@@ -82,9 +83,13 @@ int main( int argc, char* argv[])
     dg::Grid1d  g1d1(-Nsigma,Nsigma, nhist, Nhist,dg::DIR);
     dg::Grid1d  g1d2(-Nsigma,Nsigma, nhist, Nhist,dg::DIR); 
     dg::Grid2d  g2d( -Nsigma,Nsigma,-Nsigma,Nsigma, nhist, Nhist,Nhist,dg::DIR,dg::DIR); 
-    dg::Histogram<dg::HVec> hist1(g1d1,input1);  
-    dg::Histogram<dg::HVec> hist2(g1d2,input2);    
-    dg::Histogram2D<dg::HVec> hist12(g2d,input1,input2);    
+    //the bins are the cells of the grids, the data is binned without being stored
+    dg::HistogramBins bins1( -Nsigma, Nsigma, Nhist), bins2( -Nsigma, Nsigma, Nhist);
+    dg::StreamingHistogram hist1( bins1), hist2( bins2);
+    dg::StreamingHistogram2D hist12( bins1, bins2);
+    hist1.add( input1);
+    hist2.add( input2);
+    hist12.add( input1, input2);
 
  
     dg::HVec PA1 = dg::evaluate(hist1,g1d1);
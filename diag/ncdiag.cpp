@@ -14,6 +14,7 @@
 #include "dg/geometry.h"
 
 #include "file/nc_utilities.h"
+#include "file/modal_output.h"
 
 #include "geometries/geometries.h"
 
@@ -91,7 +92,6 @@ int main( int argc, char* argv[])
     dg::HVec w1d = dg::create::weights( g1d_out);   
     //read in midplane of electrons, ions Ue, Ui, and potential, and energy
     std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
-    int dataIDs[5];
 
     std::string names2d[14] = {"Ne_avg", "Ni_avg", "Ue_avg", "Ui_avg", "phi_avg","dNe_mp", "dNi_mp", "dUe_mp", "dUi_mp", "dphi_mp","vor_avg","Deperp_avg","Depsi_avg","Lperpinv_avg"}; 
     int dataIDs2d[14];
@@ -219,8 +219,7 @@ int main( int argc, char* argv[])
 
             //get 3d data
             err = nc_open( argv[1], NC_NOWRITE, &ncid); //open 3d file
-            err = nc_inq_varid(ncid, names[j].data(), &dataIDs[j]);
-            err = nc_get_vara_double( ncid, dataIDs[j], start3d, count3d, fields3d[j].data());
+            file::get_field_vara( ncid, names[j].data(), start3d[0], fields3d[j]); //nodal or modal output
             err = nc_close(ncid);  //close 3d file
     
             //get 2d data and sum up for avg
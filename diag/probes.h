@@ -14,6 +14,136 @@ using namespace std;
 #include "dg/backend/interpolation.cuh"
 #include <fstream>
 #include <sstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include <thrust/copy.h>
+#include <thrust/host_vector.h>
+
+/*
+ * Buffered binary sink for many probes sampled at high rates
+ *
+ * All probe positions are interpolated with a single sparse interpolation
+ * matrix (one gemv per field), the samples are accumulated in device memory
+ * and written to one binary file every chunk samples, so the cost per sample
+ * is independent of the file system.
+ *
+ * File layout (native byte order):
+ *   char[8]    "DGPROBES"
+ *   uint64     num_probes P, uint64 num_quantities Q
+ *   char[16]   name of each quantity (zero padded), Q times
+ *   double[P]  x coordinates, double[P] y coordinates
+ *   records of 1+Q*P doubles: time, then P values of each quantity
+ *
+ * In python: records = np.fromfile(f, offset=24+16*Q+16*P).reshape(-1, 1+Q*P)
+ */
+template<class IMatrix, class container = thrust::device_vector<double> >
+struct probe_sink
+{
+    public:
+        template<class Grid2d>
+        probe_sink(const container& x_c, const container& y_c, const Grid2d& g,
+                   const std::string& fname, const std::vector<std::string>& names, unsigned chunk = 1024);
+        ~probe_sink() { flush(); }
+        // Interpolate fields[i] on the probe positions into values(i)
+        void interpolate(const std::vector<const container*>& fields);
+        // Values of quantity i at the probe positions (to compute derived quantities before record)
+        container& values(unsigned i) { return values_[i]; }
+        // Append the current values of all quantities as one sample
+        void record(double time);
+        // interpolate( fields) followed by record( time)
+        void sample(double time, const std::vector<const container*>& fields) { interpolate(fields); record(time); }
+        // Write all buffered samples to the file
+        void flush();
+        size_t num_probes() const { return num_probes_; }
+
+    private:
+        probe_sink(const probe_sink&);
+        probe_sink& operator=(const probe_sink&);
+        const size_t num_probes_;                           // Number of probes
+        const unsigned chunk_;                              // Number of samples buffered before a write
+        IMatrix probe_interp;                               // Interpolates a field on all probe positions at once
+        std::vector<container> values_;                     // Current values of every quantity at the probes
+        container buffer_;                                  // Samples [chunk][quantity][probe] not yet written
+        std::vector<double> times_;                         // Times of the buffered samples
+        thrust::host_vector<double> host_;                  // Host copy of buffer_
+        std::vector<double> records_;                       // Interleaved records written in one call
+        ofstream of;                                        // Output file, open for the lifetime of the sink
+};
+
+template<class IMatrix, class container>
+template<class Grid2d>
+probe_sink<IMatrix, container> :: probe_sink(const container& x_c, const container& y_c, const Grid2d& g,
+        const std::string& fname, const std::vector<std::string>& names, unsigned chunk) :
+    num_probes_(x_c.size()),
+    chunk_(chunk == 0 ? 1 : chunk),
+    values_(names.size(), container(x_c.size())),
+    buffer_(chunk_ * names.size() * x_c.size())
+{
+    assert(x_c.size() == y_c.size());
+    thrust::host_vector<double> t1, t2;
+    dg::blas1::transfer( x_c, t1);
+    dg::blas1::transfer( y_c, t2);
+    dg::blas2::transfer( dg::create::interpolation( t1, t2, g, dg::NEU), probe_interp);
+    times_.reserve(chunk_);
+
+    of.open(fname.data(), std::ios::binary | std::ios::trunc);
+    uint64_t dims[2] = { num_probes_, names.size() };
+    of.write("DGPROBES", 8);
+    of.write(reinterpret_cast<const char*>(dims), sizeof(dims));
+    for(unsigned q = 0; q < names.size(); q++)
+    {
+        char name[16];
+        std::memset(name, 0, 16);
+        std::strncpy(name, names[q].data(), 15);
+        of.write(name, 16);
+    }
+    of.write(reinterpret_cast<const char*>(&t1[0]), num_probes_ * sizeof(double));
+    of.write(reinterpret_cast<const char*>(&t2[0]), num_probes_ * sizeof(double));
+    of.flush();
+}
+
+template<class IMatrix, class container>
+void probe_sink<IMatrix, container> :: interpolate(const std::vector<const container*>& fields)
+{
+    assert(fields.size() <= values_.size());
+    for(unsigned q = 0; q < fields.size(); q++)
+        dg::blas2::gemv(probe_interp, *fields[q], values_[q]);
+}
+
+template<class IMatrix, class container>
+void probe_sink<IMatrix, container> :: record(double time)
+{
+    // Samples stay in device memory until the chunk is full
+    const size_t slab = values_.size() * num_probes_;
+    for(unsigned q = 0; q < values_.size(); q++)
+        thrust::copy(values_[q].begin(), values_[q].end(), buffer_.begin() + times_.size() * slab + q * num_probes_);
+    times_.push_back(time);
+    if(times_.size() == chunk_)
+        flush();
+}
+
+template<class IMatrix, class container>
+void probe_sink<IMatrix, container> :: flush()
+{
+    if(times_.empty())
+        return;
+    const size_t slab = values_.size() * num_probes_, samples = times_.size();
+    // One device to host transfer and one write per chunk
+    host_.resize(samples * slab);
+    thrust::copy(buffer_.begin(), buffer_.begin() + samples * slab, host_.begin());
+    records_.resize(samples * (1 + slab));
+    for(size_t s = 0; s < samples; s++)
+    {
+        records_[s * (1 + slab)] = times_[s];
+        std::copy(host_.begin() + s * slab, host_.begin() + (s + 1) * slab, records_.begin() + s * (1 + slab) + 1);
+    }
+    of.write(reinterpret_cast<const char*>(&records_[0]), records_.size() * sizeof(double));
+    of.flush();
+    times_.clear();
+}
+
 
 /* 
  * Class that takes care of probe output
@@ -23,7 +153,8 @@ using namespace std;
  *
  * x_probe = n * p.lx / num_probes, y_probe = p.ly / 2 , n = 0 .. num_probes
  *
- * Creates files probe_[0-9][0-9][0-9].dat in which to write output
+ * Writes the probe time series through a probe_sink into probes.bin
+ * (quantities ne, phi, Gamma_x, see probe_sink for the layout)
  *
  */
 
@@ -32,7 +163,7 @@ struct probes
 {
     public:
         template<class Grid2d>
-        probes(container, container, const Grid2d&);
+        probes(container, container, const Grid2d&, unsigned chunk = 64);
         // Write time series of electron dcensity, electric potental, and radial particle flux
         void fluxes(double, container&, container&);
         // Write radial electron density and potential profile
@@ -44,48 +175,39 @@ struct probes
         const container x_coords;                           // Radial position of the probes
         const container y_coords;                           // Poloidal position of the probes
         const size_t num_probes;                            // Number of probes
-        IMatrix probe_interp;                                // Interpolates field (nem phi) on the probe positions
         Matrix dy;                                          // Derivative matrix
         dg::PoloidalAverage<container, container> pol_avg;  // Poloidal Average operator
-        std::vector<std::string> fnames;                    // Vector of file names for probe output
+        probe_sink<IMatrix, container> sink;                // Interpolates and buffers (ne, phi, Gamma_x) on the probe positions
+        container phi_y;                                    // Poloidal derivative of phi
+        static std::vector<std::string> flux_names()
+        {
+            std::vector<std::string> names;
+            names.push_back("ne");
+            names.push_back("phi");
+            names.push_back("Gamma_x");
+            return names;
+        }
 };
 
 
 /* 
- * Create interpolation matrixm derivation matrix
+ * Create derivation matrix and probe sink
  * Create log files
  */
 template<class IMatrix, class Matrix, class container>
 template<class Grid2d>
-probes<IMatrix, Matrix, container> :: probes (container x_c, container y_c, const Grid2d& g) :
+probes<IMatrix, Matrix, container> :: probes (container x_c, container y_c, const Grid2d& g, unsigned chunk) :
     Nx(g.Nx()),
     Ny(g.Ny()),
     x_coords(x_c),
     y_coords(y_c),
     num_probes(x_coords.size()),
     dy(dg::create::dy(g)),
-    pol_avg(g)
+    pol_avg(g),
+    sink(x_c, y_c, g, "probes.bin", flux_names(), chunk)
 { 
-    thrust::host_vector<double> t1, t2;
-    dg::blas1::transfer( x_c, t1);
-    dg::blas1::transfer( y_c, t2);
-    dg::blas2::transfer( dg::create::interpolation( t1, t2, g, dg::NEU), probe_interp);
     assert(x_coords.size () == y_coords.size());
     ofstream of;
-    stringstream fn;
-
-    /* Create datafiles for probe data */
-    for(int n = 0; n < num_probes; n++)
-    {
-        fn << "probe_" << std::setfill('0') << std::setw(3) << n << ".dat";
-        fnames.push_back(fn.str());
-
-        of.open(fn.str().data(), std::ios::trunc);
-        of << x_coords[n] << "\t" << y_coords[n] << "\n";
-        of.close();
-
-        fn.str(string(""));
-    }
 
     /* Create datafiles for radial profiles */
     of.open("ne_prof.dat");
@@ -141,40 +263,17 @@ void probes<IMatrix, Matrix, container> :: profiles(double time, container& npe,
 template<class IMatrix, class Matrix, class container>
 void probes<IMatrix, Matrix, container> :: fluxes(double time, container& npe, container& phi)
 {
-    double ip_gamma_n = 0.0;
-    static container phi_y(phi);
-    static container ip_n(num_probes);
-    static container ip_phi(num_probes);
-    static container ip_phi_y(num_probes);
-
-
     // Compute phi_y
+    phi_y.resize(phi.size());
     dg::blas2::gemv(dy, phi, phi_y);
 
-    // Get ne at interpolation values
-    dg::blas2::gemv(probe_interp, npe, ip_n);
-    // Get phi at interpolation values
-    dg::blas2::gemv(probe_interp, phi, ip_phi);
-    // Compute radial flux
-    dg::blas2::gemv(probe_interp, phi_y, ip_phi_y);
-
-    ofstream of;
-
-    for(int n = 0; n < num_probes; n++)
-    {
-        // Compute radial flux on-the-fly
-        ip_gamma_n = -1.0 * ip_n[n] * ip_phi_y[n];
-
-        of.open(fnames[n].data(), std::ios::app);
-        of << std::setw(20) << std::setprecision(16);
-        of << time << "\t";
-        of << ip_n[n] << "\t";
-        of << ip_phi[n] << "\t";
-        of << ip_gamma_n;
-        of << endl;
-        of.close();
-    }
-
+    // Get ne, phi and phi_y at the probe positions
+    std::vector<const container*> fields(3);
+    fields[0] = &npe, fields[1] = &phi, fields[2] = &phi_y;
+    sink.interpolate(fields);
+    // Compute radial flux on-the-fly, Gamma_x = -ne * phi_y
+    dg::blas1::pointwiseDot(-1.0, sink.values(0), sink.values(2), 0.0, sink.values(2));
+    sink.record(time);
 }
 
 #endif // PROBES_H
@@ -0,0 +1,182 @@
+/*
+ * Implements batched, multithreaded FFTW spectra of DG fields
+ *
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <fftw3.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+
+#include "thrust/host_vector.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/operator.h"
+
+/*
+ * Class that computes kx-ky spectra of several fields at once
+ *
+ * The fields are transformed to equidistant points (like dg::create::backscatter)
+ * directly into the FFTW input array, which is laid out as (y, field, x).
+ * Then all fields are transformed with one r2r plan in x (sine transform by default)
+ * and one batched r2c plan in y, whose output is (ky, field, kx).
+ * Plans are created once with all OpenMP threads; the planner wisdom is stored
+ * in a file, so only the first run pays for FFTW_MEASURE.
+ *
+ * Link with -lfftw3_omp -lfftw3
+ */
+struct Spectra
+{
+    public:
+        // g: grid of the fields, fields: number of fields per call of transform
+        // kind: r2r transform in x, wisdom: file name of the FFTW wisdom ("" = none)
+        Spectra( const dg::Grid2d& g, unsigned fields, fftw_r2r_kind kind = FFTW_RODFT10, const std::string& wisdom = "fftw_wisdom");
+        ~Spectra();
+        unsigned fields() const {return fields_;}
+        unsigned Nkx() const {return Nx_;}      // number of kx modes
+        unsigned Nky() const {return Ny_/2+1;}  // number of ky modes
+        unsigned Nk() const {return Nk_;}       // number of shells
+        // Transform fields.size() == fields() vectors on g
+        void transform( const std::vector<thrust::host_vector<double> >& fields);
+        // Normalised absolute value of the coefficients of field f of the last transform, (ky, kx) row-major
+        void spectrum( unsigned f, std::vector<double>& kxky) const;
+        // Average of a (ky, kx) spectrum over shells n <= sqrt(kx^2+ky^2) < n+1 (in units of the mode number)
+        void shell( const std::vector<double>& kxky, std::vector<double>& k) const;
+
+    private:
+        Spectra( const Spectra&);
+        Spectra& operator=( const Spectra&);
+        dg::Grid2d g_;
+        unsigned fields_, Nx_, Ny_, Nk_;
+        std::string wisdom_;
+        std::vector<double> backward_;  // transformation to equidistant points in one cell
+        std::vector<unsigned> shell_, count_;
+        double* in_;
+        fftw_complex* out_;
+        fftw_plan planx_, plany_;
+};
+
+
+Spectra::Spectra( const dg::Grid2d& g, unsigned fields, fftw_r2r_kind kind, const std::string& wisdom) :
+    g_( g), fields_( fields), Nx_( g.n()*g.Nx()), Ny_( g.n()*g.Ny()),
+    Nk_( (unsigned)sqrt( (double)Nx_*Nx_ + (double)(Ny_/2+1)*(Ny_/2+1))), wisdom_( wisdom)
+{
+    dg::Operator<double> backwardeq( g.dlt().backwardEQ());
+    dg::Operator<double> forward( g.dlt().forward());
+    dg::Operator<double> backward1d = backwardeq*forward;
+    backward_.assign( backward1d.data().begin(), backward1d.data().end());
+    // shell of every (ky, kx) mode and number of modes per shell
+    shell_.resize( Nky()*Nkx());
+    count_.assign( Nk_, 0);
+    for( unsigned m=0; m<Nky(); m++)
+        for( unsigned n=0; n<Nkx(); n++)
+        {
+            shell_[m*Nkx()+n] = (unsigned)sqrt( (double)(m*m + n*n));
+            if( shell_[m*Nkx()+n] < Nk_)
+                count_[shell_[m*Nkx()+n]]++;
+        }
+
+    static bool initialized = false;
+    if( !initialized)
+    {
+        fftw_init_threads();
+        initialized = true;
+    }
+#ifdef _OPENMP
+    fftw_plan_with_nthreads( omp_get_max_threads());
+#endif //_OPENMP
+    if( !wisdom_.empty())
+        fftw_import_wisdom_from_filename( wisdom_.c_str()); // a missing file is not an error
+    const int batch = fields_*Nx_;
+    in_  = fftw_alloc_real( Ny_*batch);
+    out_ = fftw_alloc_complex( Nky()*batch);
+    // x: Ny*fields rows of length Nx, contiguous and in place
+    const int nx = Nx_, ny = Ny_;
+    planx_ = fftw_plan_many_r2r( 1, &nx, ny*fields_, in_, NULL, 1, nx, in_, NULL, 1, nx, &kind, FFTW_MEASURE);
+    // y: fields*Nx columns of length Ny with stride fields*Nx
+    plany_ = fftw_plan_many_dft_r2c( 1, &ny, batch, in_, NULL, batch, 1, out_, NULL, batch, 1, FFTW_MEASURE);
+    if( !wisdom_.empty())
+        fftw_export_wisdom_to_filename( wisdom_.c_str());
+}
+
+Spectra::~Spectra()
+{
+    fftw_destroy_plan( planx_);
+    fftw_destroy_plan( plany_);
+    fftw_free( in_);
+    fftw_free( out_);
+}
+
+/*
+ * Backscatter every cell of every field into the FFTW input and execute both plans
+ */
+void Spectra::transform( const std::vector<thrust::host_vector<double> >& fields)
+{
+    assert( fields.size() == fields_);
+    const unsigned n = g_.n(), Nx = g_.Nx(), cells = g_.Ny()*Nx;
+    const double* B = &backward_[0];
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+    {
+        std::vector<double> temp( n*n);
+#ifdef _OPENMP
+#pragma omp for
+#endif //_OPENMP
+        for( int fc=0; fc<(int)(fields_*cells); fc++)
+        {
+            const unsigned f = fc/cells, c = fc%cells, i = c/Nx, j = c%Nx;
+            const double* v = &fields[f][0];
+            //transform in x: temp(k,l) = B(l,q) v(k,q)
+            for( unsigned k=0; k<n; k++)
+            for( unsigned l=0; l<n; l++)
+            {
+                temp[k*n+l] = 0;
+                for( unsigned q=0; q<n; q++)
+                    temp[k*n+l] += B[l*n+q]*v[(i*n+k)*Nx*n + j*n + q];
+            }
+            //transform in y and write row i*n+k of field f
+            for( unsigned k=0; k<n; k++)
+            for( unsigned l=0; l<n; l++)
+            {
+                double value = 0;
+                for( unsigned p=0; p<n; p++)
+                    value += B[k*n+p]*temp[p*n+l];
+                in_[((i*n+k)*fields_ + f)*Nx_ + j*n + l] = value;
+            }
+        }
+    }
+    fftw_execute( planx_);
+    fftw_execute( plany_);
+}
+
+void Spectra::spectrum( unsigned f, std::vector<double>& kxky) const
+{
+    kxky.resize( Nky()*Nkx());
+    const double norm = 1./sqrt( 2.*(double)Nx_*(double)Ny_);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int m=0; m<(int)Nky(); m++)
+        for( unsigned n=0; n<Nkx(); n++)
+        {
+            const fftw_complex& c = out_[(m*fields_ + f)*Nx_ + n];
+            kxky[m*Nkx()+n] = sqrt( c[0]*c[0] + c[1]*c[1])*norm;
+        }
+}
+
+void Spectra::shell( const std::vector<double>& kxky, std::vector<double>& k) const
+{
+    k.assign( Nk_, 0.);
+    for( unsigned i=0; i<kxky.size(); i++)
+        if( shell_[i] < Nk_)
+            k[shell_[i]] += kxky[i];
+    for( unsigned mn=0; mn<Nk_; mn++)
+        if( count_[mn] != 0)
+            k[mn] /= count_[mn];
+}
@@ -10,6 +10,7 @@
 #include "arakawa.h"
 #include "helmholtz.h"
 #include "cg.h"
+#include "multi_cg.h"
 #include "exceptions.h"
 #include "functors.h"
 #include "multistep.h"
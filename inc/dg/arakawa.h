@@ -6,6 +6,8 @@
 #include "enums.h"
 #include "backend/evaluation.cuh"
 #include "backend/derivatives.h"
+#include "backend/workspace.h"
+#include "backend/tiled_pipeline.h"
 #ifdef MPI_VERSION
 #include "backend/mpi_derivatives.h"
 #include "backend/mpi_evaluation.h"
@@ -83,6 +85,7 @@ struct ArakawaX
      */
     void variation( const container& phi, container& varphi)
     {
+        WorkspaceLoan<container> loan( ws_, dxlhs, dxrhs, dylhs, dyrhs, helper_);
         blas2::symv( bdxf, phi, dxrhs);
         blas2::symv( bdyf, phi, dyrhs);
         blas1::copy( dxrhs, dxlhs);//save results
@@ -92,28 +95,109 @@ struct ArakawaX
         blas1::pointwiseDot( 1., helper_, dyrhs,1., varphi );
     }
 
+    /**
+     * @brief Borrow temporaries from a shared Workspace instead of owning them
+     *
+     * Frees the five private temporaries
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<container>& ws)
+    {
+        ws_ = &ws;
+        detail::free_memory( dxlhs), detail::free_memory( dxrhs);
+        detail::free_memory( dylhs), detail::free_memory( dyrhs);
+        detail::free_memory( helper_);
+    }
+
+    /**
+     * @brief Evaluate the bracket band by band of z-planes
+     *
+     * All derivatives and pointwise operations of the bracket are applied to
+     * one band of z-planes before the next band is touched (see TiledPipeline).
+     * The result is the same as without tiling. Has no effect for MPI containers.
+     * @param band_size number of z-planes per band, 0 switches tiling off (the default)
+     */
+    void set_tiling( unsigned band_size)
+    {
+        pipe_.clear();
+        if( band_size != 0)
+            build_pipeline( band_size, typename VectorTraits<container>::vector_category());
+    }
+
   private:
+    void build_pipeline( unsigned band_size, ThrustVectorTag);
+    void build_pipeline( unsigned band_size, MPIVectorTag){}
+    bool execute_pipeline( const container& lhs, const container& rhs, container& result, ThrustVectorTag);
+    bool execute_pipeline( const container& lhs, const container& rhs, container& result, MPIVectorTag){ return false;}
     container dxlhs, dxrhs, dylhs, dyrhs, helper_;
     Matrix bdxf, bdyf;
     Geometry grid;
+    bc bcx_, bcy_;
+    Workspace<container>* ws_;
+    TiledPipeline<container> pipe_;
 };
 
 template<class Geometry, class Matrix, class container>
 ArakawaX<Geometry, Matrix, container>::ArakawaX( Geometry g ): 
     dxlhs( dg::evaluate( one, g) ), dxrhs(dxlhs), dylhs(dxlhs), dyrhs( dxlhs), helper_( dxlhs), 
     bdxf( dg::create::dx( g, g.bcx())),
-    bdyf( dg::create::dy( g, g.bcy())), grid( g)
+    bdyf( dg::create::dy( g, g.bcy())), grid( g), bcx_( g.bcx()), bcy_( g.bcy()), ws_(0)
 { }
 template<class Geometry, class Matrix, class container>
 ArakawaX<Geometry, Matrix, container>::ArakawaX( Geometry g, bc bcx, bc bcy): 
     dxlhs( dg::evaluate( one, g) ), dxrhs(dxlhs), dylhs(dxlhs), dyrhs( dxlhs), helper_( dxlhs),
     bdxf(dg::create::dx( g, bcx)),
-    bdyf(dg::create::dy( g, bcy)), grid(g)
+    bdyf(dg::create::dy( g, bcy)), grid(g), bcx_( bcx), bcy_( bcy), ws_(0)
 { }
 
+template<class Geometry, class Matrix, class container>
+void ArakawaX<Geometry, Matrix, container>::build_pipeline( unsigned band_size, ThrustVectorTag)
+{
+    //the same stages as in operator(), slots: in(0) lhs, in(1) rhs,
+    //out(0) result, out(1) dxlhs, out(2) dxrhs, out(3) dylhs, out(4) dyrhs, out(5) helper
+    EllSparseBlockMat<double> dx = dg::create::dx( grid, bcx_), dy = dg::create::dy( grid, bcy_);
+    pipe_ = TiledPipeline<container>( dy.left_size, band_size); //dy.left_size is the number of z-planes
+    PipelineSlot lhs = pipeline_in(0), rhs = pipeline_in(1), result = pipeline_out(0);
+    PipelineSlot dxl = pipeline_out(1), dxr = pipeline_out(2), dyl = pipeline_out(3), dyr = pipeline_out(4), helper = pipeline_out(5);
+    pipe_.symv( 1., dx, lhs, 0., dxl);
+    pipe_.symv( 1., dy, lhs, 0., dyl);
+    pipe_.symv( 1., dx, rhs, 0., dxr);
+    pipe_.symv( 1., dy, rhs, 0., dyr);
+    pipe_.pointwiseDot( 1., lhs, dyr, 0., result);
+    pipe_.pointwiseDot( 1., lhs, dxr, 0., helper);
+    pipe_.pointwiseDot( 1., dxl, dyr, 0., dyr);
+    pipe_.pointwiseDot( 1., dyl, dxr, 0., dxr);
+    pipe_.pointwiseDot( 1., dxl, rhs, 0., dxl);
+    pipe_.pointwiseDot( 1., dyl, rhs, 0., dyl);
+    pipe_.axpby( 1./3., dyr, -1./3., dxr);
+    pipe_.axpby( 1./3., dxl, -1./3., helper);
+    pipe_.axpby( 1./3., result, -1./3., dyl);
+    pipe_.symv( 1., dy, helper, 0., result);
+    pipe_.symv( 1., dx, dyl, 1., result); //saves the dxlhs round trip
+    pipe_.axpby( 1., dxr, 1., result);
+}
+
+template<class Geometry, class Matrix, class container>
+bool ArakawaX<Geometry, Matrix, container>::execute_pipeline( const container& lhs, const container& rhs, container& result, ThrustVectorTag)
+{
+    if( pipe_.stages() == 0) return false;
+    std::vector<const container*> in( 2);
+    std::vector<container*> out( 6);
+    in[0] = &lhs, in[1] = &rhs;
+    out[0] = &result, out[1] = &dxlhs, out[2] = &dxrhs, out[3] = &dylhs, out[4] = &dyrhs, out[5] = &helper_;
+    pipe_.execute( in, out);
+    return true;
+}
+
 template< class Geometry, class Matrix, class container>
 void ArakawaX< Geometry, Matrix, container>::operator()( const container& lhs, const container& rhs, container& result)
 {
+    WorkspaceLoan<container> loan( ws_, dxlhs, dxrhs, dylhs, dyrhs, helper_);
+    if( execute_pipeline( lhs, rhs, result, typename VectorTraits<container>::vector_category()))
+    {
+        geo::dividePerpVolume( result, grid);
+        return;
+    }
     //compute derivatives in x-space
     blas2::symv( bdxf, lhs, dxlhs);
     blas2::symv( bdyf, lhs, dylhs);
@@ -50,6 +50,16 @@ int main()
     t.toc();
     std::cout << "\nArakawa took "<<t.diff()/0.02<<"ms\n";
     std::cout <<   "which is     "<<t.diff()/0.02/Nz<<"ms per z plane \n\n";
+    dg::DVec tiled( jac);
+    arakawa.set_tiling( 1);
+    t.tic(); 
+    for( unsigned i=0; i<20; i++)
+        arakawa( lhs, rhs, tiled);
+    t.toc();
+    arakawa.set_tiling( 0);
+    std::cout << "Tiled Arakawa took "<<t.diff()/0.02<<"ms\n";
+    dg::blas1::axpby( 1., jac, -1., tiled);
+    std::cout << "Difference to untiled "<<sqrt(dg::blas2::dot( w3d, tiled))<<"\n\n";
 
     std::cout << std::scientific;
     std::cout << "Mean     Jacobian is "<<dg::blas2::dot( eins, w3d, jac)<<"\n";
@@ -27,6 +27,13 @@ struct Composite
         if( dual)
             m2.symv( v1, v2);
     }
+    template< class container>
+    void symv( typename MatrixTraits<Matrix>::value_type alpha, const container& v1, typename MatrixTraits<Matrix>::value_type beta, container& v2) const
+    {
+        m1.symv( alpha, v1, beta, v2);
+        if( dual)
+            m2.symv( alpha, v1, beta, v2);
+    }
     void display( std::ostream& os = std::cout) const
     {
         if( dual)
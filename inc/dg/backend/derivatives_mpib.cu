@@ -34,6 +34,7 @@ dg::bc bcy = dg::DIR;
 dg::bc bcz = dg::DIR;
 
 typedef dg::RowColDistMat<dg::EllSparseBlockMatDevice<double>, dg::CooSparseBlockMatDevice<double>, dg::NNCD> Matrix;
+typedef dg::GhostDistMat<dg::EllSparseBlockMatDevice<double>, dg::NNCD> GhostMatrix;
 typedef dg::MPI_Vector<dg::DVec > Vector;
 
 int main(int argc, char* argv[])
@@ -62,6 +63,14 @@ int main(int argc, char* argv[])
     dg::blas1::axpby( 1., u, -1., w);
     double tmp = dg::blas2::dot(w, w3d, w);
     if(rank==0)std::cout << "DX: Distance to true solution: "<<sqrt(tmp)<<"\n";
+    GhostMatrix gdx = dg::create::dx( g, bcx, dg::forward);
+    t.tic();
+    dg::blas2::symv( gdx, v, w);
+    t.toc();
+    if(rank==0)std::cout << "Dx (ghost columns) took "<<t.diff()<<"s\n";
+    dg::blas1::axpby( 1., u, -1., w);
+    tmp = dg::blas2::dot(w, w3d, w);
+    if(rank==0)std::cout << "DX: Distance to true solution: "<<sqrt(tmp)<<"\n";
     }
     if(rank==0)std::cout << "TEST DY \n";
     {
@@ -77,6 +86,14 @@ int main(int argc, char* argv[])
     dg::blas1::axpby( 1., deri, -1.,temp);
     double tmp = dg::blas2::dot(temp, w3d, temp);
     if(rank==0)std::cout << "DY(1):           Distance to true solution: "<<sqrt(tmp)<<"\n";
+    GhostMatrix gdy = dg::create::dy( g); 
+    t.tic();
+    dg::blas2::gemv( gdy, func, temp);
+    t.toc();
+    if(rank==0)std::cout << "Dy (ghost columns) took "<<t.diff()<<"s\n";
+    dg::blas1::axpby( 1., deri, -1.,temp);
+    tmp = dg::blas2::dot(temp, w3d, temp);
+    if(rank==0)std::cout << "DY(1):           Distance to true solution: "<<sqrt(tmp)<<"\n";
     }
     if(rank==0)std::cout << "TEST DZ \n";
     {
@@ -92,6 +109,14 @@ int main(int argc, char* argv[])
     dg::blas1::axpby( 1., deri, -1., temp);
     double tmp = dg::blas2::dot(temp, w3d, temp);
     if(rank==0)std::cout << "DZ(1):           Distance to true solution: "<<sqrt(tmp)<<"\n";
+    GhostMatrix gdz = dg::create::dz( g); 
+    t.tic();
+    dg::blas2::gemv( gdz, func, temp);
+    t.toc();
+    if(rank==0)std::cout << "Dz (ghost columns) took "<<t.diff()<<"s\n";
+    dg::blas1::axpby( 1., deri, -1., temp);
+    tmp = dg::blas2::dot(temp, w3d, temp);
+    if(rank==0)std::cout << "DZ(1):           Distance to true solution: "<<sqrt(tmp)<<"\n";
     }
     if(rank==0)std::cout << "JumpX and JumpY \n";
     {
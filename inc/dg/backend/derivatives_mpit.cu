@@ -34,6 +34,20 @@ double cosz( double x, double y, double z) { return cos(z)*sin(x)*sin(y);}
 //typedef dg::MPI_Vector<thrust::device_vector<double> > Vector;
 typedef dg::MDMatrix Matrix;
 typedef dg::MDVec Vector;
+typedef dg::RowColDistMat<dg::EllSparseBlockMatDevice<double>, dg::CooSparseBlockMatDevice<double>, dg::NNCD> SplitMatrix;
+
+//relative distance between the ghost column and the row/col split product
+double ghost_vs_split( const dg::MPIGrid3d& g, const Matrix& ghost, const SplitMatrix& split, const Vector& f)
+{
+    const Vector w3d = dg::create::weights( g);
+    Vector y1( f), y2( f);
+    dg::blas2::symv( ghost, f, y1);
+    dg::blas2::symv( split, f, y2);
+    double norm = dg::blas2::dot( y2, w3d, y2);
+    dg::blas1::axpby( 1., y1, -1., y2);
+    double error = dg::blas2::dot( y2, w3d, y2);
+    return norm == 0 ? sqrt( error) : sqrt( error/norm);
+}
 
 int main(int argc, char* argv[])
 {
@@ -68,6 +82,27 @@ int main(int argc, char* argv[])
         double norm = dg::blas2::dot( error, w2d, error);
         if(rank==0)std::cout << "Distance to true solution: "<<sqrt(norm)<<"\n";
     }
+    if(rank==0)std::cout << "TEST 2D ON NON-UNIFORM PARTITION: DX, DY, JX, JY\n";
+    {
+        int dims[2], periods[2], coords[2];
+        MPI_Cart_get( comm2d, 2, dims, periods, coords);
+        std::vector<double> costX( Nx, 1.), costY( Ny, 1.);
+        costX[0] = costX[Nx-1] = 4.; //e.g. expensive boundary cells
+        dg::MPIGrid2d g2d_nu( 0, M_PI,0.1, 2*M_PI+0.1, n, Nx, Ny, bcx, bcy, dg::partition( costX, dims[0]), dg::partition( costY, dims[1]), comm2d);
+        const Vector w2d_nu = dg::create::weights( g2d_nu);
+        Matrix m2_nu[] = { dg::create::dx( g2d_nu, dg::forward), dg::create::dy( g2d_nu, dg::centered), dg::create::jumpX( g2d_nu), dg::create::jumpY( g2d_nu)};
+        const Vector f2d_nu = dg::evaluate( sin, g2d_nu);
+        const Vector null2_nu = dg::evaluate( zero, g2d_nu);
+        Vector sol2_nu[] = {dg::evaluate( cosx, g2d_nu), dg::evaluate( cosy, g2d_nu), null2_nu, null2_nu};
+        for( unsigned i=0; i<4; i++)
+        {
+            Vector error = f2d_nu;
+            dg::blas2::symv( m2_nu[i], f2d_nu, error);
+            dg::blas1::axpby( 1., sol2_nu[i], -1., error);
+            double norm = dg::blas2::dot( error, w2d_nu, error);
+            if(rank==0)std::cout << "Distance to true solution: "<<sqrt(norm)<<"\n";
+        }
+    }
     MPI_Comm comm3d;
     mpi_init3d( bcx, bcy, bcz, n, Nx, Ny, Nz, comm3d);
     dg::MPIGrid3d g3d( 0, M_PI, 0.1, 2*M_PI+0.1, M_PI/2., M_PI, n, Nx, Ny, Nz, bcx, bcy, bcz, comm3d);
@@ -95,6 +130,28 @@ int main(int argc, char* argv[])
         double norm = dg::blas2::dot( error, w3d, error);
         if(rank==0)std::cout << "Distance to true solution: "<<sqrt(norm)<<"\n";
     }
+    if(rank==0)std::cout << "TEST GHOST COLUMNS AGAINST INNER/OUTER SPLIT: DX, DY, DZ\n";
+    {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get( comm3d, 3, dims, periods, coords);
+        dg::bc bcs[2] = { dg::PER, dg::DIR};
+        for( unsigned k=0; k<2; k++)
+        {
+            int p = bcs[k] == dg::PER;
+            int per[3] = {p,p,p};
+            MPI_Comm comm;
+            MPI_Cart_create( MPI_COMM_WORLD, 3, dims, per, false, &comm);
+            dg::MPIGrid3d g( 0, M_PI, 0.1, 2*M_PI+0.1, M_PI/2., M_PI, n, Nx, Ny, Nz, bcs[k], bcs[k], bcs[k], comm);
+            const Vector f = dg::evaluate( sin, g);
+            double diff[3] = {
+                ghost_vs_split( g, dg::create::dx( g, dg::forward), dg::create::dx( g, dg::forward), f),
+                ghost_vs_split( g, dg::create::dy( g, dg::centered), dg::create::dy( g, dg::centered), f),
+                ghost_vs_split( g, dg::create::dz( g, dg::backward), dg::create::dz( g, dg::backward), f)};
+            for( unsigned i=0; i<3; i++)
+                if(rank==0)std::cout << (p ? "PER" : "DIR")<<" relative difference: "<<diff[i]<<" "<<(diff[i] < 1e-14 ? "PASSED" : "FAILED")<<"\n";
+            MPI_Comm_free( &comm);
+        }
+    }
 
 
     MPI_Finalize();
@@ -85,6 +85,36 @@ int main()
     dg::blas1::axpby( 1., tX, 1., tY, tY);
     dg::blas1::axpby( 1., null3, -1., tY);
     std::cout << "Distance to true solution: "<<sqrt(dg::blas2::dot(tY, w3d, tY))<<"\n";
+    std::cout << "TEST 3D: 2DX-DX, 6DX WITH PRE/POST SCALING, DX+DY+DZ\n";
+    Vector gemv = dx3d;
+    dg::blas2::symv( 2., dx3, f3d, -1., gemv);
+    dg::blas1::axpby( 1., dx3d, -1., gemv);
+    std::cout << "Distance to true solution: "<<sqrt(dg::blas2::dot(gemv, w3d, gemv))<<"\n";
+    const Vector two( f3d.size(), 2.), three( f3d.size(), 3.);
+    dx3.symv( 1., &two, f3d, &three, 0., gemv);
+    dg::blas1::axpby( 6., dx3d, -1., gemv);
+    std::cout << "Distance to true solution: "<<sqrt(dg::blas2::dot(gemv, w3d, gemv))<<"\n";
+    dg::SumSparseBlockMatDevice<double> sum;
+    sum.add( 1., dg::create::dx( g3d, dg::forward));
+    sum.add( 1., dg::create::dy( g3d, dg::centered));
+    sum.add( 1., dg::create::dz( g3d, dg::backward));
+    dg::blas2::symv( sum, f3d, gemv);
+    dg::blas1::axpby( 1., dx3d, -1., gemv);
+    dg::blas1::axpby( 1., dy3d, 1., gemv);
+    dg::blas1::axpby( 1., dz3d, 1., gemv);
+    std::cout << "Distance to true solution: "<<sqrt(dg::blas2::dot(gemv, w3d, gemv))<<"\n";
+    std::cout << "TEST 3D STATIC ORDER 4: DX, WEIGHTS\n";
+    dg::StaticGrid3d<4> s3d( 0,M_PI, 0.1, 2.*M_PI+0.1, M_PI/2.,M_PI, Nx, Ny, Nz, bcx, bcy, bcz);
+    const Vector sw3d = dg::create::weights( s3d);
+    Matrix sdx3 = dg::create::dx( s3d, dg::forward);
+    const Vector sf3d = dg::evaluate( sin, s3d);
+    const Vector sdx3d = dg::evaluate( cosx, s3d);
+    Vector serror = sf3d;
+    dg::blas2::symv( sdx3, sf3d, serror);
+    dg::blas1::axpby( 1., sdx3d, -1., serror);
+    std::cout << "Distance to true solution: "<<sqrt(dg::blas2::dot(serror, sw3d, serror))<<"\n";
+    const Vector sone = dg::evaluate( dg::one, s3d);
+    std::cout << "Volume is "<<dg::blas1::dot( sw3d, sone)<<" (should be "<<M_PI*2.*M_PI*M_PI/2.<<")\n";
     //for periodic bc | dirichlet bc
     //n = 1 -> p = 2      2
     //n = 2 -> p = 1      1
@@ -54,7 +54,24 @@ int main ()
         std::cout << "Distance to true solution (backward ): "<<sqrt(dg::blas2::dot( w1d, error) )<<"\n";
         dg::blas2::symv( js, func, error);
         dg::blas1::axpby( 1., null , -1., error);
-        std::cout << "Distance to true solution (jump     ): "<<sqrt(dg::blas2::dot( w1d, error) )<<"\n\n";
+        std::cout << "Distance to true solution (jump     ): "<<sqrt(dg::blas2::dot( w1d, error) )<<"\n";
+        //apply to two vectors at once
+        Vector y0( func), y1( func), d0( func), d1( func);
+        std::vector<const Vector*> xs( 2); xs[0] = &func, xs[1] = &deri;
+        std::vector<Vector*> ys( 2); ys[0] = &y0, ys[1] = &y1;
+        hs.symv( 1., xs, 0., ys);
+        dg::blas2::symv( hs, func, d0), dg::blas2::symv( hs, deri, d1);
+        dg::blas1::axpby( 1., d0, -1., y0), dg::blas1::axpby( 1., d1, -1., y1);
+        std::cout << "Batched minus single symv (host  ): "<<sqrt(dg::blas2::dot( w1d, y0) + dg::blas2::dot( w1d, y1))<<" (0)\n";
+        dg::EllSparseBlockMatDevice<double> hsd( hs);
+        const dg::DVec dfunc( func), dderi( deri);
+        dg::DVec dy0( dfunc), dy1( dfunc);
+        std::vector<const dg::DVec*> dxs( 2); dxs[0] = &dfunc, dxs[1] = &dderi;
+        std::vector<dg::DVec*> dys( 2); dys[0] = &dy0, dys[1] = &dy1;
+        hsd.symv( 1., dxs, 0., dys);
+        y0 = dy0, y1 = dy1;
+        dg::blas1::axpby( 1., d0, -1., y0), dg::blas1::axpby( 1., d1, -1., y1);
+        std::cout << "Batched minus single symv (device): "<<sqrt(dg::blas2::dot( w1d, y0) + dg::blas2::dot( w1d, y1))<<" (0)\n\n";
     }
     //for periodic bc | dirichlet bc
     //n = 1 -> p = 2      2
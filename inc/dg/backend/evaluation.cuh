@@ -2,6 +2,10 @@
 
 #include <cassert> 
 #include <thrust/host_vector.h>
+#include <thrust/device_vector.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
 #include "grid.h"
 #include "weights.cuh"
 
@@ -12,6 +16,95 @@
 namespace dg
 {
 
+///@cond
+namespace detail
+{
+//Evaluate f on all points of a 2d or 3d grid (absz has one entry for 2d grids) into v.
+//Every row of points with equal y and z coordinate is contiguous in v,
+//rows are distributed among OpenMP threads, which also first-touch v
+template< class Op>
+void evaluate_points( Op f, const thrust::host_vector<double>& absx, const thrust::host_vector<double>& absy, double* v)
+{
+    const int Nx = absx.size(), rows = absy.size();
+    const double* x = &absx[0];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int r=0; r<rows; r++)
+    {
+        const double y = absy[r];
+        for( int j=0; j<Nx; j++)
+            v[r*Nx+j] = f( x[j], y);
+    }
+}
+template< class Op>
+void evaluate_points( Op f, const thrust::host_vector<double>& absx, const thrust::host_vector<double>& absy, const thrust::host_vector<double>& absz, double* v)
+{
+    const int Nx = absx.size(), Ny = absy.size(), rows = Ny*absz.size();
+    const double* x = &absx[0];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int r=0; r<rows; r++)
+    {
+        const double y = absy[r%Ny], z = absz[r/Ny];
+        for( int j=0; j<Nx; j++)
+            v[r*Nx+j] = f( x[j], y, z);
+    }
+}
+template< class RowOp>
+void evaluate_rows( RowOp f, const thrust::host_vector<double>& absx, const thrust::host_vector<double>& absy, double* v)
+{
+    const int Nx = absx.size(), rows = absy.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int r=0; r<rows; r++)
+        f( &absx[0], absy[r], v+r*Nx, Nx);
+}
+template< class RowOp>
+void evaluate_rows( RowOp f, const thrust::host_vector<double>& absx, const thrust::host_vector<double>& absy, const thrust::host_vector<double>& absz, double* v)
+{
+    const int Nx = absx.size(), Ny = absy.size(), rows = Ny*absz.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int r=0; r<rows; r++)
+        f( &absx[0], absy[r%Ny], absz[r/Ny], v+r*Nx, Nx);
+}
+//the abscissas of x, y and z of a grid
+inline void abscissas( const Grid2d& g, thrust::host_vector<double>& absx, thrust::host_vector<double>& absy)
+{
+    absx = create::abscissas( Grid1d( g.x0(), g.x1(), g.n(), g.Nx()));
+    absy = create::abscissas( Grid1d( g.y0(), g.y1(), g.n(), g.Ny()));
+}
+inline void abscissas( const Grid3d& g, thrust::host_vector<double>& absx, thrust::host_vector<double>& absy, thrust::host_vector<double>& absz)
+{
+    absx = create::abscissas( Grid1d( g.x0(), g.x1(), g.n(), g.Nx()));
+    absy = create::abscissas( Grid1d( g.y0(), g.y1(), g.n(), g.Ny()));
+    absz = create::abscissas( Grid1d( g.z0(), g.z1(), 1, g.Nz()));
+}
+//device vectors in host memory are filled in place, else on the host and copied
+template<class T, class Alloc>
+double* evaluation_target( thrust::device_vector<T, Alloc>& v, thrust::host_vector<T>& buffer, unsigned size)
+{
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+    buffer.resize( size);
+    return thrust::raw_pointer_cast( buffer.data());
+#else
+    v.resize( size);
+    return thrust::raw_pointer_cast( v.data());
+#endif //THRUST_DEVICE_SYSTEM
+}
+template<class T, class Alloc>
+void evaluation_finish( thrust::device_vector<T, Alloc>& v, const thrust::host_vector<T>& buffer)
+{
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+    v = buffer;
+#endif //THRUST_DEVICE_SYSTEM
+}
+}//namespace detail
+///@endcond
 
 ///@addtogroup evaluation
 ///@{
@@ -27,12 +120,16 @@ namespace dg
  * @param g The grid on which to evaluate f
  *
  * @return  A DG Host Vector with values
+ * @note f is called concurrently by several OpenMP threads
  */
 template< class UnaryOp>
 thrust::host_vector<double> evaluate( UnaryOp f, const Grid1d& g)
 {
     thrust::host_vector<double> abs = create::abscissas( g);
-    for( unsigned i=0; i<g.size(); i++)
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<(int)g.size(); i++)
         abs[i] = f( abs[i]);
     return abs;
 };
@@ -56,25 +153,16 @@ thrust::host_vector<double> evaluate( double (f)(double), const Grid1d& g)
  * @return  A dG Host Vector with values
  * @note Copies the binary Operator. This function is meant for small function objects, that
             may be constructed during function call.
+ * @note f is called concurrently by several OpenMP threads
  */
 template< class BinaryOp>
 thrust::host_vector<double> evaluate( BinaryOp f, const Grid2d& g)
 {
-    unsigned n= g.n();
-    //TODO: opens dlt.dat twice...!!
-    Grid1d gx( g.x0(), g.x1(), n, g.Nx()); 
-    Grid1d gy( g.y0(), g.y1(), n, g.Ny());
-    thrust::host_vector<double> absx = create::abscissas( gx);
-    thrust::host_vector<double> absy = create::abscissas( gy);
-
-    //choose layout in the comments
+    thrust::host_vector<double> absx, absy;
+    detail::abscissas( g, absx, absy);
+    //v[ ((i*n+k)*g.Nx() + j)*n + l] = f( absx[j*n+l], absy[i*n+k]);
     thrust::host_vector<double> v( g.size());
-    for( unsigned i=0; i<gy.N(); i++)
-        for( unsigned k=0; k<n; k++)
-            for( unsigned j=0; j<gx.N(); j++)
-                for( unsigned l=0; l<n; l++)
-                    //v[ i*g.Nx()*n*n + j*n*n + k*n + l] = f( absx[j*n+l], absy[i*n+k]);
-                    v[ ((i*n+k)*g.Nx() + j)*n + l] = f( absx[j*n+l], absy[i*n+k]);
+    detail::evaluate_points( f, absx, absy, thrust::raw_pointer_cast( v.data()));
     return v;
 };
 ///@cond
@@ -96,27 +184,16 @@ thrust::host_vector<double> evaluate( double(f)(double, double), const Grid2d& g
  * @return  A dG Host Vector with values
  * @note Copies the ternary Operator. This function is meant for small function objects, that
             may be constructed during function call.
+ * @note f is called concurrently by several OpenMP threads
  */
 template< class TernaryOp>
 thrust::host_vector<double> evaluate( TernaryOp f, const Grid3d& g)
 {
-    unsigned n= g.n();
-    //TODO: opens dlt.dat three times...!!
-    Grid1d gx( g.x0(), g.x1(), n, g.Nx()); 
-    Grid1d gy( g.y0(), g.y1(), n, g.Ny());
-    Grid1d gz( g.z0(), g.z1(), 1, g.Nz());
-    thrust::host_vector<double> absx = create::abscissas( gx);
-    thrust::host_vector<double> absy = create::abscissas( gy);
-    thrust::host_vector<double> absz = create::abscissas( gz);
-
+    thrust::host_vector<double> absx, absy, absz;
+    detail::abscissas( g, absx, absy, absz);
+    //v[ (((s*Ny+i)*n+k)*g.Nx() + j)*n + l] = f( absx[j*n+l], absy[i*n+k], absz[s]);
     thrust::host_vector<double> v( g.size());
-    for( unsigned s=0; s<gz.N(); s++)
-        for( unsigned i=0; i<gy.N(); i++)
-            for( unsigned k=0; k<n; k++)
-                for( unsigned j=0; j<gx.N(); j++)
-                    for( unsigned l=0; l<n; l++)
-                        //v[ s*g.Nx()*g.Ny()*n*n + i*g.Nx()*n*n + j*n*n + k*n + l] = f( absx[j*n+l], absy[i*n+k], absz[s]);
-                        v[ (((s*gy.N()+i)*n+k)*g.Nx() + j)*n + l] = f( absx[j*n+l], absy[i*n+k], absz[s]);
+    detail::evaluate_points( f, absx, absy, absz, thrust::raw_pointer_cast( v.data()));
     return v;
 };
 ///@cond
@@ -127,6 +204,138 @@ thrust::host_vector<double> evaluate( double(f)(double, double, double), const G
 };
 ///@endcond
 
+/**
+ * @brief Evaluate a function on gaussian abscissas directly into a device vector
+ *
+ * Evaluates f(x,y) on the given grid. If the device memory is host memory (OpenMP backend)
+ * no intermediate host vector is created and the threads that evaluate f first-touch v.
+ * @tparam BinaryOp Model of Binary Function
+ * @param f The function to evaluate: f = f(x,y)
+ * @param g The 2d grid on which to evaluate f
+ * @param v contains the values on output (is resized)
+ * @note f is called concurrently by several OpenMP threads
+ */
+template< class BinaryOp, class Alloc>
+void evaluate( BinaryOp f, const Grid2d& g, thrust::device_vector<double, Alloc>& v)
+{
+    thrust::host_vector<double> absx, absy, buffer;
+    detail::abscissas( g, absx, absy);
+    detail::evaluate_points( f, absx, absy, detail::evaluation_target( v, buffer, g.size()));
+    detail::evaluation_finish( v, buffer);
+}
+///@cond
+template<class Alloc>
+void evaluate( double(f)(double, double), const Grid2d& g, thrust::device_vector<double, Alloc>& v)
+{
+    evaluate<double(double, double), Alloc>( f, g, v);
+}
+///@endcond
+/**
+ * @brief Evaluate a function on gaussian abscissas directly into a device vector
+ *
+ * Evaluates f(x,y,z) on the given grid. If the device memory is host memory (OpenMP backend)
+ * no intermediate host vector is created and the threads that evaluate f first-touch v.
+ * @tparam TernaryOp Model of Ternary Function
+ * @param f The function to evaluate: f = f(x,y,z)
+ * @param g The 3d grid on which to evaluate f
+ * @param v contains the values on output (is resized)
+ * @note f is called concurrently by several OpenMP threads
+ */
+template< class TernaryOp, class Alloc>
+void evaluate( TernaryOp f, const Grid3d& g, thrust::device_vector<double, Alloc>& v)
+{
+    thrust::host_vector<double> absx, absy, absz, buffer;
+    detail::abscissas( g, absx, absy, absz);
+    detail::evaluate_points( f, absx, absy, absz, detail::evaluation_target( v, buffer, g.size()));
+    detail::evaluation_finish( v, buffer);
+}
+///@cond
+template<class Alloc>
+void evaluate( double(f)(double, double, double), const Grid3d& g, thrust::device_vector<double, Alloc>& v)
+{
+    evaluate<double(double, double, double), Alloc>( f, g, v);
+}
+///@endcond
+
+/**
+ * @brief Evaluate a batched function on gaussian abscissas
+ *
+ * Instead of one point per call f gets a whole row of points with equal y coordinate,
+ * so that its loop over x can be vectorized and expensive expressions in y are evaluated once per row
+ * @code
+ struct Profile{
+     void operator()( const double* x, double y, double* f, unsigned size) const{
+         const double gy = exp( -y*y); //once per row
+         for( unsigned i=0; i<size; i++)
+             f[i] = gy*sin( x[i]);
+     }
+ };
+ dg::HVec v = dg::evaluate_rows( Profile(), g2d);
+ * @endcode
+ * @tparam RowOp Functor with signature void operator()( const double* x, double y, double* f, unsigned size) that
+ * writes f[i] = f( x[i], y) for i < size
+ * @param f The function to evaluate, is called concurrently by several OpenMP threads
+ * @param g The 2d grid on which to evaluate f
+ *
+ * @return  A dG Host Vector with values
+ */
+template< class RowOp>
+thrust::host_vector<double> evaluate_rows( RowOp f, const Grid2d& g)
+{
+    thrust::host_vector<double> absx, absy;
+    detail::abscissas( g, absx, absy);
+    thrust::host_vector<double> v( g.size());
+    detail::evaluate_rows( f, absx, absy, thrust::raw_pointer_cast( v.data()));
+    return v;
+}
+/**
+ * @brief Evaluate a batched function on gaussian abscissas
+ *
+ * Instead of one point per call f gets a whole row of points with equal y and z coordinate
+ * @tparam RowOp Functor with signature void operator()( const double* x, double y, double z, double* f, unsigned size) that
+ * writes f[i] = f( x[i], y, z) for i < size
+ * @param f The function to evaluate, is called concurrently by several OpenMP threads
+ * @param g The 3d grid on which to evaluate f
+ *
+ * @return  A dG Host Vector with values
+ */
+template< class RowOp>
+thrust::host_vector<double> evaluate_rows( RowOp f, const Grid3d& g)
+{
+    thrust::host_vector<double> absx, absy, absz;
+    detail::abscissas( g, absx, absy, absz);
+    thrust::host_vector<double> v( g.size());
+    detail::evaluate_rows( f, absx, absy, absz, thrust::raw_pointer_cast( v.data()));
+    return v;
+}
+/**
+ * @brief Evaluate a batched function directly into a device vector
+ *
+ * @copydetails evaluate_rows(RowOp,const Grid2d&)
+ * @param v contains the values on output (is resized)
+ */
+template< class RowOp, class Alloc>
+void evaluate_rows( RowOp f, const Grid2d& g, thrust::device_vector<double, Alloc>& v)
+{
+    thrust::host_vector<double> absx, absy, buffer;
+    detail::abscissas( g, absx, absy);
+    detail::evaluate_rows( f, absx, absy, detail::evaluation_target( v, buffer, g.size()));
+    detail::evaluation_finish( v, buffer);
+}
+/**
+ * @brief Evaluate a batched function directly into a device vector
+ *
+ * @copydetails evaluate_rows(RowOp,const Grid3d&)
+ * @param v contains the values on output (is resized)
+ */
+template< class RowOp, class Alloc>
+void evaluate_rows( RowOp f, const Grid3d& g, thrust::device_vector<double, Alloc>& v)
+{
+    thrust::host_vector<double> absx, absy, absz, buffer;
+    detail::abscissas( g, absx, absy, absz);
+    detail::evaluate_rows( f, absx, absy, absz, detail::evaluation_target( v, buffer, g.size()));
+    detail::evaluation_finish( v, buffer);
+}
+
 ///@}
 }//namespace dg
-
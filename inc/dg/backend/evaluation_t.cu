@@ -23,6 +23,17 @@ double function( double x, double y, double z)
         return exp(x)*exp(y)*exp(z);
 }
 
+//batched version of function( x, y, z)
+struct Rows
+{
+    void operator()( const double* x, double y, double z, double* f, unsigned size) const
+    {
+        const double ey = exp(y), ez = exp(z); //once per row
+        for( unsigned i=0; i<size; i++)
+            f[i] = exp(x[i])*ey*ez;
+    }
+};
+
 const double lx = 2;
 const double ly = 2;
 const double lz = 2;
@@ -73,6 +84,29 @@ int main()
     std::cout << "Square normalized 3DXnorm "<< norm3X<<"\n";
     double solution3 = solution2*solution;
     std::cout << "Correct square norm is    "<<solution3<<std::endl;
-    std::cout << "Relative 3d error is      "<<(norm3X-solution3)/solution3<<"\n";
+    std::cout << "Relative 3d error is      "<<(norm3X-solution3)/solution3<<"\n\n";
+
+    //test evaluation directly into device vectors and batched evaluation
+    DVec d_z;
+    dg::evaluate( function, g3d, d_z);
+    HVec h_rows = dg::evaluate_rows( Rows(), g3d), h_d( d_z);
+    dg::blas1::axpby( 1., h_z, -1., h_d);
+    dg::blas1::axpby( 1., h_z, -1., h_rows);
+    std::cout << "Device evaluation error   "<<sqrt( dg::blas2::dot( h_d, w3d, h_d))<<" (Must be 0)\n";
+    std::cout << "Batched evaluation error  "<<sqrt( dg::blas2::dot( h_rows, w3d, h_rows))<<" (Must be 0)\n";
+
+    //static and runtime grids must give identical weights and evaluations
+    dg::StaticGrid2d<3> s2d( 0, lx,0, ly, Nx, Ny);
+    dg::StaticGrid3d<3> s3d( 0, lx,0, ly,0, lz, Nx, Ny, Nz,dg::PER,dg::PER,dg::PER);
+    dg::Grid2d r2d( 0, lx,0, ly, 3, Nx, Ny);
+    dg::Grid3d r3d( 0, lx,0, ly,0, lz, 3, Nx, Ny, Nz,dg::PER,dg::PER,dg::PER);
+    const HVec sw2d = dg::create::weights( s2d), rw2d = dg::create::weights( r2d);
+    const HVec sw3d = dg::create::weights( s3d), rw3d = dg::create::weights( r3d);
+    const HVec se2d = dg::evaluate( function, s2d), re2d = dg::evaluate( function, r2d);
+    const HVec se3d = dg::evaluate( function, s3d), re3d = dg::evaluate( function, r3d);
+    std::cout << "Static 2d weights   "<<(sw2d == rw2d ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "Static 3d weights   "<<(sw3d == rw3d ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "Static 2d evaluate  "<<(se2d == re2d ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "Static 3d evaluate  "<<(se3d == re3d ? "PASSED" : "FAILED")<<"\n";
     return 0;
 } 
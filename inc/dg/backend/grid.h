@@ -672,6 +672,110 @@ struct Grid3d
     bc bcx_, bcy_, bcz_;
     DLT<double> dlt_;
 };
+
+/**
+ * @brief A 1D grid with a compile-time number of polynomial coefficients
+ *
+ * Can be used everywhere a Grid1d is expected. 
+ * Only the weights are built with compile-time loops. Matrices created
+ * on it (derivatives, jumps) are the same as on the runtime grid; their
+ * kernels are unrolled for n = 1..5 by a dispatch on the matrix's n.
+ * @tparam P # of polynomial coefficients (not N, which would be hidden by Grid1d::N())
+ */
+template<unsigned P>
+struct StaticGrid1d : public Grid1d
+{
+    static const unsigned order = P; //!< # of polynomial coefficients
+    /**
+     * @brief 1D grid
+     * 
+     @param x0 left boundary
+     @param x1 right boundary
+     @param Nx # of cells
+     @param bcx boundary conditions
+     */
+    StaticGrid1d( double x0, double x1, unsigned Nx, bc bcx = PER): Grid1d( x0, x1, P, Nx, bcx){}
+    /**
+     * @brief # of polynomial coefficients
+     *
+     * @return P
+     */
+    unsigned n() const {return P;}
+};
+
+/**
+ * @brief A 2D grid with a compile-time number of polynomial coefficients
+ *
+ * Can be used everywhere a Grid2d is expected. 
+ * Only the weights are built with compile-time loops. Matrices created
+ * on it (derivatives, jumps) are the same as on the runtime grid; their
+ * kernels are unrolled for n = 1..5 by a dispatch on the matrix's n.
+ * @tparam N # of polynomial coefficients per dimension
+ */
+template<unsigned N>
+struct StaticGrid2d : public Grid2d
+{
+    static const unsigned order = N; //!< # of polynomial coefficients per dimension
+    /**
+     * @brief Construct a 2D grid
+     *
+     * @param x0 left boundary in x
+     * @param x1 right boundary in x 
+     * @param y0 lower boundary in y
+     * @param y1 upper boundary in y 
+     * @param Nx # of points in x 
+     * @param Ny # of points in y
+     * @param bcx boundary condition in x
+     * @param bcy boundary condition in y
+     */
+    StaticGrid2d( double x0, double x1, double y0, double y1, unsigned Nx, unsigned Ny, bc bcx = PER, bc bcy = PER):
+        Grid2d( x0, x1, y0, y1, N, Nx, Ny, bcx, bcy){}
+    /**
+     * @brief # of polynomial coefficients per dimension
+     *
+     * @return N
+     */
+    unsigned n() const {return N;}
+};
+
+/**
+ * @brief A 3D grid with a compile-time number of polynomial coefficients
+ *
+ * Can be used everywhere a Grid3d is expected. 
+ * Only the weights are built with compile-time loops. Matrices created
+ * on it (derivatives, jumps) are the same as on the runtime grid; their
+ * kernels are unrolled for n = 1..5 by a dispatch on the matrix's n.
+ * @tparam N # of polynomial coefficients per (x-,y-) dimension
+ */
+template<unsigned N>
+struct StaticGrid3d : public Grid3d
+{
+    static const unsigned order = N; //!< # of polynomial coefficients per (x-,y-) dimension
+    /**
+     * @brief Construct a 3D grid
+     *
+     * @param x0 left boundary in x
+     * @param x1 right boundary in x 
+     * @param y0 lower boundary in y
+     * @param y1 upper boundary in y 
+     * @param z0 lower boundary in z
+     * @param z1 upper boundary in z 
+     * @param Nx # of points in x 
+     * @param Ny # of points in y
+     * @param Nz # of points in z
+     * @param bcx boundary condition in x
+     * @param bcy boundary condition in y
+     * @param bcz boundary condition in z
+     */
+    StaticGrid3d( double x0, double x1, double y0, double y1, double z0, double z1, unsigned Nx, unsigned Ny, unsigned Nz, bc bcx = PER, bc bcy = PER, bc bcz = PER):
+        Grid3d( x0, x1, y0, y1, z0, z1, N, Nx, Ny, Nz, bcx, bcy, bcz){}
+    /**
+     * @brief # of polynomial coefficients per (x-,y-) dimension
+     *
+     * @return N
+     */
+    unsigned n() const {return N;}
+};
 ///@}
 
 ///@cond
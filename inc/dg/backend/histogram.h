@@ -0,0 +1,349 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+#include "grid.h"
+
+/*!@file
+ *
+ * Histograms accumulated in parallel over many batches of data
+ */
+namespace dg
+{
+
+///@addtogroup utilities
+///@{
+
+/**
+ * @brief Uniformly or logarithmically spaced bins
+ *
+ * Values outside [x0, x1) are counted in the first or last bin.
+ */
+struct HistogramBins
+{
+    /**
+     * @brief Divide [x0, x1) into N bins
+     *
+     * @param x0 left boundary
+     * @param x1 right boundary
+     * @param N number of bins
+     * @param logarithmic if true the bins are equidistant in log(x) (requires 0 < x0)
+     */
+    HistogramBins( double x0, double x1, unsigned N, bool logarithmic = false):
+        log_( logarithmic), N_( N)
+    {
+        assert( N > 0 && x0 < x1);
+        assert( !logarithmic || x0 > 0);
+        x0_ = log_ ? log( x0) : x0;
+        h_ = ( (log_ ? log( x1) : x1) - x0_)/(double)N;
+    }
+    /**
+     * @brief One bin per grid point starting at g.x0() with width g.h() (the bins of dg::Histogram)
+     *
+     * @param g the grid
+     */
+    HistogramBins( const Grid1d& g): log_( false), N_( g.size()), x0_( g.x0()), h_( g.h()) { }
+    /**
+     * @brief Number of bins
+     * @return size
+     */
+    unsigned size() const { return N_;}
+    /**
+     * @brief Check for logarithmic spacing
+     * @return true if bins are logarithmic
+     */
+    bool logarithmic() const { return log_;}
+    /**
+     * @brief Index of the bin that contains x
+     *
+     * @param x value
+     * @return bin index (values outside are clamped to the first or last bin)
+     */
+    unsigned operator()( double x) const
+    {
+        if( log_) x = x > 0 ? log( x) : -HUGE_VAL;
+        const double bin = floor( (x-x0_)/h_);
+        if( !(bin > 0)) return 0; //also catches NaN
+        if( bin >= (double)N_) return N_-1;
+        return (unsigned)bin;
+    }
+    /**
+     * @brief Left edge of a bin
+     *
+     * @param i bin index (i == size() gives the right boundary)
+     * @return left edge
+     */
+    double edge( unsigned i) const { return log_ ? exp( x0_ + i*h_) : x0_ + i*h_;}
+    /**
+     * @brief Center of a bin (geometric center for logarithmic bins)
+     *
+     * @param i bin index
+     * @return center
+     */
+    double center( unsigned i) const { return log_ ? exp( x0_ + (i+0.5)*h_) : x0_ + (i+0.5)*h_;}
+    /**
+     * @brief Width of a bin
+     *
+     * @param i bin index
+     * @return edge(i+1) - edge(i)
+     */
+    double width( unsigned i) const { return log_ ? edge( i+1) - edge( i) : h_;}
+  private:
+    bool log_;
+    unsigned N_;
+    double x0_, h_;
+};
+
+///@cond
+namespace detail
+{
+//count bins(x_i) (or binsx(x_i) + Nx*binsy(y_i) if y != 0) into counts
+//every thread fills its own bins, the bins are merged in thread order afterwards
+template<class Bins>
+void count_bins( const Bins& binsx, const double* x, const Bins& binsy, const double* y, unsigned size, std::vector<double>& counts)
+{
+    const unsigned bins = counts.size();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = size < 10000 ? 1 : omp_get_max_threads();
+#endif //_OPENMP
+    std::vector<double> local( (size_t)threads*bins, 0.);
+#ifdef _OPENMP
+#pragma omp parallel num_threads( threads)
+#endif //_OPENMP
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif //_OPENMP
+        double* mine = &local[(size_t)t*bins];
+#ifdef _OPENMP
+#pragma omp for schedule( static)
+#endif //_OPENMP
+        for( int i=0; i<(int)size; i++)
+        {
+            unsigned bin = binsx( x[i]);
+            if( y != 0) bin += binsx.size()*binsy( y[i]);
+            mine[bin] += 1.;
+        }
+#ifdef _OPENMP
+#pragma omp for schedule( static)
+#endif //_OPENMP
+        for( int b=0; b<(int)bins; b++)
+            for( int s=0; s<threads; s++)
+                counts[b] += local[(size_t)s*bins+b];
+    }
+}
+}//namespace detail
+///@endcond
+
+/**
+ * @brief A histogram that is accumulated batch by batch
+ *
+ * In contrast to dg::Histogram the data is not stored: every call to add()
+ * bins one batch (e.g. a time slice of a 3d field) with thread-local bins
+ * that are merged afterwards, so arbitrarily long time series can be binned.
+ * @code
+ dg::StreamingHistogram hist( dg::HistogramBins( 1e-3, 10., 100, true));
+ for( unsigned i=0; i<time_slices; i++)
+ {
+     file::get_vara( ncid, varID, i, g, field); //read one slice
+     hist.add( field);
+ }
+ hist.reduce( MPI_COMM_WORLD); //only if every process binned its own data
+ * @endcode
+ */
+struct StreamingHistogram
+{
+    /**
+     * @brief Construct with empty bins
+     * @param bins the bins
+     */
+    StreamingHistogram( const HistogramBins& bins): bins_( bins), counts_( bins.size(), 0.), total_( 0){}
+    /**
+     * @brief Bin a batch of values
+     *
+     * @param x pointer to (host) data
+     * @param size number of values
+     */
+    void add( const double* x, unsigned size)
+    {
+        detail::count_bins( bins_, x, bins_, (const double*)0, size, counts_);
+        total_ += size;
+    }
+    /**
+     * @brief Bin a batch of values
+     *
+     * @tparam Vector a contiguous host vector (std::vector, thrust::host_vector)
+     * @param x the values
+     */
+    template<class Vector>
+    void add( const Vector& x) { if( !x.empty()) add( &x[0], x.size());}
+#ifdef MPI_VERSION
+    /**
+     * @brief Sum the counts of all processes (collective)
+     *
+     * Afterwards every process holds the counts of all data
+     * @param comm the communicator
+     */
+    void reduce( MPI_Comm comm)
+    {
+        std::vector<double> local( counts_);
+        MPI_Allreduce( &local[0], &counts_[0], counts_.size(), MPI_DOUBLE, MPI_SUM, comm);
+        double total = total_;
+        MPI_Allreduce( &total, &total_, 1, MPI_DOUBLE, MPI_SUM, comm);
+    }
+#endif //MPI_VERSION
+    /**
+     * @brief Reset all counts to zero
+     */
+    void clear() { std::fill( counts_.begin(), counts_.end(), 0.); total_ = 0;}
+    /**
+     * @brief The bins
+     * @return bins
+     */
+    const HistogramBins& bins() const { return bins_;}
+    /**
+     * @brief Number of values in every bin
+     * @return counts
+     */
+    const std::vector<double>& counts() const { return counts_;}
+    /**
+     * @brief Number of values added so far
+     * @return total
+     */
+    double total() const { return total_;}
+    /**
+     * @brief Counts normalized to the maximum count (as in dg::Histogram)
+     * @return counts/max(counts)
+     */
+    std::vector<double> normalized() const
+    {
+        std::vector<double> n( counts_);
+        const double max = *std::max_element( counts_.begin(), counts_.end());
+        if( max > 0)
+            for( unsigned i=0; i<n.size(); i++)
+                n[i] /= max;
+        return n;
+    }
+    /**
+     * @brief Probability density estimate
+     * @return counts/total/width of every bin
+     */
+    std::vector<double> pdf() const
+    {
+        std::vector<double> p( counts_.size(), 0.);
+        if( total_ > 0)
+            for( unsigned i=0; i<p.size(); i++)
+                p[i] = counts_[i]/total_/bins_.width( i);
+        return p;
+    }
+    /**
+     * @brief Normalized count of the bin that contains x
+     *
+     * @param x value
+     * @return normalized()[bins()(x)]
+     */
+    double operator()( double x) const
+    {
+        const double max = *std::max_element( counts_.begin(), counts_.end());
+        return max > 0 ? counts_[bins_( x)]/max : 0.;
+    }
+  private:
+    HistogramBins bins_;
+    std::vector<double> counts_;
+    double total_;
+};
+
+/**
+ * @brief A joint histogram of two quantities that is accumulated batch by batch
+ *
+ * The counts are stored with x varying fastest, i.e. bin (i,j) is at j*binsx.size()+i
+ * @sa StreamingHistogram
+ */
+struct StreamingHistogram2D
+{
+    /**
+     * @brief Construct with empty bins
+     * @param binsx the bins in x
+     * @param binsy the bins in y
+     */
+    StreamingHistogram2D( const HistogramBins& binsx, const HistogramBins& binsy):
+        binsx_( binsx), binsy_( binsy), counts_( binsx.size()*binsy.size(), 0.), total_( 0){}
+    /**
+     * @brief Bin a batch of value pairs
+     *
+     * @param x pointer to (host) data in x
+     * @param y pointer to (host) data in y
+     * @param size number of values
+     */
+    void add( const double* x, const double* y, unsigned size)
+    {
+        detail::count_bins( binsx_, x, binsy_, y, size, counts_);
+        total_ += size;
+    }
+    /**
+     * @brief Bin a batch of value pairs
+     *
+     * @tparam Vector a contiguous host vector (std::vector, thrust::host_vector)
+     * @param x the values in x
+     * @param y the values in y (same size as x)
+     */
+    template<class Vector>
+    void add( const Vector& x, const Vector& y)
+    {
+        assert( x.size() == y.size());
+        if( !x.empty()) add( &x[0], &y[0], x.size());
+    }
+#ifdef MPI_VERSION
+    /**
+     * @brief Sum the counts of all processes (collective)
+     * @param comm the communicator
+     */
+    void reduce( MPI_Comm comm)
+    {
+        std::vector<double> local( counts_);
+        MPI_Allreduce( &local[0], &counts_[0], counts_.size(), MPI_DOUBLE, MPI_SUM, comm);
+        double total = total_;
+        MPI_Allreduce( &total, &total_, 1, MPI_DOUBLE, MPI_SUM, comm);
+    }
+#endif //MPI_VERSION
+    /**
+     * @brief Reset all counts to zero
+     */
+    void clear() { std::fill( counts_.begin(), counts_.end(), 0.); total_ = 0;}
+    /**
+     * @brief Number of value pairs in every bin
+     * @return counts (x varies fastest)
+     */
+    const std::vector<double>& counts() const { return counts_;}
+    /**
+     * @brief Number of value pairs added so far
+     * @return total
+     */
+    double total() const { return total_;}
+    /**
+     * @brief Normalized count of the bin that contains (x,y)
+     *
+     * @param x value in x
+     * @param y value in y
+     * @return count/max(counts)
+     */
+    double operator()( double x, double y) const
+    {
+        const double max = *std::max_element( counts_.begin(), counts_.end());
+        return max > 0 ? counts_[binsy_( y)*binsx_.size() + binsx_( x)]/max : 0.;
+    }
+  private:
+    HistogramBins binsx_, binsy_;
+    std::vector<double> counts_;
+    double total_;
+};
+///@}
+
+}//namespace dg
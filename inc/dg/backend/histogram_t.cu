@@ -0,0 +1,52 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+
+#include "histogram.h"
+
+int main()
+{
+    std::cout << "This program tests the streaming histograms\n";
+    //values 0.05, 0.15, ..., 0.95 repeated in batches
+    std::vector<double> batch( 100000);
+    for( unsigned i=0; i<batch.size(); i++)
+        batch[i] = 0.05 + 0.1*(i%10);
+    dg::StreamingHistogram hist( dg::HistogramBins( 0., 1., 10));
+    for( unsigned k=0; k<3; k++)
+        hist.add( batch);
+    bool equal = true;
+    for( unsigned i=0; i<10; i++)
+        if( hist.counts()[i] != 3.*batch.size()/10.) equal = false;
+    std::cout << "Total count "<<hist.total()<<" (Must be "<<3*batch.size()<<")\n";
+    std::cout << "Uniform counts "<<(equal ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "PDF of bin 5   "<<hist.pdf()[5]<<" (Must be 1)\n";
+
+    //values outside the range are clamped into the first and last bin
+    std::vector<double> outside( 2, -10.);
+    outside[1] = 10.;
+    hist.clear();
+    hist.add( outside);
+    std::cout << "Clamped counts "<<hist.counts()[0]<<" "<<hist.counts()[9]<<" (Must be 1 1)\n";
+
+    //logarithmic bins: one decade per bin
+    dg::HistogramBins logbins( 1e-3, 1e3, 6, true);
+    std::vector<double> decades;
+    for( int d=-3; d<3; d++)
+        decades.push_back( 2.*pow( 10., d));
+    dg::StreamingHistogram loghist( logbins);
+    loghist.add( decades);
+    equal = true;
+    for( unsigned i=0; i<6; i++)
+        if( loghist.counts()[i] != 1.) equal = false;
+    std::cout << "Logarithmic bins "<<(equal ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "Edge of bin 4     "<<logbins.edge( 4)<<" (Must be 10)\n";
+
+    //joint histogram of perfectly correlated values lies on the diagonal
+    dg::StreamingHistogram2D hist2d( dg::HistogramBins( 0., 1., 10), dg::HistogramBins( 0., 1., 10));
+    hist2d.add( batch, batch);
+    double diagonal = 0;
+    for( unsigned i=0; i<10; i++)
+        diagonal += hist2d.counts()[i*10+i];
+    std::cout << "Diagonal counts   "<<diagonal<<" (Must be "<<batch.size()<<")\n";
+    return 0;
+}
@@ -63,6 +63,225 @@ std::vector<double> coefficients( double xn, unsigned n)
     return px;
 }
 
+
+/**
+ * @brief The Legendre polynomials and the forward transformation of a grid in flat arrays
+ *
+ * Used by the interpolation builders to avoid the construction of temporary
+ * vectors and Operators for every point
+ */
+struct LegendreTable
+{
+    LegendreTable( const DLT<double>& dlt, unsigned n): n_(n), nodes_( dlt.abscissas()), forward_( dlt.forward()){}
+    /**
+     * @brief Index of the Gauss node that xn coincides with
+     * @param xn normalized x-value
+     * @return -1 if xn is not a node
+     */
+    int node( double xn) const
+    {
+        int idx = -1;
+        for( unsigned k=0; k<n_; k++)
+            if( fabs( xn - nodes_[k]) < 1e-14)
+                idx = k;
+        return idx;
+    }
+    /**
+     * @brief The interpolation coefficients pxF_l = sum_k p_k(xn) F_{kl}
+     *
+     * @param xn normalized x-value: -1<=xn<=1
+     * @param px workspace of size n
+     * @param pxF contains the n coefficients on output
+     */
+    void coefficients( double xn, double* px, double* pxF) const
+    {
+        assert( xn <= 1. && xn >= -1.);
+        if( xn == -1)
+            for( unsigned i=0; i<n_; i++)
+                px[i] = (i%2 == 0) ? 1. : -1.;
+        else if( xn == 1)
+            for( unsigned i=0; i<n_; i++)
+                px[i] = 1.;
+        else
+        {
+            px[0] = 1.;
+            if( n_ > 1)
+            {
+                px[1] = xn;
+                for( unsigned i=1; i<n_-1; i++)
+                    px[i+1] = ((double)(2*i+1)*xn*px[i]-(double)i*px[i-1])/(double)(i+1);
+            }
+        }
+        for( unsigned l=0; l<n_; l++)
+        {
+            pxF[l] = 0;
+            for( unsigned k=0; k<n_; k++)
+                pxF[l]+= px[k]*forward_[k*n_+l];
+        }
+    }
+  private:
+    unsigned n_;
+    std::vector<double> nodes_, forward_;
+};
+
+//location of an interpolation point in a 2d grid
+struct InterpolationPoint
+{
+    unsigned nn, mm; //cell
+    double xn, yn; //normalized coordinates
+    int idxX, idxY; //grid column and line if the point is a Gauss point
+    unsigned entries( unsigned n) const 
+    {
+        if( idxX < 0 && idxY < 0) return n*n;
+        if( idxX < 0 || idxY < 0) return n;
+        return 1;
+    }
+};
+
+InterpolationPoint locate( double x, double y, const Grid2d& g, const LegendreTable& table)
+{
+    //assert that point is inside the grid boundaries
+    if (!(x >= g.x0() && x <= g.x1())) {
+        std::cerr << g.x0()<<"< xi = " << x <<" < "<<g.x1()<<std::endl;
+    }
+    assert(x >= g.x0() && x <= g.x1());
+    if (!(y >= g.y0() && y <= g.y1())) {
+        std::cerr << g.y0()<<"< yi = " << y <<" < "<<g.y1()<<std::endl;
+    }
+    assert( y >= g.y0() && y <= g.y1());
+    InterpolationPoint p;
+    //determine which cell (x,y) lies in 
+    double xnn = (x-g.x0())/g.hx();
+    double ynn = (y-g.y0())/g.hy();
+    p.nn = (unsigned)floor(xnn);
+    p.mm = (unsigned)floor(ynn);
+    //determine normalized coordinates
+    p.xn =  2.*xnn - (double)(2*p.nn+1); 
+    p.yn =  2.*ynn - (double)(2*p.mm+1); 
+    //interval correction
+    if (p.nn==g.Nx()) {
+        p.nn-=1;
+        p.xn = 1.;
+    }
+    if (p.mm==g.Ny()) {
+        p.mm-=1;
+        p.yn =1.;
+    }
+    //Test if the point is a Gauss point since then no interpolation is needed
+    p.idxX = table.node( p.xn), p.idxY = table.node( p.yn);
+    if( p.idxX >= 0) p.idxX += p.nn*g.n(); //determine which grid column it is
+    if( p.idxY >= 0) p.idxY += p.mm*g.n(); //determine grid line
+    return p;
+}
+
+//write the entries of one row, plane is the offset of the z-plane
+void fill_row( const InterpolationPoint& p, double x, double y, const Grid2d& g, dg::bc globalbcz, unsigned plane, const LegendreTable& table, double* px, double* pxF, double* pyF, int* cols, double* values)
+{
+    const unsigned n = g.n(), Nx = g.Nx();
+    if( p.idxX < 0 && p.idxY < 0 ) //there is no corresponding point
+    {
+        //evaluate 2d Legendre polynomials at (xn, yn)...
+        table.coefficients( p.xn, px, pxF);
+        table.coefficients( p.yn, px, pyF);
+        //zeroe boundary values 
+        bool zero = globalbcz == dg::DIR && ( x==g.x0() || x==g.x1()  || y==g.y0()  || y==g.y1());
+        //...these are the matrix coefficients with which to multiply 
+        for( unsigned k=0; k<n; k++)
+            for( unsigned l=0; l<n; l++)
+            {
+                cols[k*n+l] = plane + (p.mm*n+k)*n*Nx+p.nn*n + l;
+                values[k*n+l] = zero ? 0. : pyF[k]*pxF[l];
+            }
+    }
+    else if ( p.idxX < 0 && p.idxY >=0) //there is a corresponding line
+    {
+        table.coefficients( p.xn, px, pxF);
+        for( unsigned l=0; l<n; l++)
+        {
+            cols[l] = plane + p.idxY*Nx*n + p.nn*n + l;
+            values[l] = pxF[l];
+        }
+    }
+    else if ( p.idxX >= 0 && p.idxY < 0) //there is a corresponding column
+    {
+        table.coefficients( p.yn, px, pyF);
+        for( unsigned k=0; k<n; k++)
+        {
+            cols[k] = plane + (p.mm*n+k)*Nx*n + p.idxX;
+            values[k] = pyF[k];
+        }
+    }
+    else //the point already exists
+    {
+        cols[0] = plane + p.idxY*Nx*n + p.idxX;
+        values[0] = 1.;
+    }
+}
+
+/**
+ * @brief Two-pass construction of the CSR interpolation matrix
+ *
+ * The first pass locates all points and counts the entries of each row,
+ * the second fills the rows; both are parallelized with OpenMP.
+ * @param planes the z-plane of each point (empty in 2d)
+ */
+cusp::csr_matrix<int, double, cusp::host_memory> interpolationCSR( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const std::vector<unsigned>& planes, const Grid2d& g, unsigned num_cols, dg::bc globalbcz)
+{
+    assert( x.size() == y.size());
+    const int size = x.size();
+    const unsigned n = g.n();
+    const LegendreTable table( g.dlt(), n);
+    std::vector<InterpolationPoint> points( size);
+    std::vector<int> offsets( size+1, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<size; i++)
+    {
+        points[i] = locate( x[i], y[i], g, table);
+        offsets[i+1] = points[i].entries( n);
+    }
+    for( int i=0; i<size; i++)
+        offsets[i+1] += offsets[i];
+    cusp::csr_matrix<int, double, cusp::host_memory> A( size, num_cols, offsets[size]);
+    thrust::copy( offsets.begin(), offsets.end(), A.row_offsets.begin());
+    int* cols = thrust::raw_pointer_cast( A.column_indices.data());
+    double* values = thrust::raw_pointer_cast( A.values.data());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+    {
+        std::vector<double> px( n), pxF( n), pyF( n);
+#ifdef _OPENMP
+#pragma omp for
+#endif //_OPENMP
+        for( int i=0; i<size; i++)
+        {
+            unsigned plane = planes.empty() ? 0 : planes[i]*g.size();
+            fill_row( points[i], x[i], y[i], g, globalbcz, plane, table, &px[0], &pxF[0], &pyF[0], cols + offsets[i], values + offsets[i]);
+        }
+    }
+    if (globalbcz == DIR_NEU ) std::cerr << "DIR_NEU NOT IMPLEMENTED "<<std::endl;
+    if (globalbcz == NEU_DIR ) std::cerr << "NEU_DIR NOT IMPLEMENTED "<<std::endl;
+    if (globalbcz == dg::PER ) std::cerr << "PER NOT IMPLEMENTED "<<std::endl;
+    return A;
+}
+
+std::vector<unsigned> planes( const thrust::host_vector<double>& z, const Grid3d& g)
+{
+    std::vector<unsigned> ll( z.size());
+    for( unsigned i=0; i<z.size(); i++)
+    {
+        if (!(z[i] >= g.z0() && z[i] <= g.z1())) {
+            std::cerr << g.z0()<<"< zi = " << z[i] <<" < "<<g.z1()<<std::endl;
+        } assert( z[i] >= g.z0() && z[i] <= g.z1());
+        ll[i] = (unsigned)floor((z[i]-g.z0())/g.hz());
+        if (ll[i]==g.Nz()) 
+            ll[i]-=1;
+    }
+    return ll;
+}
+
 }//namespace detail
 ///@endcond
 ///@addtogroup utilities
@@ -112,10 +331,38 @@ cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::ho
     return A;
 }
 
+
 /**
- * @brief Create interpolation matrix
+ * @brief Transpose a CSR matrix
  *
- * The matrix, when applied to a vector, interpolates its values to the given coordinates
+ * Counts the entries per column and then scatters the rows; the column indices 
+ * of the result are sorted
+ * @param A the matrix
+ * @param AT contains the transpose on output
+ */
+void transpose( const cusp::csr_matrix<int, double, cusp::host_memory>& A, cusp::csr_matrix<int, double, cusp::host_memory>& AT)
+{
+    AT.resize( A.num_cols, A.num_rows, A.num_entries);
+    thrust::fill( AT.row_offsets.begin(), AT.row_offsets.end(), 0);
+    for( unsigned e=0; e<A.num_entries; e++)
+        AT.row_offsets[A.column_indices[e]+1]++;
+    for( unsigned i=0; i<A.num_cols; i++)
+        AT.row_offsets[i+1] += AT.row_offsets[i];
+    std::vector<int> next( AT.row_offsets.begin(), AT.row_offsets.end()-1);
+    for( unsigned i=0; i<A.num_rows; i++)
+        for( int e=A.row_offsets[i]; e<A.row_offsets[i+1]; e++)
+        {
+            int pos = next[A.column_indices[e]]++;
+            AT.column_indices[pos] = i;
+            AT.values[pos] = A.values[e];
+        }
+}
+
+/**
+ * @brief Create interpolation matrix in CSR format
+ *
+ * Same as the coo version but built in parallel directly in CSR format, 
+ * which avoids the conversion (and sorting) of the coo matrix
  * @param x X-coordinates of interpolation points
  * @param y Y-coordinates of interpolation points
  * @param g The Grid on which to operate
@@ -123,136 +370,83 @@ cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::ho
  *
  * @return interpolation matrix
  */
-cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const Grid2d& g , dg::bc globalbcz = dg::NEU)
+cusp::csr_matrix<int, double, cusp::host_memory> interpolationCSR( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const Grid2d& g , dg::bc globalbcz = dg::NEU)
 {
-    assert( x.size() == y.size());
-    std::vector<double> gauss_nodes = g.dlt().abscissas(); 
-    dg::Operator<double> forward( g.dlt().forward());
-    cusp::array1d<double, cusp::host_memory> values;
-    cusp::array1d<int, cusp::host_memory> row_indices;
-    cusp::array1d<int, cusp::host_memory> column_indices;
-
-    for( int i=0; i<(int)x.size(); i++)
-    {
-        //assert that point is inside the grid boundaries
-        if (!(x[i] >= g.x0() && x[i] <= g.x1())) {
-            std::cerr << g.x0()<<"< xi = " << x[i] <<" < "<<g.x1()<<std::endl;
-        }
-        assert(x[i] >= g.x0() && x[i] <= g.x1());
-        if (!(y[i] >= g.y0() && y[i] <= g.y1())) {
-            std::cerr << g.y0()<<"< yi = " << y[i] <<" < "<<g.y1()<<std::endl;
-        }
-        assert( y[i] >= g.y0() && y[i] <= g.y1());
+    return detail::interpolationCSR( x, y, std::vector<unsigned>(), g, g.size(), globalbcz);
+}
 
-        //determine which cell (x,y) lies in 
-        double xnn = (x[i]-g.x0())/g.hx();
-        double ynn = (y[i]-g.y0())/g.hy();
-        unsigned nn = (unsigned)floor(xnn);
-        unsigned mm = (unsigned)floor(ynn);
-        //determine normalized coordinates
-        double xn =  2.*xnn - (double)(2*nn+1); 
-        double yn =  2.*ynn - (double)(2*mm+1); 
-        //interval correction
-        if (nn==g.Nx()) {
-            nn-=1;
-            xn = 1.;
-        }
-        if (mm==g.Ny()) {
-            mm-=1;
-            yn =1.;
-        }
-        //Test if the point is a Gauss point since then no interpolation is needed
-        int idxX =-1, idxY = -1;
-        for( unsigned k=0; k<g.n(); k++)
-        {
-            if( fabs( xn - gauss_nodes[k]) < 1e-14)
-                idxX = nn*g.n() + k; //determine which grid column it is
-            if( fabs( yn - gauss_nodes[k]) < 1e-14)
-                idxY = mm*g.n() + k;  //determine grid line
-        }
-        if( idxX < 0 && idxY < 0 ) //there is no corresponding point
-        {
-            //evaluate 2d Legendre polynomials at (xn, yn)...
-            std::vector<double> px = detail::coefficients( xn, g.n()), 
-                                py = detail::coefficients( yn, g.n());
-            std::vector<double> pxF(g.n(),0), pyF(g.n(), 0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                {
-                    pxF[l]+= px[k]*forward(k,l);
-                    pyF[l]+= py[k]*forward(k,l);
-                }
-            std::vector<double> pxy( g.n()*g.n());
-            //these are the matrix coefficients with which to multiply 
-            for(unsigned k=0; k<pyF.size(); k++)
-                for( unsigned l=0; l<pxF.size(); l++)
-                    pxy[k*px.size()+l]= pyF[k]*pxF[l];
-            if (globalbcz == dg::DIR)
-            {
-                if ( x[i]==g.x0() || x[i]==g.x1()  || y[i]==g.y0()  || y[i]==g.y1())
-    //             if ( fabs(x[i]-g.x0())<1e-10 || fabs(x[i]-g.x1())<1e-10  || fabs(y[i]-g.y0())<1e-10  || fabs(y[i]-g.y1())<1e-10)
-                {
-                    //zeroe boundary values 
-                    for(unsigned k=0; k<py.size(); k++)
-                    for( unsigned l=0; l<px.size(); l++)
-                        pxy[k*px.size()+l]= 0; 
-                }
-            }
-            for( unsigned k=0; k<g.n(); k++)
-                for( unsigned l=0; l<g.n(); l++)
-                {
-                    row_indices.push_back( i);
-                    column_indices.push_back( (mm*g.n()+k)*g.n()*g.Nx()+nn*g.n() + l);
-                    values.push_back( pxy[k*g.n()+l]);
-                }
-        }
-        else if ( idxX < 0 && idxY >=0) //there is a corresponding line
-        {
-            std::vector<double> px = detail::coefficients( xn, g.n());
-            std::vector<double> pxF(g.n(),0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                    pxF[l]+= px[k]*forward(k,l);
-            for( unsigned l=0; l<g.n(); l++)
-            {
-                row_indices.push_back( i);
-                column_indices.push_back( (idxY)*g.Nx()*g.n() + nn*g.n() + l);
-                values.push_back( pxF[l]);
-            }
-        }
-        else if ( idxX >= 0 && idxY < 0) //there is a corresponding column
-        {
-            std::vector<double> py = detail::coefficients( yn, g.n());
-            std::vector<double> pyF(g.n(),0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                    pyF[l]+= py[k]*forward(k,l);
-            for( unsigned k=0; k<g.n(); k++)
-            {
-                row_indices.push_back(i);
-                column_indices.push_back((mm*g.n()+k)*g.Nx()*g.n() + idxX);
-                values.push_back(pyF[k]);
-            }
-        }
-        else //the point already exists
-        {
-            row_indices.push_back(i);
-            column_indices.push_back(idxY*g.Nx()*g.n() + idxX); 
-            values.push_back(1.);
-        }
+/**
+ * @brief Create interpolation matrix and its transpose in CSR format
+ *
+ * @param x X-coordinates of interpolation points
+ * @param y Y-coordinates of interpolation points
+ * @param g The Grid on which to operate
+ * @param globalbcz NEU for common interpolation. DIR for zeros at Box
+ * @param transposed contains the transposed interpolation matrix on output
+ *
+ * @return interpolation matrix
+ */
+cusp::csr_matrix<int, double, cusp::host_memory> interpolationCSR( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const Grid2d& g , dg::bc globalbcz, cusp::csr_matrix<int, double, cusp::host_memory>& transposed)
+{
+    cusp::csr_matrix<int, double, cusp::host_memory> A = interpolationCSR( x, y, g, globalbcz);
+    transpose( A, transposed);
+    return A;
+}
 
-    }
-    cusp::coo_matrix<int, double, cusp::host_memory> A( x.size(), g.size(), values.size());
-    A.row_indices = row_indices; A.column_indices = column_indices; A.values = values;
+/**
+ * @brief Create interpolation matrix in CSR format
+ *
+ * Same as the coo version but built in parallel directly in CSR format. 
+ * In z-direction only a nearest neighbor interpolation is used
+ * @param x X-coordinates of interpolation points
+ * @param y Y-coordinates of interpolation points
+ * @param z Z-coordinates of interpolation points
+ * @param g The Grid on which to operate
+ * @param globalbcz determines what to do if values lie exactly on the boundary
+ *
+ * @return interpolation matrix
+ */
+cusp::csr_matrix<int, double, cusp::host_memory> interpolationCSR( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const thrust::host_vector<double>& z, const Grid3d& g, dg::bc globalbcz= dg::NEU)
+{
+    assert( y.size() == z.size());
+    return detail::interpolationCSR( x, y, detail::planes( z, g), Grid2d(g), g.size(), globalbcz);
+}
 
-    if (globalbcz == DIR_NEU ) std::cerr << "DIR_NEU NOT IMPLEMENTED "<<std::endl;
-    if (globalbcz == NEU_DIR ) std::cerr << "NEU_DIR NOT IMPLEMENTED "<<std::endl;
-    if (globalbcz == dg::PER ) std::cerr << "PER NOT IMPLEMENTED "<<std::endl;
-    
+/**
+ * @brief Create interpolation matrix and its transpose in CSR format
+ *
+ * @param x X-coordinates of interpolation points
+ * @param y Y-coordinates of interpolation points
+ * @param z Z-coordinates of interpolation points
+ * @param g The Grid on which to operate
+ * @param globalbcz determines what to do if values lie exactly on the boundary
+ * @param transposed contains the transposed interpolation matrix on output
+ *
+ * @return interpolation matrix
+ */
+cusp::csr_matrix<int, double, cusp::host_memory> interpolationCSR( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const thrust::host_vector<double>& z, const Grid3d& g, dg::bc globalbcz, cusp::csr_matrix<int, double, cusp::host_memory>& transposed)
+{
+    cusp::csr_matrix<int, double, cusp::host_memory> A = interpolationCSR( x, y, z, g, globalbcz);
+    transpose( A, transposed);
     return A;
 }
 
-
+/**
+ * @brief Create interpolation matrix
+ *
+ * The matrix, when applied to a vector, interpolates its values to the given coordinates
+ * @param x X-coordinates of interpolation points
+ * @param y Y-coordinates of interpolation points
+ * @param g The Grid on which to operate
+ * @param globalbcz NEU for common interpolation. DIR for zeros at Box
+ *
+ * @return interpolation matrix
+ * @note built by interpolationCSR
+ */
+cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const Grid2d& g , dg::bc globalbcz = dg::NEU)
+{
+    return cusp::coo_matrix<int, double, cusp::host_memory>( interpolationCSR( x, y, g, globalbcz));
+}
 
 /**
  * @brief Create interpolation matrix
@@ -266,141 +460,13 @@ cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::ho
  *
  * @return interpolation matrix
  * @note The values of x, y and z must lie within the boundaries of g
+ * @note built by interpolationCSR
  */
 cusp::coo_matrix<int, double, cusp::host_memory> interpolation( const thrust::host_vector<double>& x, const thrust::host_vector<double>& y, const thrust::host_vector<double>& z, const Grid3d& g, dg::bc globalbcz= dg::NEU)
 {
-    assert( x.size() == y.size());
-    assert( y.size() == z.size());
-    std::vector<double> gauss_nodes = g.dlt().abscissas(); 
-    dg::Operator<double> forward( g.dlt().forward());
-    cusp::array1d<double, cusp::host_memory> values;
-    cusp::array1d<int, cusp::host_memory> row_indices;
-    cusp::array1d<int, cusp::host_memory> column_indices;
-
-    for( int i=0; i<(int)x.size(); i++)
-    {
-        //assert that point is inside the grid boundaries
-        if (!(x[i] >= g.x0() && x[i] <= g.x1())) {
-            std::cerr << g.x0()<<"< xi = " << x[i] <<" < "<<g.x1()<<std::endl;
-        } assert(x[i] >= g.x0() && x[i] <= g.x1());
-        if (!(y[i] >= g.y0() && y[i] <= g.y1())) {
-            std::cerr << g.y0()<<"< yi = " << y[i] <<" < "<<g.y1()<<std::endl;
-        } assert( y[i] >= g.y0() && y[i] <= g.y1());
-        if (!(z[i] >= g.z0() && z[i] <= g.z1())) {
-            std::cerr << g.z0()<<"< zi = " << z[i] <<" < "<<g.z1()<<std::endl;
-        } assert( z[i] >= g.z0() && z[i] <= g.z1());
-
-        //determine which cell (x,y) lies in 
-        double xnn = (x[i]-g.x0())/g.hx();
-        double ynn = (y[i]-g.y0())/g.hy();
-        double znn = (z[i]-g.z0())/g.hz();
-        unsigned nn = (unsigned)floor(xnn);
-        unsigned mm = (unsigned)floor(ynn);
-        unsigned ll = (unsigned)floor(znn);
-        //determine normalized coordinates
-        double xn = 2.*xnn - (double)(2*nn+1); 
-        double yn = 2.*ynn - (double)(2*mm+1); 
-        //interval correction
-        if (nn==g.Nx()) {
-            nn-=1;
-            xn = 1.;
-        }
-        if (mm==g.Ny()) {
-            mm-=1;
-            yn =1.;
-        }
-        if (ll==g.Nz()) {
-            ll-=1;
-        }
-        //Test if the point is a Gauss point since then no interpolation is needed
-        int idxX =-1, idxY = -1;
-        for( unsigned k=0; k<g.n(); k++)
-        {
-            if( fabs( xn - gauss_nodes[k]) < 1e-14)
-                idxX = nn*g.n() + k; //determine which grid column it is
-            if( fabs( yn - gauss_nodes[k]) < 1e-14)
-                idxY = mm*g.n() + k;  //determine grid line
-        } //in z-direction we don't interpolate
-        if( idxX < 0 && idxY < 0 ) //there is no corresponding point
-        {
-            //evaluate 2d Legendre polynomials at (xn, yn)...
-            std::vector<double> px = detail::coefficients( xn, g.n()), 
-                                py = detail::coefficients( yn, g.n());
-            std::vector<double> pxF(g.n(),0), pyF(g.n(), 0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                {
-                    pxF[l]+= px[k]*forward(k,l);
-                    pyF[l]+= py[k]*forward(k,l);
-                }
-            std::vector<double> pxyz( g.n()*g.n());
-            //these are the matrix coefficients with which to multiply 
-            for(unsigned k=0; k<pyF.size(); k++)
-                for( unsigned l=0; l<pxF.size(); l++)
-                    pxyz[k*g.n()+l]= 1.*pyF[k]*pxF[l];
-            if (globalbcz == dg::DIR)
-            {
-                if ( x[i]==g.x0() || x[i]==g.x1()  ||y[i]==g.y0()  || y[i]==g.y1())
-                {
-                    //zeroe boundary values 
-                    for(unsigned k=0; k<g.n(); k++)
-                    for(unsigned l=0; l<g.n(); l++)
-                        pxyz[k*g.n()+l]= 0; 
-                }
-            }
-            for( unsigned k=0; k<g.n(); k++)
-                for( unsigned l=0; l<g.n(); l++)
-                {
-                    row_indices.push_back( i);
-                    column_indices.push_back( ((ll*g.Ny()+mm)*g.n()+k)*g.n()*g.Nx()+nn*g.n() + l);
-                    values.push_back( pxyz[k*g.n()+l]);
-                }
-        }
-        else if ( idxX < 0 && idxY >=0) //there is a corresponding line
-        {
-            std::vector<double> px = detail::coefficients( xn, g.n());
-            std::vector<double> pxF(g.n(),0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                    pxF[l]+= px[k]*forward(k,l);
-            for( unsigned l=0; l<g.n(); l++)
-            {
-                row_indices.push_back( i);
-                column_indices.push_back( (ll*g.Ny()*g.n() + idxY)*g.Nx()*g.n() + nn*g.n() + l);
-                values.push_back( pxF[l]);
-            }
-        }
-        else if ( idxX >= 0 && idxY < 0) //there is a corresponding column
-        {
-            std::vector<double> py = detail::coefficients( yn, g.n());
-            std::vector<double> pyF(g.n(),0);
-            for( unsigned l=0; l<g.n(); l++)
-                for( unsigned k=0; k<g.n(); k++)
-                    pyF[l]+= py[k]*forward(k,l);
-            for( unsigned k=0; k<g.n(); k++)
-            {
-                row_indices.push_back(i);
-                column_indices.push_back(((ll*g.Ny()+mm)*g.n()+k)*g.Nx()*g.n() + idxX);
-                values.push_back(pyF[k]);
-            }
-        }
-        else //the point already exists
-        {
-            row_indices.push_back(i);
-            column_indices.push_back((ll*g.Ny()*g.n()+idxY)*g.Nx()*g.n() + idxX); 
-            values.push_back(1.);
-        }
-
-    }
-    cusp::coo_matrix<int, double, cusp::host_memory> A( x.size(), g.size(), values.size());
-    A.row_indices = row_indices; A.column_indices = column_indices; A.values = values;
-
-    if (globalbcz == DIR_NEU ) std::cerr << "DIR_NEU NOT IMPLEMENTED "<<std::endl;
-    if (globalbcz == NEU_DIR ) std::cerr << "NEU_DIR NOT IMPLEMENTED "<<std::endl;
-    if (globalbcz == dg::PER ) std::cerr << "PER NOT IMPLEMENTED "<<std::endl;
-    
-    return A;
+    return cusp::coo_matrix<int, double, cusp::host_memory>( interpolationCSR( x, y, z, g, globalbcz));
 }
+
 /**
  * @brief Create interpolation between two grids
  *
@@ -1,6 +1,7 @@
 #include <iostream>
 
 #include <cusp/print.h>
+#include <cusp/transpose.h>
 #include "xspacelib.cuh"
 #include "interpolation.cuh"
 #include "../blas.h"
@@ -61,8 +62,19 @@ int main()
     else
         std::cout << "2D TEST PASSED!\n";
 
+    dg::IHMatrix C, CT, BT;
+    C = dg::create::interpolationCSR( x, y, g, dg::NEU, CT);
+    cusp::transpose( C, BT);
+    bool passed = C.num_entries == B.num_entries && CT.num_entries == BT.num_entries;
+    for( unsigned i=0; passed && i<BT.num_entries; i++)
+        if( CT.column_indices[i] != BT.column_indices[i] || fabs( CT.values[i] - BT.values[i]) > 1e-14)
+            passed = false;
+    if( passed)
+        std::cout << "2D CSR TRANSPOSE TEST PASSED!\n";
+    else
+        std::cout << "2D CSR TRANSPOSE TEST FAILED!\n";
 
-    bool passed = true;
+    passed = true;
     thrust::host_vector<double> xs = dg::evaluate( dg::cooX2d, g); 
     thrust::host_vector<double> ys = dg::evaluate( dg::cooY2d, g); 
     thrust::host_vector<double> xF = dg::create::forward_transform( xs, g);
@@ -12,23 +12,23 @@
 namespace dg{
 
 ///@cond
-template< class T>
-struct MatrixTraits<thrust::host_vector<T> > {
+template< class T, class Alloc>
+struct MatrixTraits<thrust::host_vector<T, Alloc> > {
     typedef T value_type;
     typedef ThrustMatrixTag matrix_category; 
 };
-template< class T>
-struct MatrixTraits<thrust::device_vector<T> > {
+template< class T, class Alloc>
+struct MatrixTraits<thrust::device_vector<T, Alloc> > {
     typedef T value_type;
     typedef ThrustMatrixTag matrix_category; 
 };
-template< class T>
-struct MatrixTraits<const thrust::host_vector<T> > {
+template< class T, class Alloc>
+struct MatrixTraits<const thrust::host_vector<T, Alloc> > {
     typedef T value_type;
     typedef ThrustMatrixTag matrix_category; 
 };
-template< class T>
-struct MatrixTraits<const thrust::device_vector<T> > {
+template< class T, class Alloc>
+struct MatrixTraits<const thrust::device_vector<T, Alloc> > {
     typedef T value_type;
     typedef ThrustMatrixTag matrix_category; 
 };
@@ -59,50 +59,64 @@ CooSparseBlockMat<double> save_outer_values(EllSparseBlockMat<double>& m)
 }
 
 /**
-* @brief Reduce a global matrix into equal chunks among mpi processes
+* @brief Reduce a global matrix into (possibly unequal) chunks among mpi processes
 *
 * grabs the right chunk of column and data indices and remaps the column indices to vector with ghostcells
 * copies the whole data array 
-* @param coord The mpi proces coordinate of the proper dimension
-* @param howmany[3] # of processes 0 is left, 1 is the middle, 2 is right
+* @param offset The first row of the chunk
+* @param chunk_size The number of rows of the chunk (if it equals the number of rows the process is alone in this direction)
+* @param left_size The local left_size
+* @param right_size The local right_size
 * @return The reduced matrix
 */
-EllSparseBlockMat<double> distribute_rows( const EllSparseBlockMat<double>& src, int coord, const int* howmany)
+EllSparseBlockMat<double> distribute_rows( const EllSparseBlockMat<double>& src, int offset, int chunk_size, int left_size, int right_size)
 {
-    if( howmany[1] == 1)
+    if( chunk_size == src.num_rows)
     {
         EllSparseBlockMat<double> temp(src);
-        temp.left_size = temp.left_size/howmany[0];
-        temp.right_size = temp.right_size/howmany[2];
+        temp.left_size = left_size;
+        temp.right_size = right_size;
         temp.set_default_range();
         return temp;
     }
     assert( src.num_rows == src.num_cols);
-    int chunk_size = src.num_rows/howmany[1];
     EllSparseBlockMat<double> temp(chunk_size, chunk_size, src.blocks_per_line, src.data.size()/(src.n*src.n), src.n);
-    temp.left_size = src.left_size/howmany[0];
-    temp.right_size = src.right_size/howmany[2];
+    temp.left_size = left_size;
+    temp.right_size = right_size;
     //first copy data elements (even though not all might be needed it doesn't slow down things either)
     for( unsigned  i=0; i<src.data.size(); i++)
         temp.data[i] = src.data[i];
     //now grab the right chunk of cols and data indices
     for( unsigned i=0; i<temp.cols_idx.size(); i++)
     {
-        temp.data_idx[i] = src.data_idx[ coord*(chunk_size*src.blocks_per_line)+i];
-        temp.cols_idx[i] = src.cols_idx[ coord*(chunk_size*src.blocks_per_line)+i];
+        temp.data_idx[i] = src.data_idx[ offset*src.blocks_per_line+i];
+        temp.cols_idx[i] = src.cols_idx[ offset*src.blocks_per_line+i];
         //data indices are correct but cols are still the global indices (remapping a bit clumsy)
         //first in the zeroth line the col idx might be (global)num_cols - 1 -> map that to -1
-        if( coord==0 && i/src.blocks_per_line == 0 && temp.cols_idx[i] == src.num_cols-1) temp.cols_idx[i] = -1; 
+        if( offset==0 && i/src.blocks_per_line == 0 && temp.cols_idx[i] == src.num_cols-1) temp.cols_idx[i] = -1; 
         //second in the last line the col idx mighty be 0 -> map to (global)num_cols
-        if( coord==(howmany[1]-1)&& (int)i/src.blocks_per_line == temp.num_rows-1 && temp.cols_idx[i] == 0) temp.cols_idx[i] = src.num_cols;  
+        if( offset+chunk_size==src.num_rows && (int)i/src.blocks_per_line == temp.num_rows-1 && temp.cols_idx[i] == 0) temp.cols_idx[i] = src.num_cols;  
         //Elements are now in the range -1, 0, 1,..., (global)num_cols
         //now shift this range to chunk range -1,..,chunk_size
-        temp.cols_idx[i] = (temp.cols_idx[i] - coord*chunk_size ); 
+        temp.cols_idx[i] = (temp.cols_idx[i] - offset ); 
     }
     temp.set_default_range();
     return temp;
 }
 
+/**
+* @brief Reduce a global matrix into equal chunks among mpi processes
+*
+* @param coord The mpi proces coordinate of the proper dimension
+* @param howmany[3] # of processes 0 is left, 1 is the middle, 2 is right
+* @return The reduced matrix
+*/
+EllSparseBlockMat<double> distribute_rows( const EllSparseBlockMat<double>& src, int coord, const int* howmany)
+{
+    int chunk_size = src.num_rows/howmany[1];
+    return distribute_rows( src, coord*chunk_size, chunk_size, src.left_size/howmany[0], src.right_size/howmany[2]);
+}
+
 
 } //namespace detail
 
@@ -127,12 +141,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> dx( c
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 2);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[1], dims[0], 1}; //left, middle, right
-    //distribute_rows, collective and save_outer_values are aware of howmany[1] == 1
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[0], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetX(), g.Nx(), g.n()*g.Ny(), 1);
     NNCH c( g.n(), vector_dimensions, comm, 0);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -156,11 +166,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> dy( c
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 2);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {1, dims[1], dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[1], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetY(), g.Ny(), 1, g.n()*g.Nx());
     NNCH c( g.n(), vector_dimensions, comm, 1);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -183,11 +190,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> jumpX
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 2);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[1], dims[0], 1}; //left, middle, right
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[0], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetX(), g.Nx(), g.n()*g.Ny(), 1);
     NNCH c( g.n(), vector_dimensions, comm, 0);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -209,11 +213,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> jumpY
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 2);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {1, dims[1], dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[1], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetY(), g.Ny(), 1, g.n()*g.Nx());
     NNCH c( g.n(), vector_dimensions, comm, 1);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -237,11 +238,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> dx( c
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[2]*dims[1], dims[0], 1};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[0], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetX(), g.Nx(), g.n()*g.Ny()*g.Nz(), 1);
     NNCH c( g.n(), vector_dimensions, comm, 0);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -264,11 +262,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> dy( c
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[2], dims[1], dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[1], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetY(), g.Ny(), g.Nz(), g.n()*g.Nx());
     NNCH c( g.n(), vector_dimensions, comm, 1);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -291,11 +286,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> dz( c
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {1, dims[2], dims[1]*dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[2], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetZ(), g.Nz(), 1, g.n()*g.n()*g.Nx()*g.Ny());
     NNCH c( 1, vector_dimensions, comm, 2);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -318,11 +310,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> jumpX
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[2]*dims[1], dims[0], 1};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[0], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetX(), g.Nx(), g.n()*g.Ny()*g.Nz(), 1);
     NNCH c( g.n(), vector_dimensions, comm, 0);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -345,11 +334,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> jumpY
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {dims[2], dims[1], dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[1], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetY(), g.Ny(), g.Nz(), g.n()*g.Nx());
     NNCH c( g.n(), vector_dimensions, comm, 1);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
@@ -371,11 +357,8 @@ RowColDistMat< EllSparseBlockMat<double>, CooSparseBlockMat<double>, NNCH> jumpZ
     int ndims;
     MPI_Cartdim_get( comm, &ndims);
     assert( ndims == 3);
-    int dims[ndims], periods[ndims], coords[ndims];
-    MPI_Cart_get( comm, ndims, dims, periods, coords);
 
-    int howmany[] = {1, dims[2], dims[1]*dims[0]};
-    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, coords[2], howmany);
+    EllSparseBlockMat<double> inner = detail::distribute_rows(matrix, g.offsetZ(), g.Nz(), 1, g.n()*g.n()*g.Nx()*g.Ny());
     NNCH c( 1, vector_dimensions, comm, 2);
     CooSparseBlockMat<double> outer = detail::save_outer_values(inner);
 
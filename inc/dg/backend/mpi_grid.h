@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cmath>
+#include <vector>
+#include <algorithm>
 #include "../enums.h"
 #include "grid.h"
 /*! @file 
@@ -10,6 +12,83 @@
 
 namespace dg
 {
+
+///@cond
+namespace detail
+{
+//offsets[i] is the first cell of process coordinate i, offsets[dims] = N
+inline std::vector<unsigned> uniform_offsets( unsigned N, int dims)
+{
+    std::vector<unsigned> offsets( dims+1);
+    for( int i=0; i<=dims; i++)
+        offsets[i] = i*(N/dims);
+    return offsets;
+}
+inline std::vector<unsigned> offsets_from_cells( const std::vector<unsigned>& cells)
+{
+    std::vector<unsigned> offsets( cells.size()+1, 0);
+    for( unsigned i=0; i<cells.size(); i++)
+    {
+        assert( cells[i] > 0);
+        offsets[i+1] = offsets[i] + cells[i];
+    }
+    return offsets;
+}
+inline std::vector<unsigned> cells_from_offsets( const std::vector<unsigned>& offsets)
+{
+    std::vector<unsigned> cells( offsets.size()-1);
+    for( unsigned i=0; i<cells.size(); i++)
+        cells[i] = offsets[i+1]-offsets[i];
+    return cells;
+}
+//process coordinate that holds the given (global) cell coordinate
+inline int coord_of_cell( double cell, const std::vector<unsigned>& offsets)
+{
+    if( cell < 0) return -1;
+    if( cell >= (double)offsets.back()) return offsets.size()-1;
+    return std::upper_bound( offsets.begin(), offsets.end(), (unsigned)cell) - offsets.begin() - 1;
+}
+}//namespace detail
+///@endcond
+
+/**
+ * @brief Distribute cells among processes such that each process gets about the same cost
+ *
+ * @ingroup grid
+ * The cost of a process is the sum of the costs of its cells. Cells are attributed
+ * in consecutive chunks and each process gets at least one cell. Use with
+ * the MPI grid constructors that take the number of cells per process, e.g.
+ * @code
+ std::vector<double> costX( Nx, 1.);
+ costX[0] = costX[Nx-1] = 4.; //boundary cells are more expensive
+ dg::MPIGrid2d g( x0, x1, y0, y1, n, Nx, Ny, bcx, bcy, dg::partition( costX, npx), dg::partition( costY, npy), comm);
+ * @endcode
+ * @param cost the cost of each cell in one dimension (e.g. summed over the other dimensions)
+ * @param np the number of processes in this dimension
+ * @return number of cells for each process coordinate (sums to cost.size())
+ */
+inline std::vector<unsigned> partition( const std::vector<double>& cost, unsigned np)
+{
+    unsigned N = cost.size();
+    assert( np > 0 && np <= N);
+    std::vector<double> sum( N+1, 0.); //sum[i] is the cost of cells 0..i-1
+    for( unsigned i=0; i<N; i++)
+        sum[i+1] = sum[i] + cost[i];
+    std::vector<unsigned> offsets( np+1, 0);
+    offsets[np] = N;
+    for( unsigned k=1; k<np; k++)
+    {
+        double target = sum[N]*(double)k/(double)np;
+        unsigned i = std::lower_bound( sum.begin(), sum.end(), target) - sum.begin();
+        if( i > 0 && target - sum[i-1] < sum[i] - target) i--; //choose the closer boundary
+        //leave at least one cell for this and all remaining processes
+        i = std::max( i, offsets[k-1]+1);
+        i = std::min( i, N-(np-k));
+        offsets[k] = i;
+    }
+    return detail::cells_from_offsets( offsets);
+}
+
 ///@addtogroup grid
 ///@{
 
@@ -19,6 +98,8 @@ namespace dg
  *
  * Represents the local grid coordinates and the process topology. 
  * It just divides the given (global) box into nonoverlapping (local) subboxes that are attributed to each process
+ * By default all subboxes have the same number of cells, a constructor taking
+ * the number of cells per process coordinate allows a load-balanced distribution (cf. dg::partition).
  * @attention
  * The boundaries in the constructors are global boundaries, the boundaries returned by the access functions are local boundaries, this is because the grid represents the information given to one process
  *
@@ -59,6 +140,8 @@ struct MPIGrid2d
             if( g.bcy() == dg::PER) assert( periods[1] == true);
             else assert( periods[1] == false);
         }
+        ox_ = detail::uniform_offsets( Nx, dims[0]);
+        oy_ = detail::uniform_offsets( Ny, dims[1]);
     }
 
     /**
@@ -94,6 +177,38 @@ struct MPIGrid2d
             if( bcy == dg::PER) assert( periods[1] == true);
             else assert( periods[1] == false);
         }
+        ox_ = detail::uniform_offsets( Nx, dims[0]);
+        oy_ = detail::uniform_offsets( Ny, dims[1]);
+    }
+
+    /**
+     * @brief Construct mpi grid with a non-uniform distribution of cells
+     *
+     * @param x0
+     * @param x1
+     * @param y0
+     * @param y1
+     * @param n
+     * @param Nx
+     * @param Ny
+     * @param bcx
+     * @param bcy
+     * @param cellsX number of cells of each process coordinate in x (size npx, sums to Nx, cf. dg::partition)
+     * @param cellsY number of cells of each process coordinate in y (size npy, sums to Ny)
+     * @param comm
+     */
+    MPIGrid2d( double x0, double x1, double y0, double y1, unsigned n, unsigned Nx, unsigned Ny, bc bcx, bc bcy, const std::vector<unsigned>& cellsX, const std::vector<unsigned>& cellsY, MPI_Comm comm):
+        g( x0, x1, y0, y1, n, Nx, Ny, bcx, bcy), comm( comm), 
+        ox_( detail::offsets_from_cells( cellsX)), oy_( detail::offsets_from_cells( cellsY))
+    {
+        int dims[2], periods[2], coords[2];
+        MPI_Cart_get( comm, 2, dims, periods, coords);
+        assert( cellsX.size() == (unsigned)dims[0] && ox_.back() == Nx);
+        assert( cellsY.size() == (unsigned)dims[1] && oy_.back() == Ny);
+        if( bcx == dg::PER) assert( periods[0] == true);
+        else assert( periods[0] == false);
+        if( bcy == dg::PER) assert( periods[1] == true);
+        else assert( periods[1] == false);
     }
 
     /**
@@ -104,7 +219,7 @@ struct MPIGrid2d
     double x0() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.x0() + g.lx()/(double)dims[0]*(double)coords[0]; 
+        return g.x0() + g.hx()*(double)ox_[coords[0]]; 
     }
 
     /**
@@ -115,7 +230,8 @@ struct MPIGrid2d
     double x1() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.x0() + g.lx()/(double)dims[0]*(double)(coords[0]+1); 
+        if( coords[0] == dims[0]-1) return g.x1();
+        return g.x0() + g.hx()*(double)ox_[coords[0]+1]; 
     }
 
     /**
@@ -126,7 +242,7 @@ struct MPIGrid2d
     double y0() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.y0() + g.ly()/(double)dims[1]*(double)coords[1]; 
+        return g.y0() + g.hy()*(double)oy_[coords[1]]; 
     }
 
     /**
@@ -137,7 +253,8 @@ struct MPIGrid2d
     double y1() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.y0() + g.ly()/(double)dims[1]*(double)(coords[1]+1); 
+        if( coords[1] == dims[1]-1) return g.y1();
+        return g.y0() + g.hy()*(double)oy_[coords[1]+1]; 
     }
 
     /**
@@ -183,7 +300,7 @@ struct MPIGrid2d
     unsigned Nx() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.Nx()/dims[0];
+        return ox_[coords[0]+1] - ox_[coords[0]];
     }
 
     /**
@@ -195,8 +312,41 @@ struct MPIGrid2d
     unsigned Ny() const {
         int dims[2], periods[2], coords[2];
         MPI_Cart_get( comm, 2, dims, periods, coords);
-        return g.Ny()/dims[1];
+        return oy_[coords[1]+1] - oy_[coords[1]];
+    }
+
+    /**
+     * @brief Return the global index of the first local cell in x
+     *
+     * @return offset in cells
+     */
+    unsigned offsetX() const {
+        int dims[2], periods[2], coords[2];
+        MPI_Cart_get( comm, 2, dims, periods, coords);
+        return ox_[coords[0]];
+    }
+    /**
+     * @brief Return the global index of the first local cell in y
+     *
+     * @return offset in cells
+     */
+    unsigned offsetY() const {
+        int dims[2], periods[2], coords[2];
+        MPI_Cart_get( comm, 2, dims, periods, coords);
+        return oy_[coords[1]];
     }
+    /**
+     * @brief Number of cells of each process coordinate in x
+     *
+     * @return vector of size npx
+     */
+    std::vector<unsigned> partitionX() const { return detail::cells_from_offsets( ox_);}
+    /**
+     * @brief Number of cells of each process coordinate in y
+     *
+     * @return vector of size npy
+     */
+    std::vector<unsigned> partitionY() const { return detail::cells_from_offsets( oy_);}
 
     /**
      * @brief global x boundary
@@ -283,6 +433,7 @@ struct MPIGrid2d
     private:
     Grid2d g; //global grid
     MPI_Comm comm; //just an integer...
+    std::vector<unsigned> ox_, oy_; //first cell of each process coordinate
 
 };
 
@@ -291,6 +442,8 @@ struct MPIGrid2d
  *
  * Represents the local grid coordinates and the process topology. 
  * It just divides the given box into nonoverlapping subboxes that are attributed to each process
+ * By default all subboxes have the same number of cells, a constructor taking
+ * the number of cells per process coordinate allows a load-balanced distribution (cf. dg::partition).
  * @attention
  * The boundaries in the constructors are global boundaries, the boundaries returned by the access functions are local boundaries, this is because the grid represents the information given to one process
  *
@@ -340,6 +493,9 @@ struct MPIGrid3d
             if( g.bcz() == dg::PER) assert( periods[2] == true);
             else assert( periods[2] == false);
         }
+        ox_ = detail::uniform_offsets( Nx, dims[0]);
+        oy_ = detail::uniform_offsets( Ny, dims[1]);
+        oz_ = detail::uniform_offsets( Nz, dims[2]);
     }
 
     /**
@@ -385,6 +541,48 @@ struct MPIGrid3d
             if( bcz == dg::PER) assert( periods[2] == true);
             else assert( periods[2] == false);
         }
+        ox_ = detail::uniform_offsets( Nx, dims[0]);
+        oy_ = detail::uniform_offsets( Ny, dims[1]);
+        oz_ = detail::uniform_offsets( Nz, dims[2]);
+    }
+
+    /**
+     * @brief Construct a 3D grid with a non-uniform distribution of cells
+     *
+     * @param x0 left boundary in x
+     * @param x1 right boundary in x 
+     * @param y0 lower boundary in y
+     * @param y1 upper boundary in y 
+     * @param z0 lower boundary in z
+     * @param z1 upper boundary in z 
+     * @param n  # of polynomial coefficients per (x-,y-) dimension
+     * @param Nx # of points in x 
+     * @param Ny # of points in y
+     * @param Nz # of points in z
+     * @param bcx boundary condition in x
+     * @param bcy boundary condition in y
+     * @param bcz boundary condition in z
+     * @param cellsX number of cells of each process coordinate in x (size npx, sums to Nx, cf. dg::partition)
+     * @param cellsY number of cells of each process coordinate in y (size npy, sums to Ny)
+     * @param cellsZ number of cells of each process coordinate in z (size npz, sums to Nz)
+     * @param comm mpi communicator
+     * @attention # of polynomial coefficients in z direction is always 1
+     */
+    MPIGrid3d( double x0, double x1, double y0, double y1, double z0, double z1, unsigned n, unsigned Nx, unsigned Ny, unsigned Nz, bc bcx, bc bcy, bc bcz, const std::vector<unsigned>& cellsX, const std::vector<unsigned>& cellsY, const std::vector<unsigned>& cellsZ, MPI_Comm comm):
+        g( x0, x1, y0, y1, z0, z1, n, Nx, Ny, Nz, bcx, bcy, bcz), comm( comm),
+        ox_( detail::offsets_from_cells( cellsX)), oy_( detail::offsets_from_cells( cellsY)), oz_( detail::offsets_from_cells( cellsZ))
+    {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get( comm, 3, dims, periods, coords);
+        assert( cellsX.size() == (unsigned)dims[0] && ox_.back() == Nx);
+        assert( cellsY.size() == (unsigned)dims[1] && oy_.back() == Ny);
+        assert( cellsZ.size() == (unsigned)dims[2] && oz_.back() == Nz);
+        if( bcx == dg::PER) assert( periods[0] == true);
+        else assert( periods[0] == false);
+        if( bcy == dg::PER) assert( periods[1] == true);
+        else assert( periods[1] == false);
+        if( bcz == dg::PER) assert( periods[2] == true);
+        else assert( periods[2] == false);
     }
 
     /**
@@ -395,7 +593,7 @@ struct MPIGrid3d
     double x0() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.x0() + g.lx()/(double)dims[0]*(double)coords[0]; 
+        return g.x0() + g.hx()*(double)ox_[coords[0]]; 
     }
     /**
      * @brief Return local x1
@@ -406,7 +604,7 @@ struct MPIGrid3d
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
         if( coords[0] == dims[0]-1) return g.x1();
-        return g.x0() + g.lx()/(double)dims[0]*(double)(coords[0]+1); 
+        return g.x0() + g.hx()*(double)ox_[coords[0]+1]; 
     }
     /**
      * @brief Return local y0
@@ -416,7 +614,7 @@ struct MPIGrid3d
     double y0() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.y0() + g.ly()/(double)dims[1]*(double)coords[1]; 
+        return g.y0() + g.hy()*(double)oy_[coords[1]]; 
     }
     /**
      * @brief Return local y1
@@ -427,7 +625,7 @@ struct MPIGrid3d
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
         if( coords[1] == dims[1]-1) return g.y1();
-        return g.y0() + g.ly()/(double)dims[1]*(double)(coords[1]+1); 
+        return g.y0() + g.hy()*(double)oy_[coords[1]+1]; 
     }
     /**
      * @brief Return local z0
@@ -437,7 +635,7 @@ struct MPIGrid3d
     double z0() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.z0() + g.lz()/(double)dims[2]*(double)coords[2]; 
+        return g.z0() + g.hz()*(double)oz_[coords[2]]; 
     }
     /**
      * @brief Return local z1
@@ -448,7 +646,7 @@ struct MPIGrid3d
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
         if( coords[2] == dims[2]-1) return g.z1();
-        return g.z0() + g.lz()/(double)dims[2]*(double)(coords[2]+1); 
+        return g.z0() + g.hz()*(double)oz_[coords[2]+1]; 
     }
     /**
      * @brief Return local lx
@@ -501,7 +699,7 @@ struct MPIGrid3d
     unsigned Nx() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.Nx()/dims[0];
+        return ox_[coords[0]+1] - ox_[coords[0]];
     }
     /**
      * @brief Return the local number of cells 
@@ -512,7 +710,7 @@ struct MPIGrid3d
     unsigned Ny() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.Ny()/dims[1];
+        return oy_[coords[1]+1] - oy_[coords[1]];
     }
     /**
      * @brief Return the local number of cells 
@@ -523,8 +721,56 @@ struct MPIGrid3d
     unsigned Nz() const {
         int dims[3], periods[3], coords[3];
         MPI_Cart_get( comm, 3, dims, periods, coords);
-        return g.Nz()/dims[2];
+        return oz_[coords[2]+1] - oz_[coords[2]];
+    }
+    /**
+     * @brief Return the global index of the first local cell in x
+     *
+     * @return offset in cells
+     */
+    unsigned offsetX() const {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get( comm, 3, dims, periods, coords);
+        return ox_[coords[0]];
+    }
+    /**
+     * @brief Return the global index of the first local cell in y
+     *
+     * @return offset in cells
+     */
+    unsigned offsetY() const {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get( comm, 3, dims, periods, coords);
+        return oy_[coords[1]];
+    }
+    /**
+     * @brief Return the global index of the first local cell in z
+     *
+     * @return offset in cells
+     */
+    unsigned offsetZ() const {
+        int dims[3], periods[3], coords[3];
+        MPI_Cart_get( comm, 3, dims, periods, coords);
+        return oz_[coords[2]];
     }
+    /**
+     * @brief Number of cells of each process coordinate in x
+     *
+     * @return vector of size npx
+     */
+    std::vector<unsigned> partitionX() const { return detail::cells_from_offsets( ox_);}
+    /**
+     * @brief Number of cells of each process coordinate in y
+     *
+     * @return vector of size npy
+     */
+    std::vector<unsigned> partitionY() const { return detail::cells_from_offsets( oy_);}
+    /**
+     * @brief Number of cells of each process coordinate in z
+     *
+     * @return vector of size npz
+     */
+    std::vector<unsigned> partitionZ() const { return detail::cells_from_offsets( oz_);}
     /**
      * @brief global x boundary
      *
@@ -609,14 +855,15 @@ struct MPIGrid3d
     private:
     Grid3d g; //global grid
     MPI_Comm comm; //just an integer...
+    std::vector<unsigned> ox_, oy_, oz_; //first cell of each process coordinate
 };
 ///@cond
 int MPIGrid2d::pidOf( double x, double y) const
 {
     int dims[2], periods[2], coords[2];
     MPI_Cart_get( comm, 2, dims, periods, coords);
-    coords[0] = (unsigned)floor( (x-g.x0())/g.lx()*(double)dims[0] );
-    coords[1] = (unsigned)floor( (y-g.y0())/g.ly()*(double)dims[1] );
+    coords[0] = detail::coord_of_cell( floor( (x-g.x0())/g.hx()), ox_);
+    coords[1] = detail::coord_of_cell( floor( (y-g.y0())/g.hy()), oy_);
     //if point lies on or over boundary of last cell shift into current cell (not so good for periodic boundaries)
     coords[0]=(coords[0]==dims[0]) ? coords[0]-1 :coords[0];
     coords[1]=(coords[1]==dims[1]) ? coords[1]-1 :coords[1];
@@ -630,9 +877,9 @@ int MPIGrid3d::pidOf( double x, double y, double z) const
 {
     int dims[3], periods[3], coords[3];
     MPI_Cart_get( comm, 3, dims, periods, coords);
-    coords[0] = (unsigned)floor( (x-g.x0())/g.lx()*(double)dims[0] );
-    coords[1] = (unsigned)floor( (y-g.y0())/g.ly()*(double)dims[1] );
-    coords[2] = (unsigned)floor( (z-g.z0())/g.lz()*(double)dims[2] );
+    coords[0] = detail::coord_of_cell( floor( (x-g.x0())/g.hx()), ox_);
+    coords[1] = detail::coord_of_cell( floor( (y-g.y0())/g.hy()), oy_);
+    coords[2] = detail::coord_of_cell( floor( (z-g.z0())/g.hz()), oz_);
     //if point lies on or over boundary of last cell shift into current cell (not so good for periodic boundaries)
     coords[0]=(coords[0]==dims[0]) ? coords[0]-1 :coords[0];
     coords[1]=(coords[1]==dims[1]) ? coords[1]-1 :coords[1];
@@ -1,5 +1,202 @@
 #pragma once
 //enums need to be included before this
+#include <vector>
+#include <iostream>
+#include <cassert>
+
+/*! @file
+ *
+ * Setup of the Cartesian process grid
+ */
+
+///@cond
+namespace dg{
+namespace detail{
+//choose np[d] for all d >= dim with np[d] == 0 such that prod np = size
+inline void mpi_dims_enumerate( int size, unsigned dim, std::vector<int>& np, const std::vector<int>& fixed, std::vector<std::vector<int> >& result)
+{
+    if( dim == np.size())
+    {
+        if( size == 1) result.push_back( np);
+        return;
+    }
+    if( fixed[dim] != 0)
+    {
+        if( size % fixed[dim] != 0) return;
+        np[dim] = fixed[dim];
+        mpi_dims_enumerate( size/fixed[dim], dim+1, np, fixed, result);
+        return;
+    }
+    for( int i=1; i<=size; i++)
+        if( size%i == 0)
+        {
+            np[dim] = i;
+            mpi_dims_enumerate( size/i, dim+1, np, fixed, result);
+        }
+}
+//number of halo faces along one dimension for p (sub-)domains
+inline int mpi_halo_faces( int p, bool periodic)
+{
+    if( p == 1) return 0;
+    return periodic ? p : p-1;
+}
+}//namespace detail
+}//namespace dg
+///@endcond
+
+/**
+ * @brief Number of processes that share a node with the calling process
+ *
+ * @param comm communicator (collective call)
+ * @return size of the shared memory communicator (1 if MPI version < 3)
+ */
+inline int mpi_ranks_per_node( MPI_Comm comm = MPI_COMM_WORLD)
+{
+#if MPI_VERSION >= 3
+    MPI_Comm shared;
+    int rank, ppn;
+    MPI_Comm_rank( comm, &rank);
+    MPI_Comm_split_type( comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &shared);
+    MPI_Comm_size( shared, &ppn);
+    MPI_Comm_free( &shared);
+    return ppn;
+#else
+    return 1;
+#endif //MPI_VERSION
+}
+
+/**
+ * @brief Halo surface of a Cartesian process grid
+ *
+ * Counts the cell faces that are communicated between processes.
+ * Faces between processes on different nodes are additionally weighted with node_weight,
+ * where the ranks of one node are assumed to be consecutive in row-major order of
+ * the process grid (the last dimension runs fastest as in MPI_Cart_create).
+ * @param np the process grid
+ * @param N the number of cells in each dimension
+ * @param periodic periodicity in each dimension
+ * @param ppn the number of processes per node
+ * @param node_weight additional cost of a face across nodes
+ * @return the cost of the process grid
+ */
+inline double mpi_halo_cost( const std::vector<int>& np, const std::vector<unsigned>& N, const std::vector<bool>& periodic, int ppn = 1, double node_weight = 4.)
+{
+    unsigned ndims = np.size();
+    //shape of the box of processes that share a node
+    std::vector<int> block( ndims, 1);
+    int remaining = ppn;
+    for( int d=ndims-1; d>=0 && remaining>1; d--)
+    {
+        if( remaining % np[d] == 0)
+        {
+            block[d] = np[d];
+            remaining /= np[d];
+        }
+        else
+        {
+            //a node does not span a full row: it owns at most a segment of it
+            int b = 1;
+            for( int i=1; i<=np[d]; i++)
+                if( np[d]%i == 0 && remaining%i == 0) b = i;
+            block[d] = b;
+            break;
+        }
+    }
+    double cost = 0;
+    for( unsigned d=0; d<ndims; d++)
+    {
+        double area = 1.;
+        for( unsigned e=0; e<ndims; e++)
+            if( e != d) area *= N[e];
+        cost += area*( dg::detail::mpi_halo_faces( np[d], periodic[d])
+                     + node_weight*dg::detail::mpi_halo_faces( np[d]/block[d], periodic[d]));
+    }
+    return cost;
+}
+
+/**
+ * @brief Choose a Cartesian process grid that minimises the halo surface
+ *
+ * Among all process grids with size processes that divide the number of cells in every dimension
+ * (as required by the MPI grids) the one with the smallest mpi_halo_cost is chosen.
+ * As in MPI_Dims_create non-zero entries of np on input are kept.
+ * @param size total number of processes
+ * @param N number of cells in each dimension
+ * @param bcs boundary conditions in each dimension (dg::PER means periodic)
+ * @param np on input zero entries are free, non-zero entries are fixed; contains the process grid on output
+ * @param ppn number of processes per node (cf. mpi_ranks_per_node())
+ * @param M further numbers of cells (e.g. of an output grid) that the process grid must divide (empty: none)
+ * @return false if no process grid divides N (and M), np is then the result of MPI_Dims_create
+ */
+inline bool mpi_dims_create( int size, const std::vector<unsigned>& N, const std::vector<dg::bc>& bcs, std::vector<int>& np, int ppn = 1, const std::vector<unsigned>& M = std::vector<unsigned>())
+{
+    unsigned ndims = N.size();
+    assert( bcs.size() == ndims && np.size() == ndims);
+    assert( M.empty() || M.size() == ndims);
+    std::vector<bool> periodic( ndims);
+    for( unsigned d=0; d<ndims; d++)
+        periodic[d] = (bcs[d] == dg::PER);
+    std::vector<int> current( ndims, 1);
+    std::vector<std::vector<int> > candidates;
+    dg::detail::mpi_dims_enumerate( size, 0, current, np, candidates);
+    double min_cost = 0;
+    int best = -1;
+    for( unsigned i=0; i<candidates.size(); i++)
+    {
+        bool divisible = true;
+        for( unsigned d=0; d<ndims; d++)
+            if( N[d] % candidates[i][d] != 0 || (!M.empty() && M[d] % candidates[i][d] != 0)) divisible = false;
+        if( !divisible) continue;
+        double cost = mpi_halo_cost( candidates[i], N, periodic, ppn);
+        if( best == -1 || cost < min_cost)
+        {
+            best = i;
+            min_cost = cost;
+        }
+    }
+    if( best == -1)
+    {
+        MPI_Dims_create( size, ndims, &np[0]);
+        return false;
+    }
+    np = candidates[best];
+    return true;
+}
+
+/**
+ * @brief Create a Cartesian communicator with a process grid chosen by mpi_dims_create
+ *
+ * Collective call; rank 0 prints the chosen process grid
+ * @param N number of cells in each dimension
+ * @param bcs boundary conditions in each dimension (dg::PER means periodic)
+ * @param np zero entries are chosen automatically, non-zero entries are kept
+ * @param comm contains the Cartesian communicator on output
+ * @param verbose print the process grid on rank 0
+ * @param M further numbers of cells (e.g. of an output grid) that the process grid must divide (empty: none)
+ * @return false if the process grid does not divide N (and M), a warning is printed
+ */
+inline bool mpi_cart_create( const std::vector<unsigned>& N, const std::vector<dg::bc>& bcs, std::vector<int> np, MPI_Comm& comm, bool verbose = true, const std::vector<unsigned>& M = std::vector<unsigned>())
+{
+    int rank, size;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank);
+    MPI_Comm_size( MPI_COMM_WORLD, &size);
+    int ppn = mpi_ranks_per_node( MPI_COMM_WORLD);
+    bool divisible = mpi_dims_create( size, N, bcs, np, ppn, M);
+    std::vector<int> periods( N.size(), false);
+    for( unsigned d=0; d<N.size(); d++)
+        if( bcs[d] == dg::PER) periods[d] = true;
+    if( rank == 0 && verbose)
+    {
+        std::cout << "Computing with "<<np[0];
+        for( unsigned d=1; d<np.size(); d++)
+            std::cout << " x "<<np[d];
+        std::cout << " = "<<size<<" processes ("<<ppn<<" per node)! "<<std::endl;
+        if( !divisible)
+            std::cerr << "WARNING: No process grid divides the number of cells!\n";
+    }
+    MPI_Cart_create( MPI_COMM_WORLD, N.size(), &np[0], &periods[0], true, &comm);
+    return divisible;
+}
 
 void mpi_init2d( dg::bc bcx, dg::bc bcy, unsigned& n, unsigned& Nx, unsigned& Ny, MPI_Comm& comm  )
 {
@@ -13,22 +210,32 @@ void mpi_init2d( dg::bc bcx, dg::bc bcy, unsigned& n, unsigned& Nx, unsigned& Ny
     int np[2];
     if( rank == 0)
     {
-        std::cout << "Type npx and npy\n";
+        std::cout << "Type npx and npy (0 0 chooses automatically)\n";
         std::cin >> np[0] >> np[1];
-        std::cout<< "Computing with "<<np[0] <<" x "<<np[1]<<" = "<<size<<" processes! "<<std::endl;
-        assert( size == np[0]*np[1]);
+        if( np[0] != 0 && np[1] != 0)
+        {
+            std::cout<< "Computing with "<<np[0] <<" x "<<np[1]<<" = "<<size<<" processes! "<<std::endl;
+            assert( size == np[0]*np[1]);
+        }
     }
     MPI_Bcast( np, 2, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Cart_create( MPI_COMM_WORLD, 2, np, periods, true, &comm);
     if( rank == 0)
     {
         std::cout << "Type n, Nx and Ny\n";
         std::cin >> n >> Nx >> Ny;
         std::cout<< "On the grid "<<n <<" x "<<Nx<<" x "<<Ny<<std::endl;
     }
-    MPI_Bcast(  &n,1 , MPI_UNSIGNED, 0, comm);
-    MPI_Bcast( &Nx,1 , MPI_UNSIGNED, 0, comm);
-    MPI_Bcast( &Ny,1 , MPI_UNSIGNED, 0, comm);
+    MPI_Bcast(  &n,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    MPI_Bcast( &Nx,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    MPI_Bcast( &Ny,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    if( np[0] == 0 || np[1] == 0)
+    {
+        std::vector<unsigned> N(2); N[0] = Nx, N[1] = Ny;
+        std::vector<dg::bc> bcs(2); bcs[0] = bcx, bcs[1] = bcy;
+        mpi_cart_create( N, bcs, std::vector<int>( np, np+2), comm);
+    }
+    else
+        MPI_Cart_create( MPI_COMM_WORLD, 2, np, periods, true, &comm);
 #if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
     int num_devices=0;
     cudaGetDeviceCount(&num_devices);
@@ -56,13 +263,15 @@ void mpi_init3d( dg::bc bcx, dg::bc bcy, dg::bc bcz, unsigned& n, unsigned& Nx,
     int np[3];
     if( rank == 0)
     {
-        std::cout << "Type npx and npy and npz\n";
+        std::cout << "Type npx and npy and npz (0 0 0 chooses automatically)\n";
         std::cin >> np[0] >> np[1]>>np[2];
-        std::cout<< "Computing with "<<np[0] <<" x "<<np[1]<<" x "<<np[2]<<" = "<<size<<" processses! "<<std::endl;
-        assert( size == np[0]*np[1]*np[2]);
+        if( np[0] != 0 && np[1] != 0 && np[2] != 0)
+        {
+            std::cout<< "Computing with "<<np[0] <<" x "<<np[1]<<" x "<<np[2]<<" = "<<size<<" processses! "<<std::endl;
+            assert( size == np[0]*np[1]*np[2]);
+        }
     }
     MPI_Bcast( np, 3, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Cart_create( MPI_COMM_WORLD, 3, np, periods, true, &comm);
     if( rank == 0)
     {
         std::cout << "Type n, Nx and Ny and Nz\n";
@@ -73,6 +282,14 @@ void mpi_init3d( dg::bc bcx, dg::bc bcy, dg::bc bcz, unsigned& n, unsigned& Nx,
     MPI_Bcast( &Nx,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     MPI_Bcast( &Ny,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
     MPI_Bcast( &Nz,1 , MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    if( np[0] == 0 || np[1] == 0 || np[2] == 0)
+    {
+        std::vector<unsigned> N(3); N[0] = Nx, N[1] = Ny, N[2] = Nz;
+        std::vector<dg::bc> bcs(3); bcs[0] = bcx, bcs[1] = bcy, bcs[2] = bcz;
+        mpi_cart_create( N, bcs, std::vector<int>( np, np+3), comm);
+    }
+    else
+        MPI_Cart_create( MPI_COMM_WORLD, 3, np, periods, true, &comm);
 #if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
     int num_devices=0;
     cudaGetDeviceCount(&num_devices);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "mpi_vector.h"
+#include "sparseblockmat.h"
 
 //the corresponding blas file for the Local matrix must be included before this file
 namespace dg
@@ -130,6 +131,32 @@ struct RowColDistMat
         //t.toc();
         //if(rank==0)std::cout << "Outer points took "<<t.diff()<<"s\n";
     }
+    /**
+    * @brief Matrix Vector product with scalars
+    *
+    * Computes \f$ y = \alpha Mx + \beta y\f$: the inner matrix is applied with alpha and beta,
+    * then the outer elements are added with alpha
+    * @tparam container container class of the vector elements
+    * @param alpha multiplies the result
+    * @param x input
+    * @param beta premultiplies output
+    * @param y output
+    */
+    template<class container> 
+    void symv( typename VectorTraits<container>::value_type alpha, const MPI_Vector<container>& x, typename VectorTraits<container>::value_type beta, MPI_Vector<container>& y) const
+    {
+        assert( x.communicator() == y.communicator());
+        assert( x.communicator() == c_.communicator());
+        dg::blas2::detail::doSymv( alpha, m_i, x.data(), beta, y.data(), 
+                       typename dg::MatrixTraits<LocalMatrixInner>::matrix_category(), 
+                       typename dg::VectorTraits<container>::vector_category() );
+        if( c_.size() == 0) //no communication needed
+            return;
+        const container& temp = c_.collect( x.data());
+        dg::blas2::detail::doSymv( alpha, m_o, temp, 1., y.data(), 
+                       typename dg::MatrixTraits<LocalMatrixOuter>::matrix_category(), 
+                       typename dg::VectorTraits<container>::vector_category() );
+    }
 
         
     private:
@@ -138,6 +165,100 @@ struct RowColDistMat
     Collective c_;
 };
 
+/**
+* @brief Distributed memory matrix class with ghost columns
+*
+* Instead of splitting the matrix into an inner and an outer part (cf. RowColDistMat) the elements that 
+* require communication are stored as additional columns of one local matrix that refer to a packed
+* ghost (halo) vector. After the halo has arrived the product is computed by a single parallel kernel over all rows.
+* @tparam LocalMatrix The class of the local matrix, e.g. EllSparseBlockMat(Device), must provide 
+ symv( alpha, x, ghost, beta, y) where ghost is the return value of the collect function of the Collective
+* @tparam Collective models aCommunicator The Communication class needs to gather values across processes. 
+container collect( const container& input);
+Gather the halo. If size()==0 the collect() function won't be called and the ghost vector is empty.
+* @sa fuse_ghost_columns
+*/
+template<class LocalMatrix, class Collective >
+struct GhostDistMat
+{
+    GhostDistMat(){}
+    /**
+    * @brief Constructor 
+    *
+    * @param m The local matrix with ghost columns
+    * @param c The communication object
+    */
+    GhostDistMat( const LocalMatrix& m, const Collective& c):m_(m), c_(c) { }
+    /**
+    * @brief Copy constructor 
+    *
+    * The idea is that a device matrix can be constructed by copying a host matrix.
+    * @param src another Matrix
+    */
+    template< class OtherMatrix, class OtherCollective>
+    GhostDistMat( const GhostDistMat<OtherMatrix, OtherCollective>& src):m_(src.matrix()), c_(src.collective()) { }
+    /**
+    * @brief Fuse a split matrix 
+    *
+    * The outer matrix is folded into ghost columns of the inner matrix with fuse_ghost_columns
+    * @param src a matrix as created by e.g. dg::create::dx( MPIGrid)
+    */
+    template< class T, class OtherCollective>
+    GhostDistMat( const RowColDistMat<EllSparseBlockMat<T>, CooSparseBlockMat<T>, OtherCollective>& src):
+        m_( fuse_ghost_columns( src.inner_matrix(), src.outer_matrix())), c_(src.collective()) { }
+    /**
+    * @brief Read access to the local matrix
+    *
+    * @return 
+    */
+    const LocalMatrix& matrix() const{return m_;}
+    /**
+    * @brief Read access to the communication object
+    *
+    * @return 
+    */
+    const Collective& collective() const{return c_;}
+    /**
+    * @brief Matrix Vector product
+    *
+    * First the halo is collected, then all rows are computed in one sweep 
+    * @tparam container container class of the vector elements
+    * @param x input
+    * @param y output
+    */
+    template<class container> 
+    void symv( const MPI_Vector<container>& x, MPI_Vector<container>& y) const
+    {
+        symv( 1., x, 0., y);
+    }
+    /**
+    * @brief Matrix Vector product with scalars
+    *
+    * Computes \f$ y = \alpha Mx + \beta y\f$ 
+    * @tparam container container class of the vector elements
+    * @param alpha multiplies the result
+    * @param x input
+    * @param beta premultiplies output
+    * @param y output
+    */
+    template<class container> 
+    void symv( typename VectorTraits<container>::value_type alpha, const MPI_Vector<container>& x, typename VectorTraits<container>::value_type beta, MPI_Vector<container>& y) const
+    {
+        assert( x.communicator() == y.communicator());
+        assert( x.communicator() == c_.communicator());
+        if( c_.size() == 0) //no communication needed
+        {
+            m_.symv( alpha, x.data(), container(), beta, y.data());
+            return;
+        }
+        const container& ghost = c_.collect( x.data());
+        m_.symv( alpha, x.data(), ghost, beta, y.data());
+    }
+    private:
+    LocalMatrix m_;
+    Collective c_;
+};
+
 /**
 * @brief Distributed memory matrix class
 *
@@ -321,6 +442,18 @@ struct MatrixTraits<const RowColDistMat<LI,LO, C> >
     typedef MPIMatrixTag matrix_category; //!< 
 };
 
+template<class L, class C>
+struct MatrixTraits<GhostDistMat<L, C> >
+{
+    typedef typename MatrixTraits<L>::value_type value_type;//!< value type
+    typedef MPIMatrixTag matrix_category; //!< 
+};
+template<class L, class C>
+struct MatrixTraits<const GhostDistMat<L, C> >
+{
+    typedef typename MatrixTraits<L>::value_type value_type;//!< value type
+    typedef MPIMatrixTag matrix_category; //!< 
+};
 template<class L, class C>
 struct MatrixTraits<RowDistMat<L, C> >
 {
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <thrust/device_vector.h>
+#include <thrust/device_malloc_allocator.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif //__linux__
+
+/*!@file
+ *
+ * NUMA-aware first-touch allocation for device vectors on the OpenMP backend
+ */
+namespace dg
+{
+
+///@cond
+namespace detail
+{
+inline bool& huge_pages_enabled()
+{
+    static bool huge = false;
+    return huge;
+}
+}//namespace detail
+///@endcond
+
+///@addtogroup utilities
+///@{
+
+/**
+ * @brief Back all following NumaAllocator allocations by transparent huge pages
+ *
+ * Allocations are aligned to 2MB and advised with madvise( MADV_HUGEPAGE) (Linux only, otherwise ignored).
+ * @param on true switches huge pages on, false off (the default)
+ */
+inline void set_huge_pages( bool on){ detail::huge_pages_enabled() = on;}
+
+/**
+ * @brief Allocator that places pages on the NUMA node of the thread that computes on them
+ *
+ * Linux places a page on the node of the thread that first writes to it. NumaAllocator
+ * writes every new allocation in an OpenMP parallel loop with static schedule,
+ * i.e. with the same partitioning as the blas1 and sparse matrix kernels of the OpenMP backend,
+ * before any other thread (e.g. a serial copy from a host vector) can touch it.
+ * Pin threads (e.g. OMP_PROC_BIND=close, OMP_PLACES=cores) to make the placement stick,
+ * report_thread_placement shows where threads run.
+ * @code
+ thrust::device_vector<double, dg::NumaAllocator<double> > v = dg::evaluate( f, g);
+ * @endcode
+ * If the macro DG_NUMA is defined (and THRUST_DEVICE_SYSTEM is not CUDA) dg::DVec uses this allocator.
+ * @tparam T value type
+ */
+template<class T>
+struct NumaAllocator : public thrust::device_malloc_allocator<T>
+{
+    typedef thrust::device_malloc_allocator<T> super_t;
+    typedef typename super_t::pointer pointer; //!< device pointer
+    typedef typename super_t::size_type size_type; //!< size type
+    ///@brief rebind to other value type
+    template<class U>
+    struct rebind { typedef NumaAllocator<U> other; };
+    NumaAllocator(){}
+    ///@brief no state to copy
+    NumaAllocator( const NumaAllocator& src): super_t( src){}
+    ///@brief no state to copy
+    template<class U>
+    NumaAllocator( const NumaAllocator<U>& src){}
+    /**
+     * @brief Allocate and first-touch memory
+     *
+     * @param n number of elements
+     * @return pointer to uninitialized memory
+     * @note throws std::bad_alloc if allocation fails
+     */
+    pointer allocate( size_type n)
+    {
+        if( n == 0) return pointer( (T*)0);
+        const size_t bytes = n*sizeof(T);
+        size_t alignment = 4096;
+#ifdef MADV_HUGEPAGE
+        if( detail::huge_pages_enabled()) alignment = 2*1024*1024;
+#endif //MADV_HUGEPAGE
+        void* ptr = 0;
+        if( posix_memalign( &ptr, alignment, bytes) != 0)
+            throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        if( detail::huge_pages_enabled())
+            madvise( ptr, bytes, MADV_HUGEPAGE); //only an advice, failure is not an error
+#endif //MADV_HUGEPAGE
+        char* bytes_ptr = static_cast<char*>( ptr);
+#ifdef _OPENMP
+#pragma omp parallel for schedule( static)
+#endif //_OPENMP
+        for( long i=0; i<(long)n; i++)
+            std::memset( bytes_ptr + i*sizeof(T), 0, sizeof(T));
+        return pointer( static_cast<T*>( ptr));
+    }
+    /**
+     * @brief Free memory
+     *
+     * @param p pointer returned by allocate
+     * @param n number of elements
+     */
+    void deallocate( pointer p, size_type n)
+    {
+        free( thrust::raw_pointer_cast( p));
+    }
+};
+///@cond
+template<class T, class U>
+bool operator==( const NumaAllocator<T>&, const NumaAllocator<U>&){ return true;}
+template<class T, class U>
+bool operator!=( const NumaAllocator<T>&, const NumaAllocator<U>&){ return false;}
+///@endcond
+
+/**
+ * @brief Print the cpu and NUMA node every OpenMP thread runs on
+ *
+ * Call at startup (on every MPI process) to check thread pinning, e.g.
+ * @code
+ thread  0 of 4 on cpu  0 (NUMA node 0)
+ thread  1 of 4 on cpu  1 (NUMA node 0)
+ ...
+ * @endcode
+ * @param os output stream
+ */
+inline void report_thread_placement( std::ostream& os = std::cout)
+{
+    const char* bind = getenv( "OMP_PROC_BIND");
+    const char* places = getenv( "OMP_PLACES");
+    os << "OMP_PROC_BIND = "<<(bind ? bind : "(unset)")<<", OMP_PLACES = "<<(places ? places : "(unset)");
+    os << ", huge pages "<<(detail::huge_pages_enabled() ? "on" : "off")<<"\n";
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif //_OPENMP
+    std::vector<int> cpus( threads, -1), nodes( threads, -1);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+    {
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif //_OPENMP
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu, node;
+        if( syscall( SYS_getcpu, &cpu, &node, NULL) == 0)
+            cpus[t] = cpu, nodes[t] = node;
+#endif //__linux__
+    }
+    for( int t=0; t<threads; t++)
+    {
+        os << "thread "<<t<<" of "<<threads<<" on cpu ";
+        if( cpus[t] < 0) os << "(unknown)\n";
+        else os << cpus[t] << " (NUMA node "<<nodes[t]<<")\n";
+    }
+}
+///@}
+
+}//namespace dg
@@ -0,0 +1,29 @@
+#include <iostream>
+#include "blas.h"
+#include "evaluation.cuh"
+#include "weights.cuh"
+#include "numa_allocator.h"
+
+double function( double x, double y, double z) { return sin(x)*sin(y)*sin(z);}
+
+typedef thrust::device_vector<double, dg::NumaAllocator<double> > NumaVec;
+
+int main()
+{
+    dg::report_thread_placement( std::cout);
+    unsigned n, Nx, Ny, Nz;
+    std::cout << "Type in n, Nx and Ny and Nz!\n";
+    std::cin >> n >> Nx >> Ny >> Nz;
+    dg::Grid3d g3d( 0, M_PI, 0, M_PI, 0, M_PI, n, Nx, Ny, Nz);
+    const dg::DVec w3d = dg::create::weights( g3d);
+    const dg::DVec f = dg::evaluate( function, g3d);
+    NumaVec numa = dg::evaluate( function, g3d), evaluated;
+    dg::evaluate( function, g3d, evaluated);
+    dg::blas1::axpby( 1., numa, -1., evaluated);
+    std::cout << "Difference of evaluations "<<dg::blas1::dot( evaluated, evaluated)<<" (Must be 0)\n";
+    dg::set_huge_pages( true);
+    NumaVec huge( numa);
+    std::cout << "Norm                      "<<dg::blas2::dot( f, w3d, f)<<"\n";
+    std::cout << "Norm with NUMA allocator  "<<dg::blas2::dot( huge, w3d, numa)<<" (Must be the same)\n";
+    return 0;
+}
@@ -1,14 +1,16 @@
 #pragma once
 #include <vector>
 #include <cusp/coo_matrix.h>
+#include <thrust/host_vector.h>
 #include "grid.h"
 #include "interpolation.cuh"
 #include "matrix_traits_thrust.h"
+#include "../blas1.h"
 #include "../blas2.h"
 
 /*!@file 
   
-  contains the Difference Norm class that computes differences between vectors on different grids
+  contains the OverlapNorm and DifferenceNorm classes that compute differences between vectors on different grids
  */
 namespace dg{
 ///@addtogroup utilities
@@ -90,11 +92,317 @@ cusp::coo_matrix< int, double, cusp::host_memory> projection( const Grid2d& g1,
 }//namespace create
 
 
-//eventuell könnte man zwei Projektionsmatrizen malnehmen um eine kleinere zu erhalten
+///@cond
+namespace detail
+{
+//cell i of one 1d grid overlaps cell j of another on [a,b] with
+//m[k*n2+l] = \int_a^b l^1_{ik}(x) l^2_{jl}(x) dx (integrals of the Lagrange polynomials of the two cells)
+//and the Gauss quadrature of the overlap: weights w[q] and polynomial values b1[q*n1+k] = l^1_{ik}(x_q), b2[q*n2+l] = l^2_{jl}(x_q)
+struct CellOverlap
+{
+    unsigned i, j;
+    std::vector<double> m, w, b1, b2;
+};
+
+//all cell overlaps of two 1d grids on the same interval, sorted by position
+inline std::vector<CellOverlap> cell_overlaps( const Grid1d& g1, const Grid1d& g2)
+{
+    assert( fabs( g1.x0() - g2.x0()) < 1e-12*g1.lx() && fabs( g1.x1() - g2.x1()) < 1e-12*g1.lx());
+    const unsigned n1 = g1.n(), n2 = g2.n();
+    //the product of two Lagrange polynomials has degree n1+n2-2
+    const DLT<double> quad( std::max( n1, n2));
+    create::detail::LegendreTable table1( g1.dlt(), n1), table2( g2.dlt(), n2);
+    std::vector<double> px( std::max( n1, n2)), pxF1( n1), pxF2( n2);
+    const double tol = 1e-12*g1.lx();
+    std::vector<CellOverlap> overlaps;
+    unsigned i = 0, j = 0;
+    while( i < g1.N() && j < g2.N())
+    {
+        const double left1 = g1.x0() + i*g1.h(), left2 = g2.x0() + j*g2.h();
+        const double right1 = ( i+1 == g1.N()) ? g1.x1() : left1 + g1.h();
+        const double right2 = ( j+1 == g2.N()) ? g2.x1() : left2 + g2.h();
+        const double a = std::max( left1, left2), b = std::min( right1, right2);
+        if( b - a > tol)
+        {
+            CellOverlap o;
+            const unsigned Q = quad.abscissas().size();
+            o.i = i, o.j = j, o.m.assign( n1*n2, 0.);
+            o.w.resize( Q), o.b1.resize( Q*n1), o.b2.resize( Q*n2);
+            for( unsigned q=0; q<Q; q++)
+            {
+                const double x = (a+b)/2. + (b-a)/2.*quad.abscissas()[q];
+                const double w = (b-a)/2.*quad.weights()[q];
+                const double xn1 = std::min( 1., std::max( -1., 2.*(x-left1)/g1.h() - 1.));
+                const double xn2 = std::min( 1., std::max( -1., 2.*(x-left2)/g2.h() - 1.));
+                table1.coefficients( xn1, &px[0], &pxF1[0]);
+                table2.coefficients( xn2, &px[0], &pxF2[0]);
+                o.w[q] = w;
+                std::copy( pxF1.begin(), pxF1.end(), o.b1.begin() + q*n1);
+                std::copy( pxF2.begin(), pxF2.end(), o.b2.begin() + q*n2);
+                for( unsigned k=0; k<n1; k++)
+                    for( unsigned l=0; l<n2; l++)
+                        o.m[k*n2+l] += w*pxF1[k]*pxF2[l];
+            }
+            overlaps.push_back( o);
+        }
+        if( right1 < right2 - tol) i++;
+        else if( right2 < right1 - tol) j++;
+        else i++, j++;
+    }
+    return overlaps;
+}
+}//namespace detail
+///@endcond
+
+/**
+ * @brief Compare dG vectors on different grids cell overlap by cell overlap
+ *
+ * The integral \f$ \int v_1 v_2 dV\f$ is the sum over all pairs of overlapping cells
+ * of the integrals of the products of the polynomials of both cells.
+ * In every direction these are tensor products of 1d overlap integrals
+ * that are precomputed once (there are less than Nx1+Nx2 overlaps per direction),
+ * so no common grid is constructed and the vectors are read in place.
+ * Differences and sums are integrated directly, i.e. \f$ (v_1\mp v_2)^2\f$ is accumulated
+ * at the Gauss points of every overlap, such that the relative error of small
+ * differences is of the order of machine precision.
+ * The result is exact for arbitrary numbers of cells and polynomial coefficients.
+ * @code
+ dg::OverlapNorm norm( g_coarse, g_fine);
+ double error = norm( v_coarse, v_fine)/norm( v_fine);
+ * @endcode
+ * @note The vectors must reside on the host
+ */
+struct OverlapNorm
+{
+    /**
+     * @brief Construct from two different grids on the same domain
+     *
+     * @param g1 grid of the first vectors
+     * @param g2 grid of the second vectors
+     */
+    OverlapNorm( const Grid2d& g1, const Grid2d& g2):
+        n1_( g1.n()), n2_( g2.n()), Nx1_( g1.Nx()), Nx2_( g2.Nx()), Ny1_( g1.Ny()), Ny2_( g2.Ny()),
+        w1_( weights( g1.dlt(), g1.hx(), g1.hy(), 1.)), w2_( weights( g2.dlt(), g2.hx(), g2.hy(), 1.))
+    {
+        x_ = detail::cell_overlaps( Grid1d( g1.x0(), g1.x1(), g1.n(), g1.Nx()), Grid1d( g2.x0(), g2.x1(), g2.n(), g2.Nx()));
+        y_ = detail::cell_overlaps( Grid1d( g1.y0(), g1.y1(), g1.n(), g1.Ny()), Grid1d( g2.y0(), g2.y1(), g2.n(), g2.Ny()));
+        z_.resize( 1);
+        z_[0].i = z_[0].j = 0, z_[0].m.assign( 1, 1.);
+        z_[0].w = z_[0].b1 = z_[0].b2 = z_[0].m;
+    }
+    /**
+     * @brief Construct from two different grids on the same domain
+     *
+     * The values of a plane are constant in z within its cell
+     * @param g1 grid of the first vectors
+     * @param g2 grid of the second vectors
+     */
+    OverlapNorm( const Grid3d& g1, const Grid3d& g2):
+        n1_( g1.n()), n2_( g2.n()), Nx1_( g1.Nx()), Nx2_( g2.Nx()), Ny1_( g1.Ny()), Ny2_( g2.Ny()),
+        w1_( weights( g1.dlt(), g1.hx(), g1.hy(), g1.hz())), w2_( weights( g2.dlt(), g2.hx(), g2.hy(), g2.hz()))
+    {
+        x_ = detail::cell_overlaps( Grid1d( g1.x0(), g1.x1(), g1.n(), g1.Nx()), Grid1d( g2.x0(), g2.x1(), g2.n(), g2.Nx()));
+        y_ = detail::cell_overlaps( Grid1d( g1.y0(), g1.y1(), g1.n(), g1.Ny()), Grid1d( g2.y0(), g2.y1(), g2.n(), g2.Ny()));
+        z_ = detail::cell_overlaps( Grid1d( g1.z0(), g1.z1(), 1, g1.Nz()), Grid1d( g2.z0(), g2.z1(), 1, g2.Nz()));
+    }
+    /**
+     * @brief Compute the integral of the product of two vectors
+     *
+     * \f[ \int v_1 v_2 dV \f]
+     * @param v1 vector on the first grid
+     * @param v2 vector on the second grid
+     *
+     * @return scalar product
+     */
+    double product( const thrust::host_vector<double>& v1, const thrust::host_vector<double>& v2) const
+    {
+        return product( &v1[0], &v2[0]);
+    }
+    /**
+     * @brief Compute the norm of a vector on the first grid
+     *
+     * \f[ ||v_1|| = \sqrt{ \int v_1^2 dV} \f]
+     * @param v1 vector on the first grid
+     *
+     * @return norm
+     */
+    double operator()( const thrust::host_vector<double>& v1) const { return sqrt( self( w1_, &v1[0], v1.size(), n1_, Nx1_));}
+    /**
+     * @brief Compute the difference of two vectors
+     *
+     * \f[ ||v_1 - v_2|| = \sqrt{ \int (v_1-v_2)^2 dV} \f]
+     * @param v1 vector on the first grid
+     * @param v2 vector on the second grid
+     *
+     * @return norm of the difference
+     */
+    double operator()( const thrust::host_vector<double>& v1, const thrust::host_vector<double>& v2) const
+    {
+        return sqrt( squares( &v1[0], -1., &v2[0]));
+    }
+    /**
+     * @brief Compute the sum of two vectors
+     *
+     * \f[ ||v_1 + v_2|| = \sqrt{ \int (v_1+v_2)^2 dV} \f]
+     * @param v1 vector on the first grid
+     * @param v2 vector on the second grid
+     *
+     * @return norm of the sum
+     */
+    double sum( const thrust::host_vector<double>& v1, const thrust::host_vector<double>& v2) const
+    {
+        return sqrt( squares( &v1[0], 1., &v2[0]));
+    }
+  private:
+    //weights of one cell (planes of the same grid overlap only with themselves)
+    static std::vector<double> weights( const DLT<double>& dlt, double hx, double hy, double hz)
+    {
+        const unsigned n = dlt.weights().size();
+        std::vector<double> w( n*n);
+        for( unsigned k=0; k<n; k++)
+            for( unsigned l=0; l<n; l++)
+                w[k*n+l] = hz*hy/2.*dlt.weights()[k]*hx/2.*dlt.weights()[l];
+        return w;
+    }
+    //the layout is (z, y cell, y node, x cell, x node), w is periodic in (y node, x node)
+    static double self( const std::vector<double>& w, const double* v, unsigned size, unsigned n, unsigned Nx)
+    {
+        const unsigned row = n*Nx;
+        double sum = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:sum)
+#endif //_OPENMP
+        for( int i=0; i<(int)size; i++)
+            sum += w[((i/row)%n)*n + (i%n)]*v[i]*v[i];
+        return sum;
+    }
+    double product( const double* v1, const double* v2) const
+    {
+        const unsigned n1 = n1_, n2 = n2_;
+        const unsigned row1 = n1*Nx1_, row2 = n2*Nx2_;
+        const unsigned plane1 = n1*Ny1_*row1, plane2 = n2*Ny2_*row2;
+        //every (z,y) overlap is summed by one thread, the partial sums are added in order
+        std::vector<double> partial( z_.size()*y_.size(), 0.);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+        {
+            std::vector<double> t( n1*n2);
+#ifdef _OPENMP
+#pragma omp for schedule( static)
+#endif //_OPENMP
+            for( int p=0; p<(int)partial.size(); p++)
+            {
+                const detail::CellOverlap& oz = z_[p/y_.size()], & oy = y_[p%y_.size()];
+                const double* f = v1 + oz.i*plane1 + oy.i*n1*row1;
+                const double* g = v2 + oz.j*plane2 + oy.j*n2*row2;
+                double sum = 0;
+                for( unsigned o=0; o<x_.size(); o++)
+                {
+                    const detail::CellOverlap& ox = x_[o];
+                    //t[ky][lx] = sum_kx f[ky][kx] Mx[kx][lx]
+                    for( unsigned ky=0; ky<n1; ky++)
+                        for( unsigned lx=0; lx<n2; lx++)
+                        {
+                            double s = 0;
+                            for( unsigned kx=0; kx<n1; kx++)
+                                s += f[ky*row1 + ox.i*n1 + kx]*ox.m[kx*n2+lx];
+                            t[ky*n2+lx] = s;
+                        }
+                    //sum_ky,ly My[ky][ly] sum_lx t[ky][lx] g[ly][lx]
+                    for( unsigned ky=0; ky<n1; ky++)
+                        for( unsigned ly=0; ly<n2; ly++)
+                        {
+                            double s = 0;
+                            for( unsigned lx=0; lx<n2; lx++)
+                                s += t[ky*n2+lx]*g[ly*row2 + ox.j*n2 + lx];
+                            sum += oy.m[ky*n2+ly]*s;
+                        }
+                }
+                partial[p] = oz.m[0]*sum;
+            }
+        }
+        double sum = 0;
+        for( unsigned p=0; p<partial.size(); p++)
+            sum += partial[p];
+        return sum;
+    }
+    //the values of the polynomials of cell (ky,kx) of v at the Gauss points (qy,qx) of an overlap
+    static void values( const double* v, unsigned row, unsigned n, const std::vector<double>& by, const std::vector<double>& bx, std::vector<double>& t, double* result)
+    {
+        const unsigned Qy = by.size()/n, Qx = bx.size()/n;
+        //t[ky][qx] = sum_kx v[ky][kx] bx[qx][kx]
+        for( unsigned ky=0; ky<n; ky++)
+            for( unsigned qx=0; qx<Qx; qx++)
+            {
+                double s = 0;
+                for( unsigned kx=0; kx<n; kx++)
+                    s += v[ky*row + kx]*bx[qx*n+kx];
+                t[ky*Qx+qx] = s;
+            }
+        //result[qy][qx] = sum_ky by[qy][ky] t[ky][qx]
+        for( unsigned qy=0; qy<Qy; qy++)
+            for( unsigned qx=0; qx<Qx; qx++)
+            {
+                double s = 0;
+                for( unsigned ky=0; ky<n; ky++)
+                    s += by[qy*n+ky]*t[ky*Qx+qx];
+                result[qy*Qx+qx] = s;
+            }
+    }
+    //\int (v1 + sign*v2)^2 dV accumulated at the Gauss points of all overlaps
+    double squares( const double* v1, double sign, const double* v2) const
+    {
+        const unsigned n1 = n1_, n2 = n2_;
+        const unsigned row1 = n1*Nx1_, row2 = n2*Nx2_;
+        const unsigned plane1 = n1*Ny1_*row1, plane2 = n2*Ny2_*row2;
+        const unsigned Q = std::max( n1, n2);
+        //every (z,y) overlap is summed by one thread, the partial sums are added in order
+        std::vector<double> partial( z_.size()*y_.size(), 0.);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+        {
+            std::vector<double> t( Q*Q), f( Q*Q), g( Q*Q);
+#ifdef _OPENMP
+#pragma omp for schedule( static)
+#endif //_OPENMP
+            for( int p=0; p<(int)partial.size(); p++)
+            {
+                const detail::CellOverlap& oz = z_[p/y_.size()], & oy = y_[p%y_.size()];
+                const double* f0 = v1 + oz.i*plane1 + oy.i*n1*row1;
+                const double* g0 = v2 + oz.j*plane2 + oy.j*n2*row2;
+                double sum = 0;
+                for( unsigned o=0; o<x_.size(); o++)
+                {
+                    const detail::CellOverlap& ox = x_[o];
+                    values( f0 + ox.i*n1, row1, n1, oy.b1, ox.b1, t, &f[0]);
+                    values( g0 + ox.j*n2, row2, n2, oy.b2, ox.b2, t, &g[0]);
+                    for( unsigned qy=0; qy<Q; qy++)
+                        for( unsigned qx=0; qx<Q; qx++)
+                        {
+                            const double d = f[qy*Q+qx] + sign*g[qy*Q+qx];
+                            sum += oy.w[qy]*ox.w[qx]*d*d;
+                        }
+                }
+                partial[p] = oz.w[0]*sum;
+            }
+        }
+        double sum = 0;
+        for( unsigned p=0; p<partial.size(); p++)
+            sum += partial[p];
+        return sum;
+    }
+    unsigned n1_, n2_, Nx1_, Nx2_, Ny1_, Ny2_;
+    std::vector<double> w1_, w2_;
+    std::vector<detail::CellOverlap> x_, y_, z_;
+};
+
 /**
  * @brief Class to perform comparison of dG vectors on different grids
  *
- * it basically interpolates values from the rougher grid to values on the finer grid and then uses the existing methods to compute the norm
+ * Vectors are compared cell overlap by cell overlap with an OverlapNorm
+ * (no common grid is constructed), device vectors are copied to the host first
  * @tparam container
  */
 template <typename container>
@@ -106,19 +414,14 @@ struct DifferenceNorm
      * @param g1 first grid
      * @param g2 second grid
      */
-    DifferenceNorm( const Grid2d& g1, const Grid2d& g2)
-    {
-        //find common grid
-        Grid2d gC(    g1.x0(), g1.x1(), g1.y0(), g1.y1(), 
-                            std::min( g1.n(), g2.n()), 
-                            lcm( g1.Nx(), g2.Nx()), 
-                            lcm( g1.Ny(), g2.Ny()) );
-        p1 = dg::create::interpolation( gC, g1);
-        p2 = dg::create::interpolation( gC, g2);
-        w2d = dg::create::weights( gC); v11 = w2d, v22 = w2d;
-        wg1 = dg::create::weights( g1); 
-        wg2 = dg::create::weights( g2); 
-    }
+    DifferenceNorm( const Grid2d& g1, const Grid2d& g2): norm_( g1, g2) { }
+    /**
+     * @brief Construct from two different grids
+     *
+     * @param g1 first grid
+     * @param g2 second grid
+     */
+    DifferenceNorm( const Grid3d& g1, const Grid3d& g2): norm_( g1, g2) { }
     /**
      * @brief Compute difference of two vectors
      *
@@ -130,14 +433,7 @@ struct DifferenceNorm
      */
     double operator()( const container& v1, const container& v2)
     {
-        double f2, g2, fg;
-        f2 = blas2::dot( wg1, v1);
-        g2 = blas2::dot( wg2, v2);
-
-        blas2::gemv( p1, v1, v11);
-        blas2::gemv( p2, v2, v22);
-        fg = blas2::dot( v11, w2d, v22);
-        return sqrt( f2 - 2.*fg + g2);
+        return norm_( host( v1, h1_), host( v2, h2_));
     }
 
     /**
@@ -151,23 +447,18 @@ struct DifferenceNorm
      */
     double sum( const container& v1, const container& v2)
     {
-        double f2, g2, fg;
-        f2 = blas2::dot( wg1, v1);
-        g2 = blas2::dot( wg2, v2);
-
-        blas2::gemv( p1, v1, v11);
-        blas2::gemv( p2, v2, v22);
-        fg = blas2::dot( v11, w2d, v22);
-        return sqrt( f2 + 2.*fg + g2);
+        return norm_.sum( host( v1, h1_), host( v2, h2_));
     }
   private:
-    typedef typename container::value_type value_type;
-    typedef typename thrust::iterator_system<typename container::iterator>::type MemorySpace;
-    typedef cusp::csr_matrix<int, double, MemorySpace> Matrix;
-
-    container wg1, wg2, w2d;
-    container v11, v22;
-    Matrix p1, p2;
+    static const thrust::host_vector<double>& host( const thrust::host_vector<double>& v, thrust::host_vector<double>& buffer){ return v;}
+    template<class Vector>
+    static const thrust::host_vector<double>& host( const Vector& v, thrust::host_vector<double>& buffer)
+    {
+        dg::blas1::transfer( v, buffer);
+        return buffer;
+    }
+    OverlapNorm norm_;
+    thrust::host_vector<double> h1_, h2_;
 };
 ///@}
 
@@ -7,6 +7,7 @@
 
 double sine( double x){ return sin(x);}
 double sine( double x, double y){return sin(x)*sin(y);}
+double quadratic( double x, double y){return 1.+x+2.*y*y;}
 
 int main()
 {
@@ -66,6 +67,22 @@ int main()
     dg::blas1::axpby( 1., sinN, -1., sinP);
     std::cout << dg::blas2::dot( sinP, w2dn, sinP)<<" (smaller than above)\n";
 
+    std::cout << "TEST OVERLAP NORM ON COPRIME GRIDS\n";
+    dg::Grid2d g2a( 0, M_PI, 0, M_PI, 3, 7, 5), g2b( 0, M_PI, 0, M_PI, 4, 11, 13);
+    const dg::HVec quadA = dg::evaluate( quadratic, g2a), quadB = dg::evaluate( quadratic, g2b);
+    dg::OverlapNorm overlap( g2a, g2b);
+    const double rel = overlap( quadA, quadB)/overlap( quadA);
+    std::cout << "Difference of exactly represented functions "<<rel<<" "<<( rel < 1e-14 ? "PASSED" : "FAILED")<<"\n";
+    const double relsum = overlap.sum( quadA, quadB)/overlap( quadA) - 2.;
+    std::cout << "Sum of exactly represented functions        "<<relsum<<" "<<( fabs( relsum) < 1e-14 ? "PASSED" : "FAILED")<<"\n";
+    std::cout << "Difference of sines\n";
+    for( unsigned i=1; i<5; i++)
+    {
+        dg::Grid2d g1( 0, M_PI, 0, M_PI, 3, 5*i, 5*i), g2( 0, M_PI, 0, M_PI, 3, 7*i, 7*i);
+        dg::OverlapNorm norm( g1, g2);
+        std::cout << 5*i<<" vs "<<7*i<<" cells: "<<norm( dg::evaluate( sine, g1), dg::evaluate( sine, g2))<<" (converges with order 3)\n";
+    }
+
 
     return 0;
 }
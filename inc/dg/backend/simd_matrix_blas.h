@@ -0,0 +1,101 @@
+#ifndef _DG_BLAS_SIMD_PRECONDITIONER_
+#define _DG_BLAS_SIMD_PRECONDITIONER_
+
+#ifdef DG_DEBUG
+#include <cassert>
+#endif //DG_DEBUG
+
+#include "simd_vector_blas.h" //load SIMD BLAS1 routines
+#include "thrust_matrix_blas.cuh"
+#include "vector_categories.h"
+#include "matrix_categories.h"
+
+/*!@file
+ *
+ * diagonal matrices (weights) applied to aligned host vectors
+ */
+
+namespace dg{
+namespace blas2{
+    ///@cond
+namespace detail{
+
+template< class Matrix, class Vector>
+inline typename MatrixTraits<Matrix>::value_type doDot( const Vector& x, const Matrix& m, const Vector& y, ThrustMatrixTag, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() && x.size() == m.size() );
+#endif //DG_DEBUG
+    typedef typename MatrixTraits<Matrix>::value_type value_type;
+    return dg::blas1::detail::simd_dot<value_type>( x.size(), 
+            thrust::raw_pointer_cast( x.data()), 
+            thrust::raw_pointer_cast( m.data()), 
+            thrust::raw_pointer_cast( y.data()));
+}
+template< class Matrix, class Vector>
+inline typename MatrixTraits<Matrix>::value_type doDot( const Matrix& m, const Vector& x, dg::ThrustMatrixTag, dg::SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( m.size() == x.size());
+#endif //DG_DEBUG
+    typedef typename MatrixTraits<Matrix>::value_type value_type;
+    return dg::blas1::detail::simd_dot<value_type>( x.size(), 
+            thrust::raw_pointer_cast( x.data()), 
+            thrust::raw_pointer_cast( m.data()), 
+            thrust::raw_pointer_cast( x.data()));
+}
+
+template< class Matrix, class Vector>
+inline void doSymv(  
+              typename MatrixTraits<Matrix>::value_type alpha, 
+              const Matrix& m,
+              const Vector& x, 
+              typename MatrixTraits<Matrix>::value_type beta, 
+              Vector& y, 
+              ThrustMatrixTag,
+              SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() && x.size() == m.size() );
+#endif //DG_DEBUG
+    typedef typename MatrixTraits<Matrix>::value_type value_type;
+    if( alpha == 0)
+    {
+        if( beta == 1) 
+            return;
+        dg::blas1::detail::doScal( y, beta, dg::SimdVectorTag());
+        return;
+    }
+    dg::blas1::detail::simd_for_each( y.size(), 
+            dg::blas1::detail::SimdPointwiseDot<value_type>( alpha, 
+                thrust::raw_pointer_cast( m.data()), 
+                thrust::raw_pointer_cast( x.data()), 
+                beta, 
+                thrust::raw_pointer_cast( y.data())));
+}
+
+template< class Matrix, class Vector>
+inline void doSymv(  
+              Matrix& m, 
+              const Vector& x,
+              Vector& y, 
+              ThrustMatrixTag,
+              SimdVectorTag,
+              SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() && x.size() == m.size() );
+#endif //DG_DEBUG
+    typedef typename MatrixTraits<Matrix>::value_type value_type;
+    dg::blas1::detail::simd_for_each( y.size(), 
+            dg::blas1::detail::SimdProduct<value_type>( 
+                thrust::raw_pointer_cast( m.data()), 
+                thrust::raw_pointer_cast( x.data()), 
+                thrust::raw_pointer_cast( y.data())));
+}
+
+}//namespace detail
+    ///@endcond
+} //namespace blas2
+} //namespace dg
+#endif //_DG_BLAS_SIMD_PRECONDITIONER_
@@ -0,0 +1,373 @@
+#ifndef _DG_BLAS_SIMD_VECTOR_
+#define _DG_BLAS_SIMD_VECTOR_
+
+#ifdef DG_DEBUG
+#include <cassert>
+#endif //DG_DEBUG
+
+#include <new>
+#include <limits>
+#include <cstdlib>
+#include <vector>
+#include <thrust/host_vector.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif //__AVX512F__ || __AVX2__
+
+#include "vector_categories.h"
+#include "vector_traits.h"
+#include "thrust_vector_blas.cuh"
+
+/*!@file
+ *
+ * 64-byte aligned host vectors and explicitly vectorized blas1 kernels for them
+ *
+ * The instruction set is chosen at compile time: the AVX-512 or AVX2 kernels
+ * are only used if the compiler defines __AVX512F__ or __AVX2__ (e.g. -mavx512f or
+ * -mavx2 -mfma, which the Makefiles add for device=omp simd=avx512|avx2);
+ * otherwise the kernels fall back to plain (auto-vectorized) loops.
+ */
+
+namespace dg
+{
+
+/**
+ * @brief Allocator that aligns all allocations to 64 bytes (one cache line, one AVX-512 register)
+ *
+ * @ingroup utilities
+ * @tparam T value type
+ */
+template<class T>
+struct AlignedAllocator
+{
+    typedef T value_type; //!< value type
+    typedef T* pointer; //!< pointer
+    typedef const T* const_pointer; //!< const pointer
+    typedef T& reference; //!< reference
+    typedef const T& const_reference; //!< const reference
+    typedef std::size_t size_type; //!< size type
+    typedef std::ptrdiff_t difference_type; //!< difference type
+    static const size_type alignment = 64; //!< alignment in bytes
+    ///@brief rebind to other value type
+    template<class U>
+    struct rebind{ typedef AlignedAllocator<U> other;};
+    AlignedAllocator(){}
+    ///@brief no state to copy
+    template<class U>
+    AlignedAllocator( const AlignedAllocator<U>&){}
+    ///@cond
+    pointer address( reference x) const {return &x;}
+    const_pointer address( const_reference x) const {return &x;}
+    pointer allocate( size_type n, const void* hint = 0)
+    {
+        void* ptr = 0;
+        if( n == 0) return 0;
+        if( posix_memalign( &ptr, alignment, n*sizeof(T)) != 0)
+            throw std::bad_alloc();
+        return static_cast<pointer>( ptr);
+    }
+    void deallocate( pointer p, size_type n) { free( p);}
+    size_type max_size() const { return std::numeric_limits<size_type>::max()/sizeof(T);}
+    void construct( pointer p, const T& value) { new( static_cast<void*>(p)) T( value);}
+    void destroy( pointer p) { p->~T();}
+    ///@endcond
+};
+///@cond
+template<class T, class U>
+bool operator==( const AlignedAllocator<T>&, const AlignedAllocator<U>&){ return true;}
+template<class T, class U>
+bool operator!=( const AlignedAllocator<T>&, const AlignedAllocator<U>&){ return false;}
+
+template< class T>
+struct VectorTraits<thrust::host_vector<T, AlignedAllocator<T> > > {
+    typedef T value_type;
+    typedef SimdVectorTag vector_category;
+};
+template< class T>
+struct VectorTraits<const thrust::host_vector<T, AlignedAllocator<T> > > {
+    typedef T value_type;
+    typedef SimdVectorTag vector_category;
+};
+
+namespace blas1
+{
+namespace detail
+{
+
+//apply op(i) to all i < size, in parallel and vectorized (op must not carry dependencies between elements)
+template<class Op>
+inline void simd_for_each( unsigned size, Op op)
+{
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp parallel for simd
+#elif defined(_OPENMP)
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<(int)size; i++)
+        op( i);
+}
+
+template<class T>
+struct SimdAxpby
+{
+    SimdAxpby( T alpha, const T* x, T beta, const T* y, T* z): alpha_(alpha), beta_(beta), x_(x), y_(y), z_(z){}
+    void operator()( int i) const { z_[i] = alpha_*x_[i] + beta_*y_[i];}
+  private:
+    T alpha_, beta_;
+    const T* x_, *y_;
+    T* z_;
+};
+template<class T>
+struct SimdScal
+{
+    SimdScal( T alpha, const T* x, T* z): alpha_(alpha), x_(x), z_(z){}
+    void operator()( int i) const { z_[i] = alpha_*x_[i];}
+  private:
+    T alpha_;
+    const T* x_;
+    T* z_;
+};
+template<class T>
+struct SimdPlus
+{
+    SimdPlus( T alpha, T* x): alpha_(alpha), x_(x){}
+    void operator()( int i) const { x_[i] = alpha_ + x_[i];}
+  private:
+    T alpha_;
+    T* x_;
+};
+template<class T>
+struct SimdPointwiseDot
+{
+    SimdPointwiseDot( T alpha, const T* x1, const T* x2, T beta, T* y): alpha_(alpha), beta_(beta), x1_(x1), x2_(x2), y_(y){}
+    void operator()( int i) const { y_[i] = alpha_*x1_[i]*x2_[i] + beta_*y_[i];}
+  private:
+    T alpha_, beta_;
+    const T* x1_, *x2_;
+    T* y_;
+};
+template<class T>
+struct SimdProduct
+{
+    SimdProduct( const T* x1, const T* x2, T* y): x1_(x1), x2_(x2), y_(y){}
+    void operator()( int i) const { y_[i] = x1_[i]*x2_[i];}
+  private:
+    const T* x1_, *x2_;
+    T* y_;
+};
+template<class T>
+struct SimdDivide
+{
+    SimdDivide( const T* x1, const T* x2, T* y): x1_(x1), x2_(x2), y_(y){}
+    void operator()( int i) const { y_[i] = x1_[i]/x2_[i];}
+  private:
+    const T* x1_, *x2_;
+    T* y_;
+};
+
+//sum_{begin<=i<end} w_i x_i y_i (w = 0 means w_i = 1)
+template<class T>
+T simd_dot_range( const T* x, const T* w, const T* y, int begin, int end)
+{
+    T sum = 0;
+    if( w == 0)
+    {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif //_OPENMP
+        for( int i=begin; i<end; i++)
+            sum += x[i]*y[i];
+    }
+    else
+    {
+#if defined(_OPENMP) && _OPENMP >= 201307
+#pragma omp simd reduction(+:sum)
+#endif //_OPENMP
+        for( int i=begin; i<end; i++)
+            sum += w[i]*x[i]*y[i];
+    }
+    return sum;
+}
+#if defined(__AVX512F__) || defined(__AVX2__)
+//the double version is written with intrinsics: two independent accumulators hide the latency of the fused multiply-add
+template<>
+inline double simd_dot_range<double>( const double* x, const double* w, const double* y, int begin, int end)
+{
+    int i = begin;
+    double sum = 0;
+#if defined(__AVX512F__)
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    for( ; i+16<=end; i+=16)
+    {
+        __m512d x0 = _mm512_loadu_pd( x+i), x1 = _mm512_loadu_pd( x+i+8);
+        if( w != 0)
+            x0 = _mm512_mul_pd( x0, _mm512_loadu_pd( w+i)), x1 = _mm512_mul_pd( x1, _mm512_loadu_pd( w+i+8));
+        s0 = _mm512_fmadd_pd( x0, _mm512_loadu_pd( y+i), s0);
+        s1 = _mm512_fmadd_pd( x1, _mm512_loadu_pd( y+i+8), s1);
+    }
+    double partial[8];
+    _mm512_storeu_pd( partial, _mm512_add_pd( s0, s1));
+    sum = ((partial[0] + partial[1]) + (partial[2] + partial[3])) + ((partial[4] + partial[5]) + (partial[6] + partial[7]));
+#else
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    for( ; i+8<=end; i+=8)
+    {
+        __m256d x0 = _mm256_loadu_pd( x+i), x1 = _mm256_loadu_pd( x+i+4);
+        if( w != 0)
+            x0 = _mm256_mul_pd( x0, _mm256_loadu_pd( w+i)), x1 = _mm256_mul_pd( x1, _mm256_loadu_pd( w+i+4));
+#ifdef __FMA__
+        s0 = _mm256_fmadd_pd( x0, _mm256_loadu_pd( y+i), s0);
+        s1 = _mm256_fmadd_pd( x1, _mm256_loadu_pd( y+i+4), s1);
+#else
+        s0 = _mm256_add_pd( _mm256_mul_pd( x0, _mm256_loadu_pd( y+i)), s0);
+        s1 = _mm256_add_pd( _mm256_mul_pd( x1, _mm256_loadu_pd( y+i+4)), s1);
+#endif //__FMA__
+    }
+    double partial[4];
+    _mm256_storeu_pd( partial, _mm256_add_pd( s0, s1));
+    sum = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+#endif //__AVX512F__
+    for( ; i<end; i++)
+        sum += (w == 0 ? x[i] : w[i]*x[i])*y[i];
+    return sum;
+}
+#endif //__AVX512F__ || __AVX2__
+
+//every thread reduces a contiguous range of whole cache lines, partial sums are added in thread order
+template<class T>
+T simd_dot( unsigned size, const T* x, const T* w, const T* y)
+{
+    const int line = 64/sizeof(T), lines = (size + line - 1)/line;
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif //_OPENMP
+    std::vector<T> partial( threads, T(0));
+#ifdef _OPENMP
+#pragma omp parallel num_threads( threads)
+#endif //_OPENMP
+    {
+        int t = 0, number = 1;
+#ifdef _OPENMP
+        t = omp_get_thread_num(), number = omp_get_num_threads();
+#endif //_OPENMP
+        const int begin = std::min( (int)size, (int)((long)lines*t/number)*line);
+        const int end   = std::min( (int)size, (int)((long)lines*(t+1)/number)*line);
+        partial[t] = simd_dot_range( x, w, y, begin, end);
+    }
+    T sum = 0;
+    for( int t=0; t<threads; t++)
+        sum += partial[t];
+    return sum;
+}
+
+template< class Vector>
+typename Vector::value_type doDot( const Vector& x, const Vector& y, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    return simd_dot<value_type>( x.size(), thrust::raw_pointer_cast( x.data()), 0, thrust::raw_pointer_cast( y.data()));
+}
+
+template< class Vector>
+inline void doScal( Vector& x, typename Vector::value_type alpha, SimdVectorTag)
+{
+    typedef typename Vector::value_type value_type;
+    value_type* px = thrust::raw_pointer_cast( x.data());
+    simd_for_each( x.size(), SimdScal<value_type>( alpha, px, px));
+}
+
+template< class Vector>
+inline void doPlus( Vector& x, typename Vector::value_type alpha, SimdVectorTag)
+{
+    typedef typename Vector::value_type value_type;
+    simd_for_each( x.size(), SimdPlus<value_type>( alpha, thrust::raw_pointer_cast( x.data())));
+}
+
+template< class Vector>
+inline void doAxpby( typename Vector::value_type alpha, const Vector& x, typename Vector::value_type beta, Vector& y, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    value_type* py = thrust::raw_pointer_cast( y.data());
+    if( alpha == 0)
+    {
+        if( beta == 1)
+            return;
+        simd_for_each( y.size(), SimdScal<value_type>( beta, py, py));
+        return;
+    }
+    simd_for_each( y.size(), SimdAxpby<value_type>( alpha, thrust::raw_pointer_cast( x.data()), beta, py, py));
+}
+
+template< class Vector>
+inline void doAxpby( typename Vector::value_type alpha, const Vector& x, typename Vector::value_type beta, const Vector& y, Vector& z, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x.size() == y.size() );
+    assert( x.size() == z.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    const value_type* px = thrust::raw_pointer_cast( x.data()), *py = thrust::raw_pointer_cast( y.data());
+    value_type* pz = thrust::raw_pointer_cast( z.data());
+    if( alpha == 0)
+        simd_for_each( z.size(), SimdScal<value_type>( beta, py, pz));
+    else if( beta == 0)
+        simd_for_each( z.size(), SimdScal<value_type>( alpha, px, pz));
+    else
+        simd_for_each( z.size(), SimdAxpby<value_type>( alpha, px, beta, py, pz));
+}
+
+template< class Vector>
+inline void doPointwiseDot( const Vector& x1, const Vector& x2, Vector& y, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x1.size() == x2.size() );
+    assert( x1.size() == y.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    simd_for_each( y.size(), SimdProduct<value_type>( thrust::raw_pointer_cast( x1.data()), thrust::raw_pointer_cast( x2.data()), thrust::raw_pointer_cast( y.data())));
+}
+
+template< class Vector>
+inline void doPointwiseDot( typename Vector::value_type alpha, const Vector& x1, const Vector& x2, typename Vector::value_type beta, Vector& y, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x1.size() == y.size() && x2.size() == y.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    if( alpha == 0)
+    {
+        if( beta == 1)
+            return;
+        doScal( y, beta, SimdVectorTag());
+        return;
+    }
+    simd_for_each( y.size(), SimdPointwiseDot<value_type>( alpha, thrust::raw_pointer_cast( x1.data()), thrust::raw_pointer_cast( x2.data()), beta, thrust::raw_pointer_cast( y.data())));
+}
+
+template< class Vector>
+inline void doPointwiseDivide( const Vector& x1, const Vector& x2, Vector& y, SimdVectorTag)
+{
+#ifdef DG_DEBUG
+    assert( x1.size() == x2.size() );
+    assert( x1.size() == y.size() );
+#endif //DG_DEBUG
+    typedef typename Vector::value_type value_type;
+    simd_for_each( y.size(), SimdDivide<value_type>( thrust::raw_pointer_cast( x1.data()), thrust::raw_pointer_cast( x2.data()), thrust::raw_pointer_cast( y.data())));
+}
+
+} //namespace detail
+} //namespace blas1
+///@endcond
+
+} //namespace dg
+
+#endif //_DG_BLAS_SIMD_VECTOR_
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <cmath>
+
+#include "../blas.h"
+#include "typedefs.cuh"
+
+//relative difference between the SIMD and the thrust result
+double difference( const dg::SVec& s, const dg::HVec& h)
+{
+    double diff = 0, norm = 0;
+    for( unsigned i=0; i<h.size(); i++)
+    {
+        diff += (s[i]-h[i])*(s[i]-h[i]);
+        norm += h[i]*h[i];
+    }
+    return norm == 0 ? sqrt( diff) : sqrt( diff/norm);
+}
+double difference( double s, double h) { return h == 0 ? fabs( s) : fabs( (s-h)/h);}
+
+//the dot products sum in a different order, so they agree only up to the rounding of the sum
+bool check( const char* name, double diff, double eps = 1e-14)
+{
+    const bool passed = diff < eps;
+    std::cout << "    "<<name<<" "<<diff<<" "<<(passed ? "PASSED" : "FAILED")<<"\n";
+    return passed;
+}
+
+int main()
+{
+    std::cout << "This program compares the blas routines of dg::SVec with the ones of dg::HVec\n";
+    //sizes that are not a multiple of the vector width (4 or 8) test the tail loops
+    const unsigned sizes[6] = { 1, 3, 8, 29, 1000, 100003};
+    bool passed = true;
+    for( unsigned k=0; k<6; k++)
+    {
+        const unsigned N = sizes[k];
+        std::cout << "Size "<<N<<"\n";
+        dg::HVec x( N), y( N), w( N);
+        for( unsigned i=0; i<N; i++)
+        {
+            x[i] = sin( 0.1*i) + 2.;
+            y[i] = cos( 0.3*i) + 1.5; //positive, so that the dot products do not cancel
+            w[i] = 1. + (i%7)/7.;
+        }
+        const dg::SVec sx( x.begin(), x.end()), sy( y.begin(), y.end()), sw( w.begin(), w.end());
+        dg::HVec z( y);
+        dg::SVec sz( sy);
+
+        dg::blas1::axpby( 2., x, 3., y, z);
+        dg::blas1::axpby( 2., sx, 3., sy, sz);
+        passed &= check( "axpby        ", difference( sz, z));
+        dg::blas1::axpby( -0.5, x, 1.5, z);
+        dg::blas1::axpby( -0.5, sx, 1.5, sz);
+        passed &= check( "axpby inplace", difference( sz, z));
+        dg::blas1::pointwiseDot( x, y, z);
+        dg::blas1::pointwiseDot( sx, sy, sz);
+        passed &= check( "pointwiseDot ", difference( sz, z));
+        dg::blas1::pointwiseDot( 2., x, y, -4., z);
+        dg::blas1::pointwiseDot( 2., sx, sy, -4., sz);
+        passed &= check( "pointwiseDot5", difference( sz, z));
+        dg::blas1::pointwiseDivide( y, x, z);
+        dg::blas1::pointwiseDivide( sy, sx, sz);
+        passed &= check( "pointwiseDiv ", difference( sz, z));
+        dg::blas1::scal( z, 0.4);
+        dg::blas1::scal( sz, 0.4);
+        dg::blas1::plus( z, -7.);
+        dg::blas1::plus( sz, -7.);
+        passed &= check( "scal and plus", difference( sz, z));
+        passed &= check( "dot          ", difference( dg::blas1::dot( sx, sy), dg::blas1::dot( x, y)), 1e-12);
+        passed &= check( "weighted dot ", difference( dg::blas2::dot( sx, sw, sy), dg::blas2::dot( x, w, y)), 1e-12);
+        passed &= check( "weighted norm", difference( dg::blas2::dot( sw, sx), dg::blas2::dot( w, x)), 1e-12);
+        dg::blas2::symv( w, x, z);
+        dg::blas2::symv( sw, sx, sz);
+        passed &= check( "symv         ", difference( sz, z));
+        dg::blas2::symv( 2., w, y, 0.5, z);
+        dg::blas2::symv( 2., sw, sy, 0.5, sz);
+        passed &= check( "symv5        ", difference( sz, z));
+    }
+    std::cout << (passed ? "ALL PASSED" : "SOME FAILED")<<"\n";
+    return 0;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+#include <algorithm>
 #include <thrust/device_vector.h>
 //#include <cusp/system/cuda/utils.h>
 #include "sparseblockmat.h"
@@ -7,6 +9,21 @@
 namespace dg
 {
 
+///@cond
+namespace detail
+{
+//raw pointers to a batch of input and output vectors of an EllSparseBlockMatDevice, passed to the kernels by value
+template<class value_type>
+struct MultiVectors
+{
+    enum{ max_vectors = 4};
+    int number;
+    const value_type* x[max_vectors];
+    value_type* y[max_vectors];
+};
+}//namespace detail
+///@endcond
+
 /**
 * @brief Ell Sparse Block Matrix format device version
 *
@@ -45,15 +62,72 @@ struct EllSparseBlockMatDevice
     template <class deviceContainer>
     void symv(const deviceContainer& x, deviceContainer& y) const;
     /**
+    * @brief Apply the matrix to a vector and add to the output
+    *
+    * Computes \f$ y = \alpha Mx + \beta y\f$ (only within the right_range)
+    * @param alpha multiplies the result
+    * @param x input
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const deviceContainer& x, value_type beta, deviceContainer& y) const;
+    /**
+    * @brief Apply the matrix to a pointwise scaled vector and scale the result pointwise
+    *
+    * Computes \f$ y = \alpha\ \text{diag}(post) M\ \text{diag}(pre) x + \beta y\f$ in one sweep
+    * without a temporary for the scaled input or output (e.g. leftx times chi times rightx)
+    * @param alpha multiplies the result
+    * @param pre multiplies x pointwise (if NULL, no scaling; same size as x)
+    * @param x input
+    * @param post multiplies the product pointwise (if NULL, no scaling; same size as y)
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const deviceContainer* pre, const deviceContainer& x, const deviceContainer* post, value_type beta, deviceContainer& y) const;
+    /**
+    * @brief Apply a matrix with ghost columns to a vector and its halo
+    *
+    * Column indices num_cols and num_cols+1 refer to the first and second block of the ghost vector.
+    * Computes \f$ y = \alpha M(x,g) + \beta y\f$ in a single kernel
+    * @param alpha multiplies the result
+    * @param x input
+    * @param ghost halo of x (may be empty if there are no ghost columns)
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    * @sa fuse_ghost_columns
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const deviceContainer& x, const deviceContainer& ghost, value_type beta, deviceContainer& y) const;
+    /**
+    * @brief Apply the matrix to several vectors at once
+    *
+    * Computes \f$ y_m = \alpha Mx_m + \beta y_m\f$ for all m (only within the right_range).
+    * Each block and index of the matrix is loaded once for a batch of up to four vectors
+    * instead of once per vector (e.g. for the search directions of MultiCG)
+    * @param alpha multiplies the result
+    * @param x inputs
+    * @param beta premultiplies outputs (if 0, y is not read)
+    * @param y outputs (same number as inputs) may not equal any input
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const std::vector<const deviceContainer*>& x, value_type beta, const std::vector<deviceContainer*>& y) const;
+    /**
     * @brief Display internal data to a stream
     *
     * @param os the output stream
     */
     void display( std::ostream& os = std::cout) const;
     private:
+    template<class T>
+    friend struct SumSparseBlockMatDevice;
     typedef thrust::device_vector<int> IVec;
     template <class deviceContainer>
     void launch_multiply_kernel(const deviceContainer& x, deviceContainer& y) const;
+    void launch_gemv_kernel(value_type alpha, const value_type* pre, const value_type* x, const value_type* post, value_type beta, value_type* y) const;
+    void launch_ghost_kernel(value_type alpha, const value_type* x, const value_type* ghost, value_type beta, value_type* y) const;
+    void launch_multi_kernel(value_type alpha, const detail::MultiVectors<value_type>& v, value_type beta) const;
     
     thrust::device_vector<value_type> data;
     IVec cols_idx, data_idx; 
@@ -118,6 +192,129 @@ struct CooSparseBlockMatDevice
     int n, left_size, right_size;
 };
 
+///@cond
+namespace detail
+{
+//raw pointers and sizes of the terms of a SumSparseBlockMatDevice, passed to the kernels by value
+template<class value_type>
+struct SumTerms
+{
+    enum{ max_terms = 4};
+    int terms;
+    const value_type* data[max_terms];
+    const int* cols_idx[max_terms];
+    const int* data_idx[max_terms];
+    int num_rows[max_terms], num_cols[max_terms], blocks_per_line[max_terms];
+    int n[max_terms], right_size[max_terms];
+    value_type alpha[max_terms];
+    const value_type* post[max_terms];
+    const value_type* x[max_terms];
+};
+}//namespace detail
+///@endcond
+
+/**
+* @brief Sum of Ell Sparse Block Matrices, device version
+*
+* @ingroup sparsematrix
+* Represents \f[ M = \sum_i \alpha_i\ \text{diag}(p_i) (1\otimes M_i\otimes 1)\f]
+for up to four Kronecker operators \f$ M_i\f$ (e.g. dx plus dy or the jump terms in x and y) with
+optional pointwise post-scaling vectors \f$ p_i\f$.
+All terms are evaluated in a single traversal of the output, i.e. the result is written exactly once
+and no temporaries are needed. Every term must map onto the same output vector and must use its full right_range.
+* @code
+dg::SumSparseBlockMatDevice<double> jump;
+jump.add( 1., dg::create::jumpX( g));
+jump.add( 1., dg::create::jumpY( g));
+dg::blas2::symv( jump, x, y); //y = jumpX x + jumpY x
+* @endcode
+*/
+template<class value_type>
+struct SumSparseBlockMatDevice
+{
+    SumSparseBlockMatDevice(){}
+    /**
+    * @brief Add a term \f$ \alpha M\f$
+    *
+    * @param alpha scalar prefactor
+    * @param m the matrix (is copied)
+    */
+    template< class OtherValueType>
+    void add( value_type alpha, const EllSparseBlockMat<OtherValueType>& m)
+    {
+        add( alpha, m, thrust::host_vector<value_type>());
+    }
+    /**
+    * @brief Add a term \f$ \alpha\ \text{diag}(p) M\f$
+    *
+    * @param alpha scalar prefactor
+    * @param m the matrix (is copied)
+    * @param post pointwise post-scaling (is copied; must have the size of the output or be empty)
+    */
+    template< class OtherValueType>
+    void add( value_type alpha, const EllSparseBlockMat<OtherValueType>& m, const thrust::host_vector<value_type>& post)
+    {
+        assert( terms_.size() < (unsigned)detail::SumTerms<value_type>::max_terms);
+        assert( m.right_range[0] == 0 && m.right_range[1] == m.right_size);
+        if( !terms_.empty())
+            assert( m.num_rows*m.n*m.left_size*m.right_size == size_);
+        size_ = m.num_rows*m.n*m.left_size*m.right_size;
+        assert( post.empty() || post.size() == (unsigned)size_);
+        terms_.push_back( EllSparseBlockMatDevice<value_type>( m));
+        alpha_.push_back( alpha);
+        post_.push_back( thrust::device_vector<value_type>( post));
+    }
+    /**
+    * @brief Number of terms
+    *
+    * @return number of terms
+    */
+    unsigned terms() const {return terms_.size();}
+    /**
+    * @brief Apply the sum to a vector
+    *
+    * @param x input (the same for all terms)
+    * @param y output may not equal input
+    */
+    template <class deviceContainer>
+    void symv(const deviceContainer& x, deviceContainer& y) const
+    {
+        symv( 1, x, 0, y);
+    }
+    /**
+    * @brief Apply the sum to a vector and add to the output
+    *
+    * Computes \f$ y = \alpha Mx + \beta y\f$
+    * @param alpha multiplies the result
+    * @param x input (the same for all terms)
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const deviceContainer& x, value_type beta, deviceContainer& y) const
+    {
+        std::vector<const deviceContainer*> xs( terms_.size(), &x);
+        symv( alpha, xs, beta, y);
+    }
+    /**
+    * @brief Apply every term to its own input and add to the output
+    *
+    * Computes \f$ y = \alpha \sum_i \alpha_i\ \text{diag}(p_i) M_i x_i + \beta y\f$
+    * @param alpha multiplies the result
+    * @param x x[i] is the input of term i (x.size() == terms())
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal any input
+    */
+    template <class deviceContainer>
+    void symv(value_type alpha, const std::vector<const deviceContainer*>& x, value_type beta, deviceContainer& y) const;
+    private:
+    void launch_sum_kernel( const detail::SumTerms<value_type>& t, value_type beta, value_type* y) const;
+    std::vector<EllSparseBlockMatDevice<value_type> > terms_;
+    std::vector<value_type> alpha_;
+    std::vector<thrust::device_vector<value_type> > post_;
+    int size_;
+};
+
 ///@cond
 template<class value_type>
 void EllSparseBlockMatDevice<value_type>::display( std::ostream& os) const
@@ -178,6 +375,83 @@ inline void EllSparseBlockMatDevice<value_type>::symv( const DeviceContainer& x,
 }
 template<class value_type>
 template<class DeviceContainer>
+inline void EllSparseBlockMatDevice<value_type>::symv( value_type alpha, const DeviceContainer& x, value_type beta, DeviceContainer& y) const
+{
+    if( alpha == 1 && beta == 0)
+        launch_multiply_kernel( x,y);
+    else
+        symv( alpha, (const DeviceContainer*)0, x, (const DeviceContainer*)0, beta, y);
+}
+template<class value_type>
+template<class DeviceContainer>
+inline void EllSparseBlockMatDevice<value_type>::symv( value_type alpha, const DeviceContainer* pre, const DeviceContainer& x, const DeviceContainer* post, value_type beta, DeviceContainer& y) const
+{
+    assert( y.size() == (unsigned)num_rows*n*left_size*right_size);
+    assert( x.size() == (unsigned)num_cols*n*left_size*right_size);
+    assert( pre == 0 || pre->size() == x.size());
+    assert( post == 0 || post->size() == y.size());
+    launch_gemv_kernel( alpha,
+        pre == 0 ? 0 : thrust::raw_pointer_cast( &(*pre)[0]),
+        thrust::raw_pointer_cast( &x[0]),
+        post == 0 ? 0 : thrust::raw_pointer_cast( &(*post)[0]),
+        beta, thrust::raw_pointer_cast( &y[0]));
+}
+template<class value_type>
+template<class DeviceContainer>
+inline void EllSparseBlockMatDevice<value_type>::symv( value_type alpha, const DeviceContainer& x, const DeviceContainer& ghost, value_type beta, DeviceContainer& y) const
+{
+    assert( y.size() == (unsigned)num_rows*n*left_size*right_size);
+    assert( x.size() == (unsigned)num_cols*n*left_size*right_size);
+    assert( ghost.empty() || ghost.size() == (unsigned)2*n*left_size*right_size);
+    launch_ghost_kernel( alpha, thrust::raw_pointer_cast( &x[0]),
+        ghost.empty() ? 0 : thrust::raw_pointer_cast( &ghost[0]),
+        beta, thrust::raw_pointer_cast( &y[0]));
+}
+template<class value_type>
+template<class DeviceContainer>
+void EllSparseBlockMatDevice<value_type>::symv( value_type alpha, const std::vector<const DeviceContainer*>& x, value_type beta, const std::vector<DeviceContainer*>& y) const
+{
+    assert( x.size() == y.size());
+    detail::MultiVectors<value_type> v;
+    for( unsigned b=0; b<x.size(); b+=detail::MultiVectors<value_type>::max_vectors)
+    {
+        v.number = std::min<int>( x.size()-b, detail::MultiVectors<value_type>::max_vectors);
+        for( int m=0; m<v.number; m++)
+        {
+            assert( y[b+m]->size() == (unsigned)num_rows*n*left_size*right_size);
+            assert( x[b+m]->size() == (unsigned)num_cols*n*left_size*right_size);
+            v.x[m] = thrust::raw_pointer_cast( &(*x[b+m])[0]);
+            v.y[m] = thrust::raw_pointer_cast( &(*y[b+m])[0]);
+        }
+        launch_multi_kernel( alpha, v, beta);
+    }
+}
+template<class value_type>
+template<class DeviceContainer>
+void SumSparseBlockMatDevice<value_type>::symv( value_type alpha, const std::vector<const DeviceContainer*>& x, value_type beta, DeviceContainer& y) const
+{
+    assert( x.size() == terms_.size());
+    assert( !terms_.empty() && y.size() == (unsigned)size_);
+    detail::SumTerms<value_type> t;
+    t.terms = terms_.size();
+    for( unsigned i=0; i<terms_.size(); i++)
+    {
+        const EllSparseBlockMatDevice<value_type>& m = terms_[i];
+        assert( x[i]->size() == (unsigned)m.num_cols*m.n*m.left_size*m.right_size);
+        assert( (const void*)x[i] != (const void*)&y);
+        t.data[i] = thrust::raw_pointer_cast( &m.data[0]);
+        t.cols_idx[i] = thrust::raw_pointer_cast( &m.cols_idx[0]);
+        t.data_idx[i] = thrust::raw_pointer_cast( &m.data_idx[0]);
+        t.num_rows[i] = m.num_rows, t.num_cols[i] = m.num_cols, t.blocks_per_line[i] = m.blocks_per_line;
+        t.n[i] = m.n, t.right_size[i] = m.right_size;
+        t.alpha[i] = alpha*alpha_[i];
+        t.post[i] = post_[i].empty() ? 0 : thrust::raw_pointer_cast( &post_[i][0]);
+        t.x[i] = thrust::raw_pointer_cast( &(*x[i])[0]);
+    }
+    launch_sum_kernel( t, beta, thrust::raw_pointer_cast( &y[0]));
+}
+template<class value_type>
+template<class DeviceContainer>
 inline void CooSparseBlockMatDevice<value_type>::symv( value_type alpha, const DeviceContainer& x, value_type beta, DeviceContainer& y) const
 {
     launch_multiply_kernel(alpha, x, beta, y);
@@ -197,6 +471,18 @@ struct MatrixTraits<const EllSparseBlockMatDevice<T> >
     typedef SelfMadeMatrixTag matrix_category;
 };
 template <class T>
+struct MatrixTraits<SumSparseBlockMatDevice<T> >
+{
+    typedef T value_type;
+    typedef SelfMadeMatrixTag matrix_category;
+};
+template <class T>
+struct MatrixTraits<const SumSparseBlockMatDevice<T> >
+{
+    typedef T value_type;
+    typedef SelfMadeMatrixTag matrix_category;
+};
+template <class T>
 struct MatrixTraits<CooSparseBlockMatDevice<T> >
 {
     typedef T value_type;
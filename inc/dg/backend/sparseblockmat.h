@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <thrust/host_vector.h>
 #include "matrix_traits.h"
 
@@ -66,6 +67,41 @@ struct EllSparseBlockMat
     * @param y output may not equal input
     */
     void symv(const thrust::host_vector<value_type>& x, thrust::host_vector<value_type>& y) const;
+    /**
+    * @brief Apply the matrix to a vector and add to the output
+    *
+    * Computes \f$ y = \alpha Mx + \beta y\f$ (only within the right_range)
+    * @param alpha multiplies the result
+    * @param x input
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    */
+    void symv(value_type alpha, const thrust::host_vector<value_type>& x, value_type beta, thrust::host_vector<value_type>& y) const;
+    /**
+    * @brief Apply a matrix with ghost columns to a vector and its halo
+    *
+    * Column indices num_cols and num_cols+1 refer to the first and second block of the ghost vector,
+    * which is laid out like an input vector with two columns (as returned by NearestNeighborComm::collect).
+    * Computes \f$ y = \alpha M(x,g) + \beta y\f$ (only within the right_range)
+    * @param alpha multiplies the result
+    * @param x input
+    * @param ghost halo of x (may be empty if there are no ghost columns)
+    * @param beta premultiplies output (if 0, y is not read)
+    * @param y output may not equal input
+    * @sa fuse_ghost_columns
+    */
+    void symv(value_type alpha, const thrust::host_vector<value_type>& x, const thrust::host_vector<value_type>& ghost, value_type beta, thrust::host_vector<value_type>& y) const;
+    /**
+    * @brief Apply the matrix to several vectors at once
+    *
+    * Computes \f$ y_m = \alpha Mx_m + \beta y_m\f$ for all m (only within the right_range)
+    * and reads each block of the matrix once for all vectors
+    * @param alpha multiplies the result
+    * @param x inputs
+    * @param beta premultiplies outputs (if 0, y is not read)
+    * @param y outputs (same number as inputs) may not equal any input
+    */
+    void symv(value_type alpha, const std::vector<const thrust::host_vector<value_type>*>& x, value_type beta, const std::vector<thrust::host_vector<value_type>*>& y) const;
     /**
      * @brief Sets ranges from 0 to left_size and 0 to right_size
      */
@@ -202,6 +238,87 @@ void EllSparseBlockMat<value_type>::symv(const thrust::host_vector<value_type>&
     }
 }
 
+template<class value_type>
+void EllSparseBlockMat<value_type>::symv(value_type alpha, const thrust::host_vector<value_type>& x, value_type beta, thrust::host_vector<value_type>& y) const
+{
+    assert( y.size() == (unsigned)num_rows*n*left_size*right_size);
+    assert( x.size() == (unsigned)num_cols*n*left_size*right_size);
+
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        value_type temp = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        for( int q=0; q<n; q++) //multiplication-loop
+            temp += data[ (data_idx[i*blocks_per_line+d]*n + k)*n+q]*
+                x[((s*num_cols + cols_idx[i*blocks_per_line+d])*n+q)*right_size+j];
+        y[I] = beta == 0 ? alpha*temp : alpha*temp + beta*y[I];
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMat<value_type>::symv(value_type alpha, const std::vector<const thrust::host_vector<value_type>*>& x, value_type beta, const std::vector<thrust::host_vector<value_type>*>& y) const
+{
+    assert( x.size() == y.size());
+    for( unsigned m=0; m<x.size(); m++)
+    {
+        assert( y[m]->size() == (unsigned)num_rows*n*left_size*right_size);
+        assert( x[m]->size() == (unsigned)num_cols*n*left_size*right_size);
+    }
+    std::vector<value_type> temp( x.size());
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        for( unsigned m=0; m<x.size(); m++)
+            temp[m] = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        for( int q=0; q<n; q++) //multiplication-loop
+        {
+            value_type a = data[ (data_idx[i*blocks_per_line+d]*n + k)*n+q];
+            int J = ((s*num_cols + cols_idx[i*blocks_per_line+d])*n+q)*right_size+j;
+            for( unsigned m=0; m<x.size(); m++)
+                temp[m] += a*(*x[m])[J];
+        }
+        for( unsigned m=0; m<x.size(); m++)
+            (*y[m])[I] = beta == 0 ? alpha*temp[m] : alpha*temp[m] + beta*(*y[m])[I];
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMat<value_type>::symv(value_type alpha, const thrust::host_vector<value_type>& x, const thrust::host_vector<value_type>& ghost, value_type beta, thrust::host_vector<value_type>& y) const
+{
+    assert( y.size() == (unsigned)num_rows*n*left_size*right_size);
+    assert( x.size() == (unsigned)num_cols*n*left_size*right_size);
+    assert( ghost.empty() || ghost.size() == (unsigned)2*n*left_size*right_size);
+
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        value_type temp = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n + k)*n;
+            int C = cols_idx[i*blocks_per_line+d];
+            if( C < num_cols)
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += data[ B+q]* x[((s*num_cols + C)*n+q)*right_size+j];
+            else
+                for( int q=0; q<n; q++) 
+                    temp += data[ B+q]* ghost[((s*2 + C-num_cols)*n+q)*right_size+j];
+        }
+        y[I] = beta == 0 ? alpha*temp : alpha*temp + beta*y[I];
+    }
+}
+
 template<class T>
 void EllSparseBlockMat<T>::display( std::ostream& os) const
 {
@@ -300,4 +417,39 @@ struct MatrixTraits<const CooSparseBlockMat<T> >
 };
 ///@endcond
 
+/**
+* @brief Fold the outer matrix of a distributed derivative into ghost columns of the inner matrix
+*
+* The inner matrix must be the result of splitting off the outer values (dg::create::detail::save_outer_values),
+i.e. every outer element of a row replaces one entry of that row by the zero block appended to the data array.
+In the same order these entries are made to point to column num_cols + (outer column), i.e. to the ghost
+vector, and to a copy of the outer data block. The resulting matrix computes \f$ M_i x + M_o g\f$ in one
+sweep with EllSparseBlockMat::symv( alpha, x, g, beta, y)
+* @ingroup sparsematrix
+* @param inner the inner matrix
+* @param outer the outer matrix (num_cols == 2, same n, left_size and right_size)
+* @return the inner matrix with ghost columns
+*/
+template<class value_type>
+EllSparseBlockMat<value_type> fuse_ghost_columns( const EllSparseBlockMat<value_type>& inner, const CooSparseBlockMat<value_type>& outer)
+{
+    EllSparseBlockMat<value_type> m( inner);
+    if( outer.num_entries == 0) return m;
+    assert( outer.n == m.n && outer.left_size == m.left_size && outer.right_size == m.right_size);
+    const int nn = m.n*m.n, zero = m.data.size()/nn - 1;
+    const int bpl = m.blocks_per_line;
+    thrust::host_vector<int> next( m.num_rows, 0); //next entry to search in every row
+    for( int e=0; e<outer.num_entries; e++)
+    {
+        int i = outer.rows_idx[e], d = next[i];
+        while( d < bpl && m.data_idx[i*bpl+d] != zero) d++;
+        assert( d < bpl);
+        next[i] = d+1;
+        m.cols_idx[i*bpl+d] = m.num_cols + outer.cols_idx[e];
+        m.data_idx[i*bpl+d] = m.data.size()/nn;
+        m.data.insert( m.data.end(), outer.data.begin() + outer.data_idx[e]*nn, outer.data.begin() + (outer.data_idx[e]+1)*nn);
+    }
+    return m;
+}
+
 } //namespace dg
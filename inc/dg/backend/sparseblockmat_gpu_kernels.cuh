@@ -39,6 +39,61 @@ template<class value_type>
 
 }
 
+// multiply kernel with compile-time n and blocks per line (inner loops are unrolled)
+template<class value_type, int n, int blocks_per_line>
+ __global__ void ell_multiply_kernel_static(
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int size,
+         const int right, 
+         const int* right_range,
+         const value_type* x, value_type *y
+         )
+{
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    const int right_ = right_range[1]-right_range[0];
+    //every thread takes num_rows/grid_size rows
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rr = row/right_, rrn = rr/n;
+        int s=rrn/num_rows, 
+            i = (rrn)%num_rows, 
+            k = (rr)%n, 
+            j=right_range[0]+row%right_;
+        value_type temp=0;
+#pragma unroll
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+#pragma unroll
+            for( int q=0; q<n; q++) //multiplication-loop
+                temp +=data[ B+q]* x[(J+q)*right+j];
+        }
+        int idx = ((s*num_rows+i)*n+k)*right+j;
+        y[idx]=temp;
+    }
+}
+
+// choose the number of blocks per line at compile time
+template<class value_type, int n>
+void ell_multiply_kernel_n( size_t NUM_BLOCKS, size_t BLOCK_SIZE,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int size, const int right, 
+         const int* right_range,
+         const value_type* x, value_type *y
+         )
+{
+    switch( blocks_per_line)
+    {
+        case 1: ell_multiply_kernel_static<value_type, n, 1> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( data, cols_idx, data_idx, num_rows, num_cols, size, right, right_range, x, y); break;
+        case 2: ell_multiply_kernel_static<value_type, n, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( data, cols_idx, data_idx, num_rows, num_cols, size, right, right_range, x, y); break;
+        case 3: ell_multiply_kernel_static<value_type, n, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( data, cols_idx, data_idx, num_rows, num_cols, size, right, right_range, x, y); break;
+        default: ell_multiply_kernel<value_type> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( data, cols_idx, data_idx, num_rows, num_cols, blocks_per_line, n, size, right, right_range, x, y);
+    }
+}
+
 // multiply kernel, n=3, 3 blocks per line
 template<class value_type>
  __global__ void ell_multiply_kernel33(
@@ -230,6 +285,238 @@ template<class value_type>
 
 }
 
+// gemv kernel y = alpha*post*M*(pre*x) + beta*y, compile-time n if n_static > 0
+template<class value_type, int n_static>
+ __global__ void ell_gemv_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, const int size,
+         const int right, 
+         const int* right_range,
+         const value_type* pre, const value_type* x, const value_type* post, 
+         value_type beta, value_type *y
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    const int right_ = right_range[1]-right_range[0];
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rr = row/right_, rrn = rr/n;
+        int s=rrn/num_rows, 
+            i = (rrn)%num_rows, 
+            k = (rr)%n, 
+            j=right_range[0]+row%right_;
+        value_type temp=0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+            if( pre == 0)
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp +=data[ B+q]* x[(J+q)*right+j];
+            else
+                for( int q=0; q<n; q++) 
+                    temp +=data[ B+q]* pre[(J+q)*right+j]*x[(J+q)*right+j];
+        }
+        int idx = ((s*num_rows+i)*n+k)*right+j;
+        if( post != 0)
+            temp *= post[idx];
+        y[idx] = beta == 0 ? alpha*temp : alpha*temp + beta*y[idx];
+    }
+}
+
+// multiply kernel with ghost columns y = alpha*M*(x,ghost) + beta*y, compile-time n if n_static > 0
+template<class value_type, int n_static>
+ __global__ void ell_ghost_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, const int size,
+         const int right, 
+         const int* right_range,
+         const value_type* x, const value_type* ghost, 
+         value_type beta, value_type *y
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    const int right_ = right_range[1]-right_range[0];
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rr = row/right_, rrn = rr/n;
+        int s=rrn/num_rows, 
+            i = (rrn)%num_rows, 
+            k = (rr)%n, 
+            j=right_range[0]+row%right_;
+        value_type temp=0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int C = cols_idx[i*blocks_per_line+d];
+            if( C < num_cols)
+            {
+                int J = (s*num_cols+C)*n;
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp +=data[ B+q]* x[(J+q)*right+j];
+            }
+            else
+            {
+                int J = (s*2+C-num_cols)*n;
+                for( int q=0; q<n; q++) 
+                    temp +=data[ B+q]* ghost[(J+q)*right+j];
+            }
+        }
+        int idx = ((s*num_rows+i)*n+k)*right+j;
+        y[idx] = beta == 0 ? alpha*temp : alpha*temp + beta*y[idx];
+    }
+}
+
+// multiply kernel with ghost columns, n=3, compile-time blocks per line
+template<class value_type, int blocks_per_line>
+ __global__ void ell_ghost_kernel3(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols,
+         const int size,
+         const int right, 
+         const int* right_range,
+         const value_type* x, const value_type* ghost, 
+         value_type beta, value_type *y
+         )
+{
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    const int right_ = right_range[1]-right_range[0];
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rr = row/right_, rrn = rr/3;
+        int s=rrn/num_rows, 
+            i = (rrn)%num_rows, 
+            k = (rr)%3, 
+            j=right_range[0]+row%right_;
+        value_type temp=0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*3+k)*3;
+            int C = cols_idx[i*blocks_per_line+d];
+            const value_type* v = C < num_cols ? x + (s*num_cols+C)*3*right : ghost + (s*2+C-num_cols)*3*right;
+            temp +=data[ B  ]* v[        j];
+            temp +=data[ B+1]* v[  right+j];
+            temp +=data[ B+2]* v[2*right+j];
+        }
+        int idx = ((s*num_rows+i)*3+k)*right+j;
+        y[idx] = beta == 0 ? alpha*temp : alpha*temp + beta*y[idx];
+    }
+}
+
+// multiply kernel with ghost columns, n=3, compile-time blocks per line, right = 1
+template<class value_type, int blocks_per_line>
+ __global__ void ell_ghost_kernel3x(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols,
+         const int size,
+         const value_type* x, const value_type* ghost, 
+         value_type beta, value_type *y
+         )
+{
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rrn = row/3, k = row%3;
+        int s=rrn/num_rows, i = (rrn)%num_rows;
+        value_type temp=0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*3+k)*3;
+            int C = cols_idx[i*blocks_per_line+d];
+            const value_type* v = C < num_cols ? x + (s*num_cols+C)*3 : ghost + (s*2+C-num_cols)*3;
+            temp +=data[ B  ]* v[0];
+            temp +=data[ B+1]* v[1];
+            temp +=data[ B+2]* v[2];
+        }
+        int idx = (s*num_rows+i)*3+k;
+        y[idx] = beta == 0 ? alpha*temp : alpha*temp + beta*y[idx];
+    }
+}
+
+// multiply kernel for a batch of vectors y_m = alpha*M*x_m + beta*y_m, every block is loaded once for all m
+template<class value_type, int n_static>
+ __global__ void ell_multi_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, const int size,
+         const int right, 
+         const int* right_range,
+         const detail::MultiVectors<value_type> v,
+         value_type beta
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    const int right_ = right_range[1]-right_range[0];
+    for( int row = thread_id; row<size; row += grid_size)
+    {
+        int rr = row/right_, rrn = rr/n;
+        int s=rrn/num_rows, 
+            i = (rrn)%num_rows, 
+            k = (rr)%n, 
+            j=right_range[0]+row%right_;
+        value_type temp[detail::MultiVectors<value_type>::max_vectors] = {0};
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+            for( int q=0; q<n; q++) //multiplication-loop
+            {
+                const value_type a = data[ B+q];
+                for( int m=0; m<v.number; m++)
+                    temp[m] += a* v.x[m][(J+q)*right+j];
+            }
+        }
+        int idx = ((s*num_rows+i)*n+k)*right+j;
+        for( int m=0; m<v.number; m++)
+            v.y[m][idx] = beta == 0 ? alpha*temp[m] : alpha*temp[m] + beta*v.y[m][idx];
+    }
+}
+
+// sum of several Kronecker operators in one sweep over the output
+template<class value_type>
+ __global__ void ell_sum_kernel( const detail::SumTerms<value_type> t, const int size, value_type beta, value_type *y)
+{
+    const int thread_id = blockDim.x * blockIdx.x + threadIdx.x;
+    const int grid_size = gridDim.x*blockDim.x;
+    for( int I = thread_id; I<size; I += grid_size)
+    {
+        value_type result = beta == 0 ? 0 : beta*y[I];
+        for( int m=0; m<t.terms; m++)
+        {
+            const int n = t.n[m], right = t.right_size[m], bpl = t.blocks_per_line[m];
+            const int rr = I/right, rrn = rr/n;
+            const int s = rrn/t.num_rows[m], i = rrn%t.num_rows[m], k = rr%n, j = I%right;
+            value_type temp = 0;
+            for( int d=0; d<bpl; d++)
+            {
+                int B = (t.data_idx[m][i*bpl+d]*n+k)*n;
+                int J = (s*t.num_cols[m]+t.cols_idx[m][i*bpl+d])*n;
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += t.data[m][B+q]*t.x[m][(J+q)*right+j];
+            }
+            if( t.post[m] != 0) 
+                temp *= t.post[m][I];
+            result += t.alpha[m]*temp;
+        }
+        y[I] = result;
+    }
+}
+
 template<class value_type>
 template<class DeviceContainer>
 void EllSparseBlockMatDevice<value_type>::launch_multiply_kernel( const DeviceContainer& x, DeviceContainer& y) const
@@ -264,14 +551,111 @@ void EllSparseBlockMatDevice<value_type>::launch_multiply_kernel( const DeviceCo
                 ell_multiply_kernel32<value_type> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, size, right_size, right_range_ptr, x_ptr,y_ptr);
         }
         else
-            ell_multiply_kernel<value_type> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( 
-                data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, 3, size, right_size, right_range_ptr, x_ptr,y_ptr);
+            ell_multiply_kernel_n<value_type, 3>( NUM_BLOCKS, BLOCK_SIZE, 
+                data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, size, right_size, right_range_ptr, x_ptr,y_ptr);
     }
+    //the common orders get kernels specialised at compile time
+    else if( n == 1)
+        ell_multiply_kernel_n<value_type, 1>( NUM_BLOCKS, BLOCK_SIZE, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, size, right_size, right_range_ptr, x_ptr,y_ptr);
+    else if( n == 2)
+        ell_multiply_kernel_n<value_type, 2>( NUM_BLOCKS, BLOCK_SIZE, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, size, right_size, right_range_ptr, x_ptr,y_ptr);
+    else if( n == 4)
+        ell_multiply_kernel_n<value_type, 4>( NUM_BLOCKS, BLOCK_SIZE, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, size, right_size, right_range_ptr, x_ptr,y_ptr);
+    else if( n == 5)
+        ell_multiply_kernel_n<value_type, 5>( NUM_BLOCKS, BLOCK_SIZE, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, size, right_size, right_range_ptr, x_ptr,y_ptr);
     else
         ell_multiply_kernel<value_type> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( 
             data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr,y_ptr);
 }
 
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_gemv_kernel( value_type alpha, const value_type* pre, const value_type* x_ptr, const value_type* post, value_type beta, value_type* y_ptr) const
+{
+    //set up kernel parameters
+    const size_t BLOCK_SIZE = 256; 
+    const size_t size = (left_size)*(right_range[1]-right_range[0])*num_rows*n; //number of lines
+    const size_t NUM_BLOCKS = std::min<size_t>((size-1)/BLOCK_SIZE+1, 65000);
+
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_gemv_kernel<value_type, 1> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 2: ell_gemv_kernel<value_type, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 3: ell_gemv_kernel<value_type, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 4: ell_gemv_kernel<value_type, 4> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 5: ell_gemv_kernel<value_type, 5> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        default: ell_gemv_kernel<value_type, 0> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr);
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_ghost_kernel( value_type alpha, const value_type* x_ptr, const value_type* ghost, value_type beta, value_type* y_ptr) const
+{
+    //set up kernel parameters
+    const size_t BLOCK_SIZE = 256; 
+    const size_t size = (left_size)*(right_range[1]-right_range[0])*num_rows*n; //number of lines
+    const size_t NUM_BLOCKS = std::min<size_t>((size-1)/BLOCK_SIZE+1, 65000);
+
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_ghost_kernel<value_type, 1> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 2: ell_ghost_kernel<value_type, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 3: //the common derivatives keep the unrolled kernels of the local product
+            if( blocks_per_line == 3 && right_size == 1)
+                ell_ghost_kernel3x<value_type, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, size, x_ptr, ghost, beta, y_ptr);
+            else if( blocks_per_line == 3)
+                ell_ghost_kernel3<value_type, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr);
+            else if( blocks_per_line == 2 && right_size == 1)
+                ell_ghost_kernel3x<value_type, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, size, x_ptr, ghost, beta, y_ptr);
+            else if( blocks_per_line == 2)
+                ell_ghost_kernel3<value_type, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr);
+            else
+                ell_ghost_kernel<value_type, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr);
+            break;
+        case 4: ell_ghost_kernel<value_type, 4> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 5: ell_ghost_kernel<value_type, 5> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        default: ell_ghost_kernel<value_type, 0> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr);
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_multi_kernel( value_type alpha, const detail::MultiVectors<value_type>& v, value_type beta) const
+{
+    //set up kernel parameters
+    const size_t BLOCK_SIZE = 256; 
+    const size_t size = (left_size)*(right_range[1]-right_range[0])*num_rows*n; //number of lines
+    const size_t NUM_BLOCKS = std::min<size_t>((size-1)/BLOCK_SIZE+1, 65000);
+
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_multi_kernel<value_type, 1> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta); break;
+        case 2: ell_multi_kernel<value_type, 2> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta); break;
+        case 3: ell_multi_kernel<value_type, 3> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta); break;
+        case 4: ell_multi_kernel<value_type, 4> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta); break;
+        case 5: ell_multi_kernel<value_type, 5> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta); break;
+        default: ell_multi_kernel<value_type, 0> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, size, right_size, right_range_ptr, v, beta);
+    }
+}
+
+template<class value_type>
+void SumSparseBlockMatDevice<value_type>::launch_sum_kernel( const detail::SumTerms<value_type>& t, value_type beta, value_type* y_ptr) const
+{
+    const size_t BLOCK_SIZE = 256; 
+    const size_t NUM_BLOCKS = std::min<size_t>((size_-1)/BLOCK_SIZE+1, 65000);
+    ell_sum_kernel<value_type> <<<NUM_BLOCKS, BLOCK_SIZE>>> ( t, size_, beta, y_ptr);
+}
+
 template<class value_type>
 template<class DeviceContainer>
 void CooSparseBlockMatDevice<value_type>::launch_multiply_kernel( value_type alpha, const DeviceContainer& x, value_type beta, DeviceContainer& y) const
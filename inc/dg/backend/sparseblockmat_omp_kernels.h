@@ -32,6 +32,53 @@ void ell_multiply_kernel(
     }
 }
 
+// multiply kernel with compile-time n and blocks per line (inner loops are unrolled)
+template<class value_type, int n, int blocks_per_line>
+void ell_multiply_kernel_static(
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, 
+         const int left_size, const int right_size, 
+         const int* right_range,
+         const value_type* x, value_type *y
+         )
+{
+#pragma omp parallel for collapse(2)
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        value_type temp = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+            for( int q=0; q<n; q++) //multiplication-loop
+                temp += data[ B+q]* x[(J+q)*right_size+j];
+        }
+        y[((s*num_rows + i)*n+k)*right_size+j] = temp;
+    }
+}
+
+// choose the number of blocks per line at compile time
+template<class value_type, int n>
+void ell_multiply_kernel_n(
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int left_size, const int right_size, 
+         const int* right_range,
+         const value_type* x, value_type *y
+         )
+{
+    switch( blocks_per_line)
+    {
+        case 1: ell_multiply_kernel_static<value_type, n, 1>( data, cols_idx, data_idx, num_rows, num_cols, left_size, right_size, right_range, x, y); break;
+        case 2: ell_multiply_kernel_static<value_type, n, 2>( data, cols_idx, data_idx, num_rows, num_cols, left_size, right_size, right_range, x, y); break;
+        case 3: ell_multiply_kernel_static<value_type, n, 3>( data, cols_idx, data_idx, num_rows, num_cols, left_size, right_size, right_range, x, y); break;
+        default: ell_multiply_kernel<value_type>( data, cols_idx, data_idx, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range, x, y);
+    }
+}
+
 // multiply kernel n=3, 3 blocks per line
 template<class value_type>
 void ell_multiply_kernel33(
@@ -417,6 +464,155 @@ void ell_multiply_kernel32x(
 
 }
 
+// gemv kernel y = alpha*post*M*(pre*x) + beta*y, compile-time n if n_static > 0
+template<class value_type, int n_static>
+void ell_gemv_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, 
+         const int left_size, const int right_size, 
+         const int* right_range,
+         const value_type* pre, const value_type* x, const value_type* post, 
+         value_type beta, value_type *y
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+#pragma omp parallel for collapse(2)
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        value_type temp = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+            if( pre == 0)
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += data[ B+q]* x[(J+q)*right_size+j];
+            else
+                for( int q=0; q<n; q++) 
+                    temp += data[ B+q]* pre[(J+q)*right_size+j]*x[(J+q)*right_size+j];
+        }
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        if( post != 0) 
+            temp *= post[I];
+        y[I] = beta == 0 ? alpha*temp : alpha*temp + beta*y[I];
+    }
+}
+
+// multiply kernel with ghost columns y = alpha*M*(x,ghost) + beta*y, compile-time n if n_static > 0
+template<class value_type, int n_static>
+void ell_ghost_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, 
+         const int left_size, const int right_size, 
+         const int* right_range,
+         const value_type* x, const value_type* ghost, 
+         value_type beta, value_type *y
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+#pragma omp parallel for collapse(2)
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        value_type temp = 0;
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int C = cols_idx[i*blocks_per_line+d];
+            if( C < num_cols)
+            {
+                int J = (s*num_cols+C)*n;
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += data[ B+q]* x[(J+q)*right_size+j];
+            }
+            else
+            {
+                int J = (s*2+C-num_cols)*n;
+                for( int q=0; q<n; q++) 
+                    temp += data[ B+q]* ghost[(J+q)*right_size+j];
+            }
+        }
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        y[I] = beta == 0 ? alpha*temp : alpha*temp + beta*y[I];
+    }
+}
+
+// multiply kernel for a batch of vectors y_m = alpha*M*x_m + beta*y_m, every block is loaded once for all m
+template<class value_type, int n_static>
+void ell_multi_kernel(
+         value_type alpha,
+         const value_type* data, const int* cols_idx, const int* data_idx, 
+         const int num_rows, const int num_cols, const int blocks_per_line,
+         const int n_dynamic, 
+         const int left_size, const int right_size, 
+         const int* right_range,
+         const detail::MultiVectors<value_type>& v,
+         value_type beta
+         )
+{
+    const int n = n_static > 0 ? n_static : n_dynamic;
+#pragma omp parallel for collapse(2)
+    for( int s=0; s<left_size; s++)
+    for( int i=0; i<num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=right_range[0]; j<right_range[1]; j++)
+    {
+        value_type temp[detail::MultiVectors<value_type>::max_vectors] = {0};
+        for( int d=0; d<blocks_per_line; d++)
+        {
+            int B = (data_idx[i*blocks_per_line+d]*n+k)*n;
+            int J = (s*num_cols+cols_idx[i*blocks_per_line+d])*n;
+            for( int q=0; q<n; q++) //multiplication-loop
+            {
+                const value_type a = data[ B+q];
+                for( int m=0; m<v.number; m++)
+                    temp[m] += a* v.x[m][(J+q)*right_size+j];
+            }
+        }
+        int I = ((s*num_rows + i)*n+k)*right_size+j;
+        for( int m=0; m<v.number; m++)
+            v.y[m][I] = beta == 0 ? alpha*temp[m] : alpha*temp[m] + beta*v.y[m][I];
+    }
+}
+
+// sum of several Kronecker operators in one sweep over the output
+template<class value_type>
+void ell_sum_kernel( const detail::SumTerms<value_type>& t, const int size, value_type beta, value_type *y)
+{
+#pragma omp parallel for
+    for( int I=0; I<size; I++)
+    {
+        value_type result = beta == 0 ? 0 : beta*y[I];
+        for( int m=0; m<t.terms; m++)
+        {
+            const int n = t.n[m], right = t.right_size[m], bpl = t.blocks_per_line[m];
+            const int rr = I/right, rrn = rr/n;
+            const int s = rrn/t.num_rows[m], i = rrn%t.num_rows[m], k = rr%n, j = I%right;
+            value_type temp = 0;
+            for( int d=0; d<bpl; d++)
+            {
+                int B = (t.data_idx[m][i*bpl+d]*n+k)*n;
+                int J = (s*t.num_cols[m]+t.cols_idx[m][i*bpl+d])*n;
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += t.data[m][B+q]*t.x[m][(J+q)*right+j];
+            }
+            if( t.post[m] != 0) 
+                temp *= t.post[m][I];
+            result += t.alpha[m]*temp;
+        }
+        y[I] = result;
+    }
+}
+
 template<class value_type>
 template<class DeviceContainer>
 void EllSparseBlockMatDevice<value_type>::launch_multiply_kernel( const DeviceContainer& x, DeviceContainer& y) const
@@ -447,14 +643,83 @@ void EllSparseBlockMatDevice<value_type>::launch_multiply_kernel( const DeviceCo
                 ell_multiply_kernel32<value_type> ( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
         }
         else
-            ell_multiply_kernel<value_type>( 
-                data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, 3, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
+            ell_multiply_kernel_n<value_type, 3>( 
+                data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
     }
+    //the common orders get kernels specialised at compile time
+    else if( n == 1)
+        ell_multiply_kernel_n<value_type, 1>( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
+    else if( n == 2)
+        ell_multiply_kernel_n<value_type, 2>( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
+    else if( n == 4)
+        ell_multiply_kernel_n<value_type, 4>( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
+    else if( n == 5)
+        ell_multiply_kernel_n<value_type, 5>( data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
     else
         ell_multiply_kernel<value_type>  ( 
             data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr,  x_ptr,y_ptr);
 }
 
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_gemv_kernel( value_type alpha, const value_type* pre, const value_type* x_ptr, const value_type* post, value_type beta, value_type* y_ptr) const
+{
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_gemv_kernel<value_type, 1>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 2: ell_gemv_kernel<value_type, 2>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 3: ell_gemv_kernel<value_type, 3>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 4: ell_gemv_kernel<value_type, 4>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        case 5: ell_gemv_kernel<value_type, 5>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr); break;
+        default: ell_gemv_kernel<value_type, 0>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, pre, x_ptr, post, beta, y_ptr);
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_ghost_kernel( value_type alpha, const value_type* x_ptr, const value_type* ghost, value_type beta, value_type* y_ptr) const
+{
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_ghost_kernel<value_type, 1>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 2: ell_ghost_kernel<value_type, 2>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 3: ell_ghost_kernel<value_type, 3>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 4: ell_ghost_kernel<value_type, 4>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        case 5: ell_ghost_kernel<value_type, 5>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr); break;
+        default: ell_ghost_kernel<value_type, 0>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, x_ptr, ghost, beta, y_ptr);
+    }
+}
+
+template<class value_type>
+void EllSparseBlockMatDevice<value_type>::launch_multi_kernel( value_type alpha, const detail::MultiVectors<value_type>& v, value_type beta) const
+{
+    const value_type* data_ptr = thrust::raw_pointer_cast( &data[0]);
+    const int* cols_ptr = thrust::raw_pointer_cast( &cols_idx[0]);
+    const int* block_ptr = thrust::raw_pointer_cast( &data_idx[0]);
+    const int* right_range_ptr = thrust::raw_pointer_cast( &right_range[0]);
+    switch( n)
+    {
+        case 1: ell_multi_kernel<value_type, 1>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta); break;
+        case 2: ell_multi_kernel<value_type, 2>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta); break;
+        case 3: ell_multi_kernel<value_type, 3>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta); break;
+        case 4: ell_multi_kernel<value_type, 4>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta); break;
+        case 5: ell_multi_kernel<value_type, 5>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta); break;
+        default: ell_multi_kernel<value_type, 0>( alpha, data_ptr, cols_ptr, block_ptr, num_rows, num_cols, blocks_per_line, n, left_size, right_size, right_range_ptr, v, beta);
+    }
+}
+
+template<class value_type>
+void SumSparseBlockMatDevice<value_type>::launch_sum_kernel( const detail::SumTerms<value_type>& t, value_type beta, value_type* y_ptr) const
+{
+    ell_sum_kernel<value_type>( t, size_, beta, y_ptr);
+}
+
 template<class value_type>
 template<class DeviceContainer>
 void CooSparseBlockMatDevice<value_type>::launch_multiply_kernel( value_type alpha, const DeviceContainer& x, value_type beta, DeviceContainer& y) const
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <thrust/host_vector.h>
+#include <thrust/device_vector.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+
+#include "vector_traits.h"
+#include "sparseblockmat.cuh"
+#include "../blas.h"
+
+/*!@file
+ *
+ * Band-wise (z-plane blocked) execution of a sequence of perpendicular derivatives and pointwise operations
+ */
+namespace dg
+{
+
+/**
+ * @brief An operand of a TiledPipeline stage
+ *
+ * @ingroup utilities
+ * Refers to the index-th vector of either the read-only or the writable vectors given to TiledPipeline::execute
+ */
+struct PipelineSlot
+{
+    unsigned index; //!< index into the input or output vectors
+    bool writable; //!< true if index refers to the output vectors
+};
+/**
+ * @brief Refer to a read-only vector of TiledPipeline::execute
+ *
+ * @param i index
+ * @return slot
+ */
+inline PipelineSlot pipeline_in( unsigned i) { PipelineSlot s; s.index = i, s.writable = false; return s;}
+/**
+ * @brief Refer to a writable vector of TiledPipeline::execute
+ *
+ * @param i index
+ * @return slot
+ */
+inline PipelineSlot pipeline_out( unsigned i) { PipelineSlot s; s.index = i, s.writable = true; return s;}
+
+///@cond
+namespace detail
+{
+//the tiled engine dereferences raw pointers on the host
+template<class T>
+bool on_device( const thrust::host_vector<T>& v){ return false;}
+template<class T, class Alloc>
+bool on_device( const thrust::device_vector<T, Alloc>& v){ return THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA;}
+}//namespace detail
+///@endcond
+
+/**
+ * @brief Apply a sequence of derivative and pointwise stages band by band of z-planes
+ *
+ * @ingroup utilities
+ * On a 3d grid derivatives in x and y (and all pointwise operations) never couple different z-planes.
+ * Instead of streaming every vector through memory once per stage, the pipeline runs all recorded stages
+ * on a band of z-planes before it moves on to the next band, so that the working set of a band stays in cache.
+ * Bands are distributed among OpenMP threads; if there are fewer bands than threads the bands are processed
+ * one after the other with all threads working inside every stage.
+ * Stages are recorded once and refer to their operands by slots, which are bound to vectors in execute():
+ * @code
+ dg::TiledPipeline<dg::DVec> p( g.Nz());
+ p.symv( 1., dg::create::dx( g), dg::pipeline_in(0), 0., dg::pipeline_out(1)); //t = dx f
+ p.symv( 1., dg::create::dy( g), dg::pipeline_in(0), 0., dg::pipeline_out(0)); //y = dy f
+ p.pointwiseDot( 1., dg::pipeline_out(1), dg::pipeline_in(1), 1., dg::pipeline_out(0)); //y += t*chi
+ std::vector<const dg::DVec*> in(2); in[0] = &f, in[1] = &chi;
+ std::vector<dg::DVec*> out(2); out[0] = &y, out[1] = &t;
+ p.execute( in, out);
+ * @endcode
+ * The result is the same as if the stages were executed one after the other on whole vectors.
+ * @tparam container thrust::host_vector or thrust::device_vector (with a gpu backend the stages are executed one after the other on whole vectors)
+ * @note derivative matrices must not couple z-planes, i.e. their left_size must be a multiple of the number of planes
+ */
+template<class container>
+struct TiledPipeline
+{
+    typedef typename VectorTraits<container>::value_type value_type; //!< value type
+    /**
+     * @brief Empty pipeline on one plane
+     */
+    TiledPipeline(): planes_(1), band_(1), num_in_(0), num_out_(0){}
+    /**
+     * @brief Empty pipeline
+     *
+     * @param planes number of z-planes of all vectors (Nz for 3d grids, 1 for 2d)
+     * @param band_size number of planes per band
+     */
+    TiledPipeline( unsigned planes, unsigned band_size = 1): planes_(planes), band_(std::max(band_size,1u)), num_in_(0), num_out_(0){ assert( planes > 0);}
+    /**
+     * @brief Number of z-planes
+     * @return planes
+     */
+    unsigned planes() const {return planes_;}
+    /**
+     * @brief Number of planes per band
+     * @return band size
+     */
+    unsigned band_size() const {return band_;}
+    /**
+     * @brief Set the number of planes per band
+     * @param band_size number of planes per band
+     */
+    void set_band_size( unsigned band_size) { band_ = std::max( band_size, 1u);}
+    /**
+     * @brief Number of recorded stages
+     * @return stages
+     */
+    unsigned stages() const {return stages_.size();}
+    /**
+     * @brief Remove all stages
+     */
+    void clear() { stages_.clear(), matrices_.clear(); num_in_ = num_out_ = 0;
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+        dmatrices_.clear();
+#endif //THRUST_DEVICE_SYSTEM
+    }
+    /**
+     * @brief Record \f$ y = \alpha Mx + \beta y\f$
+     *
+     * @param alpha scalar
+     * @param m a perpendicular derivative, e.g. dg::create::dx( g) (is copied)
+     * @param x input slot
+     * @param beta scalar (if 0, y is not read)
+     * @param y output slot (must be writable and different from x)
+     */
+    template<class OtherValueType>
+    void symv( value_type alpha, const EllSparseBlockMat<OtherValueType>& m, PipelineSlot x, value_type beta, PipelineSlot y)
+    {
+        assert( m.left_size % planes_ == 0);
+        assert( m.num_rows == m.num_cols);
+        assert( x.writable != y.writable || x.index != y.index);
+        matrices_.push_back( EllSparseBlockMat<value_type>( m));
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+        dmatrices_.push_back( EllSparseBlockMatDevice<value_type>( m));
+#endif //THRUST_DEVICE_SYSTEM
+        add( Stage::symv, alpha, x, x, beta, y, matrices_.size()-1);
+    }
+    /**
+     * @brief Record \f$ y = \alpha a b + \beta y\f$ (pointwise)
+     *
+     * @param alpha scalar
+     * @param a input slot
+     * @param b input slot
+     * @param beta scalar (if 0, y is not read)
+     * @param y output slot (may equal a or b)
+     */
+    void pointwiseDot( value_type alpha, PipelineSlot a, PipelineSlot b, value_type beta, PipelineSlot y)
+    {
+        add( Stage::dot, alpha, a, b, beta, y, -1);
+    }
+    /**
+     * @brief Record \f$ y = \alpha x + \beta y\f$
+     *
+     * @param alpha scalar
+     * @param x input slot
+     * @param beta scalar (if 0, y is not read)
+     * @param y output slot (may equal x)
+     */
+    void axpby( value_type alpha, PipelineSlot x, value_type beta, PipelineSlot y)
+    {
+        add( Stage::axpby, alpha, x, x, beta, y, -1);
+    }
+    /**
+     * @brief Execute all stages
+     *
+     * @param in read-only vectors, pipeline_in(i) refers to in[i]
+     * @param out writable vectors, pipeline_out(i) refers to out[i]
+     * @note all vectors must have the same size and must not alias each other
+     */
+    void execute( const std::vector<const container*>& in, const std::vector<container*>& out) const;
+  private:
+    struct Stage
+    {
+        enum Type{ symv, dot, axpby};
+        Type type;
+        value_type alpha, beta;
+        PipelineSlot a, b, y;
+        int matrix;
+    };
+    void add( typename Stage::Type type, value_type alpha, PipelineSlot a, PipelineSlot b, value_type beta, PipelineSlot y, int matrix)
+    {
+        assert( y.writable);
+        Stage s;
+        s.type = type, s.alpha = alpha, s.beta = beta, s.a = a, s.b = b, s.y = y, s.matrix = matrix;
+        stages_.push_back( s);
+        update( a), update( b), update( y);
+    }
+    void update( PipelineSlot s)
+    {
+        if( s.writable) num_out_ = std::max( num_out_, s.index+1);
+        else num_in_ = std::max( num_in_, s.index+1);
+    }
+    void apply( const Stage& s, const std::vector<const value_type*>& r, const std::vector<value_type*>& w, unsigned p0, unsigned p1, unsigned plane, bool parallel) const;
+    void execute_untiled( const std::vector<const container*>& in, const std::vector<container*>& out) const;
+    unsigned planes_, band_;
+    unsigned num_in_, num_out_;
+    std::vector<Stage> stages_;
+    std::vector<EllSparseBlockMat<value_type> > matrices_;
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+    std::vector<EllSparseBlockMatDevice<value_type> > dmatrices_;
+#endif //THRUST_DEVICE_SYSTEM
+};
+
+///@cond
+template<class container>
+void TiledPipeline<container>::execute( const std::vector<const container*>& in, const std::vector<container*>& out) const
+{
+    assert( in.size() >= num_in_ && out.size() >= num_out_);
+    if( stages_.empty()) return;
+    const unsigned size = num_out_ > 0 ? out[0]->size() : in[0]->size();
+    assert( size % planes_ == 0);
+    if( detail::on_device( num_out_ > 0 ? *out[0] : *in[0]))
+    {
+        execute_untiled( in, out);
+        return;
+    }
+    //resolve raw pointers: read slots [0, num_in) are the inputs, [num_in, num_in+num_out) the outputs
+    std::vector<const value_type*> r( num_in_+num_out_);
+    std::vector<value_type*> w( num_out_);
+    for( unsigned i=0; i<num_in_; i++)
+    {
+        assert( in[i]->size() == size);
+        r[i] = thrust::raw_pointer_cast( in[i]->data());
+    }
+    for( unsigned i=0; i<num_out_; i++)
+    {
+        assert( out[i]->size() == size);
+        w[i] = thrust::raw_pointer_cast( out[i]->data());
+        r[num_in_+i] = w[i];
+    }
+    const unsigned plane = size/planes_;
+    const int bands = (planes_ + band_ - 1)/band_;
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif //_OPENMP
+    if( bands >= threads) //every thread takes whole bands through all stages
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule( static)
+#endif //_OPENMP
+        for( int b=0; b<bands; b++)
+            for( unsigned k=0; k<stages_.size(); k++)
+                apply( stages_[k], r, w, b*band_, std::min( (b+1)*band_, planes_), plane, false);
+    }
+    else //all threads work on one band at a time
+    {
+        for( int b=0; b<bands; b++)
+            for( unsigned k=0; k<stages_.size(); k++)
+                apply( stages_[k], r, w, b*band_, std::min( (b+1)*band_, planes_), plane, true);
+    }
+}
+
+template<class container>
+void TiledPipeline<container>::apply( const Stage& st, const std::vector<const value_type*>& r, const std::vector<value_type*>& w, unsigned p0, unsigned p1, unsigned plane, bool parallel) const
+{
+    const value_type* a = r[ st.a.writable ? num_in_ + st.a.index : st.a.index];
+    const value_type* b = r[ st.b.writable ? num_in_ + st.b.index : st.b.index];
+    value_type* y = w[ st.y.index];
+    const value_type alpha = st.alpha, beta = st.beta;
+    if( st.type == Stage::symv)
+    {
+        const EllSparseBlockMat<value_type>& m = matrices_[st.matrix];
+        assert( (unsigned)(m.num_rows*m.n*m.left_size*m.right_size) == plane*planes_);
+        const int n = m.n, bpl = m.blocks_per_line, rows = m.num_rows, cols = m.num_cols, right = m.right_size;
+        const int j0 = m.right_range[0], j1 = m.right_range[1];
+        const int s0 = p0*(m.left_size/planes_), s1 = p1*(m.left_size/planes_);
+        const value_type* data = thrust::raw_pointer_cast( m.data.data());
+        const int* cols_idx = thrust::raw_pointer_cast( m.cols_idx.data());
+        const int* data_idx = thrust::raw_pointer_cast( m.data_idx.data());
+#ifdef _OPENMP
+#pragma omp parallel for collapse(2) if( parallel)
+#endif //_OPENMP
+        for( int s=s0; s<s1; s++)
+        for( int i=0; i<rows; i++)
+        for( int k=0; k<n; k++)
+        for( int j=j0; j<j1; j++)
+        {
+            value_type temp = 0;
+            for( int d=0; d<bpl; d++)
+            {
+                int B = (data_idx[i*bpl+d]*n+k)*n;
+                int J = (s*cols+cols_idx[i*bpl+d])*n;
+                for( int q=0; q<n; q++) //multiplication-loop
+                    temp += data[B+q]*a[(J+q)*right+j];
+            }
+            int I = ((s*rows + i)*n+k)*right+j;
+            y[I] = beta == 0 ? alpha*temp : alpha*temp + beta*y[I];
+        }
+        return;
+    }
+    const int i0 = p0*plane, i1 = p1*plane;
+    if( st.type == Stage::dot)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for if( parallel)
+#endif //_OPENMP
+        for( int i=i0; i<i1; i++)
+            y[i] = beta == 0 ? alpha*a[i]*b[i] : alpha*a[i]*b[i] + beta*y[i];
+    }
+    else
+    {
+#ifdef _OPENMP
+#pragma omp parallel for if( parallel)
+#endif //_OPENMP
+        for( int i=i0; i<i1; i++)
+            y[i] = beta == 0 ? alpha*a[i] : alpha*a[i] + beta*y[i];
+    }
+}
+
+template<class container>
+void TiledPipeline<container>::execute_untiled( const std::vector<const container*>& in, const std::vector<container*>& out) const
+{
+#if THRUST_DEVICE_SYSTEM==THRUST_DEVICE_SYSTEM_CUDA
+    for( unsigned k=0; k<stages_.size(); k++)
+    {
+        const Stage& st = stages_[k];
+        const container& a = st.a.writable ? *out[st.a.index] : *in[st.a.index];
+        const container& b = st.b.writable ? *out[st.b.index] : *in[st.b.index];
+        container& y = *out[st.y.index];
+        if( st.type == Stage::symv)
+            dmatrices_[st.matrix].symv( st.alpha, a, st.beta, y);
+        else if( st.type == Stage::dot)
+            dg::blas1::pointwiseDot( st.alpha, a, b, st.beta, y);
+        else
+            dg::blas1::axpby( st.alpha, a, st.beta, y);
+    }
+#endif //THRUST_DEVICE_SYSTEM
+}
+///@endcond
+
+}//namespace dg
@@ -0,0 +1,47 @@
+#include <iostream>
+#include "blas.h"
+#include "derivatives.h"
+#include "evaluation.cuh"
+#include "typedefs.cuh"
+#include "tiled_pipeline.h"
+
+double sine(  double x, double y, double z) { return sin(x)*sin(y)*sin(z);}
+double cosine(  double x, double y, double z) { return cos(x)*cos(y)*(1+z);}
+
+typedef dg::DVec Vector;
+typedef dg::EllSparseBlockMatDevice<double> Matrix;
+
+int main()
+{
+    unsigned n, Nx, Ny, Nz;
+    std::cout << "Type in n, Nx and Ny and Nz!\n";
+    std::cin >> n >> Nx >> Ny >> Nz;
+    dg::Grid3d g3d( 0, M_PI, 0.1, 2*M_PI+0.1, M_PI, 2*M_PI, n, Nx, Ny, Nz, dg::DIR, dg::PER, dg::NEU);
+    const Vector w3d = dg::create::weights( g3d);
+    const Vector f = dg::evaluate( sine, g3d), chi = dg::evaluate( cosine, g3d);
+    Matrix dx = dg::create::dx( g3d, dg::forward), dy = dg::create::dy( g3d);
+
+    //untiled: y = dx( chi dy f) - 2 f*chi + 0.5 y
+    Vector y( f), t( f), y_tiled( f), t_tiled( f), y_band( f), t_band( f);
+    dg::blas2::symv( dy, f, t);
+    dg::blas1::pointwiseDot( t, chi, t);
+    dg::blas2::symv( 1., dx, t, 0.5, y);
+    dg::blas1::pointwiseDot( -2., f, chi, 1., y);
+
+    for( unsigned band=1; band<=Nz+1; band+=(Nz+1)/2)
+    {
+        dg::TiledPipeline<Vector> p( Nz, band);
+        p.symv( 1., dg::create::dy( g3d), dg::pipeline_in(0), 0., dg::pipeline_out(1));
+        p.pointwiseDot( 1., dg::pipeline_out(1), dg::pipeline_in(1), 0., dg::pipeline_out(1));
+        p.symv( 1., dg::create::dx( g3d, dg::forward), dg::pipeline_out(1), 0.5, dg::pipeline_out(0));
+        p.pointwiseDot( -2., dg::pipeline_in(0), dg::pipeline_in(1), 1., dg::pipeline_out(0));
+        std::vector<const Vector*> in( 2);
+        std::vector<Vector*> out( 2);
+        in[0] = &f, in[1] = &chi;
+        y_tiled = f, out[0] = &y_tiled, out[1] = &t_tiled;
+        p.execute( in, out);
+        dg::blas1::axpby( 1., y, -1., y_tiled);
+        std::cout << "Band of "<<band<<" planes: distance to untiled "<<sqrt( dg::blas2::dot( w3d, y_tiled))<<" (Must be 0)\n";
+    }
+    return 0;
+}
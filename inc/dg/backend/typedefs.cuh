@@ -6,6 +6,9 @@
 #define FELTOR_MINOR_VERSION 2
 #define FELTOR_SUBMINOR_VERSION 0
 
+#include "numa_allocator.h"
+#include "simd_vector_blas.h"
+
 /*! @file
 
   This file contains useful typedefs of commonly used types.
@@ -16,8 +19,13 @@ namespace dg{
 ///@{
 //vectors
 //typedef cusp::array1d<double, cusp::device_memory> DVec; //!< Device Vector. The device can be an OpenMP parallelized cpu or a gpu. This depends on the value of the macro THRUST_DEVICE_SYSTEM, which can be either THRUST_DEVICE_SYSTEM_OMP for openMP or THRUST_DEVICE_SYSTEM_CUDA for a gpu. 
+#if defined(DG_NUMA) && THRUST_DEVICE_SYSTEM!=THRUST_DEVICE_SYSTEM_CUDA
+typedef thrust::device_vector<double, NumaAllocator<double> > DVec; //!< Device Vector with NUMA-aware first-touch allocation (DG_NUMA is defined) 
+#else
 typedef thrust::device_vector<double> DVec; //!< Device Vector. The device can be an OpenMP parallelized cpu or a gpu. This depends on the value of the macro THRUST_DEVICE_SYSTEM, which can be either THRUST_DEVICE_SYSTEM_OMP for openMP or THRUST_DEVICE_SYSTEM_CUDA for a gpu. 
+#endif //DG_NUMA
 typedef thrust::host_vector<double>   HVec; //!< Host Vector
+typedef thrust::host_vector<double, AlignedAllocator<double> > SVec; //!< 64-byte aligned Host Vector with explicitly vectorized blas1 routines
 typedef thrust::device_vector<int> iDVec; //!< integer Device Vector
 //typedef cusp::array1d<int, cusp::device_memory> iDVec; //!< integer Device Vector
 typedef thrust::host_vector<int>   iHVec; //!< integer Host Vector
@@ -35,26 +43,31 @@ typedef NearestNeighborComm<thrust::host_vector<int>, thrust::host_vector<double
 typedef NearestNeighborComm<iDVec, DVec > NNCD; //!< device Communicator for the use in an mpi matrix for derivatives
 
 typedef dg::RowColDistMat<dg::EllSparseBlockMat<double>, dg::CooSparseBlockMat<double>, dg::NNCH> MHMatrix; //!< MPI Host Matrix for derivatives
-typedef dg::RowColDistMat<dg::EllSparseBlockMatDevice<double>, dg::CooSparseBlockMatDevice<double>, dg::NNCD> MDMatrix; //!< MPI Device Matrix for derivatives
+typedef dg::GhostDistMat<dg::EllSparseBlockMatDevice<double>, dg::NNCD> MDMatrix; //!< MPI Device Matrix for derivatives (halo in ghost columns, one kernel per product)
 #endif
 //////////////////////////////////////////////FLOAT VERSIONS////////////////////////////////////////////////////
 //vectors
 //typedef cusp::array1d<float, cusp::device_memory> fDVec; //!< Device Vector. The device can be an OpenMP parallelized cpu or a gpu. This depends on the value of the macro THRUST_DEVICE_SYSTEM, which can be either THRUST_DEVICE_SYSTEM_OMP for openMP or THRUST_DEVICE_SYSTEM_CUDA for a gpu. 
+#if defined(DG_NUMA) && THRUST_DEVICE_SYSTEM!=THRUST_DEVICE_SYSTEM_CUDA
+typedef thrust::device_vector<float, NumaAllocator<float> > fDVec; //!< Device Vector with NUMA-aware first-touch allocation (DG_NUMA is defined)
+#else
 typedef thrust::device_vector<float> fDVec; //!< Device Vector. The device can be an OpenMP parallelized cpu or a gpu. This depends on the value of the macro THRUST_DEVICE_SYSTEM, which can be either THRUST_DEVICE_SYSTEM_OMP for openMP or THRUST_DEVICE_SYSTEM_CUDA for a gpu. 
+#endif //DG_NUMA
 typedef thrust::host_vector<float>   fHVec; //!< Host Vector
+typedef thrust::host_vector<float, AlignedAllocator<float> > fSVec; //!< 64-byte aligned Host Vector with explicitly vectorized blas1 routines
 //derivative matrices
 typedef EllSparseBlockMatDevice<float> fDMatrix; //!< Device Matrix for derivatives
 typedef EllSparseBlockMat<float> fHMatrix; //!< Host Matrix for derivatives
 
 #ifdef MPI_VERSION
-typedef MPI_Vector<thrust::device_vector<float> >  fMDVec; //!< MPI Device Vector s.a. dg::DVec
+typedef MPI_Vector<fDVec >  fMDVec; //!< MPI Device Vector s.a. dg::DVec
 typedef MPI_Vector<thrust::host_vector<float>  >   fMHVec; //!< MPI Host Vector
 
 typedef NearestNeighborComm<thrust::host_vector<int>, thrust::host_vector<float> > fNNCH; //!< host Communicator for the use in an mpi matrix for derivatives
-typedef NearestNeighborComm<thrust::device_vector<int>, thrust::device_vector<float> > fNNCD; //!< device Communicator for the use in an mpi matrix for derivatives
+typedef NearestNeighborComm<iDVec, fDVec > fNNCD; //!< device Communicator for the use in an mpi matrix for derivatives
 
 typedef dg::RowColDistMat<dg::EllSparseBlockMat<float>, dg::CooSparseBlockMat<float>, dg::fNNCH> fMHMatrix; //!< MPI Host Matrix for derivatives
-typedef dg::RowColDistMat<dg::EllSparseBlockMatDevice<float>, dg::CooSparseBlockMatDevice<float>, dg::fNNCD> fMDMatrix; //!< MPI Device Matrix for derivatives
+typedef dg::GhostDistMat<dg::EllSparseBlockMatDevice<float>, dg::fNNCD> fMDMatrix; //!< MPI Device Matrix for derivatives (halo in ghost columns, one kernel per product)
 #endif
 ///@}
 
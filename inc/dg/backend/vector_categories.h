@@ -17,6 +17,13 @@ struct ThrustVectorTag: public AnyVectorTag {};
 
 struct CuspVectorTag: public ThrustVectorTag {};
 
+/**
+ * @brief Host vectors with 64-byte aligned storage
+ *
+ * Operations that are not explicitly vectorized fall back to the Thrust versions
+ */
+struct SimdVectorTag: public ThrustVectorTag {};
+
 struct MPIVectorTag: public AnyVectorTag{};
 
 
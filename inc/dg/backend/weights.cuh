@@ -77,6 +77,26 @@ int get_i( unsigned n, int idx) { return idx%(n*n)/n;}
 int get_j( unsigned n, int idx) { return idx%(n*n)%n;}
 int get_i( unsigned n, unsigned Nx, int idx) { return (idx/(n*Nx))%n;}
 int get_j( unsigned n, unsigned Nx, int idx) { return idx%n;}
+//v[(r*Nx+j)*n+l] = h*w[r%n]*w[l] for all rows r, rows are distributed among OpenMP threads
+void row_weights( double h, const std::vector<double>& w, unsigned Nx, unsigned rows, thrust::host_vector<double>& v)
+{
+    const int n = w.size(), size = n*Nx;
+    v.resize( size*rows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int r=0; r<(int)rows; r++)
+        for( int i=0; i<size; i++)
+            v[r*size+i] = h*w[r%n]*w[i%n];
+}
+void invert( thrust::host_vector<double>& v)
+{
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<(int)v.size(); i++)
+        v[i] = 1./v[i];
+}
 }//namespace detail
 ///@endcond
 
@@ -89,13 +109,9 @@ int get_j( unsigned n, unsigned Nx, int idx) { return idx%n;}
 */
 thrust::host_vector<double> weights( const Grid2d& g)
 {
-    //choose layout
-    thrust::host_vector<double> v( g.size());
-    for( unsigned i=0; i<g.size(); i++)
-        //v[i] = g.hx()*g.hy()/4.*g.dlt().weights()[detail::get_i(g.n(), i)]*g.dlt().weights()[detail::get_j(g.n(), i)];
-        v[i] = g.hx()*g.hy()/4.*
-                g.dlt().weights()[detail::get_i(g.n(),g.Nx(), i)]*
-                g.dlt().weights()[detail::get_j(g.n(),g.Nx(), i)];
+    //v[i] = g.hx()*g.hy()/4.*g.dlt().weights()[detail::get_i(g.n(),g.Nx(), i)]*g.dlt().weights()[detail::get_j(g.n(),g.Nx(), i)];
+    thrust::host_vector<double> v;
+    detail::row_weights( g.hx()*g.hy()/4., g.dlt().weights(), g.Nx(), g.n()*g.Ny(), v);
     return v;
 }
 /**
@@ -108,8 +124,7 @@ thrust::host_vector<double> weights( const Grid2d& g)
 thrust::host_vector<double> inv_weights( const Grid2d& g)
 {
     thrust::host_vector<double> v = weights( g);
-    for( unsigned i=0; i<g.size(); i++)
-        v[i] = 1./v[i];
+    detail::invert( v);
     return v;
 }
 
@@ -122,12 +137,9 @@ thrust::host_vector<double> inv_weights( const Grid2d& g)
 */
 thrust::host_vector<double> weights( const Grid3d& g)
 {
-    thrust::host_vector<double> v( g.size());
-    for( unsigned i=0; i<g.size(); i++)
-        //v[i] = g.hz()*g.hx()*g.hy()/4.*g.dlt().weights()[detail::get_i(g.n(), i)]*g.dlt().weights()[detail::get_j(g.n(), i)];
-        v[i] = g.hz()*g.hx()*g.hy()/4.*
-               g.dlt().weights()[detail::get_i(g.n(), g.Nx(), i)]*
-               g.dlt().weights()[detail::get_j(g.n(), g.Nx(), i)];
+    //v[i] = g.hz()*g.hx()*g.hy()/4.*g.dlt().weights()[detail::get_i(g.n(), g.Nx(), i)]*g.dlt().weights()[detail::get_j(g.n(), g.Nx(), i)];
+    thrust::host_vector<double> v;
+    detail::row_weights( g.hz()*g.hx()*g.hy()/4., g.dlt().weights(), g.Nx(), g.n()*g.Ny()*g.Nz(), v);
     return v;
 }
 
@@ -141,10 +153,56 @@ thrust::host_vector<double> weights( const Grid3d& g)
 thrust::host_vector<double> inv_weights( const Grid3d& g)
 {
     thrust::host_vector<double> v = weights( g);
-    for( unsigned i=0; i<g.size(); i++)
-        v[i] = 1./v[i];
+    detail::invert( v);
+    return v;
+}
+
+///@cond
+namespace detail{
+//with compile-time n the index arithmetic of the runtime versions vanishes
+template<unsigned n>
+thrust::host_vector<double> static_weights( double h, const std::vector<double>& w, unsigned Nx, unsigned Ny, unsigned Nz)
+{
+    thrust::host_vector<double> v( n*n*Nx*Ny*Nz);
+    unsigned idx = 0;
+    for( unsigned s=0; s<Nz; s++)
+    for( unsigned i=0; i<Ny; i++)
+    for( unsigned k=0; k<n; k++)
+    for( unsigned j=0; j<Nx; j++)
+    for( unsigned l=0; l<n; l++)
+        v[idx++] = h*w[k]*w[l];
     return v;
 }
+}//namespace detail
+///@endcond
+
+/**
+* @brief create host_vector containing 2d X-space weight coefficients
+*
+* @tparam N # of polynomial coefficients
+* @param g The grid 
+*
+* @return Host Vector
+*/
+template<unsigned N>
+thrust::host_vector<double> weights( const StaticGrid2d<N>& g)
+{
+    return detail::static_weights<N>( g.hx()*g.hy()/4., g.dlt().weights(), g.Nx(), g.Ny(), 1);
+}
+
+/**
+* @brief create host_vector containing 3d X-space weight coefficients
+*
+* @tparam N # of polynomial coefficients
+* @param g The grid 
+*
+* @return Host Vector
+*/
+template<unsigned N>
+thrust::host_vector<double> weights( const StaticGrid3d<N>& g)
+{
+    return detail::static_weights<N>( g.hz()*g.hx()*g.hy()/4., g.dlt().weights(), g.Nx(), g.Ny(), g.Nz());
+}
 
 ///@}
 }//namespace create
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cassert>
+#include <vector>
+
+/*!@file
+ *
+ * A pool of temporary vectors shared between operators
+ */
+namespace dg
+{
+
+///@cond
+namespace detail
+{
+//release the memory of a vector (clear() keeps the capacity)
+template<class container>
+void free_memory( container& v){ container().swap( v);}
+template<class container>
+void free_memory( std::vector<container>& v){ std::vector<container>().swap( v);}
+#ifdef MPI_VERSION
+template<class container>
+void free_memory( MPI_Vector<container>& v){ free_memory( v.data());}
+#endif //MPI_VERSION
+}//namespace detail
+///@endcond
+
+/**
+ * @brief A pool of temporary vectors that operators borrow for the duration of a call
+ *
+ * @ingroup utilities
+ * Operators like Elliptic, Helmholtz, ArakawaX or CG own private temporaries of
+ * full size that are only used inside a single call.
+ * If several operators share one Workspace (via their set_workspace() member)
+ * the number of allocated temporaries equals the maximum number of
+ * simultaneously borrowed vectors (plus one copy to construct new buffers)
+ * instead of the sum of all private ones.
+ * Since borrowed buffers are reused by the next operator they are also likely to
+ * be still in cache.
+ * @code
+ dg::Workspace<dg::DVec> ws( x);
+ pol.set_workspace( ws);
+ invert.set_workspace( ws);
+ invert( pol, phi, rho); //CG borrows 3 and pol 3 vectors -> ws.size() == 6
+ * @endcode
+ * @tparam container The container class (needs a swap() member)
+ * @note The content of a borrowed vector is undefined
+ * @attention Not thread-safe
+ */
+template<class container>
+struct Workspace
+{
+    /**
+     * @brief Allocate nothing
+     */
+    Workspace(){}
+    /**
+     * @brief Store a copy of a vector from which buffers are constructed
+     *
+     * @param copyable all buffers are copy-constructed from this vector
+     */
+    Workspace( const container& copyable): copyable_( copyable){ }
+    /**
+     * @brief Release all buffers and store a new copyable
+     *
+     * @param copyable all buffers are copy-constructed from this vector
+     */
+    void construct( const container& copyable)
+    {
+        assert( in_use() == 0);
+        clear();
+        copyable_ = copyable;
+    }
+    /**
+     * @brief Get an unused buffer (allocate a new one if all are in use)
+     *
+     * @return reference to buffer (content is undefined)
+     * @note call release() once you are done
+     */
+    container& borrow()
+    {
+        for( unsigned i=0; i<buffers_.size(); i++)
+            if( !used_[i])
+            {
+                used_[i] = true;
+                return *buffers_[i];
+            }
+        buffers_.push_back( new container( copyable_));
+        used_.push_back( true);
+        return *buffers_.back();
+    }
+    /**
+     * @brief Give a buffer back to the pool
+     *
+     * @param v a reference obtained by borrow()
+     */
+    void release( const container& v)
+    {
+        for( unsigned i=0; i<buffers_.size(); i++)
+            if( buffers_[i] == &v)
+            {
+                assert( used_[i]);
+                used_[i] = false;
+                return;
+            }
+        assert( false && "Vector does not belong to Workspace");
+    }
+    /**
+     * @brief Number of allocated buffers
+     *
+     * @return the peak number of simultaneously borrowed buffers
+     */
+    unsigned size() const { return buffers_.size();}
+    /**
+     * @brief Number of currently borrowed buffers
+     *
+     * @return # of borrowed buffers
+     */
+    unsigned in_use() const {
+        unsigned number = 0;
+        for( unsigned i=0; i<used_.size(); i++)
+            if( used_[i]) number++;
+        return number;
+    }
+    ~Workspace(){ clear();}
+  private:
+    Workspace( const Workspace&);
+    Workspace& operator=( const Workspace&);
+    void clear()
+    {
+        for( unsigned i=0; i<buffers_.size(); i++)
+            delete buffers_[i];
+        buffers_.clear();
+        used_.clear();
+    }
+    container copyable_; //buffers get swapped so we need an untouched copy
+    std::vector<container*> buffers_;
+    std::vector<bool> used_;
+};
+
+/**
+ * @brief Temporarily replace the private temporaries of an operator by buffers from a Workspace
+ *
+ * @ingroup utilities
+ * On construction up to six buffers are borrowed and swapped into the given vectors,
+ * on destruction the vectors are swapped back and the buffers returned.
+ * If no Workspace is given the class does nothing, i.e. the private temporaries are used.
+ * Thus an operator opts into a Workspace by opening a WorkspaceLoan
+ * on its temporaries at the beginning of a call:
+ * @code
+ void symv( const Vector& x, Vector& y)
+ {
+    dg::WorkspaceLoan<Vector> loan( ws_, temp1_, temp2_); // ws_ may be 0
+    ... //use temp1_ and temp2_ as usual
+ }
+ * @endcode
+ * @tparam container The container class (needs a swap() member)
+ */
+template<class container>
+struct WorkspaceLoan
+{
+    ///@brief Borrow one buffer @param ws Workspace (may be 0) @param v0 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0): ws_(ws), number_(0){
+        lend( v0);
+    }
+    ///@brief Borrow two buffers @param ws Workspace (may be 0) @param v0 temporary @param v1 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0, container& v1): ws_(ws), number_(0){
+        lend( v0), lend( v1);
+    }
+    ///@brief Borrow three buffers @param ws Workspace (may be 0) @param v0 temporary @param v1 temporary @param v2 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0, container& v1, container& v2): ws_(ws), number_(0){
+        lend( v0), lend( v1), lend( v2);
+    }
+    ///@brief Borrow four buffers @param ws Workspace (may be 0) @param v0 temporary @param v1 temporary @param v2 temporary @param v3 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0, container& v1, container& v2, container& v3): ws_(ws), number_(0){
+        lend( v0), lend( v1), lend( v2), lend( v3);
+    }
+    ///@brief Borrow five buffers @param ws Workspace (may be 0) @param v0 temporary @param v1 temporary @param v2 temporary @param v3 temporary @param v4 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0, container& v1, container& v2, container& v3, container& v4): ws_(ws), number_(0){
+        lend( v0), lend( v1), lend( v2), lend( v3), lend( v4);
+    }
+    ///@brief Borrow six buffers @param ws Workspace (may be 0) @param v0 temporary @param v1 temporary @param v2 temporary @param v3 temporary @param v4 temporary @param v5 temporary
+    WorkspaceLoan( Workspace<container>* ws, container& v0, container& v1, container& v2, container& v3, container& v4, container& v5): ws_(ws), number_(0){
+        lend( v0), lend( v1), lend( v2), lend( v3), lend( v4), lend( v5);
+    }
+    ///@brief Swap the temporaries back and return the buffers
+    ~WorkspaceLoan()
+    {
+        for( unsigned i=0; i<number_; i++)
+        {
+            owner_[i]->swap( *buffer_[i]);
+            ws_->release( *buffer_[i]);
+        }
+    }
+  private:
+    WorkspaceLoan( const WorkspaceLoan&);
+    WorkspaceLoan& operator=( const WorkspaceLoan&);
+    void lend( container& v)
+    {
+        if( ws_ == 0) return;
+        container& buffer = ws_->borrow();
+        v.swap( buffer);
+        owner_[number_] = &v;
+        buffer_[number_] = &buffer;
+        number_++;
+    }
+    Workspace<container>* ws_;
+    container* owner_[6];
+    container* buffer_[6];
+    unsigned number_;
+};
+
+}//namespace dg
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+
+#include "blas.h"
+#include "arakawa.h"
+#include "elliptic.h"
+#include "cg.h"
+#include "backend/timer.cuh"
+
+/*!@file
+ *
+ * Kernel sweep shared by bench_b.cu and bench_mpib.cu
+ *
+ * Every kernel is timed over a number of repetitions and reported as one
+ * JSON object per line, which bench.py collects into JSON/CSV tables and
+ * compares against a stored baseline.
+ */
+namespace dg
+{
+///@cond
+namespace bench
+{
+
+inline double sine( double x, double y, double z) { return sin(x)*sin(y);}
+inline double cosine( double x, double y, double z) { return cos(x)*cos(y);}
+
+/**
+ * @brief Print benchmark results as JSON lines
+ *
+ * Bytes and flops are the nominal counts of one call for the global problem size,
+ * i.e. every vector is assumed to be read or written exactly once.
+ */
+struct Report
+{
+    Report( std::ostream& os, unsigned n, unsigned Nx, unsigned Ny, unsigned Nz, int threads, int ranks, bool print):
+        os_(os), n_(n), Nx_(Nx), Ny_(Ny), Nz_(Nz), threads_(threads), ranks_(ranks), print_(print){}
+    /**
+     * @brief Print one line
+     *
+     * @param kernel name of the kernel
+     * @param seconds time of one call
+     * @param bytes nominal memory traffic of one call
+     * @param flops nominal floating point operations of one call
+     */
+    void operator()( const std::string& kernel, double seconds, double bytes, double flops)
+    {
+        if( !print_) return;
+        os_ << "{\"kernel\": \""<<kernel<<"\", \"n\": "<<n_<<", \"Nx\": "<<Nx_<<", \"Ny\": "<<Ny_<<", \"Nz\": "<<Nz_
+            << ", \"threads\": "<<threads_<<", \"ranks\": "<<ranks_
+            << ", \"time\": "<<seconds<<", \"GBs\": "<<bytes/seconds/1e9<<", \"GFLOPs\": "<<flops/seconds/1e9<<"}"<<std::endl;
+    }
+    /**
+     * @brief Print the iteration count of a solver (a comment line that bench.py ignores)
+     *
+     * @param kernel name of the kernel
+     * @param number number of iterations
+     * @param eps the tolerance that was reached
+     */
+    void iterations( const std::string& kernel, unsigned number, double eps)
+    {
+        if( !print_) return;
+        os_ << "# "<<kernel<<": "<<number<<" iterations to "<<eps<<std::endl;
+    }
+  private:
+    std::ostream& os_;
+    unsigned n_, Nx_, Ny_, Nz_;
+    int threads_, ranks_;
+    bool print_;
+};
+
+/**
+ * @brief Time all kernels on the given grid
+ *
+ * @tparam Geometry a (MPI) Cartesian 3d grid
+ * @tparam Matrix the derivative matrix type
+ * @tparam Vector the vector type
+ * @param grid the grid (x is DIR, y and z are periodic)
+ * @param N global number of points
+ * @param reps number of repetitions of each kernel
+ * @param report output
+ * @return sum of all dot products (keeps the compiler from removing them)
+ */
+template<class Geometry, class Matrix, class Vector>
+double kernels( const Geometry& grid, double N, unsigned reps, Report& report)
+{
+    const double vec = N*sizeof(double); //bytes of one vector
+    const unsigned n = grid.n();
+    Vector w3d, v3d, x, y, z;
+    dg::blas1::transfer( dg::create::weights( grid), w3d);
+    dg::blas1::transfer( dg::create::inv_weights( grid), v3d);
+    dg::blas1::transfer( dg::evaluate( sine, grid), x);
+    dg::blas1::transfer( dg::evaluate( cosine, grid), y);
+    z = y;
+    dg::Timer t;
+    double norm = 0;
+    /////////////////////////////blas1///////////////////////////////
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas1::axpby( 1., x, -1., z);
+    t.toc();
+    report( "axpby", t.diff()/reps, 3*vec, 3*N);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas1::pointwiseDot( x, y, z);
+    t.toc();
+    report( "pointwiseDot", t.diff()/reps, 3*vec, N);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        norm += dg::blas1::dot( x, y);
+    t.toc();
+    report( "dot", t.diff()/reps, 2*vec, 2*N);
+    /////////////////////////////blas2///////////////////////////////
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        norm += dg::blas2::dot( w3d, x);
+    t.toc();
+    report( "dot(w,x)", t.diff()/reps, 2*vec, 3*N);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        norm += dg::blas2::dot( x, w3d, y);
+    t.toc();
+    report( "dot(x,w,y)", t.diff()/reps, 3*vec, 3*N);
+    //a derivative reads x and writes y, each row contains blocks_per_line blocks
+    Matrix M;
+    dg::blas2::transfer( dg::create::dx( grid, dg::centered), M);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas2::symv( M, x, y);
+    t.toc();
+    report( "dx_centered", t.diff()/reps, 2*vec, 2*3*n*N);
+    dg::blas2::transfer( dg::create::dx( grid, dg::forward), M);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas2::symv( M, x, y);
+    t.toc();
+    report( "dx_forward", t.diff()/reps, 2*vec, 2*2*n*N);
+    dg::blas2::transfer( dg::create::dy( grid, dg::centered), M);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas2::symv( M, x, y);
+    t.toc();
+    report( "dy_centered", t.diff()/reps, 2*vec, 2*3*n*N);
+    dg::blas2::transfer( dg::create::jumpX( grid), M);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas2::symv( M, x, y);
+    t.toc();
+    report( "jumpX", t.diff()/reps, 2*vec, 2*3*n*N);
+    /////////////////////////////operators///////////////////////////
+    //4 derivatives, 2 jumps and 5 vector operations
+    dg::Elliptic<Geometry, Matrix, Vector> pol( grid, dg::not_normed, dg::centered);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        dg::blas2::symv( pol, x, y);
+    t.toc();
+    report( "elliptic", t.diff()/reps, (6*2+5*3)*vec, (6*2*3*n+5*2)*N);
+    //4 derivatives, 2 derivatives of the result and 8 vector operations
+    dg::ArakawaX<Geometry, Matrix, Vector> arakawa( grid);
+    t.tic();
+    for( unsigned i=0; i<reps; i++)
+        arakawa( x, y, z);
+    t.toc();
+    report( "arakawa", t.diff()/reps, (6*2+8*3)*vec, (6*2*3*n+8*2)*N);
+    //one iteration is one elliptic symv, 2 dots and 3 axpbys
+    //the solve runs to convergence (capped only by the number of unknowns), so the time per iteration includes the whole solve
+    const double eps = 1e-10;
+    dg::CG<Vector> pcg( x, (unsigned)N);
+    dg::blas1::scal( y, 0.);
+    t.tic();
+    unsigned number = pcg( pol, y, x, v3d, eps);
+    t.toc();
+    report.iterations( "cg_iteration", number, eps);
+    //if the initial guess already converged the whole (zero-iteration) call is reported
+    report( "cg_iteration", number == 0 ? t.diff() : t.diff()/number, ((6*2+5*3)+2*3+3*3)*vec, ((6*2*3*n+5*2)+2*3+3*3)*N);
+    return norm;
+}
+
+}//namespace bench
+///@endcond
+}//namespace dg
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Parameter sweep over the kernels in bench.cuh and comparison with a baseline
+
+Run a sweep (ranks > 1 use bench_mpib through mpirun) and store the results
+    ./bench.py run --n 3 4 --Nx 64 --Ny 64 --Nz 1 16 --threads 1 4 -o results.json
+Compare two result files (JSON or CSV); exits with 1 if a kernel became slower
+    ./bench.py compare baseline.json results.json --tolerance 0.1
+"""
+import argparse
+import csv
+import itertools
+import json
+import os
+import subprocess
+import sys
+
+KEYS = ["kernel", "n", "Nx", "Ny", "Nz", "threads", "ranks"]
+FIELDS = KEYS + ["time", "GBs", "GFLOPs"]
+
+
+def run_one(args, n, Nx, Ny, Nz, threads, ranks):
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    if ranks > 1:
+        cmd = args.mpirun.split() + [str(ranks), args.mpi_binary]
+        stdin = "0 0 0\n{} {} {} {}\n{}\n".format(n, Nx, Ny, Nz, args.reps)
+    else:
+        cmd = [args.binary]
+        stdin = "{} {} {} {} {}\n".format(n, Nx, Ny, Nz, args.reps)
+    out = subprocess.run(cmd, input=stdin, env=env, stdout=subprocess.PIPE,
+                         universal_newlines=True, check=True).stdout
+    # the programs print one JSON object per kernel, everything else is chatter
+    return [json.loads(line) for line in out.splitlines() if line.startswith("{")]
+
+
+def read(filename):
+    if filename.endswith(".csv"):
+        with open(filename) as f:
+            rows = list(csv.DictReader(f))
+        for row in rows:
+            for key in FIELDS[1:]:
+                row[key] = float(row[key])
+        return rows
+    with open(filename) as f:
+        return json.load(f)
+
+
+def write(rows, filename, fmt):
+    f = open(filename, "w") if filename else sys.stdout
+    if fmt == "csv":
+        writer = csv.DictWriter(f, fieldnames=FIELDS, lineterminator="\n")
+        writer.writeheader()
+        writer.writerows(rows)
+    else:
+        json.dump(rows, f, indent=1)
+        f.write("\n")
+    if filename:
+        f.close()
+
+
+def key(row):
+    return tuple(row[k] if k == "kernel" else int(row[k]) for k in KEYS)
+
+
+def compare(baseline, current, tolerance):
+    """Print the relative change in time of all common rows
+
+    Return the number of rows that are slower than (1+tolerance)*baseline"""
+    base = dict((key(row), row) for row in baseline)
+    regressions = 0
+    for row in current:
+        old = base.get(key(row))
+        if old is None:
+            continue
+        change = row["time"]/old["time"] - 1.
+        flag = ""
+        if change > tolerance:
+            flag = "REGRESSION"
+            regressions += 1
+        print("{:<14} n={} {}x{}x{} threads={} ranks={}: {:+7.1%} {}".format(
+            *(key(row) + (change, flag))))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command")
+    r = sub.add_parser("run", help="run a parameter sweep")
+    r.add_argument("--n", type=int, nargs="+", default=[3])
+    r.add_argument("--Nx", type=int, nargs="+", default=[64])
+    r.add_argument("--Ny", type=int, nargs="+", default=[64])
+    r.add_argument("--Nz", type=int, nargs="+", default=[1])
+    r.add_argument("--threads", type=int, nargs="+", default=[1])
+    r.add_argument("--ranks", type=int, nargs="+", default=[1])
+    r.add_argument("--reps", type=int, default=20)
+    r.add_argument("--binary", default="./bench_b")
+    r.add_argument("--mpi-binary", default="./bench_mpib")
+    r.add_argument("--mpirun", default="mpirun -n")
+    r.add_argument("--format", choices=["json", "csv"], default="json")
+    r.add_argument("-o", "--output", help="result file (default stdout)")
+    r.add_argument("--baseline", help="compare the results with this file")
+    r.add_argument("--tolerance", type=float, default=0.1)
+    c = sub.add_parser("compare", help="compare results with a baseline")
+    c.add_argument("baseline")
+    c.add_argument("current")
+    c.add_argument("--tolerance", type=float, default=0.1,
+                   help="relative increase in time that counts as regression")
+    args = parser.parse_args()
+
+    if args.command == "run":
+        rows = []
+        for p in itertools.product(args.n, args.Nx, args.Ny, args.Nz, args.threads, args.ranks):
+            rows += run_one(args, *p)
+        write(rows, args.output, args.format)
+        if args.baseline is None:
+            return 0
+        current = rows
+    elif args.command == "compare":
+        current = read(args.current)
+    else:
+        parser.print_help()
+        return 2
+    regressions = compare(read(args.baseline), current, args.tolerance)
+    if regressions > 0:
+        print("{} regression(s) above {:.0%}".format(regressions, args.tolerance))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,25 @@
+#include <iostream>
+
+#include <thrust/device_vector.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif//_OPENMP
+
+#include "bench.cuh"
+
+//Machine readable kernel benchmark, use bench.py to run a parameter sweep
+
+int main()
+{
+    unsigned n, Nx, Ny, Nz, reps;
+    std::cout << "Type n, Nx, Ny, Nz and # of repetitions\n";
+    std::cin >> n >> Nx >> Ny >> Nz >> reps;
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif//_OPENMP
+    dg::CartesianGrid3d grid( 0., M_PI, 0., 2.*M_PI, 0., 2.*M_PI, n, Nx, Ny, Nz, dg::DIR, dg::PER, dg::PER);
+    dg::bench::Report report( std::cout, n, Nx, Ny, Nz, threads, 1, true);
+    dg::bench::kernels<dg::CartesianGrid3d, dg::DMatrix, dg::DVec>( grid, grid.size(), reps, report);
+    return 0;
+}
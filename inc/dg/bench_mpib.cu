@@ -0,0 +1,38 @@
+#include <iostream>
+
+#include <mpi.h>
+#include <thrust/device_vector.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif//_OPENMP
+
+#include "bench.cuh"
+#include "backend/mpi_init.h"
+
+//Machine readable kernel benchmark, use bench.py to run a parameter sweep
+
+int main( int argc, char* argv[])
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank);
+    MPI_Comm_size( MPI_COMM_WORLD, &size);
+    unsigned n, Nx, Ny, Nz, reps;
+    MPI_Comm comm;
+    mpi_init3d( dg::DIR, dg::PER, dg::PER, n, Nx, Ny, Nz, comm);
+    if( rank == 0)
+    {
+        std::cout << "Type # of repetitions\n";
+        std::cin >> reps;
+    }
+    MPI_Bcast( &reps, 1, MPI_UNSIGNED, 0, MPI_COMM_WORLD);
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif//_OPENMP
+    dg::CartesianMPIGrid3d grid( 0., M_PI, 0., 2.*M_PI, 0., 2.*M_PI, n, Nx, Ny, Nz, dg::DIR, dg::PER, dg::PER, comm);
+    dg::bench::Report report( std::cout, n, Nx, Ny, Nz, threads, size, rank==0);
+    dg::bench::kernels<dg::CartesianMPIGrid3d, dg::MDMatrix, dg::MDVec>( grid, grid.global().size(), reps, report);
+    MPI_Finalize();
+    return 0;
+}
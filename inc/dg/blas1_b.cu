@@ -61,5 +61,31 @@ int main()
     t.toc();
     std::cout<<"pointwiseDot took                "<<t.diff()/20<<"s\t" <<gbytes*20/t.diff()<<"GB/s\n";
 
+    std::cout<<"Aligned host vectors with explicit SIMD kernels\n";
+    dg::SVec sw2d, sx, sy;
+    dg::blas1::transfer( dg::create::weights(grid), sw2d);
+    dg::blas1::transfer( dg::evaluate( function, grid), sx);
+    sy = sx;
+    t.tic();
+    for( unsigned i=0; i<20;i++)
+        value_type norm = dg::blas1::dot( sw2d, sx);
+    t.toc();
+    std::cout<<"SIMD DOT took                    " <<t.diff()/20.<<"s\t"<<gbytes*20./t.diff()<<"GB/s\n";
+    t.tic();
+    for( unsigned i=0; i<20;i++)
+        value_type norm = dg::blas2::dot( sx, sw2d, sy);
+    t.toc();
+    std::cout<<"SIMD weighted DOT took           " <<t.diff()/20.<<"s\t"<<gbytes*20./t.diff()<<"GB/s\n";
+    t.tic();
+    for( unsigned i=0; i<20;i++)
+        dg::blas1::axpby( 1., sy, -1., sx);
+    t.toc();
+    std::cout<<"SIMD AXPBY took                  "<<t.diff()/20.<<"s\t"<<gbytes*20/t.diff()<<"GB/s\n";
+    t.tic();
+    for( unsigned i=0; i<20;i++)
+        dg::blas1::pointwiseDot( sy, sx, sx);
+    t.toc();
+    std::cout<<"SIMD pointwiseDot took           "<<t.diff()/20<<"s\t" <<gbytes*20/t.diff()<<"GB/s\n";
+
     return 0;
 }
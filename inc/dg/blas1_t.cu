@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "blas1.h"
+#include "geometry.h"
 
 struct EXP{ __host__ __device__ double operator()(double x){return exp(x);}};
 
@@ -70,6 +71,22 @@ int main()
     dg::blas1::scal( w2, 0.6);
     dg::blas1::plus( w3, -7.0);
     std::cout << "e^2-7 = " << w3[0][0] <<" (0.389056...)"<< std::endl;
+    std::cout << "Test planes of 3d vectors\n";
+    thrust::host_vector<double> m( 2, 2), x( 6, 3), y( 6, 1), x5( 5, 3);
+    m[1] = 4;
+    dg::geo::detail::pointwiseDotPlanes( m, x, y);
+    std::cout << "2*3 4*3 = "<<y[4]<<" "<<y[5]<<" (6 12)\n";
+    dg::geo::detail::pointwiseDotPlanes( 2., m, x, -1., y);
+    std::cout << "2*2*3-6 2*4*3-12 = "<<y[4]<<" "<<y[5]<<" (6 12)\n";
+    dg::geo::detail::pointwiseDividePlanes( x, m, y);
+    std::cout << "3/2 3/4 = "<<y[4]<<" "<<y[5]<<" (1.5 0.75)\n";
+    try{
+        dg::geo::detail::pointwiseDotPlanes( m, x5, y);
+        std::cout << "Size mismatch not detected! FAILED\n";
+    }
+    catch( dg::Ooops& e){
+        std::cout << "Size mismatch detected: "<<e.what()<<" PASSED\n";
+    }
     std::cout << "FINISHED\n\n";
 
 
@@ -5,6 +5,7 @@
 #include "backend/cusp_precon_blas.h"
 #include "backend/matrix_traits_thrust.h"
 #include "backend/thrust_matrix_blas.cuh"
+#include "backend/simd_matrix_blas.h"
 #include "backend/cusp_matrix_blas.cuh"
 #include "backend/sparseblockmat.cuh"
 #include "backend/selfmade_blas.cuh"
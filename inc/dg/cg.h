@@ -5,6 +5,8 @@
 
 #include "blas.h"
 #include "functors.h"
+#include "backend/workspace.h"
+#include "plane_cg.h"
 
 #ifdef DG_BENCHMARK
 #include "backend/timer.cuh"
@@ -43,14 +45,14 @@ class CG
     /**
      * @brief Allocate nothing, 
      */
-    CG(){}
+    CG(): ws_(0){}
       /**
        * @brief Reserve memory for the pcg method
        *
        * @param copyable A Vector must be copy-constructible from this
        * @param max_iter Maximum number of iterations to be used
        */
-    CG( const Vector& copyable, unsigned max_iter):r(copyable), p(r), ap(r), max_iter(max_iter){}
+    CG( const Vector& copyable, unsigned max_iter):r(copyable), p(r), ap(r), max_iter(max_iter), ws_(0){}
     /**
      * @brief Set the maximum number of iterations 
      *
@@ -71,9 +73,20 @@ class CG
      * @param max_iterations
      */
     void construct( const Vector& copyable, unsigned max_iterations) { 
-        ap = p = r = copyable;
+        if( ws_ == 0)
+            ap = p = r = copyable;
         max_iter = max_iterations;
     }
+    /**
+     * @brief Borrow the three vectors r, p, ap from a shared Workspace instead of owning them
+     *
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<Vector>& ws)
+    {
+        ws_ = &ws;
+        detail::free_memory( r), detail::free_memory( p), detail::free_memory( ap);
+    }
     /**
      * @brief Solve the system A*x = b using a preconditioned conjugate gradient method
      *
@@ -128,6 +141,7 @@ class CG
   private:
     Vector r, p, ap; 
     unsigned max_iter;
+    Workspace<Vector>* ws_;
 };
 
 /*
@@ -150,6 +164,7 @@ template< class Vector>
 template< class Matrix, class Preconditioner>
 unsigned CG< Vector>::operator()( Matrix& A, Vector& x, const Vector& b, Preconditioner& P, value_type eps, value_type nrmb_correction)
 {
+    WorkspaceLoan<Vector> loan( ws_, r, p, ap);
     value_type nrmb = sqrt( blas2::dot( P, b));
 #ifdef DG_DEBUG
 #ifdef MPI_VERSION
@@ -213,6 +228,7 @@ template< class Vector>
 template< class Matrix, class Preconditioner, class SquareNorm>
 unsigned CG< Vector>::operator()( Matrix& A, Vector& x, const Vector& b, Preconditioner& P, SquareNorm& S, value_type eps, value_type nrmb_correction)
 {
+    WorkspaceLoan<Vector> loan( ws_, r, p, ap);
     value_type nrmb = sqrt( blas2::dot( S, b));
 #ifdef DG_DEBUG
 #ifdef MPI_VERSION
@@ -297,7 +313,7 @@ struct Invert
      * @brief Allocate nothing
      *
      */
-    Invert() { multiplyWeights_ = true; set_extrapolationType(2); nrmb_correction_ = 1.; }
+    Invert() { multiplyWeights_ = true; set_extrapolationType(2); nrmb_correction_ = 1.; planes_ = 1; }
 
     /**
      * @brief Constructor
@@ -311,6 +327,7 @@ struct Invert
      */
     Invert(const container& copyable, unsigned max_iter, value_type eps, int extrapolationType = 2, bool multiplyWeights = true, value_type nrmb_correction = 1)
     {
+        planes_ = 1;
         construct( copyable, max_iter, eps, extrapolationType, multiplyWeights, nrmb_correction);
     }
 
@@ -340,10 +357,45 @@ struct Invert
      * @param max_iterations
      */
     void set_size( const container& assignable, unsigned max_iterations) {
-        cg.construct(assignable, max_iterations);
         phi0 = phi1 = phi2 = assignable;
+        if( planes_ > 1)
+            plane_cg.construct( assignable, planes_, max_iterations);
+        else
+            cg.construct(assignable, max_iterations);
+        max_iter_ = max_iterations;
     }
 
+    /**
+     * @brief Solve every z-plane of the following inversions separately
+     *
+     * For perpendicular operators on a 3d grid (which do not couple z-planes)
+     * the inversion can be done with PlaneCG instead of CG. Then every plane
+     * stops iterating as soon as it is converged on its own and in MPI the
+     * scalar products are reduced over the x-y communicator only.
+     * @param planes number of local z-planes ( e.g. g.Nz() of the 3d grid), 1 means one global CG
+     * @note call after construct() or set_size()
+     */
+    void set_planes( unsigned planes) {
+        assert( planes > 0 && phi0.size() % planes == 0);
+        planes_ = planes;
+        if( planes_ > 1)
+        {
+            plane_cg.construct( phi0, planes_, max_iter_);
+            cg.construct( container(), max_iter_);
+        }
+        else
+        {
+            cg.construct( phi0, max_iter_);
+            plane_cg.construct( container(), 1, max_iter_);
+        }
+    }
+    /**
+     * @brief Number of z-planes solved separately
+     *
+     * @return the value set in set_planes() (1 by default)
+     */
+    unsigned get_planes() const {return planes_;}
+
     /**
      * @brief Set accuracy parameters for following inversions
      *
@@ -381,19 +433,48 @@ struct Invert
      *
      * @param new_max New maximum number
      */
-    void set_max( unsigned new_max) {cg.set_max( new_max);}
+    void set_max( unsigned new_max) {cg.set_max( new_max); plane_cg.set_max( new_max); max_iter_ = new_max;}
     /**
      * @brief Get the current maximum number of iterations
      *
      * @return the current maximum
      */
-    unsigned get_max() const {return cg.get_max();}
+    unsigned get_max() const {return max_iter_;}
+
+    /**
+     * @brief Let the conjugate gradient borrow its vectors from a shared Workspace
+     *
+     * @param ws must outlive this object
+     * @note the previous solutions are still owned since they are needed between calls
+     */
+    void set_workspace( Workspace<container>& ws) {cg.set_workspace( ws); plane_cg.set_workspace( ws);}
 
     /**
     * @brief Return last solution
     */
     const container& get_last() const { return phi0;}
 
+    /**
+    * @brief Return one of the last three solutions used for extrapolation
+    *
+    * @param i 0 is the last, 1 the second to last and 2 the third to last solution
+    */
+    const container& get_history( unsigned i) const { 
+        assert( i<3);
+        return i==0 ? phi0 : ( i==1 ? phi1 : phi2);
+    }
+
+    /**
+    * @brief Set the last three solutions used for extrapolation (e.g. on restart)
+    *
+    * @param phi_0 last solution
+    * @param phi_1 second to last solution
+    * @param phi_2 third to last solution
+    */
+    void set_history( const container& phi_0, const container& phi_1, const container& phi_2) {
+        phi0 = phi_0, phi1 = phi_1, phi2 = phi_2;
+    }
+
     /**
      * @brief Solve linear problem
      *
@@ -479,13 +560,13 @@ struct Invert
         Timer t;
         t.tic();
 #endif //DG_BENCHMARK
+        const container& rhs = multiplyWeights_ ? phi2 : rho;
         if( multiplyWeights_ ) 
-        {
             dg::blas2::symv( w, rho, phi2);
-            number = cg( op, phi, phi2, p, inv_weights, eps_, nrmb_correction_);
-        }
+        if( planes_ > 1)
+            number = plane_cg( op, phi, rhs, p, inv_weights, eps_, nrmb_correction_);
         else
-            number = cg( op, phi, rho, p, inv_weights, eps_, nrmb_correction_);
+            number = cg( op, phi, rhs, p, inv_weights, eps_, nrmb_correction_);
 #ifdef DG_BENCHMARK
 #ifdef MPI_VERSION
         if(rank==0)
@@ -508,6 +589,8 @@ struct Invert
     value_type eps_, nrmb_correction_;
     container phi0, phi1, phi2;
     dg::CG< container > cg;
+    dg::PlaneCG< container > plane_cg;
+    unsigned planes_, max_iter_;
     value_type alpha[3];
     bool multiplyWeights_; 
 };
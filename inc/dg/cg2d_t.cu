@@ -2,6 +2,7 @@
 #include <iomanip>
 
 #include "cg.h"
+#include "multi_cg.h"
 #include "elliptic.h"
 
 const double lx = 2.*M_PI;
@@ -61,5 +62,17 @@ int main()
     std::cout << "L2 Norm of relative error is  " << eps/norm<<std::endl;
     //Fehler der Integration des Sinus ist vernachlässigbar (vgl. evaluation_t)
 
+    std::cout << "Solve two systems at once with MultiCG\n";
+    dg::MultiCG<dg::HVec > mcg( x, 2, n*n*Nx*Ny);
+    dg::HVec x1 = dg::evaluate( initial, grid), x2( x1), b2( b);
+    dg::blas1::scal( b2, 2.);
+    std::vector<dg::HVec*> xs( 2); xs[0] = &x1, xs[1] = &x2;
+    std::vector<const dg::HVec*> bs( 2); bs[0] = &b, bs[1] = &b2;
+    std::cout << "Number of pcg iterations "<< mcg( A, xs, bs, v2d, v2d, eps_)<<std::endl;
+    dg::blas1::axpby( 1., solution, -1., x1);
+    std::cout << "L2 Norm of relative error is  " << sqrt( dg::blas2::dot( w2d, x1))/norm<<std::endl;
+    dg::blas1::axpby( 2., solution, -1., x2);
+    std::cout << "L2 Norm of relative error is  " << sqrt( dg::blas2::dot( w2d, x2))/norm/2.<<std::endl;
+
     return 0;
 }
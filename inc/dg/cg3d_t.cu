@@ -59,5 +59,14 @@ int main()
     std::cout << "L2 Norm2 of Residuum is        " << normres3 <<"\n";
     std::cout << "L2 Norm of relative error is   " <<sqrt( eps3/norm3)<<std::endl;
 
+    std::cout << "TEST PLANE CG\n";
+    dg::HVec x4 = dg::evaluate( initial, g3d);
+    dg::PlaneCG<dg::HVec > plane_cg( x4, g3d.Nz(), g3d.size());
+    std::cout << "Maximum number of pcg iterations "<< plane_cg( A3, x4, b3, v3d, v3d, eps_)<<std::endl;
+    for( unsigned k=0; k<g3d.Nz(); k++)
+        std::cout << "Plane "<<k<<" took "<<plane_cg.iterations()[k]<<" iterations\n";
+    dg::blas1::axpby( 1., x3, -1., x4);
+    std::cout << "L2 Norm of difference to CG is " <<sqrt( dg::blas2::dot( w3d, x4)/norm3)<<std::endl;
+
     return 0;
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cusp/coo_matrix.h>
+#include <cusp/multiply.h>
+
 #include "blas.h"
 #include "geometry.h"
 #include "backend/derivatives.h"
@@ -16,6 +19,81 @@
 
 namespace dg{
 
+///@cond
+namespace detail{
+
+//returns a*A + b*B, entries with equal row and column are merged
+dg::IHMatrix combine( double a, const dg::IHMatrix& A, double b, const dg::IHMatrix& B)
+{
+    assert( A.num_rows == B.num_rows && A.num_cols == B.num_cols);
+    cusp::coo_matrix<int, double, cusp::host_memory> C( A.num_rows, A.num_cols, A.num_entries + B.num_entries);
+    unsigned e = 0;
+    for( int i=0; i<(int)A.num_rows; i++)
+        for( int k=A.row_offsets[i]; k<A.row_offsets[i+1]; k++, e++)
+            C.row_indices[e] = i, C.column_indices[e] = A.column_indices[k], C.values[e] = a*A.values[k];
+    for( int i=0; i<(int)B.num_rows; i++)
+        for( int k=B.row_offsets[i]; k<B.row_offsets[i+1]; k++, e++)
+            C.row_indices[e] = i, C.column_indices[e] = B.column_indices[k], C.values[e] = b*B.values[k];
+    C.sort_by_row_and_column();
+    unsigned u = 0;
+    for( unsigned i=0; i<C.num_entries; i++)
+    {
+        if( u > 0 && C.row_indices[i] == C.row_indices[u-1] && C.column_indices[i] == C.column_indices[u-1])
+            C.values[u-1] += C.values[i];
+        else
+        {
+            C.row_indices[u] = C.row_indices[i], C.column_indices[u] = C.column_indices[i], C.values[u] = C.values[i];
+            u++;
+        }
+    }
+    C.resize( A.num_rows, A.num_cols, u);
+    return dg::IHMatrix( C);
+}
+
+//A = diag(left) A diag(right)
+void scale( const thrust::host_vector<double>& left, dg::IHMatrix& A, const thrust::host_vector<double>& right)
+{
+    for( int i=0; i<(int)A.num_rows; i++)
+        for( int k=A.row_offsets[i]; k<A.row_offsets[i+1]; k++)
+            A.values[k] *= left[i]*right[A.column_indices[k]];
+}
+
+dg::IHMatrix identity( unsigned size)
+{
+    cusp::coo_matrix<int, double, cusp::host_memory> I( size, size, size);
+    for( unsigned i=0; i<size; i++)
+        I.row_indices[i] = I.column_indices[i] = i, I.values[i] = 1.;
+    return dg::IHMatrix( I);
+}
+
+//convert to CSR format (zero entries are dropped)
+dg::IHMatrix csr( const EllSparseBlockMat<double>& m)
+{
+    const int n = m.n, rows = m.num_rows*n*m.left_size*m.right_size, cols = m.num_cols*n*m.left_size*m.right_size;
+    cusp::coo_matrix<int, double, cusp::host_memory> A( rows, cols, m.left_size*m.num_rows*n*(m.right_range[1]-m.right_range[0])*m.blocks_per_line*n);
+    unsigned e = 0;
+    for( int s=0; s<m.left_size; s++)
+    for( int i=0; i<m.num_rows; i++)
+    for( int k=0; k<n; k++)
+    for( int j=m.right_range[0]; j<m.right_range[1]; j++)
+    for( int d=0; d<m.blocks_per_line; d++)
+    for( int q=0; q<n; q++)
+    {
+        double value = m.data[ (m.data_idx[i*m.blocks_per_line+d]*n + k)*n+q];
+        if( value == 0) continue;
+        A.row_indices[e] = ((s*m.num_rows + i)*n+k)*m.right_size+j;
+        A.column_indices[e] = ((s*m.num_cols + m.cols_idx[i*m.blocks_per_line+d])*n+q)*m.right_size+j;
+        A.values[e] = value;
+        e++;
+    }
+    A.resize( rows, cols, e);
+    A.sort_by_row_and_column();
+    return dg::IHMatrix( A);
+}
+
+}//namespace detail
+///@endcond
+
 /**
 * @brief Class for the evaluation of a parallel derivative
 *
@@ -147,6 +225,24 @@ struct DS
      */
     void symv( const container& f, container& dsTdsf);
 
+    /**
+     * @brief Assemble symv into one sparse matrix
+     *
+     * The interpolations, the volume and hz scalings and the jump terms of symv
+     * are multiplied into one matrix, such that subsequent calls to symv
+     * do one sparse matrix-vector multiplication
+     * (and one vector addition if the boundary values in the limiter region are not zero).
+     * The boundary values and conditions of set_boundaries are taken into account also if set later.
+     * @note only available for the shared memory FieldAligned class
+     */
+    void assemble(){ doAssemble( typename VectorTraits<container>::vector_category());}
+    /**
+     * @brief Check whether symv uses the assembled matrix
+     *
+     * @return true if assemble was called
+     */
+    bool assembled() const {return assembled_;}
+
     /**
     * @brief Set boundary conditions in the limiter region
     *
@@ -155,10 +251,16 @@ struct DS
     * @param bcz boundary condition
     * @param left left boundary value
     * @param right right boundary value
+    * @note returns immediately if the same constant boundaries are already set,
+    * so it is cheap to call this function in every time step
     */
     void set_boundaries( dg::bc bcz, double left, double right)
     {
+        if( constant_ && bcz == f_.bcz() && left == left_ && right == right_) return;
+        dg::bc old = f_.bcz();
         f_.set_boundaries( bcz, left, right);
+        constant_ = true, left_ = left, right_ = right;
+        update_assembly( old);
     }
     /**
      * @brief Set boundary conditions in the limiter region
@@ -171,7 +273,10 @@ struct DS
     */
     void set_boundaries( dg::bc bcz, const container& left, const container& right)
     {
+        dg::bc old = f_.bcz();
         f_.set_boundaries( bcz, left, right);
+        constant_ = false;
+        update_assembly( old);
     }
     /**
      * @brief Set boundary conditions in the limiter region
@@ -185,7 +290,10 @@ struct DS
      */
     void set_boundaries( dg::bc bcz, const container& global, double scal_left, double scal_right)
     {
+        dg::bc old = f_.bcz();
         f_.set_boundaries( bcz, global, scal_left, scal_right);
+        constant_ = false;
+        update_assembly( old);
     }
 
     /**
@@ -211,6 +319,12 @@ struct DS
     */
     const FA& fieldaligned() const{return f_;}
     private:
+    void update_assembly( dg::bc old);
+    void assemble_offset();
+    void doAssemble( ThrustVectorTag);
+    void doAssemble( MPIVectorTag);
+    void doSymvAssembled( const container& f, container& dsTdsf, ThrustVectorTag);
+    void doSymvAssembled( const container& f, container& dsTdsf, MPIVectorTag);
     FA f_;
     Matrix jumpX, jumpY;
     container tempP, temp0, tempM;
@@ -220,6 +334,11 @@ struct DS
     dg::norm no_;
     dg::direction dir_;
     bool apply_jumpX_;
+    typename FA::InterpolationMatrix dsTds_; //assembled symv
+    container offset_; //symv of zero, i.e. the contribution of the boundary values
+    bool assembled_, affine_;
+    bool constant_; //the last boundaries were set as constants left_, right_
+    double left_, right_;
 };
 
 ///@cond
@@ -234,7 +353,7 @@ DS<FA, M,container>::DS(const FA& field, Field inverseB, dg::norm no, dg::direct
         tempP( dg::evaluate( dg::zero, field.grid())), temp0( tempP), tempM( tempP), 
         vol3d( dg::create::volume( field.grid())), inv3d( dg::create::inv_volume( field.grid())),
         invB(dg::pullback(inverseB,field.grid())), //R_(dg::evaluate(dg::coo1,grid)), 
-        no_(no), dir_(dir), apply_jumpX_(jumpX)
+        no_(no), dir_(dir), apply_jumpX_(jumpX), assembled_(false), affine_(false), constant_(false), left_(0), right_(0)
 { }
 
 template<class F, class M, class container>
@@ -253,8 +372,7 @@ void DS<F,M,container>::centered( const container& f, container& dsf)
 {
     //direct discretisation
     assert( &f != &dsf);
-    f_.einsPlus( f, tempP);
-    f_.einsMinus( f, tempM);
+    f_.einsPlusMinus( f, tempP, tempM);
     dg::blas1::axpby( 1., tempP, -1., tempM);
     dg::blas1::pointwiseDivide( tempM, f_.hz(), dsf);
     
@@ -307,8 +425,7 @@ void DS<F,M,container>::centeredTD( const container& f, container& dsf)
 //     Direct discretisation
     assert( &f != &dsf);    
     dg::blas1::pointwiseDot( f, invB, dsf);
-    f_.einsPlus( dsf, tempP);
-    f_.einsMinus( dsf, tempM);
+    f_.einsPlusMinus( dsf, tempP, tempM);
     dg::blas1::axpby( 1., tempP, -1., tempM);
     dg::blas1::pointwiseDivide( tempM, f_.hz(), dsf);        
     dg::blas1::pointwiseDivide( dsf, invB, dsf);
@@ -404,6 +521,11 @@ void DS<F,M,container>::backwardTD( const container& f, container& dsf)
 template< class F, class M, class container >
 void DS<F,M,container>::symv( const container& f, container& dsTdsf)
 {
+    if( assembled_)
+    {
+        doSymvAssembled( f, dsTdsf, typename VectorTraits<container>::vector_category());
+        return;
+    }
     if(dir_ == dg::centered)
     {
         centered( f, tempP);
@@ -435,12 +557,115 @@ void DS<F,M,container>::symv( const container& f, container& dsTdsf)
     }
 }
 
+template< class F, class M, class container >
+void DS<F,M,container>::doSymvAssembled( const container& f, container& dsTdsf, ThrustVectorTag)
+{
+    dg::blas2::symv( dsTds_, f, dsTdsf);
+    if( affine_)
+        dg::blas1::axpby( 1., offset_, 1., dsTdsf);
+}
+
+template< class F, class M, class container >
+void DS<F,M,container>::doSymvAssembled( const container& f, container& dsTdsf, MPIVectorTag)
+{
+    assert( false && "DS::assemble is not available for MPI vectors");
+}
+
+template< class F, class M, class container >
+void DS<F,M,container>::doAssemble( ThrustVectorTag)
+{
+    //assemble the linear part on the host
+    dg::IHMatrix plus, minus, plusT, minusT, A, B;
+    f_.assemble( plus, minus, plusT, minusT);
+    thrust::host_vector<double> vol, inv, hz, hp, hm, one( vol3d.size(), 1.);
+    dg::blas1::transfer( vol3d, vol);
+    dg::blas1::transfer( inv3d, inv);
+    dg::blas1::transfer( f_.hz(), hz);
+    dg::blas1::transfer( f_.hp(), hp);
+    dg::blas1::transfer( f_.hm(), hm);
+    thrust::host_vector<double> ihz(hz), ihp(hp), ihm(hm), volhz(vol), volhp(vol), volhm(vol);
+    for( unsigned i=0; i<vol.size(); i++)
+    {
+        ihz[i] = 1./hz[i], ihp[i] = 1./hp[i], ihm[i] = 1./hm[i];
+        volhz[i] = vol[i]/hz[i], volhp[i] = vol[i]/hp[i], volhm[i] = vol[i]/hm[i];
+    }
+    if(dir_ == dg::centered)
+    {
+        dg::IHMatrix C = detail::combine( 1., plus, -1., minus);
+        detail::scale( ihz, C, one);
+        dg::IHMatrix CT = detail::combine( 1., minusT, -1., plusT);
+        detail::scale( inv, CT, volhz);
+        cusp::multiply( CT, C, A);
+    }
+    else
+    {
+        const dg::IHMatrix I = detail::identity( vol.size());
+        dg::IHMatrix F = detail::combine( 1., plus, -1., I);
+        detail::scale( ihp, F, one);
+        dg::IHMatrix FT = detail::combine( 1., I, -1., plusT);
+        detail::scale( inv, FT, volhp);
+        dg::IHMatrix Bw = detail::combine( 1., minus, -1., I);
+        detail::scale( ihm, Bw, one);
+        dg::IHMatrix BT = detail::combine( 1., I, -1., minusT);
+        detail::scale( inv, BT, volhm);
+        cusp::multiply( FT, F, A);
+        cusp::multiply( BT, Bw, B);
+        A = detail::combine( 0.5, A, 0.5, B);
+    }
+    //add jump terms
+    container ones( dg::evaluate( dg::one, f_.grid()));
+    dg::geo::divideVolume( ones, f_.grid());
+    thrust::host_vector<double> ivol;
+    dg::blas1::transfer( ones, ivol);
+    if(apply_jumpX_)
+    {
+        B = detail::csr( dg::create::jumpX( f_.grid()));
+        detail::scale( ivol, B, one);
+        A = detail::combine( 1., A, -1., B);
+    }
+    B = detail::csr( dg::create::jumpY( f_.grid()));
+    detail::scale( ivol, B, one);
+    A = detail::combine( 1., A, -1., B);
+    if( no_ == not_normed)
+        detail::scale( vol, A, one);
+    dsTds_ = A;
+    assemble_offset();
+}
+
+template< class F, class M, class container >
+void DS<F,M,container>::doAssemble( MPIVectorTag)
+{
+    assert( false && "DS::assemble is not available for MPI vectors");
+}
+
+template< class F, class M, class container >
+void DS<F,M,container>::assemble_offset()
+{
+    //the boundary values enter as a constant offset
+    container zero( vol3d);
+    dg::blas1::scal( zero, 0.);
+    offset_ = zero;
+    assembled_ = false;
+    symv( zero, offset_);
+    assembled_ = true;
+    affine_ = dg::blas1::dot( offset_, offset_) != 0;
+}
+
+template< class F, class M, class container >
+void DS<F,M,container>::update_assembly( dg::bc old)
+{
+    if( !assembled_) return;
+    if( old != f_.bcz())
+        assemble(); //the ghost cells changed
+    else
+        assemble_offset();
+}
+
 template< class F, class M, class container >
 void DS<F,M,container>::dss( const container& f, container& dssf)
 {
     assert( &f != &dssf);
-    f_.einsPlus(  f, tempP);
-    f_.einsMinus( f, tempM);
+    f_.einsPlusMinus( f, tempP, tempM);
     dg::blas1::pointwiseDivide( tempP, f_.hp(), tempP);
     dg::blas1::pointwiseDivide( tempP, f_.hz(), tempP);
     dg::blas1::pointwiseDivide( f, f_.hp(), temp0);
@@ -102,6 +102,21 @@ int main()
     ds.backward( function, derivative);
     norm = dg::blas2::dot(w3d, derivative);
     std::cout << "Norm Backward Derivative "<<sqrt( norm)<<" (compare with that of ds_mpib)\n";
+    dg::DVec lambda( function), lambdaA( function);
+    t.tic();
+    ds.symv( function, lambda);
+    t.toc();
+    std::cout << "Application of parallel Laplacian took   "<<t.diff()<<"s\n";
+    t.tic();
+    ds.assemble();
+    t.toc();
+    std::cout << "Assembly of parallel Laplacian took      "<<t.diff()<<"s\n";
+    t.tic();
+    ds.symv( function, lambdaA);
+    t.toc();
+    std::cout << "Application of assembled Laplacian took  "<<t.diff()<<"s\n";
+    dg::blas1::axpby( 1., lambda, -1., lambdaA);
+    std::cout << "Relative Difference Is "<< sqrt( dg::blas1::dot( lambdaA, lambdaA)/dg::blas1::dot( lambda, lambda))<<" (should be small)\n";
     
     return 0;
 }
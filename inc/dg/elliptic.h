@@ -5,6 +5,7 @@
 #include "enums.h"
 #include "backend/evaluation.cuh"
 #include "backend/derivatives.h"
+#include "backend/workspace.h"
 #ifdef MPI_VERSION
 #include "backend/mpi_derivatives.h"
 #include "backend/mpi_evaluation.h"
@@ -70,7 +71,7 @@ class Elliptic
      * @note chi is assumed 1 per default
      */
     Elliptic( Geometry g, norm no = not_normed, direction dir = forward, double jfactor=1.): 
-        no_(no), g_(g), jfactor_(jfactor)
+        no_(no), g_(g), jfactor_(jfactor), ws_(0)
     { 
         construct( g, g.bcx(), g.bcy(), dir);
     }
@@ -91,7 +92,7 @@ class Elliptic
      * @param jfactor scale jump terms (1 is a good value but in some cases 0.1 or 0.01 might be better)
      */
     Elliptic( Geometry g, bc bcx, bc bcy, norm no = not_normed, direction dir = forward, double jfactor=1.): 
-        no_(no), g_(g), jfactor_(jfactor)
+        no_(no), g_(g), jfactor_(jfactor), ws_(0)
     { 
         construct( g, bcx, bcy, dir);
     }
@@ -138,6 +139,18 @@ class Elliptic
      */
     double get_jfactor() const {return jfactor_;}
 
+    /**
+     * @brief Borrow temporaries from a shared Workspace instead of owning them
+     *
+     * Frees the three private temporaries; symv() borrows three vectors from ws
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<Vector>& ws)
+    {
+        ws_ = &ws;
+        detail::free_memory( tempx), detail::free_memory( tempy), detail::free_memory( gradx);
+    }
+
     /**
      * @brief Computes the polarisation term
      *
@@ -146,28 +159,26 @@ class Elliptic
      */
     void symv( const Vector& x, Vector& y) 
     {
+        WorkspaceLoan<Vector> loan( ws_, tempx, tempy, gradx);
         //compute gradient
         dg::blas2::gemv( rightx, x, tempx); //R_x*f 
-        dg::blas2::gemv( righty, x, tempy); //R_y*f
+        dg::blas2::gemv( righty, x, y); //R_y*f
 
-        dg::geo::volRaisePerpIndex( tempx, tempy, gradx, y, g_);
+        dg::geo::volRaisePerpIndex( tempx, y, gradx, tempy, g_);
 
         //multiply with chi 
         dg::blas1::pointwiseDot( xchi, gradx, gradx); //Chi*R_x*x 
-        dg::blas1::pointwiseDot( xchi, y, y); //Chi*R_x*x 
+        dg::blas1::pointwiseDot( xchi, tempy, tempy); //Chi*R_y*x 
 
-        //now take divergence
-        dg::blas2::gemv( leftx, gradx, tempx);  
-        dg::blas2::gemv( lefty, y, tempy);  
-        dg::blas1::axpby( -1., tempx, -1., tempy, y); //-D_xx - D_yy 
+        //now take divergence and accumulate directly into y
+        dg::blas2::symv( -1., leftx, gradx, 0., y);  
+        dg::blas2::symv( -1., lefty, tempy, 1., y); //-D_xx - D_yy 
         if( no_ == normed)
             dg::geo::divideVolume( y, g_);
 
         //add jump terms
-        dg::blas2::symv( jumpX, x, tempx);
-        dg::blas1::axpby( jfactor_, tempx, 1., y, y); 
-        dg::blas2::symv( jumpY, x, tempy);
-        dg::blas1::axpby( jfactor_, tempy, 1., y, y); 
+        dg::blas2::symv( jfactor_, jumpX, x, 1., y);
+        dg::blas2::symv( jfactor_, jumpY, x, 1., y);
         if( no_ == not_normed)//multiply weights without volume
             dg::blas2::symv( weights_wo_vol, y, y);
 
@@ -211,6 +222,7 @@ class Elliptic
     norm no_;
     Geometry g_;
     double jfactor_;
+    Workspace<Vector>* ws_;
 };
 
 
@@ -263,7 +275,7 @@ struct GeneralElliptic
         jumpY ( dg::create::jumpY( g, g.bcy())),
         weights_(dg::create::volume(g)), precond_(dg::create::inv_weights(g)), 
         xchi( dg::evaluate( one, g) ), ychi( xchi), zchi( xchi), 
-        xx(xchi), yy(xx), zz(xx), temp0( xx), temp1(temp0),
+        xx(xchi), temp0( xx), temp1(temp0),
         no_(no), g_(g)
     { }
     /**
@@ -291,7 +303,7 @@ struct GeneralElliptic
         jumpY ( dg::create::jumpY( g, bcy)),
         weights_(dg::create::volume(g)), precond_(dg::create::inv_weights(g)), 
         xchi( dg::evaluate( one, g) ), ychi( xchi), zchi( xchi), 
-        xx(xchi), yy(xx), zz(xx), temp0( xx), temp1(temp0),
+        xx(xchi), temp0( xx), temp1(temp0),
         no_(no), g_(g)
     { }
     /**
@@ -361,34 +373,27 @@ struct GeneralElliptic
         dg::blas1::pointwiseDot( xchi, temp0, xx); //Chi_x*R_x*x 
 
         dg::blas2::gemv( righty, x, temp0);//R_y*x
-        dg::blas1::pointwiseDot( ychi, temp0, yy);//Chi_y*R_y*x
+        dg::blas1::pointwiseDot( 1., ychi, temp0, 1., xx);//+Chi_y*R_y*x
 
         dg::blas2::gemv( rightz, x, temp0); // R_z*x
-        dg::blas1::pointwiseDot( zchi, temp0, zz); //Chi_z*R_z*x
-
-        dg::blas1::axpby( 1., xx, 1., yy, temp0);
-        dg::blas1::axpby( 1., zz, 1., temp0, temp0); //gradpar x 
-
-        dg::geo::multiplyVolume( temp0, g_);
+        dg::blas1::pointwiseDot( 1., zchi, temp0, 1., xx); //+Chi_z*R_z*x = gradpar x
 
-        dg::blas1::pointwiseDot( xchi, temp0, temp1); 
-        dg::blas2::gemv( leftx, temp1, xx); 
+        dg::geo::multiplyVolume( xx, g_);
 
-        dg::blas1::pointwiseDot( ychi, temp0, temp1);
-        dg::blas2::gemv( lefty, temp1, yy);
+        //take divergence and accumulate directly into y
+        dg::blas1::pointwiseDot( xchi, xx, temp1); 
+        dg::blas2::symv( -1., leftx, temp1, 0., y); 
 
-        dg::blas1::pointwiseDot( zchi, temp0, temp1); 
-        dg::blas2::gemv( leftz, temp1, zz); 
+        dg::blas1::pointwiseDot( ychi, xx, temp1);
+        dg::blas2::symv( -1., lefty, temp1, 1., y);
 
-        dg::blas1::axpby( -1., xx, -1., yy, y);
-        dg::blas1::axpby( -1., zz, +1., y, y); 
+        dg::blas1::pointwiseDot( zchi, xx, temp1); 
+        dg::blas2::symv( -1., leftz, temp1, 1., y); 
         if( no_==normed) 
             dg::geo::divideVolume( y, g_);
         
-        dg::blas2::symv( jumpX, x, temp0);
-        dg::blas1::axpby( +1., temp0, 1., y, y); 
-        dg::blas2::symv( jumpY, x, temp0);
-        dg::blas1::axpby( +1., temp0, 1., y, y); 
+        dg::blas2::symv( 1., jumpX, x, 1., y);
+        dg::blas2::symv( 1., jumpY, x, 1., y);
         if( no_==not_normed)//multiply weights w/o volume
         {
             dg::geo::divideVolume( y, g_);
@@ -412,7 +417,7 @@ struct GeneralElliptic
     }
     Matrix leftx, lefty, leftz, rightx, righty, rightz, jumpX, jumpY;
     Vector weights_, precond_; //contain coeffs for chi multiplication
-    Vector xchi, ychi, zchi, xx, yy, zz, temp0, temp1;
+    Vector xchi, ychi, zchi, xx, temp0, temp1;
     norm no_;
     Geometry g_;
 };
@@ -684,22 +689,19 @@ struct TensorElliptic
 
         //multiply with chi 
         dg::blas1::pointwiseDot( chixx_, tempx_, gradx_); //gxx*v_x
-        dg::blas1::pointwiseDot( chixy_, tempx_, y); //gyx*v_x
         dg::blas1::pointwiseDot( 1., chixy_, tempy_, 1., gradx_);//gxy*v_y
-        dg::blas1::pointwiseDot( 1., chiyy_, tempy_, 1., y); //gyy*v_y
+        dg::blas1::pointwiseDot( chixy_, tempx_, tempx_); //gyx*v_x
+        dg::blas1::pointwiseDot( 1., chiyy_, tempy_, 1., tempx_); //gyy*v_y
 
-        //now take divergence
-        dg::blas2::gemv( leftx, gradx_, tempx_);  
-        dg::blas2::gemv( lefty, y, tempy_);  
-        dg::blas1::axpby( -1., tempx_, -1., tempy_, y); //-D_xx - D_yy 
+        //now take divergence and accumulate directly into y
+        dg::blas2::symv( -1., leftx, gradx_, 0., y);  
+        dg::blas2::symv( -1., lefty, tempx_, 1., y); //-D_xx - D_yy 
         if( no_ == normed)
             dg::geo::divideVolume( y, g_);
 
         //add jump terms
-        dg::blas2::symv( jumpX, x, tempx_);
-        dg::blas1::axpby( +1., tempx_, 1., y, y); 
-        dg::blas2::symv( jumpY, x, tempy_);
-        dg::blas1::axpby( +1., tempy_, 1., y, y); 
+        dg::blas2::symv( 1., jumpX, x, 1., y);
+        dg::blas2::symv( 1., jumpY, x, 1., y);
         if( no_ == not_normed)//multiply weights without volume
             dg::blas2::symv( weights_wo_vol, y, y);
     }
@@ -9,6 +9,7 @@
 #include "backend/grid.h"
 #include "backend/evaluation.cuh"
 #include "backend/functions.h"
+#include "backend/histogram.h"
 /*!@file
  * Functors to use in dg::evaluate or dg::blas1::transform functions
  */
@@ -1345,6 +1346,9 @@ struct ZERO
 
 /**
  * @brief Compute a histogram on a 1D grid
+ *
+ * The input is binned in parallel and not stored, see dg::StreamingHistogram
+ * for histograms accumulated over many batches
  * @tparam container 
  */ 
 template <class container = thrust::host_vector<double> >
@@ -1357,21 +1361,13 @@ struct Histogram
      */
     Histogram(const dg::Grid1d& g1d, const std::vector<double>& in) :
     g1d_(g1d),
-    in_(in),
-    binwidth_(g1d_.h()),
-    count_(dg::evaluate(dg::zero,g1d_))
+    binwidth_(g1d_.h())
     {
-        for (unsigned j=0;j<in_.size();j++)
-        {            
-            unsigned bin =floor( (in_[j]-g1d_.x0())/binwidth_ );
-            bin = std::max(bin,(unsigned) 0);
-            bin = std::min(bin,(unsigned)(g1d_.size()-1));
-            count_[bin ]+=1.;
-        }
+        StreamingHistogram histogram( (HistogramBins(g1d_)));
+        histogram.add( in);
         //Normalize
-        unsigned Ampmax = (unsigned)thrust::reduce( count_.begin(), count_.end(),0.,   thrust::maximum<double>()  );
-        dg::blas1::scal(count_,1./Ampmax);
-        
+        const std::vector<double> count = histogram.normalized();
+        count_.assign( count.begin(), count.end());
     }
 
     /**
@@ -1397,13 +1393,15 @@ struct Histogram
 
     private:
     dg::Grid1d g1d_;
-    const std::vector<double> in_;
     double binwidth_;
     container  count_;
 };
 
 /**
  * @brief Compute a histogram on a 2D grid
+ *
+ * The input is binned in parallel and not stored, see dg::StreamingHistogram2D
+ * for histograms accumulated over many batches
  * @tparam container 
  */ 
 template <class container = thrust::host_vector<double> >
@@ -1417,29 +1415,16 @@ struct Histogram2D
      */
     Histogram2D(const dg::Grid2d& g2d, const std::vector<double>& inx,const std::vector<double>& iny) :
     g2d_(g2d),
-    inx_(inx),
-    iny_(iny),
     binwidthx_(g2d_.hx()),
     binwidthy_(g2d_.hy()),
     count_(dg::evaluate(dg::zero,g2d_))
     {
-
-        for (unsigned j=0;j<iny_.size();j++)
-        {
-            unsigned biny =floor((iny_[j]-g2d_.y0())/binwidthy_) ;
-            biny = std::max(biny,(unsigned) 0);
-            biny = std::min(biny,(unsigned)(g2d_.Ny()-1));
-
-            unsigned binx =floor((inx_[j]-g2d_.x0())/binwidthx_) ;
-            binx = std::max(binx,(unsigned) 0);
-            binx = std::min(binx,(unsigned)(g2d_.Nx()-1));
-            count_[biny*g2d_.Nx()+binx ]+=1.;
-            
-        }
+        StreamingHistogram2D histogram( HistogramBins( g2d_.x0(), g2d_.x1(), g2d_.Nx()), HistogramBins( g2d_.y0(), g2d_.y1(), g2d_.Ny()));
+        histogram.add( inx, iny);
         //Normalize
-        unsigned Ampmax =  (unsigned)thrust::reduce( count_.begin(),   count_.end(),0.,thrust::maximum<double>()  );   
-        dg::blas1::scal(count_,  1./Ampmax);
-
+        const double Ampmax = *std::max_element( histogram.counts().begin(), histogram.counts().end());
+        for( unsigned i=0; i<histogram.counts().size(); i++)
+            count_[i] = histogram.counts()[i]/Ampmax;
     }
 
     /**
@@ -1463,7 +1448,6 @@ struct Histogram2D
     }
     private:
     dg::Grid2d g2d_;
-    const std::vector<double> inx_,iny_;
     double binwidthx_,binwidthy_;
     container count_;
 };
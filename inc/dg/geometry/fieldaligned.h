@@ -2,6 +2,9 @@
 #include <cmath>
 #include <cusp/transpose.h>
 #include <cusp/csr_matrix.h>
+#include <cusp/coo_matrix.h>
+#include <thrust/for_each.h>
+#include <thrust/iterator/counting_iterator.h>
 
 #include "../backend/grid.h"
 #include "../blas.h"
@@ -180,6 +183,77 @@ void boxintegrator( Field& field, const Grid& grid,
         else if (globalbcz == dg::PER )std::cerr << "PER NOT IMPLEMENTED "<<std::endl;
     }
 }
+///@cond
+namespace detail{
+
+//computes the plus and the minus interpolation of one 3d row in one sweep
+struct PlusMinusSweep
+{
+    PlusMinusSweep( const int* rowP, const int* colP, const double* valP,
+                    const int* rowM, const int* colM, const double* valM,
+                    const double* f, double* fP, double* fM, int size, int Nz):
+        rowP_(rowP), colP_(colP), valP_(valP), rowM_(rowM), colM_(colM), valM_(valM),
+        f_(f), fP_(fP), fM_(fM), size_(size), Nz_(Nz){}
+    __host__ __device__
+    void operator()( int row) const
+    {
+        const int i0 = row/size_, r = row%size_;
+        const int ip = (i0==Nz_-1) ? 0:i0+1;
+        const int im = (i0==0) ? Nz_-1:i0-1;
+        double plus = 0, minus = 0;
+        for( int k=rowP_[r]; k<rowP_[r+1]; k++)
+            plus += valP_[k]*f_[ip*size_ + colP_[k]];
+        for( int k=rowM_[r]; k<rowM_[r+1]; k++)
+            minus += valM_[k]*f_[im*size_ + colM_[k]];
+        fP_[row] = plus;
+        fM_[row] = minus;
+    }
+    private:
+    const int *rowP_, *colP_;
+    const double *valP_;
+    const int *rowM_, *colM_;
+    const double *valM_;
+    const double* f_;
+    double *fP_, *fM_;
+    int size_, Nz_;
+};
+
+//assemble a 2d interpolation matrix that acts on the plane i0+shift into a 3d matrix
+//in the limiter region of the boundary plane the row is replaced by ghost*L*f_i0 + (1-L)*row
+cusp::csr_matrix<int, double, cusp::host_memory> planes3d( const cusp::csr_matrix<int, double, cusp::host_memory>& m2d, int shift, unsigned Nz, const thrust::host_vector<double>& limiter, double ghost, bool apply_limiter)
+{
+    const int size = m2d.num_rows;
+    const unsigned boundary = shift > 0 ? Nz-1 : 0;
+    cusp::coo_matrix<int, double, cusp::host_memory> A( Nz*size, Nz*size, Nz*m2d.num_entries + (apply_limiter ? size : 0));
+    unsigned e = 0;
+    for( unsigned i0=0; i0<Nz; i0++)
+    {
+        const unsigned j0 = (i0 + Nz + shift)%Nz;
+        const bool limited = apply_limiter && i0 == boundary;
+        for( int r=0; r<size; r++)
+        {
+            for( int k=m2d.row_offsets[r]; k<m2d.row_offsets[r+1]; k++)
+            {
+                A.row_indices[e] = i0*size + r;
+                A.column_indices[e] = j0*size + m2d.column_indices[k];
+                A.values[e] = limited ? (1.-limiter[r])*m2d.values[k] : m2d.values[k];
+                e++;
+            }
+            if( limited)
+            {
+                A.row_indices[e] = A.column_indices[e] = i0*size + r;
+                A.values[e] = ghost*limiter[r];
+                e++;
+            }
+        }
+    }
+    A.sort_by_row_and_column();
+    return cusp::csr_matrix<int, double, cusp::host_memory>( A);
+}
+
+}//namespace detail
+///@endcond
+
 ////////////////////////////////////FieldAlignedCLASS////////////////////////////////////////////
 /**
 * @brief Class for the evaluation of a parallel derivative
@@ -194,6 +268,7 @@ cylindrical coordinates
 template< class Geometry, class Matrix, class container >
 struct FieldAligned
 {
+    typedef Matrix InterpolationMatrix; //!< the matrix class of the interpolation matrices
 
     /**
     * @brief Construct from a field and a grid
@@ -325,7 +400,36 @@ struct FieldAligned
     * @param out output may not equal intpu
     */
     void einsMinusT( const container& in, container& out);
+    /**
+    * @brief Applies the interpolation to the next and to the previous planes in one sweep
+    *
+    * Same as einsPlus( in, plus) followed by einsMinus( in, minus)
+    * but reads the interpolation matrices and the input only once
+    * @param in input
+    * @param outP contains einsPlus(in) on output (may not equal in)
+    * @param outM contains einsMinus(in) on output (may not equal in)
+    */
+    void einsPlusMinus( const container& in, container& outP, container& outM);
+    /**
+    * @brief Assemble the interpolations as 3d matrices
+    *
+    * The ghost cells in the limiter region are contained as diagonal entries.
+    * The parts of the ghost cells that depend on the boundary values
+    * given in set_boundaries are not contained, i.e. the matrices
+    * are exact for zero boundary values.
+    * @param plus3d (write only) einsPlus
+    * @param minus3d (write only) einsMinus
+    * @param plusT3d (write only) einsPlusT
+    * @param minusT3d (write only) einsMinusT
+    */
+    void assemble( dg::IHMatrix& plus3d, dg::IHMatrix& minus3d, dg::IHMatrix& plusT3d, dg::IHMatrix& minusT3d) const;
 
+    /**
+    * @brief The boundary condition in the limiter region
+    *
+    * @return bcz as given in the constructor or the last call to set_boundaries
+    */
+    dg::bc bcz() const {return bcz_;}
     /**
     * @brief hz is the distance between the plus and minus planes
     *
@@ -353,6 +457,8 @@ struct FieldAligned
     private:
     typedef cusp::array1d_view< typename container::iterator> View;
     typedef cusp::array1d_view< typename container::const_iterator> cView;
+    void ghostPlus( const container& f, container& fpe); //ghost cells in the last plane
+    void ghostMinus( const container& f, container& fme); //ghost cells in the first plane
     Matrix plus, minus, plusT, minusT; //interpolation matrices
     container hz_, hp_,hm_, ghostM, ghostP;
     Geometry g_;
@@ -402,11 +508,12 @@ FieldAligned<Geometry, M,container>::FieldAligned(Field field, Geometry grid, do
         ym[0][i] = coordsM[0], ym[1][i] = coordsM[1], ym[2][i] = coordsM[2];
     }
     //fange Periodische RB ab
-    plus  = dg::create::interpolation( yp[0], yp[1], g2d, globalbcz);
-    minus = dg::create::interpolation( ym[0], ym[1], g2d, globalbcz);
-// //     Transposed matrices work only for csr_matrix due to bad matrix form for ell_matrix and MPI_Matrix lacks of transpose function!!!
-    cusp::transpose( plus, plusT);
-    cusp::transpose( minus, minusT);     
+    //build matrices and their transposes in one go
+    dg::IHMatrix interp, interpT;
+    interp = dg::create::interpolationCSR( yp[0], yp[1], g2d, globalbcz, interpT);
+    plus = interp, plusT = interpT;
+    interp = dg::create::interpolationCSR( ym[0], ym[1], g2d, globalbcz, interpT);
+    minus = interp, minusT = interpT;
 //     copy into h vectors
     for( unsigned i=0; i<grid.Nz(); i++)
     {
@@ -509,35 +616,15 @@ template< class G, class M, class container>
 void FieldAligned<G,M, container>::einsPlus( const container& f, container& fpe)
 {
     unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
-    View ghostPV( ghostP.begin(), ghostP.end());
-    View ghostMV( ghostM.begin(), ghostM.end());
-    cView rightV( right_.begin(), right_.end());
     for( unsigned i0=0; i0<g_.Nz(); i0++)
     {
         unsigned ip = (i0==g_.Nz()-1) ? 0:i0+1;
 
         cView fp( f.cbegin() + ip*size, f.cbegin() + (ip+1)*size);
-        cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
         View fP( fpe.begin() + i0*size, fpe.begin() + (i0+1)*size);
         cusp::multiply( plus, fp, fP);
-        //make ghostcells i.e. modify fpe in the limiter region
-        if( i0==g_.Nz()-1 && bcz_ != dg::PER)
-        {
-            if( bcz_ == dg::DIR || bcz_ == dg::NEU_DIR)
-            {
-                cusp::blas::axpby( rightV, f0, ghostPV, 2., -1.);
-            }
-            if( bcz_ == dg::NEU || bcz_ == dg::DIR_NEU)
-            {
-                thrust::transform( right_.begin(), right_.end(),  hp_.begin(), ghostM.begin(), thrust::multiplies<double>());
-                cusp::blas::axpby( ghostMV, f0, ghostPV, 1., 1.);
-            }
-            //interlay ghostcells with periodic cells: L*g + (1-L)*fpe
-            cusp::blas::axpby( ghostPV, fP, ghostPV, 1., -1.);
-            dg::blas1::pointwiseDot( limiter_, ghostP, ghostP);
-            cusp::blas::axpby(  ghostPV, fP, fP, 1.,1.);
-        }
     }
+    ghostPlus( f, fpe);
 }
 
 template< class G,class M, class container>
@@ -545,71 +632,45 @@ void FieldAligned<G,M, container>::einsMinus( const container& f, container& fme
 {
     //note that thrust functions don't work on views
     unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
-    View ghostPV( ghostP.begin(), ghostP.end());
-    View ghostMV( ghostM.begin(), ghostM.end());
-    cView leftV( left_.begin(), left_.end());
     for( unsigned i0=0; i0<g_.Nz(); i0++)
     {
         unsigned im = (i0==0) ? g_.Nz()-1:i0-1;
         cView fm( f.cbegin() + im*size, f.cbegin() + (im+1)*size);
-        cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
         View fM( fme.begin() + i0*size, fme.begin() + (i0+1)*size);
         cusp::multiply( minus, fm, fM );
-        //make ghostcells
-        if( i0==0 && bcz_ != dg::PER)
-        {
-            if( bcz_ == dg::DIR || bcz_ == dg::DIR_NEU)
-            {
-                cusp::blas::axpby( leftV,  f0, ghostMV, 2., -1.);
-            }
-            if( bcz_ == dg::NEU || bcz_ == dg::NEU_DIR)
-            {
-                thrust::transform( left_.begin(), left_.end(),  hm_.begin(), ghostP.begin(), thrust::multiplies<double>());
-                cusp::blas::axpby( ghostPV, f0, ghostMV, -1., 1.);
-            }
-            //interlay ghostcells with periodic cells: L*g + (1-L)*fme
-            cusp::blas::axpby( ghostMV, fM, ghostMV, 1., -1.);
-            dg::blas1::pointwiseDot( limiter_, ghostM, ghostM);
-            cusp::blas::axpby( ghostMV, fM, fM, 1., 1.);
-
-        }
     }
+    ghostMinus( f, fme);
+}
+
+template< class G,class M, class container>
+void FieldAligned<G,M, container>::einsPlusMinus( const container& f, container& fpe, container& fme)
+{
+    assert( &f != &fpe && &f != &fme);
+    const int size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
+    detail::PlusMinusSweep sweep(
+        thrust::raw_pointer_cast( &plus.row_offsets[0]), thrust::raw_pointer_cast( &plus.column_indices[0]), thrust::raw_pointer_cast( &plus.values[0]),
+        thrust::raw_pointer_cast( &minus.row_offsets[0]), thrust::raw_pointer_cast( &minus.column_indices[0]), thrust::raw_pointer_cast( &minus.values[0]),
+        thrust::raw_pointer_cast( &f[0]), thrust::raw_pointer_cast( &fpe[0]), thrust::raw_pointer_cast( &fme[0]), size, g_.Nz());
+    //run in the memory space of the container
+    typedef thrust::counting_iterator<int, typename thrust::iterator_system<typename container::iterator>::type> Counter;
+    thrust::for_each( Counter(0), Counter(size*g_.Nz()), sweep);
+    ghostPlus( f, fpe);
+    ghostMinus( f, fme);
 }
 
 template< class G,class M, class container>
 void FieldAligned<G,M, container>::einsMinusT( const container& f, container& fpe)
 {
     unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
-    View ghostPV( ghostP.begin(), ghostP.end());
-    View ghostMV( ghostM.begin(), ghostM.end());
-    cView rightV( right_.begin(), right_.end());
     for( unsigned i0=0; i0<g_.Nz(); i0++)
     {
         unsigned ip = (i0==g_.Nz()-1) ? 0:i0+1;
 
         cView fp( f.cbegin() + ip*size, f.cbegin() + (ip+1)*size);
-        cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
         View fP( fpe.begin() + i0*size, fpe.begin() + (i0+1)*size);
         cusp::multiply( minusT, fp, fP );
-        //make ghostcells i.e. modify fpe in the limiter region
-        if( i0==g_.Nz()-1 && bcz_ != dg::PER)
-        {
-            if( bcz_ == dg::DIR || bcz_ == dg::NEU_DIR)
-            {
-                cusp::blas::axpby( rightV, f0, ghostPV, 2., -1.);
-            }
-            if( bcz_ == dg::NEU || bcz_ == dg::DIR_NEU)
-            {
-                thrust::transform( right_.begin(), right_.end(),  hp_.begin(), ghostM.begin(), thrust::multiplies<double>());
-                cusp::blas::axpby( ghostMV, f0, ghostPV, 1., 1.);
-            }
-            //interlay ghostcells with periodic cells: L*g + (1-L)*fpe
-            cusp::blas::axpby( ghostPV, fP, ghostPV, 1., -1.);
-            dg::blas1::pointwiseDot( limiter_, ghostP, ghostP);
-            cusp::blas::axpby(  ghostPV, fP, fP, 1.,1.);
-        }
-
     }
+    ghostPlus( f, fpe);
 }
 
 template< class G,class M, class container>
@@ -617,35 +678,83 @@ void FieldAligned<G,M, container>::einsPlusT( const container& f, container& fme
 {
     //note that thrust functions don't work on views
     unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
-    View ghostPV( ghostP.begin(), ghostP.end());
-    View ghostMV( ghostM.begin(), ghostM.end());
-    cView leftV( left_.begin(), left_.end());
     for( unsigned i0=0; i0<g_.Nz(); i0++)
     {
         unsigned im = (i0==0) ? g_.Nz()-1:i0-1;
         cView fm( f.cbegin() + im*size, f.cbegin() + (im+1)*size);
-        cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
         View fM( fme.begin() + i0*size, fme.begin() + (i0+1)*size);
         cusp::multiply( plusT, fm, fM );
-        //make ghostcells
-        if( i0==0 && bcz_ != dg::PER)
-        {
-            if( bcz_ == dg::DIR || bcz_ == dg::DIR_NEU)
-            {
-                cusp::blas::axpby( leftV,  f0, ghostMV, 2., -1.);
-            }
-            if( bcz_ == dg::NEU || bcz_ == dg::NEU_DIR)
-            {
-                thrust::transform( left_.begin(), left_.end(),  hm_.begin(), ghostP.begin(), thrust::multiplies<double>());
-                cusp::blas::axpby( ghostPV, f0, ghostMV, -1., 1.);
-            }
-            //interlay ghostcells with periodic cells: L*g + (1-L)*fme
-            cusp::blas::axpby( ghostMV, fM, ghostMV, 1., -1.);
-            dg::blas1::pointwiseDot( limiter_, ghostM, ghostM);
-            cusp::blas::axpby( ghostMV, fM, fM, 1., 1.);
+    }
+    ghostMinus( f, fme);
+}
 
-        }
+template< class G,class M, class container>
+void FieldAligned<G,M, container>::ghostPlus( const container& f, container& fpe)
+{
+    //make ghostcells i.e. modify fpe in the limiter region
+    if( bcz_ == dg::PER) return;
+    unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
+    unsigned i0 = g_.Nz()-1;
+    View ghostPV( ghostP.begin(), ghostP.end());
+    View ghostMV( ghostM.begin(), ghostM.end());
+    cView rightV( right_.begin(), right_.end());
+    cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
+    View fP( fpe.begin() + i0*size, fpe.begin() + (i0+1)*size);
+    if( bcz_ == dg::DIR || bcz_ == dg::NEU_DIR)
+    {
+        cusp::blas::axpby( rightV, f0, ghostPV, 2., -1.);
+    }
+    if( bcz_ == dg::NEU || bcz_ == dg::DIR_NEU)
+    {
+        thrust::transform( right_.begin(), right_.end(),  hp_.begin(), ghostM.begin(), thrust::multiplies<double>());
+        cusp::blas::axpby( ghostMV, f0, ghostPV, 1., 1.);
+    }
+    //interlay ghostcells with periodic cells: L*g + (1-L)*fpe
+    cusp::blas::axpby( ghostPV, fP, ghostPV, 1., -1.);
+    dg::blas1::pointwiseDot( limiter_, ghostP, ghostP);
+    cusp::blas::axpby(  ghostPV, fP, fP, 1.,1.);
+}
+
+template< class G,class M, class container>
+void FieldAligned<G,M, container>::ghostMinus( const container& f, container& fme)
+{
+    //make ghostcells i.e. modify fme in the limiter region
+    if( bcz_ == dg::PER) return;
+    unsigned size = g_.n()*g_.n()*g_.Nx()*g_.Ny();
+    unsigned i0 = 0;
+    View ghostPV( ghostP.begin(), ghostP.end());
+    View ghostMV( ghostM.begin(), ghostM.end());
+    cView leftV( left_.begin(), left_.end());
+    cView f0( f.cbegin() + i0*size, f.cbegin() + (i0+1)*size);
+    View fM( fme.begin() + i0*size, fme.begin() + (i0+1)*size);
+    if( bcz_ == dg::DIR || bcz_ == dg::DIR_NEU)
+    {
+        cusp::blas::axpby( leftV,  f0, ghostMV, 2., -1.);
     }
+    if( bcz_ == dg::NEU || bcz_ == dg::NEU_DIR)
+    {
+        thrust::transform( left_.begin(), left_.end(),  hm_.begin(), ghostP.begin(), thrust::multiplies<double>());
+        cusp::blas::axpby( ghostPV, f0, ghostMV, -1., 1.);
+    }
+    //interlay ghostcells with periodic cells: L*g + (1-L)*fme
+    cusp::blas::axpby( ghostMV, fM, ghostMV, 1., -1.);
+    dg::blas1::pointwiseDot( limiter_, ghostM, ghostM);
+    cusp::blas::axpby( ghostMV, fM, fM, 1., 1.);
+}
+
+template< class G,class M, class container>
+void FieldAligned<G,M, container>::assemble( dg::IHMatrix& plus3d, dg::IHMatrix& minus3d, dg::IHMatrix& plusT3d, dg::IHMatrix& minusT3d) const
+{
+    const dg::IHMatrix p( plus), m( minus), pT( plusT), mT( minusT);
+    thrust::host_vector<double> limiter( limiter_.begin(), limiter_.end());
+    //linear part of the ghost cell: -f0 for Dirichlet and +f0 for Neumann conditions
+    const double signP = ( bcz_ == dg::DIR || bcz_ == dg::NEU_DIR) ? -1. : 1.; //last plane
+    const double signM = ( bcz_ == dg::DIR || bcz_ == dg::DIR_NEU) ? -1. : 1.; //first plane
+    const bool apply = bcz_ != dg::PER;
+    plus3d   = detail::planes3d( p,  +1, g_.Nz(), limiter, signP, apply);
+    minus3d  = detail::planes3d( m,  -1, g_.Nz(), limiter, signM, apply);
+    plusT3d  = detail::planes3d( pT, -1, g_.Nz(), limiter, signM, apply);
+    minusT3d = detail::planes3d( mT, +1, g_.Nz(), limiter, signP, apply);
 }
 
 ///@endcond 
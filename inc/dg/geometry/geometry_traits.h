@@ -1,6 +1,10 @@
 #pragma once
 
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/zip_iterator.h>
 #include "../blas1.h"
+#include "../exceptions.h"
 
 namespace dg
 {
@@ -44,6 +48,106 @@ struct HostVec< MPITag>
 namespace geo{
 namespace detail{
 
+//Metric coefficients of toroidally symmetric grids may be stored as a 2d vector only.
+//The following pointwise operations broadcast such a vector m to all planes of x and y
+template<class value_type>
+struct PlaneAxpby
+{
+    PlaneAxpby( value_type alpha, value_type beta): alpha_(alpha), beta_(beta){}
+    __host__ __device__
+        value_type operator()( const value_type& m, const value_type& x) const
+        {
+            return alpha_*m*x;
+        }
+    __host__ __device__
+        value_type operator()( const value_type& m, const thrust::tuple<value_type, value_type>& xy) const
+        {
+            return alpha_*m*thrust::get<0>(xy) + beta_*thrust::get<1>(xy);
+        }
+  private:
+    value_type alpha_, beta_;
+};
+template<class container>
+void doPointwiseDotPlanes( double alpha, const container& m, const container& x, double beta, container& y, ThrustVectorTag)
+{
+    typedef typename container::value_type value_type;
+    const unsigned size = m.size(), planes = x.size()/m.size();
+    for( unsigned k=0; k<planes; k++)
+    {
+        if( beta == 0)
+            thrust::transform( m.begin(), m.end(), x.begin()+k*size, y.begin()+k*size, PlaneAxpby<value_type>( alpha, 0.));
+        else
+            thrust::transform( m.begin(), m.end(),
+                    thrust::make_zip_iterator( thrust::make_tuple( x.begin()+k*size, y.begin()+k*size)),
+                    y.begin()+k*size, PlaneAxpby<value_type>( alpha, beta));
+    }
+}
+template<class container>
+void doPointwiseDividePlanes( const container& x, const container& m, container& y, ThrustVectorTag)
+{
+    typedef typename container::value_type value_type;
+    const unsigned size = m.size(), planes = x.size()/m.size();
+    for( unsigned k=0; k<planes; k++)
+        thrust::transform( x.begin()+k*size, x.begin()+(k+1)*size, m.begin(), y.begin()+k*size, thrust::divides<value_type>());
+}
+//x must consist of whole planes of the size of m
+template<class container>
+void checkPlanes( const container& m, const container& x)
+{
+    if( m.size() == 0 || x.size()%m.size() != 0)
+        throw dg::Ooops( "Error: size of the vector is not a multiple of the plane size!");
+}
+#ifdef MPI_VERSION
+template<class container>
+void doPointwiseDotPlanes( double alpha, const container& m, const container& x, double beta, container& y, MPIVectorTag)
+{
+    typedef typename container::container_type local;
+    doPointwiseDotPlanes( alpha, m.data(), x.data(), beta, y.data(), typename VectorTraits<local>::vector_category());
+}
+template<class container>
+void doPointwiseDividePlanes( const container& x, const container& m, container& y, MPIVectorTag)
+{
+    typedef typename container::container_type local;
+    doPointwiseDividePlanes( x.data(), m.data(), y.data(), typename VectorTraits<local>::vector_category());
+}
+#endif //MPI_VERSION
+//y = alpha*m*x + beta*y, m may be a 2d vector and x, y 3d vectors
+template<class container>
+void pointwiseDotPlanes( double alpha, const container& m, const container& x, double beta, container& y)
+{
+    if( m.size() == x.size())
+        dg::blas1::pointwiseDot( alpha, m, x, beta, y);
+    else
+    {
+        checkPlanes( m, x);
+        doPointwiseDotPlanes( alpha, m, x, beta, y, typename VectorTraits<container>::vector_category());
+    }
+}
+//y = m*x, m may be a 2d vector and x, y 3d vectors
+template<class container>
+void pointwiseDotPlanes( const container& m, const container& x, container& y)
+{
+    if( m.size() == x.size())
+        dg::blas1::pointwiseDot( m, x, y);
+    else
+    {
+        checkPlanes( m, x);
+        doPointwiseDotPlanes( 1., m, x, 0., y, typename VectorTraits<container>::vector_category());
+    }
+}
+//y = x/m, m may be a 2d vector and x, y 3d vectors
+template<class container>
+void pointwiseDividePlanes( const container& x, const container& m, container& y)
+{
+    if( m.size() == x.size())
+        dg::blas1::pointwiseDivide( x, m, y);
+    else
+    {
+        checkPlanes( m, x);
+        doPointwiseDividePlanes( x, m, y, typename VectorTraits<container>::vector_category());
+    }
+}
+
 template <class container, class Geometry>
 void doMultiplyVolume( container& inout, const Geometry& g, OrthonormalTag)
 {
@@ -52,7 +156,7 @@ void doMultiplyVolume( container& inout, const Geometry& g, OrthonormalTag)
 template <class container, class Geometry>
 void doMultiplyVolume( container& inout, const Geometry& g, CurvilinearTag)
 {
-    dg::blas1::pointwiseDot( inout, g.vol(), inout);
+    pointwiseDotPlanes( g.vol(), inout, inout);
 };
 template <class container, class Geometry>
 void doDivideVolume( container& inout, const Geometry& g, OrthonormalTag)
@@ -62,7 +166,7 @@ void doDivideVolume( container& inout, const Geometry& g, OrthonormalTag)
 template <class container, class Geometry>
 void doDivideVolume( container& inout, const Geometry& g, CurvilinearTag)
 {
-    dg::blas1::pointwiseDivide( inout, g.vol(), inout);
+    pointwiseDividePlanes( inout, g.vol(), inout);
 };
 
 template <class container, class Geometry>
@@ -73,7 +177,7 @@ void doMultiplyPerpVolume( container& inout, const Geometry& g, OrthonormalCylin
 template <class container, class Geometry>
 void doMultiplyPerpVolume( container& inout, const Geometry& g, CurvilinearCylindricalTag)
 {
-    dg::blas1::pointwiseDot( inout, g.perpVol(), inout);
+    pointwiseDotPlanes( g.perpVol(), inout, inout);
 };
 
 template <class container, class Geometry>
@@ -84,7 +188,7 @@ void doDividePerpVolume( container& inout, const Geometry& g, OrthonormalCylindr
 template <class container, class Geometry>
 void doDividePerpVolume( container& inout, const Geometry& g, CurvilinearCylindricalTag)
 {
-    dg::blas1::pointwiseDivide( inout, g.perpVol(), inout);
+    pointwiseDividePlanes( inout, g.perpVol(), inout);
 };
 
 template <class container, class Geometry>
@@ -96,16 +200,16 @@ void doRaisePerpIndex( container& in1, container& in2, container& out1, containe
 template <class container, class Geometry>
 void doRaisePerpIndex( container& in1, container& in2, container& out1, container& out2, const Geometry& g, OrthogonalTag)
 {
-    dg::blas1::pointwiseDot( g.g_xx(), in1, out1); //gxx*v_x
-    dg::blas1::pointwiseDot( g.g_yy(), in2, out2); //gyy*v_y
+    pointwiseDotPlanes( g.g_xx(), in1, out1); //gxx*v_x
+    pointwiseDotPlanes( g.g_yy(), in2, out2); //gyy*v_y
 };
 template <class container, class Geometry>
 void doRaisePerpIndex( container& in1, container& in2, container& out1, container& out2, const Geometry& g, CurvilinearCylindricalTag)
 {
-    dg::blas1::pointwiseDot( g.g_xx(), in1, out1); //gxx*v_x
-    dg::blas1::pointwiseDot( g.g_xy(), in1, out2); //gyx*v_x
-    dg::blas1::pointwiseDot( 1., g.g_xy(), in2, 1., out1);//gxy*v_y
-    dg::blas1::pointwiseDot( 1., g.g_yy(), in2, 1., out2); //gyy*v_y
+    pointwiseDotPlanes( g.g_xx(), in1, out1); //gxx*v_x
+    pointwiseDotPlanes( g.g_xy(), in1, out2); //gyx*v_x
+    pointwiseDotPlanes( 1., g.g_xy(), in2, 1., out1);//gxy*v_y
+    pointwiseDotPlanes( 1., g.g_yy(), in2, 1., out2); //gyy*v_y
 };
 
 template <class container, class Geometry>
@@ -117,20 +221,20 @@ void doVolRaisePerpIndex( container& in1, container& in2, container& out1, conta
 template <class container, class Geometry>
 void doVolRaisePerpIndex( container& in1, container& in2, container& out1, container& out2, const Geometry& g, OrthogonalTag)
 {
-    dg::blas1::pointwiseDot( g.g_xx(), in1, out1); //gxx*v_x
-    dg::blas1::pointwiseDot( g.g_yy(), in2, out2); //gyy*v_y
-    dg::blas1::pointwiseDot( out1, g.perpVol(), out1);
-    dg::blas1::pointwiseDot( out2, g.perpVol(), out2);
+    pointwiseDotPlanes( g.g_xx(), in1, out1); //gxx*v_x
+    pointwiseDotPlanes( g.g_yy(), in2, out2); //gyy*v_y
+    pointwiseDotPlanes( g.perpVol(), out1, out1);
+    pointwiseDotPlanes( g.perpVol(), out2, out2);
 };
 template <class container, class Geometry>
 void doVolRaisePerpIndex( container& in1, container& in2, container& out1, container& out2, const Geometry& g, CurvilinearCylindricalTag)
 {
-    dg::blas1::pointwiseDot( g.g_xx(), in1, out1); //gxx*v_x
-    dg::blas1::pointwiseDot( g.g_xy(), in1, out2); //gyx*v_x
-    dg::blas1::pointwiseDot( 1., g.g_xy(), in2, 1., out1);//gxy*v_y
-    dg::blas1::pointwiseDot( 1., g.g_yy(), in2, 1., out2); //gyy*v_y
-    dg::blas1::pointwiseDot( out1, g.perpVol(), out1);
-    dg::blas1::pointwiseDot( out2, g.perpVol(), out2);
+    pointwiseDotPlanes( g.g_xx(), in1, out1); //gxx*v_x
+    pointwiseDotPlanes( g.g_xy(), in1, out2); //gyx*v_x
+    pointwiseDotPlanes( 1., g.g_xy(), in2, 1., out1);//gxy*v_y
+    pointwiseDotPlanes( 1., g.g_yy(), in2, 1., out2); //gyy*v_y
+    pointwiseDotPlanes( g.perpVol(), out1, out1);
+    pointwiseDotPlanes( g.perpVol(), out2, out2);
 };
 
 
@@ -154,10 +258,10 @@ void doPushForwardPerp( TernaryOp1 f1, TernaryOp2 f2,
     out1 = pullback( f1, g);
     out2 = pullback( f2, g);
     container temp1( out1), temp2( out2);
-    dg::blas1::pointwiseDot( g.xr(), temp1, out1);
-    dg::blas1::pointwiseDot( 1., g.xz(), temp2, 1., out1);
-    dg::blas1::pointwiseDot( g.yr(), temp1, out2);
-    dg::blas1::pointwiseDot( 1., g.yz(), temp2, 1., out2);
+    pointwiseDotPlanes( g.xr(), temp1, out1);
+    pointwiseDotPlanes( 1., g.xz(), temp2, 1., out1);
+    pointwiseDotPlanes( g.yr(), temp1, out2);
+    pointwiseDotPlanes( 1., g.yz(), temp2, 1., out2);
 }
 
 template<class FunctorRR, class FunctorRZ, class FunctorZZ, class Geometry> 
@@ -184,8 +288,8 @@ void doPushForwardPerp( FunctorRR chiRR_, FunctorRZ chiRZ_, FunctorZZ chiZZ_,
     chixx = chiRR = pullback( chiRR_, g);
     chixy = chiRZ = pullback( chiRZ_, g);
     chiyy = chiZZ = pullback( chiZZ_, g);
-    //compute the transformation matrix
-    typename HostVec< typename GeometryTraits<Geometry>::memory_category>::host_vector t00(chixx), t01(t00), t02(t00), t10(t00), t11(t00), t12(t00), t20(t00), t21(t00), t22(t00);
+    //compute the transformation matrix (has the size of the metric)
+    typename HostVec< typename GeometryTraits<Geometry>::memory_category>::host_vector t00(g.xr()), t01(t00), t02(t00), t10(t00), t11(t00), t12(t00), t20(t00), t21(t00), t22(t00);
     dg::blas1::pointwiseDot( g.xr(), g.xr(), t00);
     dg::blas1::pointwiseDot( g.xr(), g.xz(), t01);
     dg::blas1::scal( t01, 2.);
@@ -201,15 +305,15 @@ void doPushForwardPerp( FunctorRR chiRR_, FunctorRZ chiRZ_, FunctorZZ chiZZ_,
     dg::blas1::scal( t21, 2.);
     dg::blas1::pointwiseDot( g.yz(), g.yz(), t22);
     //now multiply
-    dg::blas1::pointwiseDot(     t00, chiRR, chixx);
-    dg::blas1::pointwiseDot( 1., t01, chiRZ, 1., chixx);
-    dg::blas1::pointwiseDot( 1., t02, chiZZ, 1., chixx);
-    dg::blas1::pointwiseDot(     t10, chiRR, chixy);
-    dg::blas1::pointwiseDot( 1., t11, chiRZ, 1., chixy);
-    dg::blas1::pointwiseDot( 1., t12, chiZZ, 1., chixy);
-    dg::blas1::pointwiseDot(     t20, chiRR, chiyy);
-    dg::blas1::pointwiseDot( 1., t21, chiRZ, 1., chiyy);
-    dg::blas1::pointwiseDot( 1., t22, chiZZ, 1., chiyy);
+    pointwiseDotPlanes(     t00, chiRR, chixx);
+    pointwiseDotPlanes( 1., t01, chiRZ, 1., chixx);
+    pointwiseDotPlanes( 1., t02, chiZZ, 1., chixx);
+    pointwiseDotPlanes(     t10, chiRR, chixy);
+    pointwiseDotPlanes( 1., t11, chiRZ, 1., chixy);
+    pointwiseDotPlanes( 1., t12, chiZZ, 1., chixy);
+    pointwiseDotPlanes(     t20, chiRR, chiyy);
+    pointwiseDotPlanes( 1., t21, chiRZ, 1., chiyy);
+    pointwiseDotPlanes( 1., t22, chiZZ, 1., chiyy);
 
 }
 
@@ -220,6 +324,23 @@ void doPushForwardPerp( FunctorRR chiRR_, FunctorRZ chiRZ_, FunctorZZ chiZZ_,
 namespace create{
 namespace detail{
 
+//w = vol*w or w = w/vol on the host, vol may be a 2d vector and w a 3d vector
+inline void volumePlanes( const thrust::host_vector<double>& vol, thrust::host_vector<double>& w, bool divide)
+{
+    const unsigned size = vol.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<(int)w.size(); i++)
+        w[i] = divide ? w[i]/vol[i%size] : vol[i%size]*w[i];
+}
+#ifdef MPI_VERSION
+inline void volumePlanes( const MPI_Vector<thrust::host_vector<double> >& vol, MPI_Vector<thrust::host_vector<double> >& w, bool divide)
+{
+    volumePlanes( vol.data(), w.data(), divide);
+}
+#endif //MPI_VERSION
+
 template< class Geometry>
 typename HostVec< typename GeometryTraits<Geometry>::memory_category>::host_vector doCreateVolume( const Geometry& g, OrthonormalTag)
 {
@@ -238,7 +359,7 @@ typename HostVec< typename GeometryTraits<Geometry>::memory_category>::host_vect
     host_vector temp, vol;
     dg::blas1::transfer( dg::create::weights( g), temp);
     dg::blas1::transfer( g.vol(), vol); //g.vol might be on device
-    dg::blas1::pointwiseDot( vol, temp, temp);
+    volumePlanes( vol, temp, false);
     return temp;
 }
 
@@ -249,7 +370,7 @@ typename HostVec< typename GeometryTraits<Geometry>::memory_category>::host_vect
     host_vector temp, vol;
     dg::blas1::transfer( dg::create::inv_weights( g), temp);
     dg::blas1::transfer( g.vol(), vol); //g.vol might be on device
-    dg::blas1::pointwiseDivide( temp, vol, temp);
+    volumePlanes( vol, temp, true);
     return temp;
 }
 
@@ -274,8 +395,12 @@ template< class BinaryOp, class Geometry>
 thrust::host_vector<double> doPullback( BinaryOp f, const Geometry& g, CurvilinearTag, TwoDimensionalTag, SharedTag)
 {
     thrust::host_vector<double> vec( g.size());
-    for( unsigned i=0; i<g.size(); i++)
-        vec[i] = f( g.r()[i], g.z()[i]);
+    const thrust::host_vector<double>& r = g.r(), & z = g.z();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int i=0; i<(int)g.size(); i++)
+        vec[i] = f( r[i], z[i]);
     return vec;
 }
 
@@ -286,9 +411,15 @@ thrust::host_vector<double> doPullback( TernaryOp f, const Geometry& g, Curvilin
     unsigned size2d = g.n()*g.n()*g.Nx()*g.Ny();
     Grid1d gz( g.z0(), g.z1(), 1, g.Nz());
     thrust::host_vector<double> absz = create::abscissas( gz);
-    for( unsigned k=0; k<g.Nz(); k++)
-        for( unsigned i=0; i<size2d; i++)
-            vec[k*size2d+i] = f( g.r()[k*size2d+i], g.z()[k*size2d+i], absz[k]);
+    const thrust::host_vector<double>& r = g.r(), & z = g.z();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif //_OPENMP
+    for( int ki=0; ki<(int)(g.Nz()*size2d); ki++)
+    {
+        const unsigned k = ki/size2d, i = ki%size2d;
+        vec[ki] = f( r[i], z[i], absz[k]); //r and z are the same in every plane
+    }
     return vec;
 }
 template< class BinaryOp, class Geometry>
@@ -96,6 +96,7 @@ struct ZShifter
 template <class Geometry, class LocalMatrix, class Communicator, class LocalContainer>
 struct MPI_FieldAligned
 {
+    typedef LocalMatrix InterpolationMatrix; //!< the matrix class of the local interpolation matrices
     /**
     * @brief Construct from a field and a grid
     *
@@ -238,6 +239,26 @@ struct MPI_FieldAligned
     */
     void einsMinusT( const MPI_Vector<LocalContainer>& in, MPI_Vector<LocalContainer>& out);
     /**
+    * @brief Applies the interpolation to the next and to the previous planes
+    *
+    * Same as einsPlus( in, outP) followed by einsMinus( in, outM)
+    * @param in input
+    * @param outP contains einsPlus(in) on output (may not equal in)
+    * @param outM contains einsMinus(in) on output (may not equal in)
+    * @note the two interpolations need different communication patterns and are not fused
+    */
+    void einsPlusMinus( const MPI_Vector<LocalContainer>& in, MPI_Vector<LocalContainer>& outP, MPI_Vector<LocalContainer>& outM)
+    {
+        einsPlus( in, outP);
+        einsMinus( in, outM);
+    }
+    /**
+    * @brief The boundary condition in the limiter region
+    *
+    * @return bcz as given in the constructor or the last call to set_boundaries
+    */
+    dg::bc bcz() const {return bcz_;}
+    /**
     * @brief hz is the distance between the plus and minus planes
     *
     * @return three-dimensional vector
@@ -338,8 +359,9 @@ MPI_FieldAligned<MPIGeometry, LocalMatrix, CommunicatorXY, LocalContainer>::MPI_
     dg::blas1::transfer( cp.collect( yp[1]), pY);
 
     //construt interpolation matrix
-    plus = dg::create::interpolation( pX, pY, g2d.local(), globalbcz); //inner points hopefully never lie exactly on local boundary
-    cusp::transpose( plus, plusT);
+    dg::IHMatrix interp, interpT;
+    interp = dg::create::interpolationCSR( pX, pY, g2d.local(), globalbcz, interpT); //inner points hopefully never lie exactly on local boundary
+    plus = interp, plusT = interpT;
 
     //do the same for the minus z-plane
     for( unsigned i=0; i<pids.size(); i++)
@@ -355,8 +377,8 @@ MPI_FieldAligned<MPIGeometry, LocalMatrix, CommunicatorXY, LocalContainer>::MPI_
     commXYminus_ = cm;
     dg::blas1::transfer( cm.collect( ym[0]), pX);
     dg::blas1::transfer( cm.collect( ym[1]), pY);
-    minus = dg::create::interpolation( pX, pY, g2d.local(), globalbcz); //inner points hopefully never lie exactly on local boundary
-    cusp::transpose( minus, minusT);
+    interp = dg::create::interpolationCSR( pX, pY, g2d.local(), globalbcz, interpT); //inner points hopefully never lie exactly on local boundary
+    minus = interp, minusT = interpT;
     //copy to device
     for( unsigned i=0; i<g_.Nz(); i++)
     {
@@ -435,7 +457,7 @@ MPI_Vector<container> MPI_FieldAligned<G,M,C, container>::evaluate( BinaryOp bin
     {
         for( unsigned i0=0; i0<g_.Nz(); i0++)
         {
-            int idx = (int)(i0+coords[2]*g_.Nz())  - (int)p0;
+            int idx = (int)(i0+g_.offsetZ())  - (int)p0;
             if(idx>=0)
                 result[i0] = plus2d[idx];
             else
@@ -447,7 +469,7 @@ MPI_Vector<container> MPI_FieldAligned<G,M,C, container>::evaluate( BinaryOp bin
     {
         for( unsigned i0=0; i0<g_.global().Nz(); i0++)
         {
-            //int idx = (int)(i0+coords[2]*g_.Nz());
+            //int idx = (int)(i0+g_.offsetZ());
             unsigned revi0 = (g_.global().Nz() - i0)%g_.global().Nz(); //reverted index
             dg::blas1::axpby( 1., plus2d[i0], 0., result[i0]);
             dg::blas1::axpby( 1., minus2d[revi0], 1., result[i0]);
@@ -455,7 +477,7 @@ MPI_Vector<container> MPI_FieldAligned<G,M,C, container>::evaluate( BinaryOp bin
         dg::blas1::axpby( -1., init2d.data(), 1., result[0]);
         for(unsigned i0=0; i0<g_.Nz(); i0++)
         {
-            int idx = ((int)i0 + coords[2]*g_.Nz() -(int)p0 + g_.global().Nz())%g_.global().Nz(); //shift index
+            int idx = ((int)i0 + (int)g_.offsetZ() -(int)p0 + g_.global().Nz())%g_.global().Nz(); //shift index
             thrust::copy( result[idx].begin(), result[idx].end(), vec3d.data().begin() + i0*g2d.size());
         }
     }
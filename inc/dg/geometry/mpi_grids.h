@@ -70,7 +70,7 @@ struct CylindricalMPIGrid3d : public MPIGrid3d
         MPI_Comm planeComm;
         int remain_dims[] = {true,true,false}; //true true false
         MPI_Cart_sub( communicator(), remain_dims, &planeComm);
-        return dg::CartesianMPIGrid2d( global().x0(), global().x1(), global().y0(), global().y1(), global().n(), global().Nx(), global().Ny(), global().bcx(), global().bcy(), planeComm);
+        return dg::CartesianMPIGrid2d( dg::MPIGrid2d( global().x0(), global().x1(), global().y0(), global().y1(), global().n(), global().Nx(), global().Ny(), global().bcx(), global().bcy(), partitionX(), partitionY(), planeComm));
     }
     private:
     container R_;
@@ -110,7 +110,7 @@ MPI_Vector< thrust::host_vector<double> > doPullback( TernaryOp f, const Geometr
     thrust::host_vector<double> absz = create::abscissas( gz);
     for( unsigned k=0; k<g.Nz(); k++)
         for( unsigned i=0; i<size2d; i++)
-            vec[k*size2d+i] = f( g.r().data()[k*size2d+i], g.z().data()[k*size2d+i], absz[k]);
+            vec[k*size2d+i] = f( g.r().data()[i], g.z().data()[i], absz[k]); //r and z are the same in every plane
     MPI_Vector<thrust::host_vector<double> > v( vec, g.communicator());
     return v;
 }
@@ -39,7 +39,7 @@ struct Helmholtz
     Helmholtz( Geometry g, double alpha = 1., direction dir = dg::forward, double jfactor=1.):
         laplaceM_(g, normed, dir, jfactor), 
         temp_(dg::evaluate(dg::one, g)), chi_(temp_),
-        alpha_(alpha), isSet(false)
+        alpha_(alpha), isSet(false), ws_(0)
     { 
     }
     /**
@@ -56,7 +56,7 @@ struct Helmholtz
     Helmholtz( Geometry g, bc bcx, bc bcy, double alpha = 1., direction dir = dg::forward, double jfactor=1.):
         laplaceM_(g, bcx,bcy,normed, dir, jfactor), 
         temp_(dg::evaluate(dg::one, g)), chi_(temp_),
-        alpha_(alpha), isSet(false)
+        alpha_(alpha), isSet(false), ws_(0)
     { 
     }
     /**
@@ -70,6 +70,7 @@ struct Helmholtz
      */
     void symv( Vector& x, Vector& y) 
     {
+        WorkspaceLoan<Vector> loan( ws_, temp_);
         if( isSet)
             blas1::pointwiseDot( chi_, x, temp_);
         else
@@ -121,11 +122,24 @@ struct Helmholtz
      * @return chi
      */
     const Vector& chi() const{return chi_;}
+    /**
+     * @brief Borrow temporaries from a shared Workspace instead of owning them
+     *
+     * Frees the private temporaries of this and the underlying Elliptic operator
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<Vector>& ws)
+    {
+        ws_ = &ws;
+        laplaceM_.set_workspace( ws);
+        detail::free_memory( temp_);
+    }
   private:
     Elliptic<Geometry, Matrix, Vector> laplaceM_;
     Vector temp_, chi_;
     double alpha_;
     bool isSet;
+    Workspace<Vector>* ws_;
 };
 
 /**
@@ -159,7 +173,7 @@ struct Helmholtz2
     Helmholtz2( Geometry g, double alpha = 1., direction dir = dg::forward, double jfactor=1.):
         laplaceM_(g, normed, dir, jfactor), 
         temp1_(dg::evaluate(dg::one, g)),temp2_(temp1_), chi_(temp1_),
-        alpha_(alpha), isSet(false)
+        alpha_(alpha), isSet(false), ws_(0)
     { 
     }
     /**
@@ -176,7 +190,7 @@ struct Helmholtz2
     Helmholtz2( Geometry g, bc bcx, bc bcy, double alpha = 1., direction dir = dg::forward, double jfactor=1.):
         laplaceM_(g, bcx,bcy,normed, dir, jfactor), 
         temp1_(dg::evaluate(dg::one, g)), temp2_(temp1_),chi_(temp1_),
-        alpha_(alpha), isSet(false)
+        alpha_(alpha), isSet(false), ws_(0)
     { 
     }
     /**
@@ -190,6 +204,7 @@ struct Helmholtz2
      */
     void symv( Vector& x, Vector& y) 
     {
+        WorkspaceLoan<Vector> loan( ws_, temp1_, temp2_);
         if( alpha_ != 0)
         {
             blas2::symv( laplaceM_, x, temp1_); // temp1_ = -nabla_perp^2 x
@@ -245,11 +260,24 @@ struct Helmholtz2
      * @return chi
      */
     const Vector& chi()const {return chi_;}
+    /**
+     * @brief Borrow temporaries from a shared Workspace instead of owning them
+     *
+     * Frees the private temporaries of this and the underlying Elliptic operator
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<Vector>& ws)
+    {
+        ws_ = &ws;
+        laplaceM_.set_workspace( ws);
+        detail::free_memory( temp1_), detail::free_memory( temp2_);
+    }
   private:
     Elliptic<Geometry, Matrix, Vector> laplaceM_;
     Vector temp1_, temp2_, chi_;
     double alpha_;
     bool isSet;
+    Workspace<Vector>* ws_;
 };
 ///@cond
 template< class G, class M, class V>
@@ -73,6 +73,16 @@ int main()
     dg::Helmholtz< dg::CartesianGrid2d, dg::DMatrix, dg::DVec > maxwell( grid, alpha);
     invert( maxwell, x_, rho);
 
+    std::cout << "SHARED WORKSPACE:\n";
+    dg::DVec x_ws(rho.size(), 0.);
+    dg::Workspace<dg::DVec> ws( x_ws);
+    dg::Invert<dg::DVec> invert_ws( x_ws, grid.size(), eps);
+    dg::Helmholtz< dg::CartesianGrid2d, dg::DMatrix, dg::DVec > maxwell_ws( grid, alpha);
+    invert_ws.set_workspace( ws);
+    maxwell_ws.set_workspace( ws);
+    invert_ws( maxwell_ws, x_ws, rho);
+    std::cout << "# buffers in workspace "<<ws.size()<<" (should be 7)\n";
+
     //std::cout << "THIRD METHOD:\n";
     //dg::DVec x__(rho.size(), 0.);
     //Diffusion<dg::DVec> diffusion( grid, 1.);
@@ -84,12 +94,14 @@ int main()
     //Evaluation
     dg::blas1::axpby( 1., sol, -1., x);
     dg::blas1::axpby( 1., sol, -1., x_);
+    dg::blas1::axpby( 1., sol, -1., x_ws);
     //dg::blas1::axpby( 1., sol, -1., x__);
 
     std::cout << "number of iterations:  "<<number<<std::endl;
     std::cout << "ALL METHODS SHOULD DO THE SAME!\n";
     std::cout << "error1 " << sqrt( dg::blas2::dot( w2d, x))<<std::endl;
     std::cout << "error2 " << sqrt( dg::blas2::dot( w2d, x_))<<std::endl;
+    std::cout << "error ws " << sqrt( dg::blas2::dot( w2d, x_ws))<<std::endl;
     //std::cout << "error3 " << sqrt( dg::blas2::dot( w2d, x__))<<std::endl;
     std::cout << "Test 3d cylincdrical norm:\n";
     dg::CylindricalGrid3d<dg::DVec> g3d( R_0, R_0+lx, 0, ly, 0,lz, n, Nx, Ny,Nz, bcx, dg::PER, dg::PER);
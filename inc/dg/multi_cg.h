@@ -0,0 +1,449 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "blas.h"
+#include "functors.h"
+#include "cg.h"
+
+/*!@file
+ * Conjugate gradient for several right hand sides of the same operator
+ */
+
+namespace dg{
+
+///@cond
+namespace detail{
+//result[i] = x[i]*w[i]*y[i] (w[i] == 0 means unweighted) with a single reduction in MPI
+template<class container, class Tag>
+void multi_dot( const std::vector<const container*>& x, const std::vector<const container*>& w, const std::vector<const container*>& y, std::vector<double>& result, Tag)
+{
+    result.resize( x.size());
+    for( unsigned i=0; i<x.size(); i++)
+        result[i] = (w[i] == 0) ? blas1::dot( *x[i], *y[i]) : blas2::dot( *x[i], *w[i], *y[i]);
+}
+#ifdef MPI_VERSION
+template<class container>
+void multi_dot( const std::vector<const container*>& x, const std::vector<const container*>& w, const std::vector<const container*>& y, std::vector<double>& result, MPIVectorTag)
+{
+    result.assign( x.size(), 0.);
+    if( x.empty()) return;
+    std::vector<double> local( x.size(), 0.);
+    for( unsigned i=0; i<x.size(); i++)
+        local[i] = (w[i] == 0) ? blas1::dot( x[i]->data(), y[i]->data()) : blas2::dot( x[i]->data(), w[i]->data(), y[i]->data());
+    MPI_Allreduce( &local[0], &result[0], x.size(), MPI_DOUBLE, MPI_SUM, x[0]->communicator());
+}
+#endif //MPI_VERSION
+
+//y[i] = A x[i]; matrices that can apply themselves to several vectors read their data only once
+template<class Matrix, class container>
+void multi_symv( Matrix& A, const std::vector<const container*>& x, const std::vector<container*>& y)
+{
+    for( unsigned i=0; i<x.size(); i++)
+        blas2::symv( A, *x[i], *y[i]);
+}
+template<class T>
+void multi_symv( EllSparseBlockMat<T>& A, const std::vector<const thrust::host_vector<T>*>& x, const std::vector<thrust::host_vector<T>*>& y)
+{
+    A.symv( 1., x, 0., y);
+}
+template<class T>
+void multi_symv( const EllSparseBlockMat<T>& A, const std::vector<const thrust::host_vector<T>*>& x, const std::vector<thrust::host_vector<T>*>& y)
+{
+    A.symv( 1., x, 0., y);
+}
+template<class T, class container>
+void multi_symv( EllSparseBlockMatDevice<T>& A, const std::vector<const container*>& x, const std::vector<container*>& y)
+{
+    A.symv( 1., x, 0., y);
+}
+template<class T, class container>
+void multi_symv( const EllSparseBlockMatDevice<T>& A, const std::vector<const container*>& x, const std::vector<container*>& y)
+{
+    A.symv( 1., x, 0., y);
+}
+}//namespace detail
+///@endcond
+
+/**
+* @brief Preconditioned conjugate gradient for several systems with the same operator
+*
+* @ingroup invert
+* The systems \f$ A x_i = b_i\f$ are iterated in lockstep, such that all scalar products
+* of one iteration are computed in two fused reductions (two MPI_Allreduce for all
+* systems instead of three per system) and the operator is applied to all
+* search directions together. An EllSparseBlockMat(Device) then reads its blocks only once
+* for all systems; any other operator (e.g. Elliptic) is applied to them back to back.
+* Converged systems drop out of the iteration.
+* Every system gets the same result and the same number of iterations as with CG.
+* @tparam container The Vector class to be used
+*/
+template< class container>
+struct MultiCG
+{
+    typedef typename VectorTraits<container>::value_type value_type;//!< value type of the container class
+    /**
+     * @brief Allocate nothing
+     */
+    MultiCG(){}
+    /**
+     * @brief Reserve memory for the pcg method
+     *
+     * @param copyable A container must be copy-constructible from this
+     * @param number Number of systems to solve simultaneously
+     * @param max_iter Maximum number of iterations to be used
+     */
+    MultiCG( const container& copyable, unsigned number, unsigned max_iter){
+        construct( copyable, number, max_iter);
+    }
+    /**
+     * @brief Set internal storage and maximum number of iterations
+     *
+     * @param copyable A container must be copy-constructible from this
+     * @param number Number of systems to solve simultaneously
+     * @param max_iterations Maximum number of iterations to be used
+     */
+    void construct( const container& copyable, unsigned number, unsigned max_iterations)
+    {
+        r_.assign( number, copyable);
+        p_ = ap_ = r_;
+        max_iter_ = max_iterations;
+    }
+    /**
+     * @brief Set the maximum number of iterations
+     *
+     * @param new_max New maximum number
+     */
+    void set_max( unsigned new_max) {max_iter_ = new_max;}
+    /**
+     * @brief Get the current maximum number of iterations
+     *
+     * @return the current maximum
+     */
+    unsigned get_max() const {return max_iter_;}
+    /**
+     * @brief Number of systems
+     *
+     * @return the number given in the constructor
+     */
+    unsigned number() const {return r_.size();}
+    /**
+     * @brief Number of iterations of every system in the last call
+     *
+     * @return vector of size number()
+     */
+    const std::vector<unsigned>& iterations() const {return iter_;}
+    /**
+     * @brief Solve the systems A*x_i = b_i using a preconditioned conjugate gradient method
+     *
+     * The iteration stops for system i if \f$ ||Ax_i-b_i||_S < \epsilon( ||b_i||_S + C) \f$
+     @tparam Matrix The matrix class: no requirements except for the BLAS routines
+     @tparam Preconditioner no requirements except for the blas routines
+     * @param A A symmetric positive definit matrix
+     * @param x Contains initial values on input and the solutions on output (size number())
+     * @param b The right hand sides (size number()), x[i] and b[i] may be the same vector
+     * @param P The preconditioner to be used
+     * @param S Weights used to compute the norm for the error condition
+     * @param eps The relative error to be respected
+     * @param nrmb_correction Correction factor C for norm of b
+     *
+     * @return Maximum number of iterations over all systems
+     */
+    template< class Matrix, class Preconditioner>
+    unsigned operator()( Matrix& A, const std::vector<container*>& x, const std::vector<const container*>& b, Preconditioner& P, const container& S, value_type eps = 1e-12, value_type nrmb_correction = 1);
+  private:
+    void reduce( const std::vector<unsigned>& active, unsigned which, const container* w, const std::vector<container>& v, std::vector<double>& result);
+    std::vector<container> r_, p_, ap_;
+    std::vector<unsigned> iter_;
+    unsigned max_iter_;
+};
+
+///@cond
+//compute r_i*w*v_i (which==0), ap_i*w*v_i (which==1) or p_i*w*v_i (which==2) for all active systems
+template< class container>
+void MultiCG<container>::reduce( const std::vector<unsigned>& active, unsigned which, const container* w, const std::vector<container>& v, std::vector<double>& result)
+{
+    std::vector<const container*> x( active.size()), ws( active.size(), w), y( active.size());
+    for( unsigned k=0; k<active.size(); k++)
+    {
+        unsigned i = active[k];
+        x[k] = which == 0 ? &r_[i] : ( which == 1 ? &ap_[i] : &p_[i]);
+        y[k] = &v[i];
+    }
+    detail::multi_dot( x, ws, y, result, typename VectorTraits<container>::vector_category());
+}
+
+template< class container>
+template< class Matrix, class Preconditioner>
+unsigned MultiCG<container>::operator()( Matrix& A, const std::vector<container*>& x, const std::vector<const container*>& b, Preconditioner& P, const container& S, value_type eps, value_type nrmb_correction)
+{
+    assert( x.size() == number() && b.size() == number());
+    const unsigned num = number();
+    iter_.assign( num, 0);
+    std::vector<double> nrmb( num), nrmzr_old( num), result;
+    std::vector<unsigned> active;
+    //norm of all right hand sides in one reduction
+    {
+        std::vector<const container*> ws( num, &S);
+        detail::multi_dot( b, ws, b, result, typename VectorTraits<container>::vector_category());
+    }
+    std::vector<const container*> in;
+    std::vector<container*> out;
+    for( unsigned i=0; i<num; i++)
+    {
+        nrmb[i] = sqrt( result[i]);
+        if( nrmb[i] == 0)
+            blas1::copy( *b[i], *x[i]);
+        else
+        {
+            in.push_back( x[i]), out.push_back( &r_[i]);
+            active.push_back( i);
+        }
+    }
+    detail::multi_symv( A, in, out);
+    for( unsigned k=0; k<active.size(); k++)
+        blas1::axpby( 1., *b[active[k]], -1., r_[active[k]]);
+    std::vector<unsigned> still;
+    reduce( active, 0, &S, r_, result);
+    for( unsigned k=0; k<active.size(); k++)
+    {
+        unsigned i = active[k];
+        if( sqrt( result[k]) >= eps*(nrmb[i] + nrmb_correction)) //else x happens to be the solution
+        {
+            blas2::symv( P, r_[i], p_[i]);
+            still.push_back( i);
+        }
+    }
+    active.swap( still);
+    reduce( active, 2, 0, r_, result); //p_i*r_i
+    for( unsigned k=0; k<active.size(); k++)
+        nrmzr_old[active[k]] = result[k];
+    std::vector<double> alpha( num);
+    for( unsigned iter=1; iter<max_iter_; iter++)
+    {
+        if( active.empty()) break;
+        in.resize( active.size()), out.resize( active.size());
+        for( unsigned k=0; k<active.size(); k++)
+            in[k] = &p_[active[k]], out[k] = &ap_[active[k]];
+        detail::multi_symv( A, in, out);
+        reduce( active, 2, 0, ap_, result); //p_i*ap_i
+        for( unsigned k=0; k<active.size(); k++)
+        {
+            unsigned i = active[k];
+            alpha[i] = nrmzr_old[i]/result[k];
+            blas1::axpby( alpha[i], p_[i], 1., *x[i]);
+            blas1::axpby( -alpha[i], ap_[i], 1., r_[i]);
+            blas2::symv( P, r_[i], ap_[i]);
+        }
+        //fuse the error norms and the new scalar products into one reduction
+        std::vector<const container*> xs, ws, ys;
+        for( unsigned k=0; k<active.size(); k++)
+        {
+            unsigned i = active[k];
+            xs.push_back( &r_[i]), ws.push_back( &S), ys.push_back( &r_[i]);
+            xs.push_back( &ap_[i]), ws.push_back( 0), ys.push_back( &r_[i]);
+        }
+        detail::multi_dot( xs, ws, ys, result, typename VectorTraits<container>::vector_category());
+        still.clear();
+        for( unsigned k=0; k<active.size(); k++)
+        {
+            unsigned i = active[k];
+            if( sqrt( result[2*k]) < eps*(nrmb[i] + nrmb_correction))
+            {
+                iter_[i] = iter;
+                continue;
+            }
+            double nrmzr_new = result[2*k+1];
+            blas1::axpby( 1., ap_[i], nrmzr_new/nrmzr_old[i], p_[i]);
+            nrmzr_old[i] = nrmzr_new;
+            still.push_back( i);
+        }
+        active.swap( still);
+    }
+    for( unsigned k=0; k<active.size(); k++)
+        iter_[active[k]] = max_iter_;
+    unsigned max_number = 0;
+    for( unsigned i=0; i<num; i++)
+        max_number = std::max( max_number, iter_[i]);
+    return max_number;
+}
+///@endcond
+
+/**
+ * @brief Smart conjugate gradient solver for several right hand sides of the same operator
+ *
+ * @ingroup invert
+ * Does for every system what Invert does (extrapolation from the last three solutions
+ * and multiplication of the right hand side with the weights) but solves them
+ * together with MultiCG.
+ * @code
+ dg::MultiInvert<container> invert( omega, 2, max_iter, eps);
+ invert( invgamma, phi, rho, psi, sigma); //phi = Gamma^{-1} rho and psi = Gamma^{-1} sigma
+ * @endcode
+ * @tparam container The Vector class to be used
+ */
+template<class container>
+struct MultiInvert
+{
+    typedef typename VectorTraits<container>::value_type value_type;
+    /**
+     * @brief Allocate nothing
+     */
+    MultiInvert() { multiplyWeights_ = true; set_extrapolationType(2); nrmb_correction_ = 1.; }
+    /**
+     * @brief Constructor
+     *
+     * @param copyable Needed to construct the previous solutions
+     * @param number Number of systems solved together
+     * @param max_iter maximum iteration in conjugate gradient
+     * @param eps relative error in conjugate gradient
+     * @param extrapolationType number of last values to use for extrapolation of the current guess
+     * @param multiplyWeights if true the rhs shall be multiplied by the weights before cg is applied
+     * @param nrmb_correction Correction factor for norm of b (cf. CG)
+     */
+    MultiInvert(const container& copyable, unsigned number, unsigned max_iter, value_type eps, int extrapolationType = 2, bool multiplyWeights = true, value_type nrmb_correction = 1)
+    {
+        construct( copyable, number, max_iter, eps, extrapolationType, multiplyWeights, nrmb_correction);
+    }
+    /**
+     * @brief to be called after default constructor
+     *
+     * @param copyable Needed to construct the previous solutions
+     * @param number Number of systems solved together
+     * @param max_iter maximum iteration in conjugate gradient
+     * @param eps relative error in conjugate gradient
+     * @param extrapolationType number of last values to use for extrapolation of the current guess
+     * @param multiplyWeights if true the rhs shall be multiplied by the weights before cg is applied
+     * @param nrmb_correction Correction factor for norm of b (cf. CG)
+     */
+    void construct( const container& copyable, unsigned number, unsigned max_iter, value_type eps, int extrapolationType = 2, bool multiplyWeights = true, value_type nrmb_correction = 1.)
+    {
+        cg.construct( copyable, number, max_iter);
+        phi0.assign( number, copyable);
+        phi1 = phi2 = phi0;
+        eps_ = eps, nrmb_correction_ = nrmb_correction;
+        multiplyWeights_=multiplyWeights;
+        set_extrapolationType( extrapolationType);
+    }
+    /**
+     * @brief Set the extrapolation Type for following inversions
+     *
+     * @param extrapolationType number of last values to use for next extrapolation of initial guess
+     */
+    void set_extrapolationType( int extrapolationType)
+    {
+        assert( extrapolationType <= 3 && extrapolationType >= 0);
+        switch(extrapolationType)
+        {
+            case(0): alpha[0] = 0, alpha[1] = 0, alpha[2] = 0;
+                     break;
+            case(1): alpha[0] = 1, alpha[1] = 0, alpha[2] = 0;
+                     break;
+            case(2): alpha[0] = 2, alpha[1] = -1, alpha[2] = 0;
+                     break;
+            case(3): alpha[0] = 3, alpha[1] = -3, alpha[2] = 1;
+                     break;
+            default: alpha[0] = 2, alpha[1] = -1, alpha[2] = 0;
+        }
+    }
+    /**
+     * @brief Set the maximum number of iterations
+     *
+     * @param new_max New maximum number
+     */
+    void set_max( unsigned new_max) {cg.set_max( new_max);}
+    /**
+     * @brief Get the current maximum number of iterations
+     *
+     * @return the current maximum
+     */
+    unsigned get_max() const {return cg.get_max();}
+    /**
+     * @brief Number of systems
+     *
+     * @return the number given in the constructor
+     */
+    unsigned number() const {return cg.number();}
+    /**
+    * @brief Return last solution of a system
+    *
+    * @param i system number
+    */
+    const container& get_last( unsigned i) const { return phi0[i];}
+
+    /**
+     * @brief Solve linear problems
+     *
+     * Solves the Equations \f[ \hat O \phi_i = W\rho_i \f] using a preconditioned
+     * conjugate gradient method. The initial guesses come from an extrapolation
+     * of the last solutions
+     * @tparam SymmetricOp Symmetric operator with the SelfMadeMatrixTag
+        The functions weights() and precond() need to be callable and return
+        weights and the preconditioner for the conjugate gradient method.
+     * @param op selfmade symmetric Matrix operator class
+     * @param phi solutions (write only, size number())
+     * @param rho right-hand-sides (size number()), may not alias phi
+     *
+     * @return maximum number of iterations used
+     */
+    template< class SymmetricOp >
+    unsigned operator()( SymmetricOp& op, const std::vector<container*>& phi, const std::vector<const container*>& rho)
+    {
+        assert( phi.size() == number() && rho.size() == number());
+        container inv_weights( op.weights());
+        dg::blas1::transform( inv_weights, inv_weights, dg::INVERT<double>());
+        std::vector<const container*> rhs( rho);
+        for( unsigned i=0; i<number(); i++)
+        {
+            assert( rho[i] != phi[i]);
+            blas1::axpby( alpha[0], phi0[i], alpha[1], phi1[i], *phi[i]);
+            blas1::axpby( alpha[2], phi2[i], 1., *phi[i]);
+            if( multiplyWeights_ )
+            {
+                dg::blas2::symv( op.weights(), *rho[i], phi2[i]);
+                rhs[i] = &phi2[i];
+            }
+        }
+        unsigned iterations = cg( op, phi, rhs, op.precond(), inv_weights, eps_, nrmb_correction_);
+        for( unsigned i=0; i<number(); i++)
+        {
+            phi1[i].swap( phi2[i]);
+            phi0[i].swap( phi1[i]);
+            blas1::axpby( 1., *phi[i], 0, phi0[i]);
+        }
+        return iterations;
+    }
+    /**
+     * @brief Solve two linear problems
+     *
+     * @tparam SymmetricOp Symmetric operator with the SelfMadeMatrixTag
+     * @param op selfmade symmetric Matrix operator class
+     * @param phiA solution of first system (write only)
+     * @param rhoA right-hand-side of first system
+     * @param phiB solution of second system (write only)
+     * @param rhoB right-hand-side of second system
+     * @note number() must be 2
+     *
+     * @return maximum number of iterations used
+     */
+    template< class SymmetricOp >
+    unsigned operator()( SymmetricOp& op, container& phiA, const container& rhoA, container& phiB, const container& rhoB)
+    {
+        std::vector<container*> phi(2);
+        std::vector<const container*> rho(2);
+        phi[0] = &phiA, phi[1] = &phiB;
+        rho[0] = &rhoA, rho[1] = &rhoB;
+        return this->operator()( op, phi, rho);
+    }
+
+  private:
+    value_type eps_, nrmb_correction_;
+    std::vector<container> phi0, phi1, phi2;
+    dg::MultiCG< container > cg;
+    value_type alpha[3];
+    bool multiplyWeights_;
+};
+
+} //namespace dg
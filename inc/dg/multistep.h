@@ -269,6 +269,39 @@ struct Karniadakis
      * @return current head^
      */
     const Vector& last()const{return u_[1];}
+
+    /**
+     * @brief Return the last three solutions (for checkpointing)
+     *
+     * @return u_[0] is the head
+     */
+    const std::vector<Vector>& history_u()const{return u_;}
+    /**
+     * @brief Return the last three right hand sides (for checkpointing)
+     *
+     * @return f_[1] is the right hand side belonging to last()
+     */
+    const std::vector<Vector>& history_f()const{return f_;}
+    /**
+     * @brief Return the timestep given in init() or restart()
+     *
+     * @return timestep
+     */
+    double get_dt()const{return dt_;}
+    /**
+     * @brief Initialize with the history of a previous run instead of calling init()
+     *
+     * Restores the state of the integrator so that the next step is
+     * identical to the step of the run that wrote the history.
+     * @param u three solutions as returned by history_u()
+     * @param f three right hand sides as returned by history_f()
+     * @param dt The timestep saved for later use
+     */
+    void restart( const std::vector<Vector>& u, const std::vector<Vector>& f, double dt)
+    {
+        assert( u.size() == 3 && f.size() == 3);
+        u_ = u, f_ = f, dt_ = dt;
+    }
   private:
     std::vector<Vector> u_, f_; 
     CG< Vector> pcg;
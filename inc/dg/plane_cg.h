@@ -0,0 +1,325 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include <thrust/inner_product.h>
+#include <thrust/transform.h>
+#include <thrust/tuple.h>
+#include <thrust/iterator/zip_iterator.h>
+
+#include "blas.h"
+#include "functors.h"
+#include "backend/workspace.h"
+
+/*!@file
+ * Conjugate gradient for operators that decouple the z-planes of a 3d grid
+ */
+
+namespace dg{
+
+///@cond
+namespace detail{
+#ifdef MPI_VERSION
+//the communicator of the x-y plane a process belongs to
+//created once per (3d Cartesian) communicator and freed in the destructor
+struct PlaneComm
+{
+    PlaneComm(): in_( MPI_COMM_NULL), out_( MPI_COMM_NULL){}
+    //copies create their own sub-communicator on first use
+    PlaneComm( const PlaneComm&): in_( MPI_COMM_NULL), out_( MPI_COMM_NULL){}
+    PlaneComm& operator=( const PlaneComm&){ free(); return *this;}
+    ~PlaneComm(){ free();}
+    MPI_Comm get( MPI_Comm comm)
+    {
+        if( comm == in_) return out_;
+        free();
+        in_ = out_ = comm;
+        int status, ndims = 0;
+        MPI_Topo_test( comm, &status);
+        if( status == MPI_CART)
+            MPI_Cartdim_get( comm, &ndims);
+        if( ndims != 3) return out_;
+        int remain[3] = {1,1,0};
+        MPI_Cart_sub( comm, remain, &out_);
+        return out_;
+    }
+  private:
+    void free()
+    {
+        int finalized;
+        MPI_Finalized( &finalized);
+        if( !finalized && out_ != MPI_COMM_NULL && out_ != in_)
+            MPI_Comm_free( &out_);
+        in_ = out_ = MPI_COMM_NULL;
+    }
+    MPI_Comm in_, out_;
+};
+#else
+struct PlaneComm{};
+#endif //MPI_VERSION
+//result[j*planes+k] = x[j]*w[j]*y[j] restricted to plane k (w[j] == 0 means unweighted)
+//planes that are not active are skipped and get 0
+template<class Vector>
+void plane_dots( const std::vector<const Vector*>& x, const std::vector<const Vector*>& w, const std::vector<const Vector*>& y, const std::vector<bool>& active, std::vector<double>& result, PlaneComm&, ThrustVectorTag)
+{
+    typedef typename Vector::value_type value_type;
+    const unsigned planes = active.size();
+    result.assign( x.size()*planes, 0.);
+    for( unsigned j=0; j<x.size(); j++)
+    {
+        const unsigned size = x[j]->size()/planes;
+        for( unsigned k=0; k<planes; k++)
+        {
+            if( !active[k]) continue;
+            if( w[j] == 0)
+                result[j*planes+k] = thrust::inner_product(
+                        x[j]->begin()+k*size, x[j]->begin()+(k+1)*size,
+                        y[j]->begin()+k*size, value_type(0));
+            else
+                result[j*planes+k] = thrust::inner_product(
+                        x[j]->begin()+k*size, x[j]->begin()+(k+1)*size,
+                        thrust::make_zip_iterator( thrust::make_tuple( y[j]->begin()+k*size, w[j]->begin()+k*size)),
+                        value_type(0), thrust::plus<value_type>(),
+                        blas2::detail::ThrustVectorDoDot<Vector>());
+        }
+    }
+}
+//y = alpha[k]*x+beta[k]*y in every active plane k
+template<class Vector>
+void plane_axpby( const std::vector<double>& alpha, const Vector& x, const std::vector<double>& beta, Vector& y, const std::vector<bool>& active, ThrustVectorTag)
+{
+    typedef typename Vector::value_type value_type;
+    const unsigned planes = active.size();
+    const unsigned size = x.size()/planes;
+    for( unsigned k=0; k<planes; k++)
+    {
+        if( !active[k] || (alpha[k] == 0 && beta[k] == 1)) continue;
+        thrust::transform( x.begin()+k*size, x.begin()+(k+1)*size, y.begin()+k*size, y.begin()+k*size,
+                blas1::detail::Axpby_Functor<value_type>( alpha[k], beta[k]));
+    }
+}
+#ifdef MPI_VERSION
+//local plane dots followed by a single reduction over the plane communicator
+template<class Vector>
+void plane_dots( const std::vector<const Vector*>& x, const std::vector<const Vector*>& w, const std::vector<const Vector*>& y, const std::vector<bool>& active, std::vector<double>& result, PlaneComm& comm, MPIVectorTag)
+{
+    typedef typename Vector::container_type container_type;
+    std::vector<const container_type*> xl( x.size()), wl( x.size(), (const container_type*)0), yl( x.size());
+    for( unsigned j=0; j<x.size(); j++)
+    {
+        xl[j] = &x[j]->data(), yl[j] = &y[j]->data();
+        if( w[j] != 0) wl[j] = &w[j]->data();
+    }
+    std::vector<double> local;
+    plane_dots( xl, wl, yl, active, local, comm, typename VectorTraits<container_type>::vector_category());
+    result.assign( local.size(), 0.);
+    if( local.empty()) return;
+    MPI_Allreduce( &local[0], &result[0], local.size(), MPI_DOUBLE, MPI_SUM, comm.get( x[0]->communicator()));
+}
+template<class Vector>
+void plane_axpby( const std::vector<double>& alpha, const Vector& x, const std::vector<double>& beta, Vector& y, const std::vector<bool>& active, MPIVectorTag)
+{
+    typedef typename Vector::container_type container_type;
+    plane_axpby( alpha, x.data(), beta, y.data(), active, typename VectorTraits<container_type>::vector_category());
+}
+#endif //MPI_VERSION
+}//namespace detail
+///@endcond
+
+/**
+* @brief Preconditioned conjugate gradient for operators that act on every z-plane separately
+*
+* @ingroup invert
+* Perpendicular operators like Elliptic or Helmholtz on a 3d grid are block diagonal
+* in z, i.e. every plane is an independent 2d system. This class runs one CG per plane
+* on the whole 3d vector: the operator is still applied to all planes at once, but
+* scalar products, step sizes and the stopping criterion are computed per plane.
+* Planes that are converged are masked out of all further vector updates.
+* In MPI the scalar products are reduced over the x-y communicator only,
+* which is split off the vector's communicator once and freed with the object.
+* @tparam container The Vector class to be used (ThrustVectorTag or MPIVectorTag of it)
+* @attention The operator must not couple different z-planes
+*/
+template< class container>
+struct PlaneCG
+{
+    typedef typename VectorTraits<container>::value_type value_type;//!< value type of the container class
+    /**
+     * @brief Allocate nothing
+     */
+    PlaneCG(): ws_(0){}
+    /**
+     * @brief Reserve memory for the pcg method
+     *
+     * @param copyable A container must be copy-constructible from this
+     * @param planes Number of (local) z-planes contained in a vector
+     * @param max_iter Maximum number of iterations to be used
+     */
+    PlaneCG( const container& copyable, unsigned planes, unsigned max_iter): ws_(0){
+        construct( copyable, planes, max_iter);
+    }
+    /**
+     * @brief Set internal storage and maximum number of iterations
+     *
+     * @param copyable A container must be copy-constructible from this
+     * @param planes Number of (local) z-planes contained in a vector
+     * @param max_iterations Maximum number of iterations to be used
+     */
+    void construct( const container& copyable, unsigned planes, unsigned max_iterations)
+    {
+        if( ws_ == 0)
+            ap = p = r = copyable;
+        planes_ = planes;
+        max_iter = max_iterations;
+    }
+    /**
+     * @brief Borrow the three vectors r, p, ap from a shared Workspace instead of owning them
+     *
+     * @param ws must outlive this object
+     */
+    void set_workspace( Workspace<container>& ws)
+    {
+        ws_ = &ws;
+        detail::free_memory( r), detail::free_memory( p), detail::free_memory( ap);
+    }
+    /**
+     * @brief Set the maximum number of iterations
+     *
+     * @param new_max New maximum number
+     */
+    void set_max( unsigned new_max) {max_iter = new_max;}
+    /**
+     * @brief Get the current maximum number of iterations
+     *
+     * @return the current maximum
+     */
+    unsigned get_max() const {return max_iter;}
+    /**
+     * @brief Number of planes
+     *
+     * @return the number given in the constructor
+     */
+    unsigned planes() const {return planes_;}
+    /**
+     * @brief Number of iterations of every plane in the last call
+     *
+     * @return vector of size planes()
+     */
+    const std::vector<unsigned>& iterations() const {return iter_;}
+    /**
+     * @brief Solve the system A*x = b plane by plane using a preconditioned conjugate gradient method
+     *
+     * The iteration stops in plane k if \f$ ||Ax-b||_{S,k} < \epsilon( ||b||_{S,k} + C) \f$
+     * where the norms are restricted to plane k
+     @tparam Matrix The matrix class: no requirements except for the BLAS routines
+     @tparam Preconditioner no requirements except for the blas routines (must be diagonal)
+     * @param A A symmetric positive definit matrix that does not couple z-planes
+     * @param x Contains an initial value on input and the solution on output.
+     * @param b The right hand side vector. x and b may be the same vector.
+     * @param P The preconditioner to be used
+     * @param S Weights used to compute the norm for the error condition
+     * @param eps The relative error to be respected
+     * @param nrmb_correction Correction factor C for norm of b
+     *
+     * @return Maximum number of iterations over all planes
+     */
+    template< class Matrix, class Preconditioner>
+    unsigned operator()( Matrix& A, container& x, const container& b, Preconditioner& P, const container& S, value_type eps = 1e-12, value_type nrmb_correction = 1);
+  private:
+    void dots( const container& x0, const container* w0, const container& y0, const container& x1, const container* w1, const container& y1, std::vector<double>& result);
+    void dot( const container& x0, const container* w0, const container& y0, std::vector<double>& result);
+    container r, p, ap;
+    unsigned planes_, max_iter;
+    std::vector<unsigned> iter_;
+    std::vector<bool> active_;
+    Workspace<container>* ws_;
+    detail::PlaneComm comm_;
+};
+
+///@cond
+template< class container>
+void PlaneCG<container>::dot( const container& x0, const container* w0, const container& y0, std::vector<double>& result)
+{
+    std::vector<const container*> x( 1, &x0), w( 1, w0), y( 1, &y0);
+    detail::plane_dots( x, w, y, active_, result, comm_, typename VectorTraits<container>::vector_category());
+}
+template< class container>
+void PlaneCG<container>::dots( const container& x0, const container* w0, const container& y0, const container& x1, const container* w1, const container& y1, std::vector<double>& result)
+{
+    std::vector<const container*> x( 2), w( 2), y( 2);
+    x[0] = &x0, w[0] = w0, y[0] = &y0;
+    x[1] = &x1, w[1] = w1, y[1] = &y1;
+    detail::plane_dots( x, w, y, active_, result, comm_, typename VectorTraits<container>::vector_category());
+}
+
+template< class container>
+template< class Matrix, class Preconditioner>
+unsigned PlaneCG<container>::operator()( Matrix& A, container& x, const container& b, Preconditioner& P, const container& S, value_type eps, value_type nrmb_correction)
+{
+    WorkspaceLoan<container> loan( ws_, r, p, ap);
+    typename VectorTraits<container>::vector_category tag;
+    const unsigned planes = planes_;
+    iter_.assign( planes, 0);
+    active_.assign( planes, true);
+    std::vector<double> nrmb( planes), nrmzr_old( planes), result;
+    std::vector<double> zero( planes, 0.), one( planes, 1.), minus( planes, -1.);
+    std::vector<double> alpha( planes), beta( planes, 1.);
+    dot( b, &S, b, result);
+    std::vector<bool> vanish( planes);
+    for( unsigned k=0; k<planes; k++)
+    {
+        nrmb[k] = sqrt( result[k]);
+        vanish[k] = ( nrmb[k] == 0);
+        active_[k] = !vanish[k];
+    }
+    detail::plane_axpby( one, b, zero, x, vanish, tag); //x = b where b vanishes
+    if( std::find( active_.begin(), active_.end(), true) == active_.end())
+        return 0;
+    blas2::symv( A,x,r);
+    detail::plane_axpby( one, b, minus, r, active_, tag);
+    blas2::symv( P, r, p );//<-- compute p_0
+    dots( r, &S, r, p, 0, r, result);
+    for( unsigned k=0; k<planes; k++)
+    {
+        if( !active_[k]) continue;
+        if( sqrt( result[k]) < eps*(nrmb[k] + nrmb_correction)) //if x happens to be the solution
+            active_[k] = false;
+        nrmzr_old[k] = result[planes+k];
+    }
+    for( unsigned i=1; i<max_iter; i++)
+    {
+        if( std::find( active_.begin(), active_.end(), true) == active_.end())
+            break;
+        blas2::symv( A, p, ap);
+        dot( p, 0, ap, result);
+        for( unsigned k=0; k<planes; k++)
+            alpha[k] = active_[k] ? nrmzr_old[k]/result[k] : 0.;
+        detail::plane_axpby( alpha, p, one, x, active_, tag);
+        for( unsigned k=0; k<planes; k++)
+            alpha[k] = -alpha[k];
+        detail::plane_axpby( alpha, ap, one, r, active_, tag);
+        blas2::symv( P, r, ap);
+        dots( r, &S, r, ap, 0, r, result); //error norm and new scalar product in one reduction
+        for( unsigned k=0; k<planes; k++)
+        {
+            if( !active_[k]) continue;
+            if( sqrt( result[k]) < eps*(nrmb[k] + nrmb_correction))
+            {
+                iter_[k] = i;
+                active_[k] = false;
+                continue;
+            }
+            beta[k] = result[planes+k]/nrmzr_old[k];
+            nrmzr_old[k] = result[planes+k];
+        }
+        detail::plane_axpby( one, ap, beta, p, active_, tag);
+    }
+    for( unsigned k=0; k<planes; k++)
+        if( active_[k]) iter_[k] = max_iter;
+    return *std::max_element( iter_.begin(), iter_.end());
+}
+///@endcond
+
+} //namespace dg
@@ -6,6 +6,7 @@
 #include "enums.h"
 #include "backend/evaluation.cuh"
 #include "backend/derivatives.h"
+#include "backend/tiled_pipeline.h"
 #ifdef MPI_VERSION
 #include "backend/mpi_derivatives.h"
 #include "backend/mpi_evaluation.h"
@@ -117,10 +118,31 @@ struct Poisson
         blas1::pointwiseDot( 1., helper_, dyrhsrhs_,1., varphi );
     }
 
+    /**
+     * @brief Evaluate the bracket band by band of z-planes
+     *
+     * All derivatives and pointwise operations of the bracket are applied to
+     * one band of z-planes before the next band is touched (see TiledPipeline).
+     * The result is the same as without tiling. Has no effect for MPI containers.
+     * @param band_size number of z-planes per band, 0 switches tiling off (the default)
+     */
+    void set_tiling( unsigned band_size)
+    {
+        pipe_.clear();
+        if( band_size != 0)
+            build_pipeline( band_size, typename VectorTraits<container>::vector_category());
+    }
+
   private:
+    void build_pipeline( unsigned band_size, ThrustVectorTag);
+    void build_pipeline( unsigned band_size, MPIVectorTag){}
+    bool execute_pipeline( const container& lhs, const container& rhs, container& result, ThrustVectorTag);
+    bool execute_pipeline( const container& lhs, const container& rhs, container& result, MPIVectorTag){ return false;}
     container dxlhslhs_,dxrhsrhs_,dylhslhs_,dyrhsrhs_,helper_;
     Matrix dxlhs_, dylhs_,dxrhs_,dyrhs_;
     Geometry g_;
+    bc bcxlhs_, bcylhs_, bcxrhs_, bcyrhs_;
+    TiledPipeline<container> pipe_;
 };
 
 //idea: backward transform lhs and rhs and then use bdxf and bdyf , then forward transform
@@ -131,7 +153,8 @@ Poisson<Geometry, Matrix, container>::Poisson( Geometry g ):
     dxlhs_(dg::create::dx( g, g.bcx(),dg::centered)),
     dylhs_(dg::create::dy( g, g.bcy(),dg::centered)),
     dxrhs_(dg::create::dx( g, g.bcx(),dg::centered)),
-    dyrhs_(dg::create::dy( g, g.bcy(),dg::centered)),g_(g)
+    dyrhs_(dg::create::dy( g, g.bcy(),dg::centered)),g_(g),
+    bcxlhs_( g.bcx()), bcylhs_( g.bcy()), bcxrhs_( g.bcx()), bcyrhs_( g.bcy())
 { }
 
 template< class Geometry, class Matrix, class container>
@@ -140,7 +163,8 @@ Poisson<Geometry, Matrix, container>::Poisson( Geometry g, bc bcx, bc bcy):
     dxlhs_(dg::create::dx( g, bcx,dg::centered)),
     dylhs_(dg::create::dy( g, bcy,dg::centered)),
     dxrhs_(dg::create::dx( g, bcx,dg::centered)),
-    dyrhs_(dg::create::dy( g, bcy,dg::centered)),g_(g)
+    dyrhs_(dg::create::dy( g, bcy,dg::centered)),g_(g),
+    bcxlhs_( bcx), bcylhs_( bcy), bcxrhs_( bcx), bcyrhs_( bcy)
 { }
 
 template< class Geometry, class Matrix, class container>
@@ -149,12 +173,45 @@ Poisson<Geometry, Matrix, container>::Poisson(  Geometry g, bc bcxlhs, bc bcylhs
     dxlhs_(dg::create::dx( g, bcxlhs,dg::centered)),
     dylhs_(dg::create::dy( g, bcylhs,dg::centered)),
     dxrhs_(dg::create::dx( g, bcxrhs,dg::centered)),
-    dyrhs_(dg::create::dy( g, bcyrhs,dg::centered)),g_(g)
+    dyrhs_(dg::create::dy( g, bcyrhs,dg::centered)),g_(g),
+    bcxlhs_( bcxlhs), bcylhs_( bcylhs), bcxrhs_( bcxrhs), bcyrhs_( bcyrhs)
 { }
 
+template< class Geometry, class Matrix, class container>
+void Poisson<Geometry, Matrix, container>::build_pipeline( unsigned band_size, ThrustVectorTag)
+{
+    //the same stages as in operator(), slots: in(0) lhs, in(1) rhs,
+    //out(0) result, out(1) dxlhslhs, out(2) dylhslhs, out(3) dxrhsrhs, out(4) dyrhsrhs
+    EllSparseBlockMat<double> dyl = dg::create::dy( g_, bcylhs_, dg::centered);
+    pipe_ = TiledPipeline<container>( dyl.left_size, band_size); //dy.left_size is the number of z-planes
+    pipe_.symv( 1., dg::create::dx( g_, bcxlhs_, dg::centered), pipeline_in(0), 0., pipeline_out(1));
+    pipe_.symv( 1., dyl, pipeline_in(0), 0., pipeline_out(2));
+    pipe_.symv( 1., dg::create::dx( g_, bcxrhs_, dg::centered), pipeline_in(1), 0., pipeline_out(3));
+    pipe_.symv( 1., dg::create::dy( g_, bcyrhs_, dg::centered), pipeline_in(1), 0., pipeline_out(4));
+    pipe_.pointwiseDot( 1., pipeline_out(1), pipeline_out(4), 0., pipeline_out(0));
+    pipe_.pointwiseDot( -1., pipeline_out(2), pipeline_out(3), 1., pipeline_out(0));
+}
+
+template< class Geometry, class Matrix, class container>
+bool Poisson<Geometry, Matrix, container>::execute_pipeline( const container& lhs, const container& rhs, container& result, ThrustVectorTag)
+{
+    if( pipe_.stages() == 0) return false;
+    std::vector<const container*> in( 2);
+    std::vector<container*> out( 5);
+    in[0] = &lhs, in[1] = &rhs;
+    out[0] = &result, out[1] = &dxlhslhs_, out[2] = &dylhslhs_, out[3] = &dxrhsrhs_, out[4] = &dyrhsrhs_;
+    pipe_.execute( in, out);
+    return true;
+}
+
 template< class Geometry, class Matrix, class container>
 void Poisson< Geometry, Matrix, container>::operator()( const container& lhs, const container& rhs, container& result)
 {
+    if( execute_pipeline( lhs, rhs, result, typename VectorTraits<container>::vector_category()))
+    {
+        geo::dividePerpVolume( result, g_);
+        return;
+    }
     blas2::symv(  dxlhs_, lhs,  dxlhslhs_); //dx_lhs lhs
     blas2::symv(  dylhs_, lhs,  dylhslhs_); //dy_lhs lhs
     blas2::symv(  dxrhs_, rhs,  dxrhsrhs_); //dx_rhs rhs
@@ -463,6 +463,228 @@ void RK_classic<s, Vector>::operator()( Functor& f, const Vector& u0, Vector& u1
         blas1::axpby( dt*rk_classic<s>::b[i], k_[i],1., u1);
 }
 
+/*! @brief coefficients for low-storage (2N) explicit RK methods in Williamson form
+ *
+ * The stages are computed as
+ * \f[ \delta u_j = A_j \delta u_{j-1} + \Delta t f(u_{j-1}),\quad u_j = u_{j-1} + B_j \delta u_j \f]
+ * with \f$ A_0 = 0\f$ such that only \f$ u\f$ and \f$\delta u\f$ need to be stored.
+ * @tparam s # of stages of the method. Currently 3 (Williamson, 3rd order) and 5 (Carpenter-Kennedy, 4th order) are available
+ */
+template< size_t s>
+struct rk_2N
+{
+    static const double A[s]; //!< A
+    static const double B[s]; //!< B
+};
+///@cond
+//Williamson (J. Comput. Phys. 35, 1980), 3rd order
+template<>
+const double rk_2N<3>::A[3] = {
+    0., -5./9., -153./128.
+};
+template<>
+const double rk_2N<3>::B[3] = {
+    1./3., 15./16., 8./15.
+};
+//Carpenter and Kennedy (NASA TM 109112, 1994), LSRK4(5) 4th order
+template<>
+const double rk_2N<5>::A[5] = {
+    0.,
+    -567301805773./1357537059087.,
+    -2404267990393./2016746695238.,
+    -3550918686646./2091501179385.,
+    -1275806237668./842570457699.
+};
+template<>
+const double rk_2N<5>::B[5] = {
+    1432997174477./9575080441755.,
+    5161836677717./13612068292357.,
+    1720146321549./2090206949498.,
+    3134564353537./4481467310338.,
+    2277821191437./14882151754819.
+};
+///@endcond
+
+/**
+* @brief Struct for low-storage Runge-Kutta explicit time-integration
+* \f[
+ \begin{align}
+    \delta u_j &= A_j \delta u_{j-1} + \Delta t f\left( u_{j-1}\right) \\
+    u_j &= u_{j-1} + B_j \delta u_j
+ \end{align}
+\f]
+*
+* @ingroup time
+*
+* Uses only dg::blas1::axpby() routines to integrate one step.
+* In contrast to RK and RK_classic, which store s-1 or s copies of the state,
+* this class stores only two Vectors independent of the number of stages:
+* the increment \f$\delta u\f$ and the output of the right hand side.
+* @tparam s # of stages of the method (3 for 3rd order or 5 for 4th order)
+* @tparam Vector The argument type used in the Functor class
+*/
+template< size_t s, class Vector>
+struct RK_2N
+{
+    /**
+    * @brief Reserve memory for the integration
+    *
+    * @param copyable Vector of size which is used in integration.
+    * A Vector object must be copy-constructible from copyable.
+    */
+    RK_2N( const Vector& copyable): du_(copyable), k_(copyable){ }
+    /**
+    * @brief Advance u0 one timestep
+    *
+    * @tparam Functor models BinaryFunction with no return type (subroutine)
+        Its arguments both have to be of type Vector.
+        The first argument is the actual argument, The second contains
+        the return value, i.e. y' = f(y) translates to f( y, y').
+    * @param f right hand side function
+    * @param u0 initial value
+    * @param u1 contains result on output. u0 and u1 may currently not be the same.
+    * @param dt The timestep.
+    */
+    template< class Functor>
+    void operator()( Functor& f, const Vector& u0, Vector& u1, double dt);
+  private:
+    Vector du_, k_;
+};
+
+template< size_t s, class Vector>
+template< class Functor>
+void RK_2N<s, Vector>::operator()( Functor& f, const Vector& u0, Vector& u1, double dt)
+{
+    assert( &u0 != &u1);
+    u1 = u0;
+    f( u1, du_); //A[0] = 0
+    blas1::scal( du_, dt);
+    blas1::axpby( rk_2N<s>::B[0], du_, 1., u1);
+    for( unsigned i=1; i<s; i++)
+    {
+        f( u1, k_);
+        blas1::axpby( dt, k_, rk_2N<s>::A[i], du_);
+        blas1::axpby( rk_2N<s>::B[i], du_, 1., u1);
+    }
+}
+
+/**
+* @brief Struct for low-storage, strong stability preserving, second order explicit Runge-Kutta time-integration
+*
+* @ingroup time
+*
+* The s-stage method of Ketcheson (SIAM J. Sci. Comput. 30, 2008)
+* \f[
+ \begin{align}
+    u_0 &= u^n, \quad u_j = u_{j-1} + \frac{\Delta t}{s-1} f(u_{j-1}),\ j=1,\dots,s-1 \\
+    u^{n+1} &= \frac{1}{s}\left( u^n + (s-1) u_{s-1} + \Delta t f(u_{s-1})\right)
+ \end{align}
+\f]
+* has an effective SSP coefficient of \f$ (s-1)/s\f$ and stores, 
+* apart from u0 and u1, only one Vector for the output of the right hand side.
+* Uses only dg::blas1::axpby() routines to integrate one step.
+* @tparam s # of stages of the method (s>=2)
+* @tparam Vector The argument type used in the Functor class
+*/
+template< size_t s, class Vector>
+struct SSPRK_2S
+{
+    /**
+    * @brief Reserve memory for the integration
+    *
+    * @param copyable Vector of size which is used in integration.
+    * A Vector object must be copy-constructible from copyable.
+    */
+    SSPRK_2S( const Vector& copyable): k_(copyable){ }
+    /**
+    * @brief Advance u0 one timestep
+    *
+    * @tparam Functor models BinaryFunction with no return type (subroutine)
+        Its arguments both have to be of type Vector.
+        The first argument is the actual argument, The second contains
+        the return value, i.e. y' = f(y) translates to f( y, y').
+    * @param f right hand side function
+    * @param u0 initial value
+    * @param u1 contains result on output. u0 and u1 may currently not be the same.
+    * @param dt The timestep.
+    */
+    template< class Functor>
+    void operator()( Functor& f, const Vector& u0, Vector& u1, double dt)
+    {
+        assert( &u0 != &u1);
+        assert( s > 1);
+        u1 = u0;
+        for( unsigned i=1; i<s; i++)
+        {
+            f( u1, k_);
+            blas1::axpby( dt/(double)(s-1), k_, 1., u1);
+        }
+        f( u1, k_);
+        blas1::axpby( 1./(double)s, u0, (double)(s-1)/(double)s, u1);
+        blas1::axpby( dt/(double)s, k_, 1., u1);
+    }
+  private:
+    Vector k_;
+};
+
+/**
+* @brief Struct for low-storage, strong stability preserving, third order explicit Runge-Kutta time-integration
+*
+* @ingroup time
+*
+* The four stage method of Kraaijevanger 
+* \f[
+ \begin{align}
+    u_1 &= u^n + \frac{\Delta t}{2} f(u^n), \quad u_2 = u_1 + \frac{\Delta t}{2} f(u_1) \\
+    u_3 &= \frac{2}{3}u^n + \frac{1}{3}u_2 + \frac{\Delta t}{6} f(u_2), \quad u^{n+1} = u_3 + \frac{\Delta t}{2}f(u_3)
+ \end{align}
+\f]
+* has an SSP coefficient of 2 (effective 1/2) and stores, 
+* apart from u0 and u1, only one Vector for the output of the right hand side.
+* Uses only dg::blas1::axpby() routines to integrate one step.
+* @tparam Vector The argument type used in the Functor class
+*/
+template< class Vector>
+struct SSPRK_43
+{
+    /**
+    * @brief Reserve memory for the integration
+    *
+    * @param copyable Vector of size which is used in integration.
+    * A Vector object must be copy-constructible from copyable.
+    */
+    SSPRK_43( const Vector& copyable): k_(copyable){ }
+    /**
+    * @brief Advance u0 one timestep
+    *
+    * @tparam Functor models BinaryFunction with no return type (subroutine)
+        Its arguments both have to be of type Vector.
+        The first argument is the actual argument, The second contains
+        the return value, i.e. y' = f(y) translates to f( y, y').
+    * @param f right hand side function
+    * @param u0 initial value
+    * @param u1 contains result on output. u0 and u1 may currently not be the same.
+    * @param dt The timestep.
+    */
+    template< class Functor>
+    void operator()( Functor& f, const Vector& u0, Vector& u1, double dt)
+    {
+        assert( &u0 != &u1);
+        u1 = u0;
+        f( u1, k_);
+        blas1::axpby( dt/2., k_, 1., u1);
+        f( u1, k_);
+        blas1::axpby( dt/2., k_, 1., u1);
+        f( u1, k_);
+        blas1::axpby( 2./3., u0, 1./3., u1);
+        blas1::axpby( dt/6., k_, 1., u1);
+        f( u1, k_);
+        blas1::axpby( dt/2., k_, 1., u1);
+    }
+  private:
+    Vector k_;
+};
+
 /**
  * @brief Thrown by the integrateRK4 function if the rhs is badly conditioned
  */
@@ -48,6 +48,21 @@ struct RHS
     Vector_Type phi, temp;
 };
 
+//error of a stepper after integrating up to T in the given number of steps
+template< class Stepper>
+double error( Stepper& stepper, RHS<dg::DVec>& rhs, const dg::DVec& init, const dg::DVec& solution, const dg::DVec& w2d, unsigned steps)
+{
+    std::vector<dg::DVec> y0( 2, init), y1( y0);
+    const double dt = T/(double)steps;
+    for( unsigned i=0; i<steps; i++)
+    {
+        stepper( rhs, y0, y1, dt);
+        y0.swap( y1);
+    }
+    dg::blas1::axpby( 1., solution, -1., y0[0]);
+    return sqrt(dg::blas2::dot( w2d, y0[0]));
+}
+
 int main()
 {
     std::cout << "Type NT!\n";
@@ -81,6 +96,33 @@ int main()
     //n = 4 -> p = 3
     //n = 5 -> p = 5 
 
+    //low-storage integrators
+    std::vector<dg::DVec> y2( 2, init);
+    dg::RK_2N<5, std::vector<dg::DVec> > rk2N( y2);
+    for( unsigned i=0; i<NT; i++)
+    {
+        rk2N( rhs, y2, y1, dt);
+        y2.swap( y1);
+    }
+    dg::blas1::axpby( 1., solution, -1., y2[0]);
+    std::cout << "Norm of error RK_2N<5> is "<<sqrt(dg::blas2::dot( w2d, y2[0]))<<"\n";
+    y2.assign( 2, init);
+    dg::SSPRK_43<std::vector<dg::DVec> > ssprk( y2);
+    for( unsigned i=0; i<NT; i++)
+    {
+        ssprk( rhs, y2, y1, dt);
+        y2.swap( y1);
+    }
+    dg::blas1::axpby( 1., solution, -1., y2[0]);
+    std::cout << "Norm of error SSPRK_43 is "<<sqrt(dg::blas2::dot( w2d, y2[0]))<<"\n";
+    //convergence order: halving the timestep divides the error by 2^order
+    dg::SSPRK_2S<3, std::vector<dg::DVec> > ssprk2S( y2);
+    double e1 = error( ssprk2S, rhs, init, solution, w2d, NT), e2 = error( ssprk2S, rhs, init, solution, w2d, 2*NT);
+    std::cout << "Norm of error SSPRK_2S<3> is "<<e1<<" order "<<log(e1/e2)/log(2.)<<" (2)\n";
+    dg::RK_2N<3, std::vector<dg::DVec> > rk2N3( y2);
+    e1 = error( rk2N3, rhs, init, solution, w2d, NT), e2 = error( rk2N3, rhs, init, solution, w2d, 2*NT);
+    std::cout << "Norm of error RK_2N<3>    is "<<e1<<" order "<<log(e1/e2)/log(2.)<<" (3)\n";
+
 
     return 0;
 }
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <exception>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <stdint.h>
+#include "thrust/host_vector.h"
+
+#include "dg/blas1.h"
+/*!@file
+ *
+ * Contains binary checkpoint writer and reader for restarting simulations
+ */
+
+namespace file
+{
+
+/**
+ * @brief Class thrown by the checkpoint writer and reader
+ *
+ * @ingroup utilities
+ */
+struct Checkpoint_Error : public std::exception
+{
+    /**
+     * @brief Construct from error message
+     *
+     * @param message what went wrong
+     */
+    Checkpoint_Error( const std::string& message): message_( message) {}
+    ~Checkpoint_Error() throw(){}
+    /**
+     * @brief What string
+     *
+     * @return the error message
+     */
+    char const* what() const throw(){ return message_.c_str();}
+  private:
+    std::string message_;
+};
+
+///@cond
+namespace detail
+{
+static const char checkpoint_magic[8] = {'D','G','C','H','K','P','T','1'};
+}//namespace detail
+///@endcond
+
+/**
+ * @brief Append the process rank to a file name if MPI is used
+ *
+ * Each process writes its own local part of the vectors in a separate file
+ * @param base name of the checkpoint file
+ *
+ * @return base + ".rank" (MPI) or base (shared memory)
+ */
+inline std::string checkpoint_name( const std::string& base)
+{
+#ifdef MPI_VERSION
+    int rank;
+    MPI_Comm_rank( MPI_COMM_WORLD, &rank);
+    std::stringstream ss;
+    ss << base << "." << rank;
+    return ss.str();
+#else
+    return base;
+#endif //MPI_VERSION
+}
+
+/**
+ * @brief Write the state of a simulation into a binary checkpoint file
+ *
+ * The file consists of a header containing time, step and the parameter string
+ * followed by the raw vectors in the order of the write() calls.
+ * Data is first written to a temporary file, which replaces the checkpoint
+ * only in a successful close(). Thus, a job killed during output or a failed
+ * write leaves the previous checkpoint intact.
+ * @code
+ file::CheckpointWriter chk( file::checkpoint_name( "out.chk"), time, step, input);
+ chk.write( y0);
+ chk.write( karniadakis.history_u());
+ chk.close();
+ * @endcode
+ */
+struct CheckpointWriter
+{
+    /**
+     * @brief Open a temporary file and write the header
+     *
+     * @param filename name of the checkpoint file
+     * @param time current time
+     * @param step current step
+     * @param parameters the parameter string (e.g. the input file)
+     */
+    CheckpointWriter( const std::string& filename, double time, unsigned step, const std::string& parameters): filename_( filename), tmpname_( filename+".tmp"), os_( tmpname_.c_str(), std::ios::binary | std::ios::trunc), good_( false)
+    {
+        if( !os_.good())
+            throw Checkpoint_Error( "Cannot open checkpoint file "+tmpname_);
+        uint64_t st = step, size = parameters.size();
+        os_.write( detail::checkpoint_magic, 8);
+        os_.write( reinterpret_cast<const char*>(&time), sizeof(double));
+        os_.write( reinterpret_cast<const char*>(&st), sizeof(uint64_t));
+        os_.write( reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+        os_.write( parameters.data(), size);
+        good_ = os_.good();
+    }
+    /**
+     * @brief Append a vector to the checkpoint
+     *
+     * @tparam container a container that can be transferred to a thrust::host_vector<double>
+     * @param v vector to write
+     */
+    template<class container>
+    void write( const container& v)
+    {
+        good_ = false; //until the vector is completely written
+        dg::blas1::transfer( v, buffer_);
+        uint64_t size = buffer_.size();
+        os_.write( reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+        os_.write( reinterpret_cast<const char*>(thrust::raw_pointer_cast( buffer_.data())), size*sizeof(double));
+        if( !os_.good())
+            throw Checkpoint_Error( "Failed to write to checkpoint file "+tmpname_);
+        good_ = true;
+    }
+    /**
+     * @brief Append a vector of vectors to the checkpoint
+     *
+     * @tparam container a container that can be written with write()
+     * @param v vector to write
+     */
+    template<class container>
+    void write( const std::vector<container>& v)
+    {
+        good_ = false;
+        uint64_t size = v.size();
+        os_.write( reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+        for( unsigned i=0; i<v.size(); i++)
+            write( v[i]);
+        good_ = os_.good();
+    }
+#ifdef MPI_VERSION
+    /**
+     * @brief Append the local part of a distributed vector
+     *
+     * @tparam container the local container type
+     * @param v vector to write
+     */
+    template<class container>
+    void write( const dg::MPI_Vector<container>& v){ write( v.data());}
+#endif //MPI_VERSION
+    /**
+     * @brief Flush the file and replace any previous checkpoint
+     *
+     * Must be called explicitly: if a write failed or close() is never called
+     * (e.g. an exception unwinds the stack) the temporary file is removed
+     * and the previous checkpoint is kept.
+     */
+    void close()
+    {
+        if( !os_.is_open()) return;
+        os_.close();
+        if( !good_ || os_.fail())
+        {
+            std::remove( tmpname_.c_str());
+            throw Checkpoint_Error( "Incomplete checkpoint file "+tmpname_+" discarded");
+        }
+        if( std::rename( tmpname_.c_str(), filename_.c_str()) != 0)
+            throw Checkpoint_Error( "Cannot rename checkpoint file "+tmpname_);
+    }
+    ///Remove the temporary file unless close() succeeded
+    ~CheckpointWriter(){
+        if( !os_.is_open()) return;
+        os_.close();
+        std::remove( tmpname_.c_str());
+    }
+  private:
+    CheckpointWriter( const CheckpointWriter&);
+    CheckpointWriter& operator=( const CheckpointWriter&);
+    std::string filename_, tmpname_;
+    std::ofstream os_;
+    bool good_; //all writes so far succeeded
+    thrust::host_vector<double> buffer_;
+};
+
+/**
+ * @brief Read a checkpoint file written by CheckpointWriter
+ *
+ * Vectors have to be read in the same order they were written
+ * and need to have the correct size on input.
+ */
+struct CheckpointReader
+{
+    /**
+     * @brief Open file and read the header
+     *
+     * @param filename name of the checkpoint file
+     */
+    CheckpointReader( const std::string& filename): filename_( filename), is_( filename.c_str(), std::ios::binary)
+    {
+        if( !is_.good())
+            throw Checkpoint_Error( "Cannot open checkpoint file "+filename_);
+        char magic[8];
+        is_.read( magic, 8);
+        for( unsigned i=0; i<8; i++)
+            if( magic[i] != detail::checkpoint_magic[i])
+                throw Checkpoint_Error( filename_+" is not a checkpoint file");
+        uint64_t st, size;
+        is_.read( reinterpret_cast<char*>(&time_), sizeof(double));
+        is_.read( reinterpret_cast<char*>(&st), sizeof(uint64_t));
+        is_.read( reinterpret_cast<char*>(&size), sizeof(uint64_t));
+        std::vector<char> params( size);
+        if( size > 0) is_.read( &params[0], size);
+        if( !is_.good())
+            throw Checkpoint_Error( "Corrupt header in checkpoint file "+filename_);
+        step_ = st;
+        parameters_.assign( params.begin(), params.end());
+    }
+    /**
+     * @brief Time at which the checkpoint was written
+     * @return time
+     */
+    double time() const {return time_;}
+    /**
+     * @brief Step at which the checkpoint was written
+     * @return step
+     */
+    unsigned step() const {return step_;}
+    /**
+     * @brief The parameter string given to the writer
+     * @return parameters
+     */
+    const std::string& parameters() const {return parameters_;}
+    /**
+     * @brief Read the next vector from the checkpoint
+     *
+     * @tparam container a container that can be transferred from a thrust::host_vector<double>
+     * @param v contains vector on output (size must match the size on file)
+     */
+    template<class container>
+    void read( container& v)
+    {
+        uint64_t size;
+        is_.read( reinterpret_cast<char*>(&size), sizeof(uint64_t));
+        if( !is_.good() || size != v.size())
+            throw Checkpoint_Error( "Vector size mismatch in checkpoint file "+filename_);
+        buffer_.resize( size);
+        is_.read( reinterpret_cast<char*>(thrust::raw_pointer_cast( buffer_.data())), size*sizeof(double));
+        if( !is_.good())
+            throw Checkpoint_Error( "Failed to read from checkpoint file "+filename_);
+        dg::blas1::transfer( buffer_, v);
+    }
+    /**
+     * @brief Read the next vector of vectors from the checkpoint
+     *
+     * @tparam container a container that can be read with read()
+     * @param v contains vectors on output (sizes must match the sizes on file)
+     */
+    template<class container>
+    void read( std::vector<container>& v)
+    {
+        uint64_t size;
+        is_.read( reinterpret_cast<char*>(&size), sizeof(uint64_t));
+        if( !is_.good() || size != v.size())
+            throw Checkpoint_Error( "Vector size mismatch in checkpoint file "+filename_);
+        for( unsigned i=0; i<v.size(); i++)
+            read( v[i]);
+    }
+#ifdef MPI_VERSION
+    /**
+     * @brief Read the local part of a distributed vector
+     *
+     * @tparam container the local container type
+     * @param v contains vector on output
+     */
+    template<class container>
+    void read( dg::MPI_Vector<container>& v){ read( v.data());}
+#endif //MPI_VERSION
+  private:
+    std::string filename_;
+    std::ifstream is_;
+    double time_;
+    unsigned step_;
+    std::string parameters_;
+    thrust::host_vector<double> buffer_;
+};
+
+} //namespace file
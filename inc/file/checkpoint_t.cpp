@@ -0,0 +1,50 @@
+#include <iostream>
+#include <string>
+#include <cmath>
+
+#include "dg/blas.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/evaluation.cuh"
+#include "dg/backend/weights.cuh"
+#include "checkpoint.h"
+
+double function( double x, double y, double z){return sin(x)*sin(y)*cos(z);}
+
+typedef thrust::host_vector<double> HVec; 
+
+int main()
+{
+    std::cout << "WRITE AND READ BACK A CHECKPOINT FILE\n";
+    dg::Grid3d g( 0, 2.*M_PI, 0, 2.*M_PI, 0, 2.*M_PI, 3, 10, 10, 20);
+    const HVec w3d = dg::create::weights( g);
+    HVec data = dg::evaluate( function, g);
+    std::vector<HVec> y0( 2, data), y1( 2, data);
+    dg::blas1::scal( y0[1], 2.);
+    std::string params = "{\"n\" : 3}";
+    {
+        file::CheckpointWriter chk( file::checkpoint_name( "test.chk"), 1.5, 42, params);
+        chk.write( data);
+        chk.write( y0);
+        chk.close();
+    }
+    {
+        //an abandoned writer (e.g. an exception during write) keeps the old checkpoint
+        file::CheckpointWriter chk( file::checkpoint_name( "test.chk"), 3.0, 84, params);
+        chk.write( data);
+    }
+    file::CheckpointReader chk( file::checkpoint_name( "test.chk"));
+    HVec read( data.size(), 0.);
+    chk.read( read);
+    chk.read( y1);
+    std::cout << "Time     "<<chk.time()<<" (1.5)\n";
+    std::cout << "Step     "<<chk.step()<<" (42)\n";
+    std::cout << "Params   "<<chk.parameters()<<" ("<<params<<")\n";
+    dg::blas1::axpby( 1., data, -1., read);
+    dg::blas1::axpby( 1., y0, -1., y1);
+    std::cout << "Error    "<<sqrt( dg::blas2::dot( w3d, read))<<" (0)\n";
+    std::cout << "Error    "<<sqrt( dg::blas2::dot( w3d, y1[0]) + dg::blas2::dot( w3d, y1[1]))<<" (0)\n";
+    try{ chk.read( read);}
+    catch( file::Checkpoint_Error& e){ std::cout << "Expected error: "<< e.what()<<"\n";}
+    std::remove( file::checkpoint_name( "test.chk").c_str());
+    return 0;
+}
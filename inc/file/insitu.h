@@ -0,0 +1,442 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <netcdf.h>
+#include "thrust/host_vector.h"
+
+#include "dg/blas.h"
+#include "dg/functors.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/evaluation.cuh"
+#include "dg/backend/average.cuh"
+#include "nc_utilities.h"
+
+/*!@file
+ *
+ * Contains a framework for reduced diagnostics computed during a simulation
+ * and a set of reducers (averages, fluctuations, fluxes, probes and histograms)
+ */
+
+namespace file
+{
+
+/**
+ * @brief Interface of an in-situ diagnostic
+ *
+ * A reducer maps the (device) fields of a simulation to a compact host vector
+ * that is written as one time slice of the netcdf variable name()
+ * @tparam container the vector type of the fields
+ */
+template<class container>
+struct Reducer
+{
+    /**
+     * @brief Construct with variable name
+     * @param name name of the netcdf variable
+     */
+    Reducer( const std::string& name): name_(name){}
+    virtual ~Reducer(){}
+    /**
+     * @brief Name of the netcdf variable
+     * @return name
+     */
+    const std::string& name() const {return name_;}
+    /**
+     * @brief Lengths of the dimensions of one result (slowest varying first, empty for a scalar)
+     * @return shape
+     */
+    virtual std::vector<size_t> shape() const = 0;
+    /**
+     * @brief Compute the reduced quantity
+     *
+     * @param fields the fields of the simulation
+     * @param result contains the product of shape() values on output
+     */
+    virtual void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result) = 0;
+  private:
+    std::string name_;
+};
+
+/**
+ * @brief Manage a list of reducers that are evaluated every few time steps
+ *
+ * Every reducer gets its own variable on an unlimited time dimension named insitu_time,
+ * so the diagnostics can be written into the same file as the fields
+ * @code
+ file::InSitu<dg::DVec> insitu( 10);
+ insitu.add( new file::ToroidalAverageReducer<dg::DVec>( "electrons_tavg", 0, grid));
+ err = insitu.define( ncid); //in define mode
+ ...
+ if( insitu.due( step))
+     err = insitu.write( ncid, step, time, fields);
+ * @endcode
+ * @tparam container the vector type of the fields
+ */
+template<class container>
+struct InSitu
+{
+    /**
+     * @brief Construct an empty list
+     * @param every number of time steps between two evaluations (0 means never)
+     */
+    InSitu( unsigned every): every_( every){}
+    ~InSitu(){
+        for( unsigned i=0; i<reducers_.size(); i++)
+            delete reducers_[i];
+    }
+    /**
+     * @brief Add a reducer
+     * @param reducer a reducer allocated with new (ownership is taken)
+     */
+    void add( Reducer<container>* reducer){ reducers_.push_back( reducer);}
+    /**
+     * @brief Number of reducers
+     * @return size
+     */
+    unsigned size() const {return reducers_.size();}
+    /**
+     * @brief Check if the diagnostics should be written in the given step
+     * @param step the time step
+     * @return true if every != 0 and step is a multiple of every
+     */
+    bool due( unsigned step) const { return every_ != 0 && !reducers_.empty() && step%every_ == 0;}
+    /**
+     * @brief Define the time dimension and all variables
+     *
+     * @param ncid file ID (in define mode)
+     * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+     */
+    int define( int ncid)
+    {
+        int retval, timeID;
+        if( (retval = define_time( ncid, "insitu_time", &timeID, &tvarID_)) ){ return retval;}
+        varIDs_.resize( reducers_.size());
+        for( unsigned i=0; i<reducers_.size(); i++)
+        {
+            std::vector<size_t> shape = reducers_[i]->shape();
+            std::vector<int> dimIDs( 1, timeID);
+            for( unsigned d=0; d<shape.size(); d++)
+            {
+                std::stringstream name;
+                name << reducers_[i]->name() << "_dim" << d;
+                dimIDs.push_back( 0);
+                if( (retval = nc_def_dim( ncid, name.str().data(), shape[d], &dimIDs.back())) ){ return retval;}
+            }
+            if( (retval = nc_def_var( ncid, reducers_[i]->name().data(), NC_DOUBLE, dimIDs.size(), &dimIDs[0], &varIDs_[i])) ){ return retval;}
+        }
+        return retval;
+    }
+    /**
+     * @brief Look up the variables in an existing file (use instead of define when restarting)
+     *
+     * @param ncid file ID
+     * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+     */
+    int inquire( int ncid)
+    {
+        int retval;
+        if( (retval = nc_inq_varid( ncid, "insitu_time", &tvarID_)) ){ return retval;}
+        varIDs_.resize( reducers_.size());
+        for( unsigned i=0; i<reducers_.size(); i++)
+            if( (retval = nc_inq_varid( ncid, reducers_[i]->name().data(), &varIDs_[i])) ){ return retval;}
+        return retval;
+    }
+    /**
+     * @brief Evaluate all reducers and write the results
+     *
+     * The time index is step/every, so a restarted run overwrites the slices after its checkpoint
+     * @param ncid file ID (in data mode)
+     * @param step the current time step (should be due)
+     * @param time the current time
+     * @param fields the fields of the simulation
+     * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+     */
+    int write( int ncid, unsigned step, double time, const std::vector<const container*>& fields)
+    {
+        int retval;
+        size_t index = step/every_, one = 1;
+        if( (retval = nc_put_vara_double( ncid, tvarID_, &index, &one, &time)) ){ return retval;}
+        for( unsigned i=0; i<reducers_.size(); i++)
+        {
+            reducers_[i]->reduce( fields, result_);
+            std::vector<size_t> count = reducers_[i]->shape(), start( count.size()+1, 0);
+            count.insert( count.begin(), 1);
+            start[0] = index;
+            if( (retval = nc_put_vara_double( ncid, varIDs_[i], &start[0], &count[0], result_.data())) ){ return retval;}
+        }
+        return retval;
+    }
+  private:
+    InSitu( const InSitu&);
+    InSitu& operator=( const InSitu&);
+    unsigned every_;
+    std::vector<Reducer<container>*> reducers_;
+    std::vector<int> varIDs_;
+    int tvarID_;
+    thrust::host_vector<double> result_;
+};
+
+///@cond
+namespace detail
+{
+//toroidal average of a 3d field into a 2d vector
+template<class container>
+void toroidal_average( const dg::Grid3d& g, const container& src, container& res)
+{
+    res.assign( g.size()/g.Nz(), 0.);
+    dg::ToroidalAverage<container> average( g);
+    average( src, res);
+}
+}//namespace detail
+///@endcond
+
+/**
+ * @brief Average of a 3d field over the z (toroidal) direction
+ * @tparam container the vector type of the fields
+ */
+template<class container>
+struct ToroidalAverageReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field to average
+     * @param g the grid of the fields
+     */
+    ToroidalAverageReducer( const std::string& name, unsigned field, const dg::Grid3d& g):
+        Reducer<container>( name), field_( field), g_( g){}
+    std::vector<size_t> shape() const {
+        std::vector<size_t> s( 2, g_.n()*g_.Ny());
+        s[1] = g_.n()*g_.Nx();
+        return s;
+    }
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        detail::toroidal_average( g_, *fields[field_], avg_);
+        dg::blas1::transfer( avg_, result);
+    }
+  private:
+    unsigned field_;
+    dg::Grid3d g_;
+    container avg_;
+};
+
+/**
+ * @brief Average of a 3d field over the y and z directions (radial profile)
+ * @tparam container the vector type of the fields
+ * @tparam IndexContainer the integer vector type of PoloidalAverage
+ */
+template<class container, class IndexContainer>
+struct PoloidalAverageReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field to average
+     * @param g the grid of the fields
+     */
+    PoloidalAverageReducer( const std::string& name, unsigned field, const dg::Grid3d& g):
+        Reducer<container>( name), field_( field), g_( g),
+        average_( dg::Grid2d( g.x0(), g.x1(), g.y0(), g.y1(), g.n(), g.Nx(), g.Ny(), g.bcx(), g.bcy())){}
+    std::vector<size_t> shape() const { return std::vector<size_t>( 1, g_.n()*g_.Nx());}
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        detail::toroidal_average( g_, *fields[field_], tavg_);
+        average_( tavg_, pavg_);
+        //every line of pavg_ contains the profile
+        result.assign( pavg_.begin(), pavg_.begin() + g_.n()*g_.Nx());
+    }
+  private:
+    unsigned field_;
+    dg::Grid3d g_;
+    dg::PoloidalAverage<container, IndexContainer> average_;
+    container tavg_, pavg_;
+};
+
+/**
+ * @brief Deviation of one z-plane of a 3d field from its toroidal average
+ * @tparam container the vector type of the fields
+ */
+template<class container>
+struct PlaneFluctuationReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field
+     * @param g the grid of the fields
+     * @param plane the z-plane (e.g. g.Nz()/2 for the outboard midplane at phi = pi)
+     */
+    PlaneFluctuationReducer( const std::string& name, unsigned field, const dg::Grid3d& g, unsigned plane):
+        Reducer<container>( name), field_( field), plane_( plane), g_( g){}
+    std::vector<size_t> shape() const {
+        std::vector<size_t> s( 2, g_.n()*g_.Ny());
+        s[1] = g_.n()*g_.Nx();
+        return s;
+    }
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        const container& src = *fields[field_];
+        const unsigned size2d = g_.size()/g_.Nz();
+        detail::toroidal_average( g_, src, avg_);
+        container plane( src.begin() + plane_*size2d, src.begin() + (plane_+1)*size2d);
+        dg::blas1::axpby( 1., plane, -1., avg_);
+        dg::blas1::transfer( avg_, result);
+    }
+  private:
+    unsigned field_, plane_;
+    dg::Grid3d g_;
+    container avg_;
+};
+
+/**
+ * @brief Flux surface average of the toroidal average of a 3d field
+ * @tparam FluxSurfaceAverage e.g. dg::geo::FluxSurfaceAverage<MagneticField, container>
+ * @tparam MagneticField the magnetic field passed to FluxSurfaceAverage
+ * @tparam container the vector type of the fields
+ */
+template<class FluxSurfaceAverage, class MagneticField, class container>
+struct FluxSurfaceReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field
+     * @param g the grid of the fields
+     * @param c the magnetic field
+     * @param gpsi the grid of the poloidal flux on which the average is evaluated
+     */
+    FluxSurfaceReducer( const std::string& name, unsigned field, const dg::Grid3d& g, const MagneticField& c, const dg::Grid1d& gpsi):
+        Reducer<container>( name), field_( field), g_( g), c_( c), gpsi_( gpsi){}
+    std::vector<size_t> shape() const { return std::vector<size_t>( 1, gpsi_.size());}
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        detail::toroidal_average( g_, *fields[field_], avg_);
+        dg::Grid2d g2d( g_.x0(), g_.x1(), g_.y0(), g_.y1(), g_.n(), g_.Nx(), g_.Ny(), g_.bcx(), g_.bcy());
+        FluxSurfaceAverage fsa( g2d, c_, avg_);
+        result = dg::evaluate( fsa, gpsi_);
+    }
+  private:
+    unsigned field_;
+    dg::Grid3d g_;
+    MagneticField c_;
+    dg::Grid1d gpsi_;
+    container avg_;
+};
+
+/**
+ * @brief Toroidal average of the radial ExB flux of a density
+ *
+ * The flux n (d_R phi d_Z psi - d_Z phi d_R psi) w is computed pointwise,
+ * where w is a given weight (e.g. 1/B/|grad psi| for the flux through flux surfaces)
+ * @tparam Matrix the derivative matrix type
+ * @tparam container the vector type of the fields
+ */
+template<class Matrix, class container>
+struct RadialFluxReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param density index of the density field
+     * @param potential index of the potential field
+     * @param dR derivative in R (x)
+     * @param dZ derivative in Z (y)
+     * @param psipR d_R psi on the grid
+     * @param psipZ d_Z psi on the grid
+     * @param weight the weight w on the grid
+     * @param g the grid of the fields
+     */
+    RadialFluxReducer( const std::string& name, unsigned density, unsigned potential, const Matrix& dR, const Matrix& dZ,
+            const container& psipR, const container& psipZ, const container& weight, const dg::Grid3d& g):
+        Reducer<container>( name), density_( density), potential_( potential), dR_( dR), dZ_( dZ),
+        psipR_( psipR), psipZ_( psipZ), weight_( weight), temp1_( psipR), temp2_( psipR), g_( g){}
+    std::vector<size_t> shape() const {
+        std::vector<size_t> s( 2, g_.n()*g_.Ny());
+        s[1] = g_.n()*g_.Nx();
+        return s;
+    }
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        dg::blas2::symv( dR_, *fields[potential_], temp1_);
+        dg::blas2::symv( dZ_, *fields[potential_], temp2_);
+        dg::blas1::pointwiseDot( psipZ_, temp1_, temp1_);
+        dg::blas1::pointwiseDot( psipR_, temp2_, temp2_);
+        dg::blas1::axpby( -1., temp2_, 1., temp1_); //[phi, psi]_RZ
+        dg::blas1::pointwiseDot( weight_, temp1_, temp1_);
+        dg::blas1::pointwiseDot( *fields[density_], temp1_, temp1_);
+        detail::toroidal_average( g_, temp1_, avg_);
+        dg::blas1::transfer( avg_, result);
+    }
+  private:
+    unsigned density_, potential_;
+    Matrix dR_, dZ_;
+    container psipR_, psipZ_, weight_, temp1_, temp2_;
+    dg::Grid3d g_;
+    container avg_;
+};
+
+/**
+ * @brief Values of a field at probe positions
+ * @tparam IMatrix the interpolation matrix type
+ * @tparam container the vector type of the fields
+ */
+template<class IMatrix, class container>
+struct ProbeReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field
+     * @param interpolate interpolation matrix to the probe positions (e.g. dg::create::interpolation( x, y, z, g))
+     * @param probes number of probes (rows of interpolate)
+     */
+    ProbeReducer( const std::string& name, unsigned field, const IMatrix& interpolate, unsigned probes):
+        Reducer<container>( name), field_( field), interpolate_( interpolate), values_( probes){}
+    std::vector<size_t> shape() const { return std::vector<size_t>( 1, values_.size());}
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        dg::blas2::symv( interpolate_, *fields[field_], values_);
+        dg::blas1::transfer( values_, result);
+    }
+  private:
+    unsigned field_;
+    IMatrix interpolate_;
+    container values_;
+};
+
+/**
+ * @brief Histogram of the values of a field
+ *
+ * The counts of a dg::StreamingHistogram normalized to the maximum count
+ * @tparam container the vector type of the fields
+ */
+template<class container>
+struct HistogramReducer : public Reducer<container>
+{
+    /**
+     * @brief Construct
+     * @param name variable name
+     * @param field index of the field
+     * @param bins the range of values and the bins (must have n = 1, i.e. one bin per cell)
+     */
+    HistogramReducer( const std::string& name, unsigned field, const dg::Grid1d& bins):
+        Reducer<container>( name), field_( field), histogram_( (dg::HistogramBins( bins))){}
+    std::vector<size_t> shape() const { return std::vector<size_t>( 1, histogram_.bins().size());}
+    void reduce( const std::vector<const container*>& fields, thrust::host_vector<double>& result)
+    {
+        dg::blas1::transfer( *fields[field_], host_);
+        histogram_.clear();
+        histogram_.add( host_);
+        const std::vector<double> counts = histogram_.normalized();
+        result.assign( counts.begin(), counts.end());
+    }
+  private:
+    unsigned field_;
+    dg::StreamingHistogram histogram_;
+    thrust::host_vector<double> host_;
+};
+
+} //namespace file
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+#include <netcdf.h>
+#include <cmath>
+
+#include "dg/blas.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/evaluation.cuh"
+#include "dg/backend/weights.cuh"
+#include "dg/backend/interpolation.cuh"
+#include "insitu.h"
+
+double function( double x, double y, double z){return sin(x)*sin(y)*cos(z);}
+double average( double x, double y, double z){return sin(x)*sin(y);}
+
+typedef thrust::host_vector<double> HVec; 
+
+int main()
+{
+    std::cout << "WRITE IN-SITU DIAGNOSTICS OF A TIMEDEPENDENT FIELD\n";
+    dg::Grid3d g( 0, M_PI, 0, M_PI, 0, 2.*M_PI, 3, 10, 10, 20);
+    const HVec w2d = dg::create::weights( dg::Grid2d( 0, M_PI, 0, M_PI, 3, 10, 10));
+    HVec data = dg::evaluate( function, g);
+    dg::blas1::axpby( 1., (HVec)dg::evaluate( average, g), 1., data); //data has toroidal average sin(x)sin(y)
+    std::vector<const HVec*> fields( 1, &data);
+    HVec x( 2, M_PI/2.), y( 2, M_PI/2.), z( 2, 0.);
+    z[1] = M_PI/2.;
+    dg::IHMatrix probes = dg::create::interpolation( x, y, z, g);
+
+    file::InSitu<HVec> insitu( 2);
+    insitu.add( new file::ToroidalAverageReducer<HVec>( "tavg", 0, g));
+    insitu.add( new file::ProbeReducer<dg::IHMatrix, HVec>( "probes", 0, probes, 2));
+    insitu.add( new file::HistogramReducer<HVec>( "hist", 0, dg::Grid1d( -2., 2., 1, 8)));
+    int ncid;
+    file::NC_Error_Handle err;
+    err = nc_create( "insitu.nc", NC_NETCDF4|NC_CLOBBER, &ncid);
+    err = insitu.define( ncid);
+    err = nc_enddef( ncid);
+    for( unsigned step=0; step<=10; step++)
+        if( insitu.due( step))
+            err = insitu.write( ncid, step, 0.1*step, fields);
+    err = nc_close( ncid);
+
+    err = nc_open( "insitu.nc", NC_NOWRITE, &ncid);
+    int timeID, tavgID, probesID;
+    size_t steps;
+    err = nc_inq_dimid( ncid, "insitu_time", &timeID);
+    err = nc_inq_dimlen( ncid, timeID, &steps);
+    std::cout << "Steps    "<<steps<<" (6)\n";
+    err = nc_inq_varid( ncid, "tavg", &tavgID);
+    err = nc_inq_varid( ncid, "probes", &probesID);
+    HVec tavg( g.size()/g.Nz()), values( 2);
+    size_t start[3] = {5, 0, 0}, count[3] = {1, g.n()*g.Ny(), g.n()*g.Nx()};
+    err = nc_get_vara_double( ncid, tavgID, start, count, tavg.data());
+    count[1] = 2;
+    err = nc_get_vara_double( ncid, probesID, start, count, values.data());
+    err = nc_close( ncid);
+    dg::blas1::axpby( 1., (HVec)dg::evaluate( average, dg::Grid2d( 0, M_PI, 0, M_PI, 3, 10, 10)), -1., tavg);
+    std::cout << "Error    "<<sqrt( dg::blas2::dot( w2d, tavg))<<" (small)\n";
+    std::cout << "Probes   "<<values[0]<<" "<<values[1]<<" (2 1)\n";
+    return 0;
+}
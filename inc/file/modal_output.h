@@ -0,0 +1,360 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <netcdf.h>
+#include "thrust/host_vector.h"
+
+#include "dg/backend/grid.h"
+#include "nc_utilities.h"
+
+/*!@file
+ *
+ * Contains writer and reader for compressed modal (Legendre coefficient) output
+ */
+
+namespace file
+{
+
+/**
+ * @brief Transform between nodal values and (truncated) Legendre coefficients
+ *
+ * In every cell of a 3d grid the n x n nodal values in x and y are transformed
+ * to the n_keep x n_keep lowest Legendre coefficients (the z direction is not transformed).
+ * The coefficients are stored as float in the same cell-wise layout as the nodal values:
+ * index ((s*Ny + i)*n_keep + p)*Nx*n_keep + j*n_keep + q
+ * @note if n_keep == n the transformation is exact up to float precision
+ */
+struct ModalTransform
+{
+    /**
+     * @brief Construct from grid
+     *
+     * @param g the grid of the nodal values
+     * @param n_keep number of Legendre coefficients to keep per dimension (0 < n_keep <= g.n())
+     */
+    ModalTransform( const dg::Grid3d& g, unsigned n_keep): g_(g), nk_( n_keep),
+        forward_( g.dlt().forward()), backward_( g.dlt().backward())
+    {
+        assert( n_keep > 0 && n_keep <= g.n());
+    }
+    /**
+     * @brief The grid of the nodal values
+     * @return grid
+     */
+    const dg::Grid3d& grid() const {return g_;}
+    /**
+     * @brief Number of kept Legendre coefficients per dimension
+     * @return n_keep
+     */
+    unsigned n_keep() const {return nk_;}
+    /**
+     * @brief Number of coefficients of a modal vector
+     * @return n_keep*n_keep*Nx*Ny*Nz
+     */
+    unsigned size() const {return nk_*nk_*g_.Nx()*g_.Ny()*g_.Nz();}
+    /**
+     * @brief Compute the truncated Legendre coefficients
+     *
+     * @param nodal values on grid()
+     * @param modal contains size() coefficients on output
+     */
+    void forward( const thrust::host_vector<double>& nodal, std::vector<float>& modal) const
+    {
+        assert( nodal.size() == g_.size());
+        modal.resize( size());
+        const unsigned n = g_.n(), Nx = g_.Nx(), cells = g_.Nz()*g_.Ny()*Nx;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+        {
+            std::vector<double> temp( n*nk_);
+#ifdef _OPENMP
+#pragma omp for
+#endif //_OPENMP
+            for( int c=0; c<(int)cells; c++)
+            {
+                const unsigned row = c/Nx, j = c%Nx; // row = s*Ny + i
+                //transform in x: temp(k,q) = F(q,l) v(k,l)
+                for( unsigned k=0; k<n; k++)
+                for( unsigned q=0; q<nk_; q++)
+                {
+                    temp[k*nk_+q] = 0;
+                    for( unsigned l=0; l<n; l++)
+                        temp[k*nk_+q] += forward_[q*n+l]*nodal[(row*n+k)*Nx*n + j*n + l];
+                }
+                //transform in y: modal(p,q) = F(p,k) temp(k,q)
+                for( unsigned p=0; p<nk_; p++)
+                for( unsigned q=0; q<nk_; q++)
+                {
+                    double m = 0;
+                    for( unsigned k=0; k<n; k++)
+                        m += forward_[p*n+k]*temp[k*nk_+q];
+                    modal[(row*nk_+p)*Nx*nk_ + j*nk_ + q] = (float)m;
+                }
+            }
+        }
+    }
+    /**
+     * @brief Reconstruct nodal values from (truncated) Legendre coefficients
+     *
+     * @param modal size() coefficients
+     * @param nodal contains values on grid() on output
+     */
+    void backward( const std::vector<float>& modal, thrust::host_vector<double>& nodal) const
+    {
+        assert( modal.size() == size());
+        nodal.resize( g_.size());
+        const unsigned n = g_.n(), Nx = g_.Nx(), cells = g_.Nz()*g_.Ny()*Nx;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif //_OPENMP
+        {
+            std::vector<double> temp( n*nk_);
+#ifdef _OPENMP
+#pragma omp for
+#endif //_OPENMP
+            for( int c=0; c<(int)cells; c++)
+            {
+                const unsigned row = c/Nx, j = c%Nx;
+                //back transform in y: temp(k,q) = B(k,p) modal(p,q)
+                for( unsigned k=0; k<n; k++)
+                for( unsigned q=0; q<nk_; q++)
+                {
+                    temp[k*nk_+q] = 0;
+                    for( unsigned p=0; p<nk_; p++)
+                        temp[k*nk_+q] += backward_[k*n+p]*modal[(row*nk_+p)*Nx*nk_ + j*nk_ + q];
+                }
+                //back transform in x: v(k,l) = B(l,q) temp(k,q)
+                for( unsigned k=0; k<n; k++)
+                for( unsigned l=0; l<n; l++)
+                {
+                    double v = 0;
+                    for( unsigned q=0; q<nk_; q++)
+                        v += backward_[l*n+q]*temp[k*nk_+q];
+                    nodal[(row*n+k)*Nx*n + j*n + l] = v;
+                }
+            }
+        }
+    }
+  private:
+    dg::Grid3d g_;
+    unsigned nk_;
+    std::vector<double> forward_, backward_;
+};
+
+/**
+ * @brief Define the dimensions of modal variables and store the grid as global attributes
+ *
+ * Dimensions are named ymodal and xmodal, time and z are shared with the nodal variables
+ * @param ncid file ID
+ * @param modalIDs (write - only) 4D array of dimension IDs (time, z, ymodal, xmodal)
+ * @param dimsIDs 4D array of dimension IDs (time, z, y, x) as returned by define_dimensions
+ * @param t the transformation that is used to write the data
+ *
+ * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+ * @note File stays in define mode
+ */
+inline int define_modal_dimensions( int ncid, int* modalIDs, const int* dimsIDs, const ModalTransform& t)
+{
+    const dg::Grid3d& g = t.grid();
+    int retval;
+    modalIDs[0] = dimsIDs[0], modalIDs[1] = dimsIDs[1];
+    if( (retval = nc_def_dim( ncid, "ymodal", t.n_keep()*g.Ny(), &modalIDs[2])) ){ return retval;}
+    if( (retval = nc_def_dim( ncid, "xmodal", t.n_keep()*g.Nx(), &modalIDs[3])) ){ return retval;}
+    double bounds[6] = { g.x0(), g.x1(), g.y0(), g.y1(), g.z0(), g.z1()};
+    int sizes[5] = { (int)g.n(), (int)t.n_keep(), (int)g.Nx(), (int)g.Ny(), (int)g.Nz()};
+    if( (retval = nc_put_att_double( ncid, NC_GLOBAL, "modal_bounds", NC_DOUBLE, 6, bounds)) ){ return retval;}
+    if( (retval = nc_put_att_int( ncid, NC_GLOBAL, "modal_sizes", NC_INT, 5, sizes)) ){ return retval;}
+    return retval;
+}
+
+/**
+ * @brief Define a time-dependent modal float variable with chunking, shuffle and deflate
+ *
+ * One chunk holds one z-plane of one time step
+ * @param ncid file ID (must be a NetCDF-4 file)
+ * @param name name of the variable
+ * @param modalIDs dimension IDs as returned by define_modal_dimensions
+ * @param t the transformation that is used to write the data
+ * @param varID (write - only) the ID of the variable
+ * @param deflate_level 0 (no compression) to 9 (strongest compression)
+ *
+ * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+ */
+inline int define_modal_variable( int ncid, const char* name, const int* modalIDs, const ModalTransform& t, int* varID, int deflate_level = 4)
+{
+    int retval;
+    if( (retval = nc_def_var( ncid, name, NC_FLOAT, 4, modalIDs, varID)) ){ return retval;}
+    size_t chunks[4] = {1, 1, t.n_keep()*t.grid().Ny(), t.n_keep()*t.grid().Nx()};
+    if( (retval = nc_def_var_chunking( ncid, *varID, NC_CHUNKED, chunks)) ){ return retval;}
+    if( (retval = nc_def_var_deflate( ncid, *varID, 1, deflate_level > 0, deflate_level)) ){ return retval;}
+    return retval;
+}
+
+/**
+ * @brief Write nodal values as modal coefficients into a block of a modal variable
+ *
+ * With parallel netcdf every process transforms the values on its local grid
+ * and writes them into its own block of the global variable
+ * @param ncid file ID
+ * @param varID ID of a variable defined by define_modal_variable (on the global grid)
+ * @param start start of the block (time index, z-plane, n_keep*(first y cell), n_keep*(first x cell))
+ * @param t the transformation on the grid of the block
+ * @param nodal values on t.grid()
+ * @param buffer work array
+ *
+ * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+ */
+inline int put_modal_vara_block( int ncid, int varID, const size_t* start, const ModalTransform& t, const thrust::host_vector<double>& nodal, std::vector<float>& buffer)
+{
+    t.forward( nodal, buffer);
+    size_t count[4] = {1, t.grid().Nz(), t.n_keep()*t.grid().Ny(), t.n_keep()*t.grid().Nx()};
+    return nc_put_vara_float( ncid, varID, start, count, &buffer[0]);
+}
+
+/**
+ * @brief Write nodal values as modal coefficients at a given time index
+ *
+ * @param ncid file ID
+ * @param varID ID of a variable defined by define_modal_variable
+ * @param time the time index
+ * @param t the transformation
+ * @param nodal values on t.grid()
+ * @param buffer work array
+ *
+ * @return if anything goes wrong it returns the netcdf code, else SUCCESS
+ */
+inline int put_modal_vara( int ncid, int varID, size_t time, const ModalTransform& t, const thrust::host_vector<double>& nodal, std::vector<float>& buffer)
+{
+    size_t start[4] = {time, 0, 0, 0};
+    return put_modal_vara_block( ncid, varID, start, t, nodal, buffer);
+}
+
+/**
+ * @brief Read modal variables and reconstruct their nodal values
+ *
+ * The grid is read from the global attributes written by define_modal_dimensions
+ * @code
+ file::ModalReader reader( ncid);
+ thrust::host_vector<double> ne;
+ reader.get( ncid, "electrons", 10, ne); //nodal values on reader.grid()
+ * @endcode
+ */
+struct ModalReader
+{
+    /**
+     * @brief Read the grid from an open file
+     *
+     * @param ncid file ID
+     * @note throws NC_Error if the file contains no modal output
+     */
+    ModalReader( int ncid): t_( read_grid( ncid), read_sizes( ncid)[1]) { }
+    /**
+     * @brief The grid on which values are reconstructed
+     * @return grid
+     */
+    const dg::Grid3d& grid() const {return t_.grid();}
+    /**
+     * @brief The transformation between nodal and modal values
+     * @return transformation
+     */
+    const ModalTransform& transform() const {return t_;}
+    /**
+     * @brief Read a time slice of a modal variable and reconstruct nodal values
+     *
+     * @param ncid file ID
+     * @param name name of the variable
+     * @param time time index
+     * @param nodal contains values on grid() on output
+     */
+    void get( int ncid, const char* name, size_t time, thrust::host_vector<double>& nodal)
+    {
+        NC_Error_Handle err;
+        int varID;
+        err = nc_inq_varid( ncid, name, &varID);
+        size_t start[4] = {time, 0, 0, 0};
+        size_t count[4] = {1, grid().Nz(), t_.n_keep()*grid().Ny(), t_.n_keep()*grid().Nx()};
+        buffer_.resize( t_.size());
+        err = nc_get_vara_float( ncid, varID, start, count, &buffer_[0]);
+        t_.backward( buffer_, nodal);
+    }
+  private:
+    static std::vector<int> read_sizes( int ncid)
+    {
+        NC_Error_Handle err;
+        std::vector<int> sizes(5);
+        err = nc_get_att_int( ncid, NC_GLOBAL, "modal_sizes", &sizes[0]);
+        return sizes;
+    }
+    static dg::Grid3d read_grid( int ncid)
+    {
+        NC_Error_Handle err;
+        double bounds[6];
+        err = nc_get_att_double( ncid, NC_GLOBAL, "modal_bounds", bounds);
+        std::vector<int> sizes = read_sizes( ncid);
+        return dg::Grid3d( bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5], sizes[0], sizes[2], sizes[3], sizes[4]);
+    }
+    ModalTransform t_;
+    std::vector<float> buffer_;
+};
+
+/**
+ * @brief Check if a variable is stored as modal coefficients
+ *
+ * @param ncid file ID
+ * @param varID variable ID
+ * @return true if the last dimension of the variable is xmodal (cf. define_modal_dimensions)
+ */
+inline bool is_modal_variable( int ncid, int varID)
+{
+    NC_Error_Handle err;
+    int ndims;
+    err = nc_inq_varndims( ncid, varID, &ndims);
+    if( ndims == 0) return false;
+    std::vector<int> dimIDs( ndims);
+    err = nc_inq_vardimid( ncid, varID, &dimIDs[0]);
+    char name[NC_MAX_NAME+1];
+    err = nc_inq_dimname( ncid, dimIDs[ndims-1], name);
+    return std::string( name) == "xmodal";
+}
+
+/**
+ * @brief Read a time slice of a field that is stored either nodal or modal
+ *
+ * Nodal variables are read as they are, modal variables are reconstructed
+ * on the grid stored in the file (ModalReader), so diagnostics read both
+ * kinds of output in the same way
+ * @param ncid file ID
+ * @param name name of the time-dependent variable
+ * @param time time index
+ * @param nodal contains the nodal values on output (resized to one time slice)
+ */
+inline void get_field_vara( int ncid, const char* name, size_t time, thrust::host_vector<double>& nodal)
+{
+    NC_Error_Handle err;
+    int varID;
+    err = nc_inq_varid( ncid, name, &varID);
+    if( is_modal_variable( ncid, varID))
+    {
+        ModalReader reader( ncid);
+        reader.get( ncid, name, time, nodal);
+        return;
+    }
+    int ndims;
+    err = nc_inq_varndims( ncid, varID, &ndims);
+    std::vector<int> dimIDs( ndims);
+    err = nc_inq_vardimid( ncid, varID, &dimIDs[0]);
+    std::vector<size_t> start( ndims, 0), count( ndims, 1);
+    size_t size = 1;
+    for( int d=1; d<ndims; d++)
+    {
+        err = nc_inq_dimlen( ncid, dimIDs[d], &count[d]);
+        size *= count[d];
+    }
+    start[0] = time;
+    nodal.resize( size);
+    err = nc_get_vara_double( ncid, varID, &start[0], &count[0], nodal.data());
+}
+
+} //namespace file
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <string>
+#include <netcdf.h>
+#include <cmath>
+
+#include "dg/blas.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/evaluation.cuh"
+#include "dg/backend/weights.cuh"
+#include "modal_output.h"
+
+double function( double x, double y, double z){return sin(x)*sin(y)*cos(z);}
+
+typedef thrust::host_vector<double> HVec; 
+
+int main()
+{
+    std::cout << "WRITE AND READ BACK TRUNCATED LEGENDRE COEFFICIENTS\n";
+    dg::Grid3d g( 0, 2.*M_PI, 0, 2.*M_PI, 0, 2.*M_PI, 4, 10, 10, 4);
+    const HVec w3d = dg::create::weights( g);
+    const HVec data = dg::evaluate( function, g);
+    const double norm = sqrt( dg::blas2::dot( w3d, data));
+    std::cout << "n_keep  relative error (decreases with n_keep, float precision for n_keep = n)\n";
+    for( unsigned nk=1; nk<=g.n(); nk++)
+    {
+        int ncid;
+        file::NC_Error_Handle err;
+        err = nc_create( "modal.nc", NC_NETCDF4|NC_CLOBBER, &ncid);
+        int dim_ids[4], modal_ids[4], tvarID, dataID;
+        err = file::define_dimensions( ncid, dim_ids, &tvarID, g);
+        file::ModalTransform modal( g, nk);
+        err = file::define_modal_dimensions( ncid, modal_ids, dim_ids, modal);
+        err = file::define_modal_variable( ncid, "data", modal_ids, modal, &dataID);
+        err = nc_enddef( ncid);
+        std::vector<float> buffer;
+        err = file::put_modal_vara( ncid, dataID, 0, modal, data, buffer);
+        err = nc_close( ncid);
+
+        err = nc_open( "modal.nc", NC_NOWRITE, &ncid);
+        file::ModalReader reader( ncid);
+        HVec read;
+        reader.get( ncid, "data", 0, read);
+        err = nc_close( ncid);
+        dg::blas1::axpby( 1., data, -1., read);
+        std::cout << nk << "       "<<sqrt( dg::blas2::dot( w3d, read))/norm<<"\n";
+    }
+    return 0;
+}
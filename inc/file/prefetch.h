@@ -0,0 +1,322 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <pthread.h>
+#include <netcdf.h>
+#include "thrust/host_vector.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif //_OPENMP
+
+#include "nc_utilities.h"
+
+/*!@file
+ *
+ * Contains a reader that prefetches time slices on a background thread
+ * and a map/reduce over time slices
+ */
+
+namespace file
+{
+
+/**
+ * @brief The mutex that serializes all netcdf calls
+ *
+ * netcdf (and hdf5) are not thread-safe, not even for different files
+ * @return the global mutex
+ */
+inline pthread_mutex_t& nc_mutex()
+{
+    static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    return mutex;
+}
+
+/**
+ * @brief Locks nc_mutex() for the lifetime of the object
+ *
+ * Every netcdf call made while a PrefetchReader is alive must hold the lock
+ * @code
+ {
+     file::NC_Guard guard;
+     err = nc_put_vara_double( ncid, varID, start, count, data);
+ }
+ * @endcode
+ */
+struct NC_Guard
+{
+    NC_Guard() { pthread_mutex_lock( &nc_mutex());}
+    ~NC_Guard() { pthread_mutex_unlock( &nc_mutex());}
+  private:
+    NC_Guard( const NC_Guard&);
+    NC_Guard& operator=( const NC_Guard&);
+};
+
+/**
+ * @brief nc_put_vara_double while holding nc_mutex()
+ *
+ * For the writes of a diagnostics program that reads its input through a PrefetchReader
+ * @param ncid file ID
+ * @param varID variable ID
+ * @param start start vector
+ * @param count count vector
+ * @param data the values to write
+ * @return netcdf error code
+ */
+inline int put_vara_double_locked( int ncid, int varID, const size_t* start, const size_t* count, const double* data)
+{
+    NC_Guard guard;
+    return nc_put_vara_double( ncid, varID, start, count, data);
+}
+
+/**
+ * @brief One time slice of several variables
+ */
+struct Slice
+{
+    size_t index; //!< the time index
+    std::vector<thrust::host_vector<double> > fields; //!< one field per variable in the order given to the reader
+};
+
+/**
+ * @brief Read time slices of several variables ahead of their use
+ *
+ * A background thread reads the time slices first, ..., last-1 into a ring of depth buffers
+ * while the caller computes on the current slice.
+ * If the thread cannot be created the slices are read synchronously in next().
+ * All variables must have the unlimited time dimension as their first dimension.
+ * @code
+ file::PrefetchReader reader( ncid, names, 0, steps);
+ file::Slice slice;
+ while( reader.next( slice))
+     compute( slice.fields[0], slice.fields[1]); //slice.index is the time index
+ * @endcode
+ * @attention while the reader is alive all other netcdf calls must hold an NC_Guard
+ */
+struct PrefetchReader
+{
+    /**
+     * @brief Start reading
+     *
+     * @param ncid file ID (opened for reading)
+     * @param names names of the variables to read
+     * @param first first time index
+     * @param last one past the last time index
+     * @param depth number of slices that are read ahead
+     * @param background if false no thread is started and next() reads synchronously
+     * @note throws NC_Error if a variable does not exist
+     */
+    PrefetchReader( int ncid, const std::vector<std::string>& names, size_t first, size_t last, unsigned depth = 2, bool background = true):
+        ncid_( ncid), varIDs_( names.size()), counts_( names.size()), sizes_( names.size()),
+        first_( first), last_( std::max( first, last)),
+        ring_( std::max( depth, 1u)), produced_( 0), consumed_( 0), stop_( false), done_( false), error_( NC_NOERR), threaded_( false)
+    {
+        {
+            NC_Guard guard;
+            NC_Error_Handle err;
+            for( unsigned i=0; i<names.size(); i++)
+            {
+                err = nc_inq_varid( ncid, names[i].data(), &varIDs_[i]);
+                int ndims;
+                err = nc_inq_varndims( ncid, varIDs_[i], &ndims);
+                std::vector<int> dimIDs( ndims);
+                err = nc_inq_vardimid( ncid, varIDs_[i], &dimIDs[0]);
+                counts_[i].assign( ndims, 1);
+                sizes_[i] = 1;
+                for( int d=1; d<ndims; d++)
+                {
+                    err = nc_inq_dimlen( ncid, dimIDs[d], &counts_[i][d]);
+                    sizes_[i] *= counts_[i][d];
+                }
+            }
+        }
+        for( unsigned k=0; k<ring_.size(); k++)
+            ring_[k].fields.resize( names.size());
+        pthread_mutex_init( &mutex_, NULL);
+        pthread_cond_init( &cond_, NULL);
+        if( background)
+            threaded_ = ( pthread_create( &thread_, NULL, &PrefetchReader::run, this) == 0);
+    }
+    /**
+     * @brief Stop reading and join the background thread
+     *
+     * Afterwards the file may be closed
+     */
+    ~PrefetchReader()
+    {
+        if( threaded_)
+        {
+            pthread_mutex_lock( &mutex_);
+            stop_ = true;
+            pthread_cond_broadcast( &cond_);
+            pthread_mutex_unlock( &mutex_);
+            pthread_join( thread_, NULL);
+        }
+        pthread_cond_destroy( &cond_);
+        pthread_mutex_destroy( &mutex_);
+    }
+    /**
+     * @brief Get the next time slice
+     *
+     * Blocks until the slice is read. The buffers of slice are recycled by the reader,
+     * so passing the same object in every call avoids all allocations.
+     * @param slice contains the next time slice on output
+     * @return false if all slices have been read
+     * @note throws NC_Error if reading failed
+     */
+    bool next( Slice& slice)
+    {
+        if( !threaded_)
+        {
+            if( first_ + consumed_ == last_) return false;
+            int retval = read( first_ + consumed_, slice);
+            if( retval != NC_NOERR) throw NC_Error( retval);
+            consumed_++;
+            return true;
+        }
+        pthread_mutex_lock( &mutex_);
+        while( consumed_ == produced_ && !done_)
+            pthread_cond_wait( &cond_, &mutex_);
+        if( consumed_ == produced_)
+        {
+            int error = error_;
+            pthread_mutex_unlock( &mutex_);
+            if( error != NC_NOERR) throw NC_Error( error);
+            return false;
+        }
+        Slice& buffer = ring_[consumed_%ring_.size()];
+        slice.index = buffer.index;
+        slice.fields.swap( buffer.fields);
+        buffer.fields.resize( varIDs_.size());
+        consumed_++;
+        pthread_cond_broadcast( &cond_);
+        pthread_mutex_unlock( &mutex_);
+        return true;
+    }
+    size_t first() const {return first_;} //!< first time index
+    size_t last() const {return last_;} //!< one past the last time index
+    size_t size() const {return last_ - first_;} //!< number of time slices
+    bool background() const {return threaded_;} //!< true if slices are read on a background thread
+  private:
+    PrefetchReader( const PrefetchReader&);
+    PrefetchReader& operator=( const PrefetchReader&);
+    static void* run( void* reader)
+    {
+        static_cast<PrefetchReader*>( reader)->produce();
+        return NULL;
+    }
+    void produce()
+    {
+        for( size_t t=first_; t<last_; t++)
+        {
+            pthread_mutex_lock( &mutex_);
+            while( produced_ - consumed_ == ring_.size() && !stop_)
+                pthread_cond_wait( &cond_, &mutex_);
+            bool stop = stop_;
+            pthread_mutex_unlock( &mutex_);
+            if( stop) break;
+            //the slot is not touched by the consumer until produced_ is incremented
+            int retval = read( t, ring_[produced_%ring_.size()]);
+            pthread_mutex_lock( &mutex_);
+            if( retval == NC_NOERR)
+                produced_++;
+            else
+                error_ = retval;
+            pthread_cond_broadcast( &cond_);
+            pthread_mutex_unlock( &mutex_);
+            if( retval != NC_NOERR) break;
+        }
+        pthread_mutex_lock( &mutex_);
+        done_ = true;
+        pthread_cond_broadcast( &cond_);
+        pthread_mutex_unlock( &mutex_);
+    }
+    //read time index t of all variables into slice
+    int read( size_t t, Slice& slice)
+    {
+        slice.index = t;
+        slice.fields.resize( varIDs_.size());
+        int retval = NC_NOERR;
+        for( unsigned i=0; i<varIDs_.size() && retval == NC_NOERR; i++)
+        {
+            slice.fields[i].resize( sizes_[i]);
+            std::vector<size_t> start( counts_[i].size(), 0);
+            start[0] = t;
+            NC_Guard guard;
+            retval = nc_get_vara_double( ncid_, varIDs_[i], &start[0], &counts_[i][0], slice.fields[i].data());
+        }
+        return retval;
+    }
+    int ncid_;
+    std::vector<int> varIDs_;
+    std::vector<std::vector<size_t> > counts_;
+    std::vector<size_t> sizes_;
+    size_t first_, last_;
+    std::vector<Slice> ring_;
+    size_t produced_, consumed_;
+    bool stop_, done_;
+    int error_;
+    bool threaded_;
+    pthread_mutex_t mutex_;
+    pthread_cond_t cond_;
+    pthread_t thread_;
+};
+
+/**
+ * @brief Apply a function to all remaining time slices of a reader in parallel
+ *
+ * Slices are taken from the reader in batches of one slice per OpenMP thread,
+ * while the reader prefetches the next batch (choose its depth at least the number of threads).
+ * @tparam Map a functor with signature void operator()( const Slice&, std::vector<double>& result) const,
+ * which is called concurrently by several threads and must not call netcdf functions
+ * @param reader the source of the time slices
+ * @param map computes the per-step quantities of one slice
+ * @param results results[slice.index - reader.first()] contains the result of map on output
+ */
+template<class Map>
+void map_slices( PrefetchReader& reader, const Map& map, std::vector<std::vector<double> >& results)
+{
+    results.resize( reader.size());
+    unsigned batch = 1;
+#ifdef _OPENMP
+    batch = omp_get_max_threads();
+#endif //_OPENMP
+    std::vector<Slice> slices( batch);
+    unsigned number = batch;
+    while( number == batch)
+    {
+        for( number = 0; number < batch; number++)
+            if( !reader.next( slices[number])) break;
+#ifdef _OPENMP
+#pragma omp parallel for schedule( dynamic, 1)
+#endif //_OPENMP
+        for( int k=0; k<(int)number; k++)
+            map( slices[k], results[slices[k].index - reader.first()]);
+    }
+}
+
+/**
+ * @brief Compute per-step quantities in parallel and reduce them in time order
+ *
+ * The reduction is done serially in the order of the time index, so the result
+ * does not depend on the number of threads.
+ * @tparam Map see map_slices
+ * @tparam Reduce a functor with signature void operator()( const std::vector<double>& step, std::vector<double>& result)
+ * @param reader the source of the time slices
+ * @param map computes the per-step quantities of one slice
+ * @param reduce accumulates the quantities of one step into the result
+ * @param result contains the initial value on input and the reduced value on output
+ * @return the per-step quantities (results of map)
+ */
+template<class Map, class Reduce>
+std::vector<std::vector<double> > map_reduce( PrefetchReader& reader, const Map& map, Reduce& reduce, std::vector<double>& result)
+{
+    std::vector<std::vector<double> > steps;
+    map_slices( reader, map, steps);
+    for( unsigned i=0; i<steps.size(); i++)
+        reduce( steps[i], result);
+    return steps;
+}
+
+} //namespace file
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <string>
+#include <netcdf.h>
+#include <cmath>
+
+#include "dg/blas.h"
+#include "dg/backend/grid.h"
+#include "dg/backend/evaluation.cuh"
+#include "dg/backend/weights.cuh"
+#include "prefetch.h"
+
+double function( double x, double y){return sin(x)*sin(y);}
+
+typedef thrust::host_vector<double> HVec; 
+
+//per-step quantities: mass of both fields
+struct Mass
+{
+    Mass( const HVec& w2d): w2d_(w2d){}
+    void operator()( const file::Slice& slice, std::vector<double>& result) const
+    {
+        result.resize( slice.fields.size());
+        for( unsigned i=0; i<slice.fields.size(); i++)
+            result[i] = dg::blas1::dot( w2d_, slice.fields[i]);
+    }
+  private:
+    HVec w2d_;
+};
+
+struct Sum
+{
+    void operator()( const std::vector<double>& step, std::vector<double>& result)
+    {
+        for( unsigned i=0; i<step.size(); i++)
+            result[i] += step[i];
+    }
+};
+
+int main()
+{
+    std::cout << "WRITE TIME SLICES AND READ THEM BACK WITH THE PREFETCH READER\n";
+    dg::Grid2d g( 0, M_PI, 0, M_PI, 3, 20, 20);
+    const HVec w2d = dg::create::weights( g);
+    const HVec data = dg::evaluate( function, g);
+    const unsigned NT = 20;
+    int ncid;
+    file::NC_Error_Handle err;
+    err = nc_create( "prefetch.nc", NC_NETCDF4|NC_CLOBBER, &ncid);
+    int dim_ids[3], tvarID, fieldIDs[2];
+    err = file::define_dimensions( ncid, dim_ids, &tvarID, g);
+    err = nc_def_var( ncid, "field0", NC_DOUBLE, 3, dim_ids, &fieldIDs[0]);
+    err = nc_def_var( ncid, "field1", NC_DOUBLE, 3, dim_ids, &fieldIDs[1]);
+    err = nc_enddef( ncid);
+    size_t count[3] = {1, g.n()*g.Ny(), g.n()*g.Nx()};
+    size_t start[3] = {0, 0, 0};
+    for( unsigned i=0; i<NT; i++)
+    {
+        start[0] = i;
+        HVec field = data;
+        dg::blas1::scal( field, (double)i);
+        err = nc_put_vara_double( ncid, fieldIDs[0], start, count, field.data());
+        dg::blas1::scal( field, 2.);
+        err = nc_put_vara_double( ncid, fieldIDs[1], start, count, field.data());
+    }
+    err = nc_close( ncid);
+
+    err = nc_open( "prefetch.nc", NC_NOWRITE, &ncid);
+    std::vector<std::string> names( 2);
+    names[0] = "field0", names[1] = "field1";
+    double error = 0;
+    unsigned number = 0;
+    {
+        file::PrefetchReader reader( ncid, names, 5, NT, 3);
+        file::Slice slice;
+        while( reader.next( slice))
+        {
+            dg::blas1::axpby( (double)slice.index, data, -1., slice.fields[0]);
+            dg::blas1::axpby( 2.*slice.index, data, -1., slice.fields[1]);
+            error += dg::blas2::dot( w2d, slice.fields[0]) + dg::blas2::dot( w2d, slice.fields[1]);
+            number++;
+        }
+    }
+    std::cout << "Slices   "<<number<<" ("<<NT-5<<")\n";
+    std::cout << "Error    "<<sqrt(error)<<" (0)\n";
+    //without a background thread the slices are read in next()
+    error = 0, number = 0;
+    {
+        file::PrefetchReader reader( ncid, names, 0, NT, 4, false);
+        file::Slice slice;
+        while( reader.next( slice))
+        {
+            dg::blas1::axpby( (double)slice.index, data, -1., slice.fields[0]);
+            error += dg::blas2::dot( w2d, slice.fields[0]);
+            number++;
+        }
+        std::cout << "Background "<<reader.background()<<" (0)\n";
+    }
+    std::cout << "Slices   "<<number<<" ("<<NT<<")\n";
+    std::cout << "Error    "<<sqrt(error)<<" (0)\n";
+    {
+        file::PrefetchReader reader( ncid, names, 0, NT, 4);
+        Sum sum;
+        std::vector<double> total( 2, 0.);
+        std::vector<std::vector<double> > mass = file::map_reduce( reader, Mass( w2d), sum, total);
+        const double mass0 = dg::blas1::dot( w2d, data);
+        std::cout << "Mass     "<<mass[3][0]<<" ("<<3*mass0<<")\n";
+        std::cout << "Total    "<<total[1]<<" ("<<NT*(NT-1)*mass0<<")\n";
+    }
+    err = nc_close( ncid);
+    return 0;
+}
@@ -42,6 +42,7 @@ struct CurvilinearGrid3d : public dg::Grid3d
     }
 
     perpendicular_grid perp_grid() const { return perpendicular_grid(*this);}
+    ///@brief the coordinates and metric elements are 2d vectors (the same in every plane)
     const thrust::host_vector<double>& r()const{return r_;}
     const thrust::host_vector<double>& z()const{return z_;}
     const thrust::host_vector<double>& xr()const{return xr_;}
@@ -64,31 +65,13 @@ struct CurvilinearGrid3d : public dg::Grid3d
         thrust::host_vector<double> y_vec = dg::evaluate( dg::cooX1d, gY1d);
         generator( x_vec, y_vec, r_, z_, xr_, xz_, yr_, yz_);
         init_X_boundaries( 0., generator.width());
-        lift3d( ); //lift to 3D grid
-        construct_metric();
+        construct_metric(); //no lift to 3D grid
     }
-    void lift3d( )
-    {
-        //lift to 3D grid
-        unsigned size = this->size();
-        r_.resize( size), z_.resize(size), xr_.resize(size), yr_.resize( size), xz_.resize( size), yz_.resize(size);
-        unsigned Nx = this->n()*this->Nx(), Ny = this->n()*this->Ny();
-        for( unsigned k=1; k<this->Nz(); k++)
-            for( unsigned i=0; i<Nx*Ny; i++)
-            {
-                r_[k*Nx*Ny+i] = r_[(k-1)*Nx*Ny+i];
-                z_[k*Nx*Ny+i] = z_[(k-1)*Nx*Ny+i];
-                xr_[k*Nx*Ny+i] = xr_[(k-1)*Nx*Ny+i];
-                xz_[k*Nx*Ny+i] = xz_[(k-1)*Nx*Ny+i];
-                yr_[k*Nx*Ny+i] = yr_[(k-1)*Nx*Ny+i];
-                yz_[k*Nx*Ny+i] = yz_[(k-1)*Nx*Ny+i];
-            }
-    }
-    //compute metric elements from xr, xz, yr, yz, r and z
+    //compute metric elements from xr, xz, yr, yz, r and z (in one plane)
     void construct_metric( )
     {
         thrust::host_vector<double> tempxx( r_), tempxy(r_), tempyy(r_), tempvol(r_);
-        for( unsigned i = 0; i<this->size(); i++)
+        for( unsigned i = 0; i<r_.size(); i++)
         {
             tempxx[i] = (xr_[i]*xr_[i]+xz_[i]*xz_[i]);
             tempxy[i] = (yr_[i]*xr_[i]+yz_[i]*xz_[i]);
@@ -98,13 +81,13 @@ struct CurvilinearGrid3d : public dg::Grid3d
         g_xx_=tempxx, g_xy_=tempxy, g_yy_=tempyy, vol_=tempvol;
         dg::blas1::pointwiseDivide( tempvol, r_, tempvol);
         vol2d_ = tempvol;
-        thrust::host_vector<double> ones = dg::evaluate( dg::one, *this);
+        thrust::host_vector<double> ones( r_.size(), 1.);
         dg::blas1::pointwiseDivide( ones, r_, tempxx);
         dg::blas1::pointwiseDivide( tempxx, r_, tempxx); //1/R^2
         g_pp_=tempxx;
     }
-    thrust::host_vector<double> r_, z_, xr_, xz_, yr_, yz_;
-    container g_xx_, g_xy_, g_yy_, g_pp_, vol_, vol2d_;
+    thrust::host_vector<double> r_, z_, xr_, xz_, yr_, yz_; //2d vector
+    container g_xx_, g_xy_, g_yy_, g_pp_, vol_, vol2d_; //2d vector
 };
 
 /**
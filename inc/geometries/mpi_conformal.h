@@ -34,33 +34,31 @@ struct ConformalMPIGrid3d : public dg::MPIGrid3d
         r_(dg::evaluate( dg::one, *this)), z_(r_), xr_(r_), xz_(r_), yr_(r_), yz_(r_),
         g_xx_(r_), g_xy_(g_xx_), g_yy_(g_xx_), g_pp_(g_xx_), vol_(g_xx_), vol2d_(g_xx_)
     {
-        dg::ConformalGrid3d<LocalContainer> g( generator, n,Nx, Ny, local().Nz(), bcx);
+        dg::ConformalGrid3d<LocalContainer> g( generator, n,Nx, Ny, 1, bcx); //metric is the same in every plane
 
         //divide and conquer
-        int dims[3], periods[3], coords[3];
-        MPI_Cart_get( comm, 3, dims, periods, coords);
         init_X_boundaries( g.x0(), g.x1());
-        for( unsigned s=0; s<this->Nz(); s++)
-            //for( unsigned py=0; py<dims[1]; py++)
-                for( unsigned i=0; i<this->n()*this->Ny(); i++)
-                    //for( unsigned px=0; px<dims[0]; px++)
-                        for( unsigned j=0; j<this->n()*this->Nx(); j++)
-                        {
-                            unsigned idx1 = (s*this->n()*this->Ny()+i)*this->n()*this->Nx() + j;
-                            unsigned idx2 = (((s*dims[1]+coords[1])*this->n()*this->Ny()+i)*dims[0] + coords[0])*this->n()*this->Nx() + j;
-                            r_.data()[idx1] = g.r()[idx2];
-                            z_.data()[idx1] = g.z()[idx2];
-                            xr_.data()[idx1] = g.xr()[idx2];
-                            xz_.data()[idx1] = g.xz()[idx2];
-                            yr_.data()[idx1] = g.yr()[idx2];
-                            yz_.data()[idx1] = g.yz()[idx2];
-                            g_xx_.data()[idx1] = g.g_xx()[idx2];
-                            g_xy_.data()[idx1] = g.g_xy()[idx2];
-                            g_yy_.data()[idx1] = g.g_yy()[idx2];
-                            g_pp_.data()[idx1] = g.g_pp()[idx2];
-                            vol_.data()[idx1] = g.vol()[idx2];
-                            vol2d_.data()[idx1] = g.perpVol()[idx2];
-                        }
+        unsigned size2d = this->n()*this->n()*this->Nx()*this->Ny();
+        r_.data().resize( size2d), z_.data().resize( size2d), xr_.data().resize( size2d), xz_.data().resize( size2d), yr_.data().resize( size2d), yz_.data().resize( size2d);
+        g_xx_.data().resize( size2d), g_xy_.data().resize( size2d), g_yy_.data().resize( size2d), g_pp_.data().resize( size2d), vol_.data().resize( size2d), vol2d_.data().resize( size2d);
+        for( unsigned i=0; i<this->n()*this->Ny(); i++)
+            for( unsigned j=0; j<this->n()*this->Nx(); j++)
+            {
+                unsigned idx1 = i*this->n()*this->Nx() + j;
+                unsigned idx2 = (this->offsetY()*this->n()+i)*this->n()*g.Nx() + this->offsetX()*this->n() + j; //g is the global grid
+                r_.data()[idx1] = g.r()[idx2];
+                z_.data()[idx1] = g.z()[idx2];
+                xr_.data()[idx1] = g.xr()[idx2];
+                xz_.data()[idx1] = g.xz()[idx2];
+                yr_.data()[idx1] = g.yr()[idx2];
+                yz_.data()[idx1] = g.yz()[idx2];
+                g_xx_.data()[idx1] = g.g_xx()[idx2];
+                g_xy_.data()[idx1] = g.g_xy()[idx2];
+                g_yy_.data()[idx1] = g.g_yy()[idx2];
+                g_pp_.data()[idx1] = g.g_pp()[idx2];
+                vol_.data()[idx1] = g.vol()[idx2];
+                vol2d_.data()[idx1] = g.perpVol()[idx2];
+            }
     }
 
     //these are for the Field class
@@ -80,8 +78,8 @@ struct ConformalMPIGrid3d : public dg::MPIGrid3d
     const dg::MPI_Vector<LocalContainer>& vol()const{return vol_;}
     const dg::MPI_Vector<LocalContainer>& perpVol()const{return vol2d_;}
     private:
-    dg::MPI_Vector<thrust::host_vector<double> > r_, z_, xr_, xz_, yr_, yz_; //3d vector
-    dg::MPI_Vector<LocalContainer> g_xx_, g_xy_, g_yy_, g_pp_, vol_, vol2d_;
+    dg::MPI_Vector<thrust::host_vector<double> > r_, z_, xr_, xz_, yr_, yz_; //2d vector
+    dg::MPI_Vector<LocalContainer> g_xx_, g_xy_, g_yy_, g_pp_, vol_, vol2d_; //2d vector
 };
 
 /**
@@ -100,27 +98,23 @@ struct ConformalMPIGrid2d : public dg::MPIGrid2d
     {
         dg::ConformalGrid2d<LocalContainer> g( generator, n,Nx, Ny, bcx);
         //divide and conquer
-        int dims[2], periods[2], coords[2];
-        MPI_Cart_get( communicator(), 2, dims, periods, coords);
         init_X_boundaries( g.x0(), g.x1());
-            //for( unsigned py=0; py<dims[1]; py++)
-                for( unsigned i=0; i<this->n()*this->Ny(); i++)
-                    //for( unsigned px=0; px<dims[0]; px++)
-                        for( unsigned j=0; j<this->n()*this->Nx(); j++)
-                        {
-                            unsigned idx1 = i*this->n()*this->Nx() + j;
-                            unsigned idx2 = ((coords[1]*this->n()*this->Ny()+i)*dims[0] + coords[0])*this->n()*this->Nx() + j;
-                            r_.data()[idx1] = g.r()[idx2];
-                            z_.data()[idx1] = g.z()[idx2];
-                            xr_.data()[idx1] = g.xr()[idx2];
-                            xz_.data()[idx1] = g.xz()[idx2];
-                            yr_.data()[idx1] = g.yr()[idx2];
-                            yz_.data()[idx1] = g.yz()[idx2];
-                            g_xx_.data()[idx1] = g.g_xx()[idx2];
-                            g_xy_.data()[idx1] = g.g_xy()[idx2];
-                            g_yy_.data()[idx1] = g.g_yy()[idx2];
-                            vol2d_.data()[idx1] = g.perpVol()[idx2];
-                        }
+        for( unsigned i=0; i<this->n()*this->Ny(); i++)
+            for( unsigned j=0; j<this->n()*this->Nx(); j++)
+            {
+                unsigned idx1 = i*this->n()*this->Nx() + j;
+                unsigned idx2 = (this->offsetY()*this->n()+i)*this->n()*g.Nx() + this->offsetX()*this->n() + j; //g is the global grid
+                r_.data()[idx1] = g.r()[idx2];
+                z_.data()[idx1] = g.z()[idx2];
+                xr_.data()[idx1] = g.xr()[idx2];
+                xz_.data()[idx1] = g.xz()[idx2];
+                yr_.data()[idx1] = g.yr()[idx2];
+                yz_.data()[idx1] = g.yz()[idx2];
+                g_xx_.data()[idx1] = g.g_xx()[idx2];
+                g_xy_.data()[idx1] = g.g_xy()[idx2];
+                g_yy_.data()[idx1] = g.g_yy()[idx2];
+                vol2d_.data()[idx1] = g.perpVol()[idx2];
+            }
     }
     ConformalMPIGrid2d( const ConformalMPIGrid3d<LocalContainer>& g):
         dg::MPIGrid2d( g.global().x0(), g.global().x1(), g.global().y0(), g.global().y1(), g.global().n(), g.global().Nx(), g.global().Ny(), g.global().bcx(), g.global().bcy(), get_reduced_comm( g.communicator() )),
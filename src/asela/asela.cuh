@@ -248,7 +248,8 @@ struct Asela
     void vecdotnablaN(const container& x, const container& y, container& z, container& target);
     void vecdotnablaDIR(const container& x, const container& y, container& z, container& target);
     //extrapolates and solves for phi[1], then adds square velocity ( omega)
-    container& compute_psi( container& potential);
+    //for flrmode 1 and beta!=0 also lambda = Gamma (N_i w_i) (needs correct npe)
+    container& compute_psi( const std::vector<container>& y, container& potential);
     container& polarisation( const std::vector<container>& y); //solves polarisation equation
     container& induct(const std::vector<container>& y);//solves induction equation
     double add_parallel_dynamics( std::vector<container>& y, std::vector<container>& yp);
@@ -269,7 +270,8 @@ struct Asela
     dg::Poisson< Geometry, Matrix, container > poissonN,poissonDIR; 
     dg::Elliptic<  Geometry, Matrix, container  > pol,lapperpN,lapperpDIR; //note the host vector
     dg::Helmholtz< Geometry, Matrix, container  > maxwell, invgammaDIR, invgammaN;
-    dg::Invert<container> invert_maxwell, invert_pol, invert_invgammaN,invert_invgammaNW,invert_invgammaA, invert_invgammaPhi;
+    dg::Invert<container> invert_maxwell, invert_pol, invert_invgammaN,invert_invgammaA, invert_invgammaPhi;
+    dg::MultiInvert<container> invert_invgammaPhiNW; //Gamma phi and Gamma (N_i w_i) in one solve
 
     const eule::Parameters p;
     const dg::geo::solovev::GeomParameters gp;
@@ -337,9 +339,18 @@ Asela<Grid, DS, Matrix, container>::Asela( const Grid& g, Parameters p, dg::geo:
     invert_pol.construct(         omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_pol  ); 
     invert_maxwell.construct(     omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_maxwell ); 
     invert_invgammaN.construct(   omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
-    invert_invgammaNW.construct(  omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
+    invert_invgammaPhiNW.construct( omega, 2, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
     invert_invgammaA.construct(   omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
     invert_invgammaPhi.construct( omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
+    //perpendicular operators decouple the planes: optionally solve each plane on its own
+    if( p.plane_cg)
+    {
+        invert_pol.set_planes( g.Nz());
+        invert_maxwell.set_planes( g.Nz());
+        invert_invgammaN.set_planes( g.Nz());
+        invert_invgammaA.set_planes( g.Nz());
+        invert_invgammaPhi.set_planes( g.Nz());
+    }
     //////////////////////////////init fields /////////////////////
     using namespace dg::geo::solovev;
     MagneticField mf(gp);
@@ -425,8 +436,7 @@ container& Asela<Geometry, DS, Matrix, container>::induct(const std::vector<cont
         dg::blas1::axpby( p.beta/p.mu[0], npe[0], 0., chi); //chi = beta/mu_e N_e
         maxwell.set_chi(chi);
 
-        dg::blas1::pointwiseDot( npe[1], y[3], chi);               //lambda = N_i w_i
-        invert_invgammaNW(invgammaDIR,lambda,chi);             //chi= Gamma (Ni wi)
+        //lambda = Gamma (N_i w_i) was computed together with Gamma phi in compute_psi
         dg::blas1::pointwiseDot( npe[0], y[2], chi);                 //chi     = n_e w_e
         dg::blas1::axpby( -1.,lambda , 1., chi);  //chi = - Gamma (n_i w_i) + n_e w_e
         //maxwell = (lap_per + beta*( n_e/mu_e)) A_parallel 
@@ -438,9 +448,15 @@ container& Asela<Geometry, DS, Matrix, container>::induct(const std::vector<cont
     return apar[0];
 }
 template<class Geometry, class DS, class Matrix, class container>
-container& Asela<Geometry, DS, Matrix,container>::compute_psi( container& potential)
+container& Asela<Geometry, DS, Matrix,container>::compute_psi( const std::vector<container>& y, container& potential)
 {
-    invert_invgammaPhi(invgammaDIR,chi,potential);                    //chi  Gamma phi
+    if( p.flrmode == 1 && p.beta != 0.)
+    {
+        dg::blas1::pointwiseDot( npe[1], y[3], omega);                //omega = N_i w_i
+        invert_invgammaPhiNW(invgammaDIR,chi,potential,lambda,omega); //chi = Gamma phi, lambda = Gamma (N_i w_i)
+    }
+    else
+        invert_invgammaPhi(invgammaDIR,chi,potential);                //chi  Gamma phi
     poissonN.variationRHS(potential, omega);
     dg::blas1::pointwiseDot( binv, omega, omega);
     dg::blas1::pointwiseDot( binv, omega, omega);
@@ -602,7 +618,6 @@ void Asela<Geometry, DS, Matrix, container>::operator()( std::vector<container>&
     
     //compute phi via polarisation
     phi[0] = polarisation( y); //computes phi and Gamma n_i
-    phi[1] = compute_psi( phi[0]); //sets omega = u_E^2
     
     //transform n-1 to n and n to logn
     for(unsigned i=0; i<2; i++)
@@ -610,6 +625,7 @@ void Asela<Geometry, DS, Matrix, container>::operator()( std::vector<container>&
         dg::blas1::transform( y[i], npe[i], dg::PLUS<>(+1)); //npe = N+1
         dg::blas1::transform( npe[i], logn[i], dg::LN<double>());
     }
+    phi[1] = compute_psi( y, phi[0]); //sets omega = u_E^2 and needs correct npe
     //compute A_parallel via induction and compute U_e and U_i from it
     if (p.beta!=0.) apar[0] = induct(y); //computes a_par and needs correct npe
     if (p.flrmode==1) invert_invgammaA(invgammaDIR,apar[1] ,apar[0] );             //chi= Gamma (Ni-1)
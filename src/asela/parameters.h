@@ -54,6 +54,7 @@ struct Parameters
     enum dg::bc bc; //!< global perpendicular boundary condition
     unsigned pollim; //!< 0= no poloidal limiter, 1 = poloidal limiter
     unsigned pardiss; //!< 0 = adjoint parallel dissipation, 1 = nonadjoint parallel dissipation
+    unsigned plane_cg; //!< 1 = solve perpendicular inversions plane by plane (dg::PlaneCG), 0 = one CG for all planes
     unsigned mode; //!< 0 = blob simulations (several rounds fieldaligned), 1 = straight blob simulation( 1 round fieldaligned), 2 = turbulence simulations ( 1 round fieldaligned), 
     unsigned initcond; //!< 0 = zero electric potential, 1 = ExB vorticity equals ion diamagnetic vorticity
     unsigned curvmode; //!< 0 = low beta, 1 = toroidal field line 
@@ -106,6 +107,7 @@ struct Parameters
 
         pollim      = js.get( "pollim", 0).asUInt();
         pardiss     = js.get( "pardiss", 0).asUInt();
+        plane_cg    = js.get( "plane_cg", 0).asUInt();
         mode        = js.get( "mode", 0).asUInt();
         initcond    = js.get( "initial", 0).asUInt();
         curvmode    = js.get( "curvmode", 0).asUInt();
@@ -163,6 +165,7 @@ struct Parameters
             <<"     global BC             =              "<<dg::bc2str(bc)<<"\n"
             <<"     Poloidal limiter      =              "<<pollim<<"\n"
             <<"     Parallel dissipation  =              "<<pardiss<<"\n"
+            <<"     Plane by plane CG     =              "<<plane_cg<<"\n"
             <<"     Computation mode      =              "<<mode<<"\n"
             <<"     init cond             =              "<<initcond<<"\n"
             <<"     curvature mode        =              "<<curvmode<<"\n"
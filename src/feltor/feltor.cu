@@ -50,6 +50,7 @@ int main( int argc, char* argv[])
     }
     const eule::Parameters p( js);
     const dg::geo::solovev::GeomParameters gp(gs);
+    dg::set_huge_pages( p.huge_pages); //before any device vector is allocated
     p.display( std::cout);
     gp.display( std::cout);
     /////////glfw initialisation ////////////////////////////////////////////
@@ -73,6 +74,12 @@ int main( int argc, char* argv[])
     eule::Feltor<dg::CylindricalGrid3d<dg::DVec>, dg::DS<DFA, dg::DMatrix, dg::DVec>, dg::DMatrix, dg::DVec> feltor( grid, p, gp); //initialize before rolkar!
     std::cout << "Constructing Rolkar...\n";
     eule::Rolkar<dg::CylindricalGrid3d<dg::DVec>, dg::DS<DFA, dg::DMatrix, dg::DVec>, dg::DMatrix, dg::DVec> rolkar( grid, p, gp, feltor.ds(), feltor.dsDIR());
+    if( p.pardiss == 0 && p.pardiss_assembled)
+    {
+        std::cout << "Assembling parallel dissipation...\n";
+        feltor.ds().assemble();
+        feltor.dsDIR().assemble();
+    }
     std::cout << "Done!\n";
 
     /////////////////////The initial field///////////////////////////////////////////
@@ -243,6 +243,17 @@ struct Feltor
      */
     double fieldalignment() { return aligned_;}
 
+    /**
+     * @brief The inversion objects that extrapolate from previous solutions
+     *
+     * @return invert_pol, invert_invgammaN, invert_invgammaPhi (needed for checkpointing)
+     */
+    std::vector<dg::Invert<container>* > inverts() {
+        std::vector<dg::Invert<container>* > v(3);
+        v[0] = &invert_pol, v[1] = &invert_invgammaN, v[2] = &invert_invgammaPhi;
+        return v;
+    }
+
   private:
     void vecdotnablaN(const container& x, const container& y, container& z, container& target);
     void vecdotnablaDIR(const container& x, const container& y, container& z, container& target);
@@ -272,6 +283,7 @@ struct Feltor
     dg::Helmholtz< Geometry, Matrix, container > invgammaDIR, invgammaN;
 
     dg::Invert<container> invert_pol,invert_invgammaN,invert_invgammaPhi;
+    dg::Workspace<container> workspace_; //temporaries shared by the operators and solvers above
 
     const eule::Parameters p;
     const dg::geo::solovev::GeomParameters gp;
@@ -335,6 +347,23 @@ Feltor<Grid, DS, Matrix, container>::Feltor( const Grid& g, eule::Parameters p,
     invert_pol.construct(         omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_pol  ); 
     invert_invgammaN.construct(   omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
     invert_invgammaPhi.construct( omega, p.Nx*p.Ny*p.Nz*p.n*p.n, p.eps_gamma); 
+    //perpendicular operators decouple the planes: optionally solve each plane on its own
+    if( p.plane_cg)
+    {
+        invert_pol.set_planes( g.Nz());
+        invert_invgammaN.set_planes( g.Nz());
+        invert_invgammaPhi.set_planes( g.Nz());
+    }
+    //////////////////////////share temporaries/////////////////////
+    workspace_.construct( omega);
+    pol.set_workspace( workspace_);
+    lapperpN.set_workspace( workspace_);
+    lapperpDIR.set_workspace( workspace_);
+    invgammaDIR.set_workspace( workspace_);
+    invgammaN.set_workspace( workspace_);
+    invert_pol.set_workspace( workspace_);
+    invert_invgammaN.set_workspace( workspace_);
+    invert_invgammaPhi.set_workspace( workspace_);
     //////////////////////////////init fields /////////////////////
     using namespace dg::geo::solovev;
     MagneticField mf(gp);
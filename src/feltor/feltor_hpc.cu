@@ -13,6 +13,9 @@
 
 
 #include "file/nc_utilities.h"
+#include "file/checkpoint.h"
+#include "file/modal_output.h"
+#include "file/insitu.h"
 
 #include "feltor.cuh"
 
@@ -21,6 +24,9 @@
    - Initializes and integrates Feltor and 
    - writes outputs to a given outputfile using netcdf 
         density fields are the real densities in XSPACE ( not logarithmic values)
+   - writes checkpoints to outputfile.chk and restarts from a given checkpoint
+        (only with the same parameters unless "force" is appended)
+        by appending to the existing outputfile
 
 */
 
@@ -31,9 +37,9 @@ int main( int argc, char* argv[])
     ////////////////////////Parameter initialisation//////////////////////////
     Json::Reader reader;
     Json::Value js, gs;
-    if( argc != 4)
+    if( argc != 4 && argc != 5 && !( argc == 6 && std::string( argv[5]) == "force"))
     {
-        std::cerr << "ERROR: Wrong number of arguments!\nUsage: "<< argv[0]<<" [inputfile] [geomfile] [outputfile]\n";
+        std::cerr << "ERROR: Wrong number of arguments!\nUsage: "<< argv[0]<<" [inputfile] [geomfile] [outputfile] ([checkpointfile] [force])\n";
         return -1;
     }
     else 
@@ -45,8 +51,12 @@ int main( int argc, char* argv[])
     }
     const eule::Parameters p( js);
     const dg::geo::solovev::GeomParameters gp(gs);
+    dg::set_huge_pages( p.huge_pages); //before any device vector is allocated
     p.display( std::cout);
     gp.display( std::cout);
+#if THRUST_DEVICE_SYSTEM!=THRUST_DEVICE_SYSTEM_CUDA
+    dg::report_thread_placement( std::cout);
+#endif //THRUST_DEVICE_SYSTEM
     std::string input = js.toStyledString(), geom = gs.toStyledString();
     ////////////////////////////////set up computations///////////////////////////
 
@@ -63,12 +73,20 @@ int main( int argc, char* argv[])
     eule::Feltor<dg::CylindricalGrid3d<dg::DVec>, dg::DS<DFA, dg::DMatrix, dg::DVec>, dg::DMatrix, dg::DVec> feltor( grid, p, gp); //initialize before rolkar!
     std::cout << "Constructing Rolkar...\n";
     eule::Rolkar< dg::CylindricalGrid3d<dg::DVec>, dg::DS<DFA, dg::DMatrix, dg::DVec>, dg::DMatrix, dg::DVec > rolkar( grid, p, gp, feltor.ds(), feltor.dsDIR());
+    if( p.pardiss == 0 && p.pardiss_assembled)
+    {
+        std::cout << "Assembling parallel dissipation...\n";
+        feltor.ds().assemble();
+        feltor.dsDIR().assemble();
+    }
     std::cout << "Done!\n";
 
     /////////////////////The initial field//////////////////////////////////////////
     //background profile
     dg::geo::Nprofile<Psip> prof(p.bgprofamp, p.nprofileamp, gp, Psip(gp)); //initial background profile
-    std::vector<dg::DVec> y0(4, dg::evaluate( prof, grid)), y1(y0); 
+    dg::DVec profile;
+    dg::evaluate( prof, grid, profile); //straight into device memory
+    std::vector<dg::DVec> y0(4, profile), y1(y0); 
     //perturbation 
     dg::GaussianZ gaussianZ( 0., p.sigma_z*M_PI, 1); //modulation along fieldline
     if( p.mode == 0 || p.mode == 1)
@@ -93,7 +111,8 @@ int main( int argc, char* argv[])
     dg::blas1::plus(y0[1], -1); //initialize ni-1
     if( p.mode == 2 || p.mode == 3)
     {
-        dg::DVec damping = dg::evaluate( dg::geo::GaussianProfXDamping<Psip>(Psip(gp), gp), grid);
+        dg::DVec damping;
+        dg::evaluate( dg::geo::GaussianProfXDamping<Psip>(Psip(gp), gp), grid, damping);
         dg::blas1::pointwiseDot(damping, y0[1], y0[1]); //damp with gaussprofdamp
     }
     std::cout << "intiialize ne" << std::endl;
@@ -103,14 +122,132 @@ int main( int argc, char* argv[])
     dg::blas1::axpby( 0., y0[3], 0., y0[3]); //set Ui = 0
     
     dg::Karniadakis< std::vector<dg::DVec> > karniadakis( y0, y0[0].size(), p.eps_time);
-    karniadakis.init( feltor, rolkar, y0, p.dt);
+    double time = 0;
+    unsigned step = 0;
+    const bool restart = (argc >= 5);
+    const std::string checkpoint = file::checkpoint_name( std::string(argv[3])+".chk");
+    if( restart)
+    {
+        std::cout << "Restart from checkpoint "<<argv[4]<<" ...\n";
+        file::CheckpointReader chk( file::checkpoint_name( argv[4]));
+        if( chk.parameters() != input+geom)
+        {
+            if( argc != 6)
+            {
+                std::cerr << "ERROR: Parameters differ from the ones in the checkpoint! Append \"force\" to resume anyway.\n";
+                return -1;
+            }
+            std::cerr << "WARNING: Parameters differ from the ones in the checkpoint!\n";
+        }
+        time = chk.time(), step = chk.step();
+        std::vector<std::vector<dg::DVec> > u(3, y0), f(3, y0);
+        chk.read( y0);
+        chk.read( u);
+        chk.read( f);
+        karniadakis.restart( u, f, p.dt);
+        std::vector<dg::Invert<dg::DVec>* > inverts = feltor.inverts();
+        std::vector<dg::DVec> phi( 3, y0[0]);
+        for( unsigned i=0; i<inverts.size(); i++)
+        {
+            chk.read( phi);
+            inverts[i]->set_history( phi[0], phi[1], phi[2]);
+        }
+        std::cout << "Done! Continue at time "<<time<<" (step "<<step<<")\n";
+    }
+    else
+        karniadakis.init( feltor, rolkar, y0, p.dt);
+    /////////////////////////////in-situ diagnostics///////////////////////////////
+    //reduced quantities computed from the device fields every p.insitu steps
+    file::InSitu<dg::DVec> insitu( p.insitu);
+    if( p.insitu != 0)
+    {
+        std::string quantities[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
+        for( unsigned i=0; i<5; i++)
+        {
+            insitu.add( new file::ToroidalAverageReducer<dg::DVec>( quantities[i]+"_tavg", i, grid));
+            insitu.add( new file::PlaneFluctuationReducer<dg::DVec>( quantities[i]+"_fluc", i, grid, grid.Nz()/2));
+        }
+        insitu.add( new file::PoloidalAverageReducer<dg::DVec, dg::iDVec>( "electrons_profile", 0, grid));
+        //flux surface average on the range of psi in the box
+        MagneticField c(gp);
+        dg::Grid2d g2d( Rmin,Rmax, Zmin,Zmax, p.n, p.Nx, p.Ny, p.bc, p.bc);
+        dg::HVec psipog2d = dg::evaluate( Psip(gp), g2d);
+        double psipmin = (double)thrust::reduce( psipog2d.begin(), psipog2d.end(), 0.0, thrust::minimum<double>());
+        double psipmax = (double)thrust::reduce( psipog2d.begin(), psipog2d.end(), psipmin, thrust::maximum<double>());
+        dg::Grid1d gpsi( psipmin, psipmax, 1, 50, dg::NEU);
+        insitu.add( new file::FluxSurfaceReducer<dg::geo::FluxSurfaceAverage<MagneticField, dg::DVec>, MagneticField, dg::DVec>( "electrons_fsa", 0, grid, c, gpsi));
+        //electron ExB flux through flux surfaces: n_e [phi, psi]_RZ/B/|grad psi|
+        dg::DVec psipR, psipZ, weight;
+        dg::evaluate( PsipR(gp), grid, psipR);
+        dg::evaluate( PsipZ(gp), grid, psipZ);
+        dg::evaluate( dg::geo::Field<MagneticField>(c, gp.R_0), grid, weight);
+        dg::DVec gradpsi( psipR), temp( psipZ);
+        dg::blas1::pointwiseDot( psipR, psipR, gradpsi);
+        dg::blas1::pointwiseDot( psipZ, psipZ, temp);
+        dg::blas1::axpby( 1., temp, 1., gradpsi);
+        dg::blas1::transform( gradpsi, gradpsi, dg::SQRT<double>());
+        dg::blas1::pointwiseDivide( weight, gradpsi, weight);
+        dg::DMatrix dR = dg::create::dx( grid, p.bc, dg::centered), dZ = dg::create::dy( grid, p.bc, dg::centered);
+        insitu.add( new file::RadialFluxReducer<dg::DMatrix, dg::DVec>( "electrons_flux", 0, 4, dR, dZ, psipR, psipZ, weight, grid));
+        //probes on the outboard midplane
+        const unsigned Nprobes = 8;
+        dg::HVec Rprobes( Nprobes), Zprobes( Nprobes, 0.), Phiprobes( Nprobes, M_PI);
+        for( unsigned i=0; i<Nprobes; i++)
+            Rprobes[i] = gp.R_0 + (i+0.5)/(double)Nprobes*p.boxscaleRp*gp.a;
+        dg::IDMatrix probes = dg::create::interpolation( Rprobes, Zprobes, Phiprobes, grid, dg::NEU);
+        insitu.add( new file::ProbeReducer<dg::IDMatrix, dg::DVec>( "electrons_probes", 0, probes, Nprobes));
+        insitu.add( new file::ProbeReducer<dg::IDMatrix, dg::DVec>( "potential_probes", 4, probes, Nprobes));
+        insitu.add( new file::HistogramReducer<dg::DVec>( "electrons_hist", 0, dg::Grid1d( -1., p.nprofileamp + p.amp, 1, 100)));
+    }
     /////////////////////////////set up netcdf/////////////////////////////////////
     file::NC_Error_Handle err;
     int ncid;
+    //field IDs
+    std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
+    int dataIDs[5]; 
+    int dim_ids[4], tvarID;
+    //fields are stored as truncated Legendre coefficients if n_modal != 0
+    const file::ModalTransform modal( grid_out, p.n_modal == 0 ? grid_out.n() : std::min( p.n_modal, grid_out.n()));
+    std::vector<float> modalH;
+    //energy IDs
+    int EtimevarID;
+    int energyID, massID, energyIDs[5], dissID, alignedID, dEdtID, accuracyID;
+    std::string energies[5] = {"Se", "Si", "Uperp", "Upare", "Upari"}; 
+    //probe IDs
+    int NepID,phipID;
+    if( restart)
+    {
+        err = nc_open( argv[3], NC_WRITE, &ncid);
+        err = nc_inq_varid( ncid, "time", &tvarID);
+        for( unsigned i=0; i<5; i++)
+            err = nc_inq_varid( ncid, names[i].data(), &dataIDs[i]);
+        //the fields are appended in the format of the existing file
+        if( file::is_modal_variable( ncid, dataIDs[0]) != (p.n_modal != 0) ||
+            ( p.n_modal != 0 && file::ModalReader( ncid).transform().n_keep() != modal.n_keep()))
+        {
+            std::cerr << "ERROR: n_modal = "<<p.n_modal<<" does not match the field output in "<<argv[3]<<"!\n";
+            err = nc_close( ncid);
+            return -1;
+        }
+        err = nc_inq_varid( ncid, "energy_time", &EtimevarID);
+        err = nc_inq_varid( ncid, "energy", &energyID);
+        err = nc_inq_varid( ncid, "mass", &massID);
+        for( unsigned i=0; i<5; i++)
+            err = nc_inq_varid( ncid, energies[i].data(), &energyIDs[i]);
+        err = nc_inq_varid( ncid, "dissipation", &dissID);
+        err = nc_inq_varid( ncid, "alignment", &alignedID);
+        err = nc_inq_varid( ncid, "dEdt", &dEdtID);
+        err = nc_inq_varid( ncid, "accuracy", &accuracyID);
+        err = nc_inq_varid( ncid, "Ne_p", &NepID);
+        err = nc_inq_varid( ncid, "phi_p", &phipID);
+        if( p.insitu != 0)
+            err = insitu.inquire( ncid);
+    }
+    else
+    {
     err = nc_create( argv[3],NC_NETCDF4|NC_CLOBBER, &ncid);
     err = nc_put_att_text( ncid, NC_GLOBAL, "inputfile", input.size(), input.data());
     err = nc_put_att_text( ncid, NC_GLOBAL, "geomfile", geom.size(), geom.data());
-    int dim_ids[4], tvarID;
     {
         err = file::define_dimensions( ncid, dim_ids, &tvarID, grid_out);
         MagneticField c(gp);
@@ -132,18 +269,22 @@ int main( int argc, char* argv[])
         err = nc_redef(ncid);
     }
     
-    //field IDs
-    std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
-    int dataIDs[5]; 
-    for( unsigned i=0; i<5; i++){
-        err = nc_def_var( ncid, names[i].data(), NC_DOUBLE, 4, dim_ids, &dataIDs[i]);}
-    //energy IDs
-    int EtimeID, EtimevarID;
+    if( p.n_modal == 0)
+    {
+        for( unsigned i=0; i<5; i++){
+            err = nc_def_var( ncid, names[i].data(), NC_DOUBLE, 4, dim_ids, &dataIDs[i]);}
+    }
+    else
+    {
+        int modal_ids[4];
+        err = file::define_modal_dimensions( ncid, modal_ids, dim_ids, modal);
+        for( unsigned i=0; i<5; i++){
+            err = file::define_modal_variable( ncid, names[i].data(), modal_ids, modal, &dataIDs[i]);}
+    }
+    int EtimeID;
     err = file::define_time( ncid, "energy_time", &EtimeID, &EtimevarID);
-    int energyID, massID, energyIDs[5], dissID, alignedID, dEdtID, accuracyID;
     err = nc_def_var( ncid, "energy",   NC_DOUBLE, 1, &EtimeID, &energyID);
     err = nc_def_var( ncid, "mass",   NC_DOUBLE, 1, &EtimeID, &massID);
-    std::string energies[5] = {"Se", "Si", "Uperp", "Upare", "Upari"}; 
     for( unsigned i=0; i<5; i++){
         err = nc_def_var( ncid, energies[i].data(), NC_DOUBLE, 1, &EtimeID, &energyIDs[i]);}
     err = nc_def_var( ncid, "dissipation",   NC_DOUBLE, 1, &EtimeID, &dissID);
@@ -151,10 +292,12 @@ int main( int argc, char* argv[])
     err = nc_def_var( ncid, "dEdt",     NC_DOUBLE, 1, &EtimeID, &dEdtID);
     err = nc_def_var( ncid, "accuracy", NC_DOUBLE, 1, &EtimeID, &accuracyID);
     //probe vars definition
-    int NepID,phipID;
     err = nc_def_var( ncid, "Ne_p",     NC_DOUBLE, 1, &EtimeID, &NepID);
     err = nc_def_var( ncid, "phi_p",    NC_DOUBLE, 1, &EtimeID, &phipID);  
+    if( p.insitu != 0)
+        err = insitu.define( ncid);
     err = nc_enddef(ncid);
+    }
 
     ///////////////////////////////////PROBE//////////////////////////////
     const dg::HVec Xprobe(1,gp.R_0+p.boxscaleRp*gp.a);
@@ -163,31 +306,52 @@ int main( int argc, char* argv[])
     dg::IDMatrix probeinterp(dg::create::interpolation( Xprobe,  Zprobe,Phiprobe,grid, dg::NEU));
     dg::DVec probevalue(1,0.);  
     ///////////////////////////////////first output/////////////////////////
-    std::cout << "First output ... \n";
     size_t start[4] = {0, 0, 0, 0};
     size_t count[4] = {1, grid_out.Nz(), grid_out.n()*grid_out.Ny(), grid_out.n()*grid_out.Nx()};
-    dg::DVec transfer(  dg::evaluate(dg::zero, grid));
-    dg::DVec transferD( dg::evaluate(dg::zero, grid_out));
+    dg::DVec transfer, transferD;
+    dg::evaluate( dg::zero, grid, transfer);
+    dg::evaluate( dg::zero, grid_out, transferD);
     dg::HVec transferH( dg::evaluate(dg::zero, grid_out));
     dg::IDMatrix interpolate = dg::create::interpolation( grid_out, grid); 
+    size_t Estart[] = {0};
+    size_t Ecount[] = {1};
+    double energy0, mass0, E0, mass, E1 = 0.0, dEdt = 0., diss = 0., aligned=0, accuracy=0.;
+    std::vector<double> evec;
+    std::vector<const dg::DVec*> fields( 5);
+    for( unsigned i=0; i<4; i++)
+        fields[i] = &y0[i];
+    fields[4] = &feltor.potential()[0];
+    double Nep, phip;
+    if( restart)
+    {
+        //restore reference values from the output file
+        err = nc_get_vara_double( ncid, energyID, Estart, Ecount, &energy0);
+        err = nc_get_vara_double( ncid, massID,   Estart, Ecount, &mass0);
+        Estart[0] = step;
+        err = nc_get_vara_double( ncid, energyID, Estart, Ecount, &E0);
+        err = nc_get_vara_double( ncid, massID,   Estart, Ecount, &mass);
+        err = nc_get_vara_double( ncid, alignedID, Estart, Ecount, &aligned);
+    }
+    else
+    {
+    std::cout << "First output ... \n";
     for( unsigned i=0; i<4; i++)
     {
         dg::blas2::symv( interpolate, y0[i], transferD);
         dg::blas1::transfer( transferD, transferH);
-        err = nc_put_vara_double( ncid, dataIDs[i], start, count, transferH.data() );
+        err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[i], start, count, transferH.data())
+            : file::put_modal_vara( ncid, dataIDs[i], start[0], modal, transferH, modalH );
     }
     transfer = feltor.potential()[0];
     dg::blas2::symv( interpolate, transfer, transferD);
     dg::blas1::transfer( transferD, transferH);
-    err = nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data() );
-    double time = 0;
+    err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data())
+        : file::put_modal_vara( ncid, dataIDs[4], start[0], modal, transferH, modalH );
     err = nc_put_vara_double( ncid, tvarID, start, count, &time);
     err = nc_put_vara_double( ncid, EtimevarID, start, count, &time);
 
-    size_t Estart[] = {0};
-    size_t Ecount[] = {1};
-    double energy0 = feltor.energy(), mass0 = feltor.mass(), E0 = energy0, mass = mass0, E1 = 0.0, dEdt = 0., diss = 0., aligned=0, accuracy=0.;
-    std::vector<double> evec = feltor.energy_vector();
+    energy0 = feltor.energy(), mass0 = feltor.mass(), E0 = energy0, mass = mass0;
+    evec = feltor.energy_vector();
     err = nc_put_vara_double( ncid, energyID, Estart, Ecount, &energy0);
     err = nc_put_vara_double( ncid, massID,   Estart, Ecount, &mass0);
     for( unsigned i=0; i<5; i++)
@@ -200,20 +364,21 @@ int main( int argc, char* argv[])
     //probe
 
     dg::blas2::gemv(probeinterp,y0[0],probevalue);
-    double Nep= probevalue[0] ;
+    Nep= probevalue[0] ;
     dg::blas2::gemv(probeinterp,feltor.potential()[0],probevalue);
-    double phip=probevalue[0] ;
+    phip=probevalue[0] ;
     err = nc_put_vara_double( ncid, NepID,      Estart, Ecount,&Nep);
     err = nc_put_vara_double( ncid, phipID,     Estart, Ecount,&phip);
-    err = nc_close(ncid);
+    if( insitu.due( step))
+        err = insitu.write( ncid, step, time, fields);
     std::cout << "First write successful!\n";
+    }
+    err = nc_close(ncid);
     ///////////////////////////////////////Timeloop/////////////////////////////////
     dg::Timer t;
     t.tic();
-#ifdef DG_BENCHMARK
-    unsigned step = 0;
-#endif //DG_BENCHMARK
-    for( unsigned i=1; i<=p.maxout; i++)
+    const unsigned outstart = step/p.itstp + 1;
+    for( unsigned i=outstart; i<=p.maxout; i++)
     {
 
 #ifdef DG_BENCHMARK
@@ -254,6 +419,8 @@ int main( int argc, char* argv[])
             phip=probevalue[0] ;
             err = nc_put_vara_double( ncid, NepID,      Estart, Ecount,&Nep);
             err = nc_put_vara_double( ncid, phipID,     Estart, Ecount,&phip);
+            if( insitu.due( step))
+                err = insitu.write( ncid, step, time, fields);
 
             std::cout << "(m_tot-m_0)/m_0: "<< (feltor.mass()-mass0)/mass0<<"\t";
             std::cout << "(E_tot-E_0)/E_0: "<< (E1-energy0)/energy0<<"\t";
@@ -274,14 +441,33 @@ int main( int argc, char* argv[])
         {
             dg::blas2::symv( interpolate, y0[j], transferD);
             dg::blas1::transfer( transferD, transferH);
-            err = nc_put_vara_double( ncid, dataIDs[j], start, count, transferH.data());
+            err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[j], start, count, transferH.data())
+                : file::put_modal_vara( ncid, dataIDs[j], start[0], modal, transferH, modalH);
         }
         transfer = feltor.potential()[0];
         dg::blas2::symv( interpolate, transfer, transferD);
         dg::blas1::transfer( transferD, transferH);
-        err = nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data() );
+        err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data())
+            : file::put_modal_vara( ncid, dataIDs[4], start[0], modal, transferH, modalH );
         err = nc_put_vara_double( ncid, tvarID, start, count, &time);
         err = nc_close(ncid);
+        //////////////////////////write checkpoint////////////////////////
+        if( p.checkpoint != 0 && (i % p.checkpoint == 0 || i == p.maxout))
+        {
+            file::CheckpointWriter chk( checkpoint, time, step, input+geom);
+            chk.write( y0);
+            chk.write( karniadakis.history_u());
+            chk.write( karniadakis.history_f());
+            std::vector<dg::Invert<dg::DVec>* > inverts = feltor.inverts();
+            for( unsigned k=0; k<inverts.size(); k++)
+            {
+                std::vector<dg::DVec> phi( 3);
+                for( unsigned l=0; l<3; l++)
+                    phi[l] = inverts[k]->get_history(l);
+                chk.write( phi);
+            }
+            chk.close();
+        }
 #ifdef DG_BENCHMARK
         ti.toc();
         std::cout << "\n\t Time for output: "<<ti.diff()<<"s\n\n"<<std::flush;
@@ -293,7 +479,8 @@ int main( int argc, char* argv[])
     double second = t.diff() - hour*3600 - minute*60;
     std::cout << std::fixed << std::setprecision(2) <<std::setfill('0');
     std::cout <<"Computation Time \t"<<hour<<":"<<std::setw(2)<<minute<<":"<<second<<"\n";
-    std::cout <<"which is         \t"<<t.diff()/p.itstp/p.maxout<<"s/step\n";
+    if( outstart <= p.maxout) //a restart may already be at the end
+        std::cout <<"which is         \t"<<t.diff()/p.itstp/(p.maxout-outstart+1)<<"s/step\n";
 
     return 0;
 
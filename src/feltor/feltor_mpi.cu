@@ -10,9 +10,12 @@
 #include "dg/backend/timer.cuh"
 #include "dg/backend/xspacelib.cuh"
 #include "dg/backend/interpolation.cuh"
+#include "dg/backend/mpi_init.h"
 
 #include "netcdf_par.h" //exclude if par netcdf=OFF
 #include "file/nc_utilities.h"
+#include "file/checkpoint.h"
+#include "file/modal_output.h"
 
 #include "feltor.cuh"
 
@@ -22,6 +25,11 @@
         the parallel netcdf output 
     - pay attention that both the grid dimensions as well as the 
         output dimensions must be divisible by the mpi process numbers
+        (the program stops with an error message otherwise)
+    - the process grid is read from std::cin unless the inputfile contains
+        e.g. "np" : [0,0,0], where 0 entries are chosen to minimise the halo
+    - every process writes its part of the checkpoint to outputfile.chk.rank;
+        a restart needs the same number of processes and process grid
 */
 
 typedef dg::MPI_FieldAligned< dg::CylindricalMPIGrid3d<dg::MDVec>, dg::IDMatrix,dg::BijectiveComm< dg::iDVec, dg::DVec >, dg::DVec> DFA;
@@ -47,22 +55,12 @@ int main( int argc, char* argv[])
     int device = rank % num_devices; //assume # of gpus/node is fixed
     cudaSetDevice( device);
 #endif//cuda
-    int np[3];
-    if(rank==0)
-    {
-        std::cin>> np[0] >> np[1] >>np[2];
-        std::cout << "Computing with "<<np[0]<<" x "<<np[1]<<" x "<<np[2] << " = "<<size<<std::endl;
-        assert( size == np[0]*np[1]*np[2]);
-    }
-    MPI_Bcast( np, 3, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Comm comm;
-    MPI_Cart_create( MPI_COMM_WORLD, 3, np, periods, true, &comm);
     ////////////////////////Parameter initialisation//////////////////////////
     Json::Reader reader;
     Json::Value js, gs;
-    if( argc != 4)
+    if( argc != 4 && argc != 5 && !( argc == 6 && std::string( argv[5]) == "force"))
     {
-        if(rank==0)std::cerr << "ERROR: Wrong number of arguments!\nUsage: "<< argv[0]<<" [inputfile] [geomfile] [outputfile]\n";
+        if(rank==0)std::cerr << "ERROR: Wrong number of arguments!\nUsage: "<< argv[0]<<" [inputfile] [geomfile] [outputfile] ([checkpointfile] [force])\n";
         return -1;
     }
     else 
@@ -74,8 +72,67 @@ int main( int argc, char* argv[])
     }
     const eule::Parameters p( js);
     const dg::geo::solovev::GeomParameters gp(gs);
+    dg::set_huge_pages( p.huge_pages); //before any device vector is allocated
+    ////////////////////////////////setup process grid//////////////////////
+    MPI_Comm comm;
+    if( js.isMember( "np")) //e.g. "np" : [0,0,0] (0 = choose automatically)
+    {
+        std::vector<int> np( 3, 0);
+        for( unsigned i=0; i<3; i++)
+            np[i] = js["np"].get( i, 0).asInt();
+        std::vector<unsigned> N(3), N_out(3);
+        N[0] = p.Nx, N[1] = p.Ny, N[2] = p.Nz;
+        N_out[0] = p.Nx_out, N_out[1] = p.Ny_out, N_out[2] = p.Nz_out;
+        std::vector<dg::bc> bcs(3); bcs[0] = p.bc, bcs[1] = p.bc, bcs[2] = dg::PER;
+        mpi_cart_create( N, bcs, np, comm, true, N_out);
+    }
+    else
+    {
+        int np[3];
+        if(rank==0)
+        {
+            std::cin>> np[0] >> np[1] >>np[2];
+            std::cout << "Computing with "<<np[0]<<" x "<<np[1]<<" x "<<np[2] << " = "<<size<<std::endl;
+            assert( size == np[0]*np[1]*np[2]);
+        }
+        MPI_Bcast( np, 3, MPI_INT, 0, MPI_COMM_WORLD);
+        MPI_Cart_create( MPI_COMM_WORLD, 3, np, periods, true, &comm);
+    }
+    {
+        //the MPI grids require that the process grid divides all cell numbers
+        int dims[3], periods_[3], coords[3];
+        MPI_Cart_get( comm, 3, dims, periods_, coords);
+        const unsigned N[3]     = {p.Nx, p.Ny, p.Nz};
+        const unsigned N_out[3] = {p.Nx_out, p.Ny_out, p.Nz_out};
+        const char* names[3] = {"x", "y", "z"};
+        bool divisible = true;
+        for( unsigned d=0; d<3; d++)
+            if( N[d]%dims[d] != 0 || N_out[d]%dims[d] != 0)
+            {
+                divisible = false;
+                if(rank==0)std::cerr << "ERROR: "<<dims[d]<<" processes in "<<names[d]<<" do not divide N"<<names[d]<<" = "<<N[d]<<" and N"<<names[d]<<"_out = "<<N_out[d]<<"!\n";
+            }
+        if( !divisible)
+        {
+            if(rank==0)std::cerr << "Choose a different number of processes or different grid sizes.\n";
+            MPI_Finalize();
+            return -1;
+        }
+    }
     if(rank==0)p.display( std::cout);
     if(rank==0)gp.display( std::cout);
+#if THRUST_DEVICE_SYSTEM!=THRUST_DEVICE_SYSTEM_CUDA
+    for( int r=0; r<size; r++) //thread placement of one process after the other
+    {
+        if( r==rank)
+        {
+            std::cout << "Process "<<rank<<": ";
+            dg::report_thread_placement( std::cout);
+            std::cout << std::flush;
+        }
+        MPI_Barrier( MPI_COMM_WORLD);
+    }
+#endif //THRUST_DEVICE_SYSTEM
     std::string input = js.toStyledString(), geom = gs.toStyledString();
     ////////////////////////////////set up computations///////////////////////////
     
@@ -132,17 +189,95 @@ int main( int argc, char* argv[])
     dg::blas1::axpby( 0., y0[3], 0., y0[3]); //set Ui = 0
     
     dg::Karniadakis< std::vector<dg::MDVec> > karniadakis( y0, y0[0].size(), p.eps_time);
-    karniadakis.init( feltor, rolkar, y0, p.dt);
+    double time = 0;
+    unsigned step = 0;
+    const bool restart = (argc >= 5);
+    const std::string checkpoint = file::checkpoint_name( std::string(argv[3])+".chk");
+    if( restart)
+    {
+        if(rank==0)std::cout << "Restart from checkpoint "<<argv[4]<<" ...\n";
+        file::CheckpointReader chk( file::checkpoint_name( argv[4]));
+        if( chk.parameters() != input+geom)
+        {
+            //every process reads the same parameters, so all of them stop
+            if( argc != 6)
+            {
+                if(rank==0)std::cerr << "ERROR: Parameters differ from the ones in the checkpoint! Append \"force\" to resume anyway.\n";
+                MPI_Finalize();
+                return -1;
+            }
+            if(rank==0)std::cerr << "WARNING: Parameters differ from the ones in the checkpoint!\n";
+        }
+        time = chk.time(), step = chk.step();
+        std::vector<std::vector<dg::MDVec> > u(3, y0), f(3, y0);
+        chk.read( y0);
+        chk.read( u);
+        chk.read( f);
+        karniadakis.restart( u, f, p.dt);
+        std::vector<dg::Invert<dg::MDVec>* > inverts = feltor.inverts();
+        std::vector<dg::MDVec> phi( 3, y0[0]);
+        for( unsigned i=0; i<inverts.size(); i++)
+        {
+            chk.read( phi);
+            inverts[i]->set_history( phi[0], phi[1], phi[2]);
+        }
+        if(rank==0)std::cout << "Done! Continue at time "<<time<<" (step "<<step<<")\n";
+    }
+    else
+        karniadakis.init( feltor, rolkar, y0, p.dt);
     /////////////////////////////set up netcdf/////////////////////////////////
     file::NC_Error_Handle err;
     int ncid;
     MPI_Info info = MPI_INFO_NULL;
+    //field IDs 
+    std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
+    int dataIDs[5]; //VARIABLE IDS
+    int dimids[4], tvarID;
+    //fields are stored as truncated Legendre coefficients if n_modal != 0,
+    //every process transforms and writes its own part of the grid
+    const unsigned n_keep = p.n_modal == 0 ? grid_out.n() : std::min( p.n_modal, grid_out.n());
+    const file::ModalTransform modal( grid_out.local(), n_keep);
+    std::vector<float> modalH;
+    //energy IDs 
+    int EtimeID, EtimevarID;
+    int energyID, massID, energyIDs[5], dissID, alignedID, dEdtID, accuracyID;
+    std::string energies[5] = {"Se", "Si", "Uperp", "Upare", "Upari"}; 
+    //probe IDs
+    int NepID,phipID;
+    if( restart)
+    {
+        err = nc_open_par( argv[3], NC_WRITE|NC_MPIIO, comm, info, &ncid);
+        err = nc_inq_varid( ncid, "time", &tvarID);
+        for( unsigned i=0; i<5; i++)
+            err = nc_inq_varid( ncid, names[i].data(), &dataIDs[i]);
+        //the fields are appended in the format of the existing file
+        if( file::is_modal_variable( ncid, dataIDs[0]) != (p.n_modal != 0) ||
+            ( p.n_modal != 0 && file::ModalReader( ncid).transform().n_keep() != n_keep))
+        {
+            if(rank==0)std::cerr << "ERROR: n_modal = "<<p.n_modal<<" does not match the field output in "<<argv[3]<<"!\n";
+            err = nc_close( ncid);
+            MPI_Finalize();
+            return -1;
+        }
+        err = nc_inq_varid( ncid, "energy_time", &EtimevarID);
+        err = nc_inq_varid( ncid, "energy", &energyID);
+        err = nc_inq_varid( ncid, "mass", &massID);
+        for( unsigned i=0; i<5; i++)
+            err = nc_inq_varid( ncid, energies[i].data(), &energyIDs[i]);
+        err = nc_inq_varid( ncid, "dissipation", &dissID);
+        err = nc_inq_varid( ncid, "alignment", &alignedID);
+        err = nc_inq_varid( ncid, "dEdt", &dEdtID);
+        err = nc_inq_varid( ncid, "accuracy", &accuracyID);
+        err = nc_inq_varid( ncid, "Ne_p", &NepID);
+        err = nc_inq_varid( ncid, "phi_p", &phipID);
+    }
+    else
+    {
     err = nc_create_par( argv[3], NC_NETCDF4|NC_MPIIO|NC_CLOBBER, comm, info, &ncid); //MPI ON
     //err = nc_create( argv[3],NC_NETCDF4|NC_CLOBBER, &ncid); //MPI OFF
 
     err = nc_put_att_text( ncid, NC_GLOBAL, "inputfile", input.size(), input.data());
     err = nc_put_att_text( ncid, NC_GLOBAL, "geomfile",  geom.size(), geom.data());
-    int dimids[4], tvarID;
     {
         MagneticField c(gp);
         err = file::define_dimensions( ncid, dimids, &tvarID, grid_out.global());
@@ -163,18 +298,23 @@ int main( int argc, char* argv[])
         err = nc_redef(ncid);
     }
 
-    //field IDs 
-    std::string names[5] = {"electrons", "ions", "Ue", "Ui", "potential"}; 
-    int dataIDs[5]; //VARIABLE IDS
-    for( unsigned i=0; i<5; i++)
-        err = nc_def_var( ncid, names[i].data(), NC_DOUBLE, 4, dimids, &dataIDs[i]);
-    //energy IDs 
-    int EtimeID, EtimevarID;
+    if( p.n_modal == 0)
+    {
+        for( unsigned i=0; i<5; i++)
+            err = nc_def_var( ncid, names[i].data(), NC_DOUBLE, 4, dimids, &dataIDs[i]);
+    }
+    else
+    {
+        int modal_ids[4];
+        const file::ModalTransform modal_global( grid_out.global(), n_keep);
+        err = file::define_modal_dimensions( ncid, modal_ids, dimids, modal_global);
+        //no deflate: parallel writes to compressed variables need netcdf >= 4.7.4
+        for( unsigned i=0; i<5; i++)
+            err = file::define_modal_variable( ncid, names[i].data(), modal_ids, modal_global, &dataIDs[i], 0);
+    }
     err = file::define_time( ncid, "energy_time", &EtimeID, &EtimevarID);
-    int energyID, massID, energyIDs[5], dissID, alignedID, dEdtID, accuracyID;
     err = nc_def_var( ncid, "energy",   NC_DOUBLE, 1, &EtimeID, &energyID);
     err = nc_def_var( ncid, "mass",   NC_DOUBLE, 1, &EtimeID, &massID);
-    std::string energies[5] = {"Se", "Si", "Uperp", "Upare", "Upari"}; 
     for( unsigned i=0; i<5; i++)
         err = nc_def_var( ncid, energies[i].data(), NC_DOUBLE, 1, &EtimeID, &energyIDs[i]);
     err = nc_def_var( ncid, "dissipation",   NC_DOUBLE, 1, &EtimeID, &dissID);
@@ -182,9 +322,9 @@ int main( int argc, char* argv[])
     err = nc_def_var( ncid, "dEdt",     NC_DOUBLE, 1, &EtimeID, &dEdtID);
     err = nc_def_var( ncid, "accuracy", NC_DOUBLE, 1, &EtimeID, &accuracyID);
     //probe vars definition
-    int NepID,phipID;
     err = nc_def_var( ncid, "Ne_p",     NC_DOUBLE, 1, &EtimeID, &NepID);
     err = nc_def_var( ncid, "phi_p",    NC_DOUBLE, 1, &EtimeID, &phipID);  
+    }
     for(unsigned i=0; i<5; i++)
     {
         err = nc_var_par_access( ncid, energyIDs[i], NC_COLLECTIVE);
@@ -200,7 +340,8 @@ int main( int argc, char* argv[])
     err = nc_var_par_access( ncid, accuracyID, NC_COLLECTIVE);
     err = nc_var_par_access( ncid, NepID, NC_COLLECTIVE);
     err = nc_var_par_access( ncid, phipID, NC_COLLECTIVE);
-    err = nc_enddef(ncid);
+    if( !restart)
+        err = nc_enddef(ncid);
     ///////////////////////////////////PROBE//////////////////////////////
     const dg::HVec Xprobe(1,gp.R_0+p.boxscaleRp*gp.a);
     const dg::HVec Zprobe(1,0.);
@@ -211,33 +352,50 @@ int main( int argc, char* argv[])
         probeinterp=dg::create::interpolation( Xprobe,Zprobe,Phiprobe,grid.local(), dg::NEU);
     dg::DVec probevalue(1,0.);  
     ///////////////////////////first output/////////////////////////////////
-    if(rank==0)std::cout << "First output ... \n";
     int dims[3],  coords[3];
     MPI_Cart_get( comm, 3, dims, periods, coords);
     size_t count[4] = {1, grid_out.Nz(), grid_out.n()*(grid_out.Ny()), grid_out.n()*(grid_out.Nx())};
     size_t start[4] = {0, coords[2]*count[1], coords[1]*count[2], coords[0]*count[3]};
+    size_t mstart[4] = {0, start[1], coords[1]*n_keep*grid_out.Ny(), coords[0]*n_keep*grid_out.Nx()}; //modal block
     dg::MDVec transfer( dg::evaluate(dg::zero, grid));
     dg::DVec transferD( dg::evaluate(dg::zero, grid_out.local()));
     dg::HVec transferH( dg::evaluate(dg::zero, grid_out.local()));
     dg::IDMatrix interpolate = dg::create::interpolation( grid_out.local(), grid.local()); //create local interpolation matrix
+    size_t Estart[] = {0};
+    size_t Ecount[] = {1};
+    double energy0, mass0, E0, mass, E1 = 0.0, dEdt = 0., diss = 0., aligned=0, accuracy=0.;
+    std::vector<double> evec;
+    double Nep=0, phip=0;
+    if( restart)
+    {
+        //restore reference values from the output file
+        err = nc_get_vara_double( ncid, energyID, Estart, Ecount, &energy0);
+        err = nc_get_vara_double( ncid, massID,   Estart, Ecount, &mass0);
+        Estart[0] = step;
+        err = nc_get_vara_double( ncid, energyID, Estart, Ecount, &E0);
+        err = nc_get_vara_double( ncid, massID,   Estart, Ecount, &mass);
+        err = nc_get_vara_double( ncid, alignedID, Estart, Ecount, &aligned);
+    }
+    else
+    {
+    if(rank==0)std::cout << "First output ... \n";
     for( unsigned i=0; i<4; i++)
     {
         dg::blas2::gemv( interpolate, y0[i].data(), transferD);
         dg::blas1::transfer( transferD, transferH);
-        err = nc_put_vara_double( ncid, dataIDs[i], start, count, transferH.data() );
+        err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[i], start, count, transferH.data())
+            : file::put_modal_vara_block( ncid, dataIDs[i], mstart, modal, transferH, modalH);
     }
     transfer = feltor.potential()[0];
     dg::blas2::gemv( interpolate, transfer.data(), transferD);
     dg::blas1::transfer( transferD, transferH);
-    err = nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data());
-    double time = 0;
+    err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data())
+        : file::put_modal_vara_block( ncid, dataIDs[4], mstart, modal, transferH, modalH);
     err = nc_put_vara_double( ncid, tvarID, start, count, &time);
     err = nc_put_vara_double( ncid, EtimevarID, start, count, &time);
 
-    size_t Estart[] = {0};
-    size_t Ecount[] = {1};
-    double energy0 = feltor.energy(), mass0 = feltor.mass(), E0 = energy0, mass = mass0, E1 = 0.0, dEdt = 0., diss = 0., aligned=0, accuracy=0.;
-    std::vector<double> evec = feltor.energy_vector();
+    energy0 = feltor.energy(), mass0 = feltor.mass(), E0 = energy0, mass = mass0;
+    evec = feltor.energy_vector();
     err = nc_put_vara_double( ncid, energyID, Estart, Ecount, &energy0);
     err = nc_put_vara_double( ncid, massID,   Estart, Ecount, &mass0);
     for( unsigned i=0; i<5; i++)
@@ -248,7 +406,6 @@ int main( int argc, char* argv[])
     err = nc_put_vara_double( ncid, dEdtID,     Estart, Ecount,&dEdt);
     err = nc_put_vara_double( ncid, accuracyID, Estart, Ecount,&accuracy);
     //probe
-    double Nep=0, phip=0;
     if(rank==probeRANK) {
         dg::blas2::gemv(probeinterp,y0[0].data(),probevalue);
         Nep=probevalue[0] ;
@@ -260,13 +417,12 @@ int main( int argc, char* argv[])
     err = nc_put_vara_double( ncid, NepID,      Estart, Ecount,&Nep);
     err = nc_put_vara_double( ncid, phipID,     Estart, Ecount,&phip);
     if(rank==0)std::cout << "First write successful!\n";
+    }
     ///////////////////////////////////////Timeloop/////////////////////////////////
     dg::Timer t;
     t.tic();
-#ifdef DG_BENCHMARK
-    unsigned step = 0;
-#endif //DG_BENCHMARK
-    for( unsigned i=1; i<=p.maxout; i++)
+    const unsigned outstart = step/p.itstp + 1;
+    for( unsigned i=outstart; i<=p.maxout; i++)
     {
 
 #ifdef DG_BENCHMARK
@@ -323,18 +479,38 @@ int main( int argc, char* argv[])
 #endif//DG_BENCHMARK
         //err = nc_open_par( argv[3], NC_WRITE|NC_MPIIO, comm, info, &ncid); //dont do it
         //////////////////////////write fields////////////////////////
-        start[0] = i;
+        start[0] = mstart[0] = i;
         for( unsigned j=0; j<4; j++)
         {
             dg::blas2::gemv( interpolate, y0[j].data(), transferD);
             dg::blas1::transfer( transferD, transferH);
-            err = nc_put_vara_double( ncid, dataIDs[j], start, count, transferH.data());
+            err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[j], start, count, transferH.data())
+                : file::put_modal_vara_block( ncid, dataIDs[j], mstart, modal, transferH, modalH);
         }
         transfer = feltor.potential()[0];
         dg::blas2::gemv( interpolate, transfer.data(), transferD);
         dg::blas1::transfer( transferD, transferH);
-        err = nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data() );
+        err = p.n_modal == 0 ? nc_put_vara_double( ncid, dataIDs[4], start, count, transferH.data())
+            : file::put_modal_vara_block( ncid, dataIDs[4], mstart, modal, transferH, modalH);
         err = nc_put_vara_double( ncid, tvarID, start, count, &time);
+        err = nc_sync( ncid); //the checkpoint must not be ahead of the output file
+        //////////////////////////write checkpoint////////////////////////
+        if( p.checkpoint != 0 && (i % p.checkpoint == 0 || i == p.maxout))
+        {
+            file::CheckpointWriter chk( checkpoint, time, step, input+geom);
+            chk.write( y0);
+            chk.write( karniadakis.history_u());
+            chk.write( karniadakis.history_f());
+            std::vector<dg::Invert<dg::MDVec>* > inverts = feltor.inverts();
+            for( unsigned k=0; k<inverts.size(); k++)
+            {
+                std::vector<dg::MDVec> phi( 3);
+                for( unsigned l=0; l<3; l++)
+                    phi[l] = inverts[k]->get_history(l);
+                chk.write( phi);
+            }
+            chk.close();
+        }
 
         //err = nc_close(ncid); DONT DO IT!
 #ifdef DG_BENCHMARK
@@ -348,7 +524,7 @@ int main( int argc, char* argv[])
     double second = t.diff() - hour*3600 - minute*60;
     if(rank==0)std::cout << std::fixed << std::setprecision(2) <<std::setfill('0');
     if(rank==0)std::cout <<"Computation Time \t"<<hour<<":"<<std::setw(2)<<minute<<":"<<second<<"\n";
-    if(rank==0)std::cout <<"which is         \t"<<t.diff()/p.itstp/p.maxout<<"s/step\n";
+    if(rank==0 && outstart <= p.maxout)std::cout <<"which is         \t"<<t.diff()/p.itstp/(p.maxout-outstart+1)<<"s/step\n";
     err = nc_close(ncid);
     MPI_Finalize();
 
@@ -20,6 +20,9 @@ struct Parameters
     unsigned Nz_out; //!< \# of cells in z-direction in output file
     unsigned itstp; //!< \# of steps between outputs
     unsigned maxout; //!< \# of outputs excluding first
+    unsigned checkpoint; //!< \# of outputs between checkpoints (0 = no checkpoints)
+    unsigned insitu; //!< \# of steps between in-situ diagnostics (0 = no in-situ diagnostics)
+    unsigned n_modal; //!< \# of Legendre coefficients per direction in compressed field output (0 = nodal output)
 
     double eps_pol;  //!< accuracy of polarization 
     double jfactor; //jump factor € [1,0.01]
@@ -54,9 +57,12 @@ struct Parameters
     enum dg::bc bc; //!< global perpendicular boundary condition
     unsigned pollim; //!< 0= no poloidal limiter, 1 = poloidal limiter
     unsigned pardiss; //!< 0 = adjoint parallel dissipation, 1 = nonadjoint parallel dissipation
+    unsigned plane_cg; //!< 1 = solve perpendicular inversions plane by plane (dg::PlaneCG), 0 = one CG for all planes
+    unsigned pardiss_assembled; //!< 1 = assemble the adjoint parallel dissipation into one sparse matrix (shared memory only)
     unsigned mode; //!< 0 = blob simulations (several rounds fieldaligned), 1 = straight blob simulation( 1 round fieldaligned), 2 = turbulence simulations ( 1 round fieldaligned), 
     unsigned initcond; //!< 0 = zero electric potential, 1 = ExB vorticity equals ion diamagnetic vorticity
     unsigned curvmode; //!< 0 = low beta, 1 = toroidal field line 
+    unsigned huge_pages; //!< 1 = back the device vectors by transparent huge pages (only with DG_NUMA on the OpenMP backend)
     Parameters( const Json::Value& js) {
         n       = js["n"].asUInt();
         Nx      = js["Nx"].asUInt();
@@ -69,6 +75,9 @@ struct Parameters
         Nz_out  = js["Nz_out"].asUInt();
         itstp   = js["itstp"].asUInt();
         maxout  = js["maxout"].asUInt();
+        checkpoint = js.get("checkpoint", 0).asUInt();
+        n_modal = js.get("n_modal", 0).asUInt();
+        insitu = js.get("insitu", 0).asUInt();
 
         eps_pol     = js["eps_pol"].asDouble();
         jfactor     = js["jumpfactor"].asDouble();
@@ -105,9 +114,12 @@ struct Parameters
 
         pollim      = js.get( "pollim", 0).asUInt();
         pardiss     = js.get( "pardiss", 0).asUInt();
+        plane_cg    = js.get( "plane_cg", 0).asUInt();
+        pardiss_assembled = js.get( "pardiss_assembled", 0).asUInt();
         mode        = js.get( "mode", 0).asUInt();
         initcond    = js.get( "initial", 0).asUInt();
         curvmode    = js.get( "curvmode", 0).asUInt();
+        huge_pages  = js.get( "huge_pages", 0).asUInt();
     }
     /**
      * @brief Display parameters
@@ -156,14 +168,20 @@ struct Parameters
             <<"     Ny_out =              "<<Ny_out<<"\n"
             <<"     Nz_out =              "<<Nz_out<<"\n"
             <<"     Steps between output: "<<itstp<<"\n"
-            <<"     Number of outputs:    "<<maxout<<"\n";
+            <<"     Number of outputs:    "<<maxout<<"\n"
+            <<"     Outputs between checkpoints: "<<checkpoint<<"\n"
+            <<"     Modal output coefficients:   "<<n_modal<<"\n"
+            <<"     Steps between in-situ diagnostics: "<<insitu<<"\n";
         os << "Boundary condition is: \n"
             <<"     global BC             =              "<<dg::bc2str(bc)<<"\n"
             <<"     Poloidal limiter      =              "<<pollim<<"\n"
             <<"     Parallel dissipation  =              "<<pardiss<<"\n"
+            <<"     Plane by plane CG     =              "<<plane_cg<<"\n"
+            <<"     Assembled dissipation =              "<<pardiss_assembled<<"\n"
             <<"     Computation mode      =              "<<mode<<"\n"
             <<"     init cond             =              "<<initcond<<"\n"
-            <<"     curvature mode        =              "<<curvmode<<"\n";
+            <<"     curvature mode        =              "<<curvmode<<"\n"
+            <<"     huge pages            =              "<<huge_pages<<"\n";
         os << std::flush;
     }
 };
@@ -13,20 +13,32 @@ fig = plt.figure(figsize=(12,12))
 ax_probe = fig.add_subplot(121)
 ax_prof = fig.add_subplot(122)
 
-num_probes = 7
+def read_probes(fname):
+    """Read the binary output of probe_sink: returns names, x, y and records (time, values)"""
+    with open(fname, 'rb') as f:
+        assert(f.read(8) == b'DGPROBES')
+        num_probes, num_quantities = [int(d) for d in np.fromfile(f, dtype=np.uint64, count=2)]
+        names = [f.read(16).rstrip(b'\0').decode() for q in range(num_quantities)]
+        x = np.fromfile(f, dtype=np.float64, count=num_probes)
+        y = np.fromfile(f, dtype=np.float64, count=num_probes)
+        data = np.fromfile(f, dtype=np.float64)
+    record = 1 + num_quantities*num_probes
+    data = data[:data.size - data.size % record].reshape(-1, record)
+    values = data[:, 1:].reshape(-1, num_quantities, num_probes)
+    return names, x, y, data[:, 0], values
 
 plt.ion()
 plt.show()
 
 while(True):
     ax_prof.cla()
-    for n in np.arange(num_probes):
-        try:
-            df_probe = np.loadtxt('probe_%03d.dat' % n, skiprows=1)
-            ax_probe.plot(df_probe[:, 0], df_probe[:, 1]+n*2, 'k')
-            ax_probe.plot(df_probe[:, 0], df_probe[:, 3]+n*2, 'r')
-        except:
-            continue
+    try:
+        names, x, y, time, values = read_probes('probes.bin')
+        for n in np.arange(x.size):
+            ax_probe.plot(time, values[:, 0, n]+n*2, 'k')
+            ax_probe.plot(time, values[:, 2, n]+n*2, 'r')
+    except:
+        pass
 
     try:
         prof_ne = np.loadtxt('ne_prof.dat', skiprows=1)